@@ -0,0 +1,43 @@
+// Converts a mesh into a binary mesh, which scenariorunner can map straight
+// into memory instead of parsing it.
+#include "mesh.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+
+using namespace std;
+using namespace polyanya;
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        cerr << "usage: " << argv[0] << " <mesh> <binary mesh>" << endl;
+        return 1;
+    }
+
+    ifstream meshfile(argv[1]);
+    if (!meshfile.is_open())
+    {
+        cerr << "Unable to open mesh" << endl;
+        return 1;
+    }
+    Mesh m(meshfile);
+    meshfile.close();
+
+    ofstream outfile(argv[2], ios::out | ios::binary | ios::trunc);
+    if (!outfile.is_open())
+    {
+        cerr << "Unable to open output file" << endl;
+        return 1;
+    }
+    if (!m.write_binary(outfile))
+    {
+        return 1;
+    }
+    outfile.close();
+
+    cerr << "wrote " << m.num_vertices() << " vertices and "
+         << m.num_polygons() << " polygons to " << argv[2] << endl;
+    return 0;
+}
@@ -4,28 +4,62 @@
 #include "point.h"
 #include "mesh.h"
 #include "cfg.h"
+#include "timer.h"
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <vector>
 #include <iomanip>
 #include <algorithm>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
 
 using namespace std;
 using namespace polyanya;
 
-SearchInstance* si;
-
 int get_path = 0;
 int verbose = 0;
+int locate = 0;
 
 void print_header()
 {
     cout << "index;micro;successor_calls;generated;pushed;popped;"
-         << "pruned_post_pop;length;gridcost" << endl;
+         << "pruned_post_pop;length;gridcost;pruned_pre_push" << endl;
+}
+
+void print_locate_header()
+{
+    cout << "index;micro;start;goal" << endl;
+}
+
+// Only finds where the start and goal lie in the mesh.
+void run_locate(const Mesh* m, int index, const Scenario& scen, ostream& out)
+{
+    warthog::timer timer;
+    timer.start();
+    const PointLocation start = m->get_point_location(scen.start);
+    const PointLocation goal = m->get_point_location(scen.goal);
+    timer.stop();
+
+    #ifndef NDEBUG
+    if (start != m->get_point_location_naive(scen.start) ||
+        goal != m->get_point_location_naive(scen.goal))
+    {
+        cerr << "!!! bad point location for " << scen.start << " to "
+             << scen.goal << endl;
+    }
+    #endif
+
+    out << index << ";"
+        << timer.elapsed_time_micro() << ";"
+        << start << ";"
+        << goal << endl;
 }
 
-void run_scenario(int index, Scenario scen)
+void run_scenario(SearchInstance* si, int index, const Scenario& scen,
+                  ostream& out)
 {
     si->set_start_goal(scen.start, scen.goal);
     si->search();
@@ -51,28 +85,82 @@ void run_scenario(int index, Scenario scen)
         }
         #endif
 
-        cout << "path "<< index << "; ";
+        out << "path "<< index << "; ";
         for (int i = 0; i < n; i++)
         {
-            cout << path[i];
+            out << path[i];
             if (i != n-1)
             {
-                cout << " ";
+                out << " ";
             }
         }
-        cout << endl;
+        out << endl;
     }
     else
     {
-        cout << index << ";"
-             << si->get_search_micro() << ";"
-             << si->successor_calls << ";"
-             << si->nodes_generated << ";"
-             << si->nodes_pushed << ";"
-             << si->nodes_popped << ";"
-             << si->nodes_pruned_post_pop << ";"
-             << setprecision(16) << si->get_cost() << ";"
-             << setprecision(8) << scen.gridcost << endl;
+        out << index << ";"
+            << si->get_search_micro() << ";"
+            << si->successor_calls << ";"
+            << si->nodes_generated << ";"
+            << si->nodes_pushed << ";"
+            << si->nodes_popped << ";"
+            << si->nodes_pruned_post_pop << ";"
+            << setprecision(16) << si->get_cost() << ";"
+            << setprecision(8) << scen.gridcost << ";"
+            << si->nodes_pruned_pre_push << endl;
+    }
+}
+
+// Runs every scenario on num_threads threads, which share the mesh but each
+// use their own search instance. A thread takes the next scenario nobody has
+// taken yet and writes its output to a buffer; the buffers are printed in
+// scenario order once all threads are done.
+void run_threads(const Mesh* m, const vector<Scenario>& scenarios,
+                 int num_threads)
+{
+    const int num_scenarios = (int) scenarios.size();
+    vector<string> output(num_scenarios);
+    atomic<int> next_scenario(0);
+
+    auto work = [&]()
+    {
+        SearchInstance* si = locate ? nullptr : new SearchInstance(m);
+        while (true)
+        {
+            const int i = next_scenario++;
+            if (i >= num_scenarios)
+            {
+                break;
+            }
+            ostringstream out;
+            // Matches the precision cout is left with after the first row.
+            out << setprecision(8);
+            if (locate)
+            {
+                run_locate(m, i, scenarios[i], out);
+            }
+            else
+            {
+                run_scenario(si, i, scenarios[i], out);
+            }
+            output[i] = out.str();
+        }
+        delete si;
+    };
+
+    vector<thread> threads;
+    for (int i = 0; i < num_threads; i++)
+    {
+        threads.emplace_back(work);
+    }
+    for (thread& t : threads)
+    {
+        t.join();
+    }
+
+    for (const string& line : output)
+    {
+        cout << line;
     }
 }
 
@@ -82,6 +170,9 @@ int main(int argc, char* argv[])
     {
         {"path", no_argument, &get_path, 1},
         {"verbose", no_argument, &verbose, 1},
+        {"locate", no_argument, &locate, 1},
+        {"threads", required_argument, 0, 1},
+        {0, 0, 0, 0}
     };
 
     warthog::util::cfg cfg;
@@ -89,26 +180,50 @@ int main(int argc, char* argv[])
 
     if (argc - optind != 2)
     {
-        cerr << "usage: " << argv[0] << "[--path] [--verbose]"
-             << "<mesh> <scenario>" << endl;
+        cerr << "usage: " << argv[0] << " [--path] [--verbose] [--locate]"
+             << " [--threads N] <mesh> <scenario>" << endl;
         return 1;
     }
 
-    string temp = argv[optind];;
-    ifstream meshfile(temp);
-    if (!meshfile.is_open())
+    int num_threads = 1;
+    const string threads_value = cfg.get_param_value("threads");
+    if (threads_value != "")
+    {
+        num_threads = atoi(threads_value.c_str());
+        if (num_threads < 1)
+        {
+            cerr << "Number of threads must be at least 1" << endl;
+            return 1;
+        }
+    }
+    if (verbose && num_threads > 1)
     {
-        cerr << "Unable to open mesh" << endl;
+        // The debug output of the searches would be interleaved.
+        cerr << "--verbose can only be used with one thread" << endl;
         return 1;
     }
-    Mesh* m = new Mesh(meshfile);
-    meshfile.close();
-
-    si = new SearchInstance(m);
 
-    if (verbose)
+    string temp = argv[optind];;
+    Mesh* m;
+    if (Mesh::is_binary(temp))
     {
-        si->verbose = true;
+        // Made by meshcompiler: map it instead of parsing it.
+        m = new Mesh();
+        if (!m->read_binary(temp))
+        {
+            return 1;
+        }
+    }
+    else
+    {
+        ifstream meshfile(temp);
+        if (!meshfile.is_open())
+        {
+            cerr << "Unable to open mesh" << endl;
+            return 1;
+        }
+        m = new Mesh(meshfile);
+        meshfile.close();
     }
 
     vector<Scenario> scenarios;
@@ -122,16 +237,40 @@ int main(int argc, char* argv[])
     load_scenarios(scenfile, scenarios);
     scenfile.close();
 
-    if (!get_path)
+    if (locate)
+    {
+        print_locate_header();
+    }
+    else if (!get_path)
     {
         print_header();
     }
-    for (int i = 0; i < (int) scenarios.size(); i++)
+
+    if (num_threads > 1)
+    {
+        run_threads(m, scenarios, num_threads);
+    }
+    else if (locate)
     {
-        run_scenario(i, scenarios[i]);
+        for (int i = 0; i < (int) scenarios.size(); i++)
+        {
+            run_locate(m, i, scenarios[i], cout);
+        }
+    }
+    else
+    {
+        SearchInstance* si = new SearchInstance(m);
+        if (verbose)
+        {
+            si->verbose = true;
+        }
+        for (int i = 0; i < (int) scenarios.size(); i++)
+        {
+            run_scenario(si, i, scenarios[i], cout);
+        }
+        delete si;
     }
 
-    delete si;
     delete m;
     return 0;
 }
@@ -91,9 +91,9 @@ double get_h_value(const Point& root, Point goal,
 #define normalise(index) (index) - ((index) >= N ? N : 0)
 // Assume that there exists at least one element within the range which
 // satisifies the predicate.
-template<typename Type, typename Pred>
-inline int binary_search(const std::vector<int>& arr, const int N,
-                         const std::vector<Type>& objects, int lower, int upper,
+template<typename Pred>
+inline int binary_search(const int* arr, const int N,
+                         const Mesh& mesh, int lower, int upper,
                          const Pred pred, const bool is_upper_bound)
 {
     if (lower == upper) return lower;
@@ -101,7 +101,7 @@ inline int binary_search(const std::vector<int>& arr, const int N,
     while (lower <= upper)
     {
         const int mid = lower + (upper - lower) / 2;
-        const bool matches_pred = pred(objects[arr[normalise(mid)]]);
+        const bool matches_pred = pred(mesh.vertex_point(arr[normalise(mid)]));
         if (matches_pred)
         {
             best_so_far = mid;
@@ -139,13 +139,11 @@ int get_successors(SearchNode& node, const Point& start, const Mesh& mesh,
     // If the next polygon is -1, we did a bad job at pruning...
     assert(node.next_polygon != -1);
 
-    const Polygon& polygon = mesh.mesh_polygons[node.next_polygon];
-    const std::vector<Vertex>& mesh_vertices = mesh.mesh_vertices;
-    // V, P and N are solely used for conciseness
-    const std::vector<int>& V = polygon.vertices;
-    const int N = (int) V.size();
+    // V and N are solely used for conciseness
+    const int* V = mesh.poly_vertex_list(node.next_polygon);
+    const int N = mesh.poly_size(node.next_polygon);
 
-    const Point& root = (node.root == -1 ? start : mesh_vertices[node.root].p);
+    const Point root = (node.root == -1 ? start : mesh.vertex_point(node.root));
 
     int out = 0;
 
@@ -177,7 +175,7 @@ int get_successors(SearchNode& node, const Point& start, const Mesh& mesh,
                 )))
             {
                 // We should turn at L... if we can!
-                if (!mesh_vertices[node.left_vertex].is_corner)
+                if (!mesh.vertex_is_corner[node.left_vertex])
                 {
                     return 0;
                 }
@@ -186,7 +184,7 @@ int get_successors(SearchNode& node, const Point& start, const Mesh& mesh,
             else
             {
                 // We should turn at R... if we can!
-                if (!mesh_vertices[node.right_vertex].is_corner)
+                if (!mesh.vertex_is_corner[node.right_vertex])
                 {
                     return 0;
                 }
@@ -195,7 +193,7 @@ int get_successors(SearchNode& node, const Point& start, const Mesh& mesh,
 
             // We can be lazy and start iterating from any point.
             // We still need to exclude the current interval as a successor.
-            int last_vertex = V.back();
+            int last_vertex = V[N - 1];
 
             for (int i = 0; i < N; i++)
             {
@@ -207,8 +205,8 @@ int get_successors(SearchNode& node, const Point& start, const Mesh& mesh,
                     last_vertex = this_vertex;
                     continue;
                 }
-                const Point& left = mesh_vertices[this_vertex].p,
-                             right = mesh_vertices[last_vertex].p;
+                const Point left = mesh.vertex_point(this_vertex),
+                            right = mesh.vertex_point(last_vertex);
                 successors[out++] = {succ_type, left, right, i};
                 last_vertex = this_vertex;
             }
@@ -224,9 +222,9 @@ int get_successors(SearchNode& node, const Point& start, const Mesh& mesh,
         // Note that p3 is redundant, as that's the polygon we came from.
 
         // The right point of the triangle.
-        const Point& t1 = mesh_vertices[node.right_vertex].p;
+        const Point t1 = mesh.vertex_point(node.right_vertex);
         // The middle point of the triangle.
-        const Point& t2 = [&]() -> const Point&
+        const Point t2 = [&]() -> Point
         {
             // horrible hacky lambda which also sets p1/p2
 
@@ -236,25 +234,25 @@ int get_successors(SearchNode& node, const Point& start, const Mesh& mesh,
                 // t1 = V[0], t2 = V[1], t3 = V[2]
                 p1 = 1;
                 p2 = 2;
-                return mesh_vertices[V[1]].p;
+                return mesh.vertex_point(V[1]);
             }
             else if (V[0] == node.left_vertex)
             {
                 // t1 = V[1], t2 = V[2], t3 = V[0]
                 p1 = 2;
                 p2 = 0;
-                return mesh_vertices[V[2]].p;
+                return mesh.vertex_point(V[2]);
             }
             else
             {
                 // t1 = V[2], t2 = V[0], t3 = V[1]
                 p1 = 0;
                 p2 = 1;
-                return mesh_vertices[V[0]].p;
+                return mesh.vertex_point(V[0]);
             }
         }();
         // The left point of the triangle.
-        const Point& t3 = mesh_vertices[node.left_vertex].p;
+        const Point t3 = mesh.vertex_point(node.left_vertex);
 
 
 
@@ -285,7 +283,7 @@ int get_successors(SearchNode& node, const Point& start, const Mesh& mesh,
                 };
 
                 // if we can turn left
-                if (mesh_vertices[node.left_vertex].is_corner && L == t3)
+                if (mesh.vertex_is_corner[node.left_vertex] && L == t3)
                 {
                     // left_non_observable(LI, 2)
                     successors[1] = {
@@ -321,7 +319,7 @@ int get_successors(SearchNode& node, const Point& start, const Mesh& mesh,
                 };
 
                 // if we can turn left
-                if (mesh_vertices[node.left_vertex].is_corner && L == t3)
+                if (mesh.vertex_is_corner[node.left_vertex] && L == t3)
                 {
                     // left_collinear(2, 3)
                     successors[1] = {
@@ -351,7 +349,7 @@ int get_successors(SearchNode& node, const Point& start, const Mesh& mesh,
                         const Point RI = line_intersect(t2, t3, root, R);
 
                         // if we can turn right
-                        if (mesh_vertices[node.right_vertex].is_corner &&
+                        if (mesh.vertex_is_corner[node.right_vertex] &&
                             R == t1)
                         {
                             // right_collinear(1, 2)
@@ -392,7 +390,7 @@ int get_successors(SearchNode& node, const Point& start, const Mesh& mesh,
                     {
                         // RI = 2
                         // if we can turn right
-                        if (mesh_vertices[node.right_vertex].is_corner &&
+                        if (mesh.vertex_is_corner[node.right_vertex] &&
                             R == t1)
                         {
                             // right_collinear(1, 2)
@@ -459,9 +457,9 @@ int get_successors(SearchNode& node, const Point& start, const Mesh& mesh,
     // It is not collinear.
     // Find the starting vertex (the "right" vertex).
 
-    // Note that "_ind" means "index in V/P",
-    // "_vertex" means "index of mesh_vertices".
-    // "_vertex_obj" means "object of the vertex" and
+    // Note that "_ind" means "index in V",
+    // "_vertex" means "index of a mesh vertex",
+    // "_is_corner" means "whether the vertex is a corner" and
     // "_p" means "point".
     const int right_ind = [&]() -> int
     {
@@ -482,16 +480,17 @@ int get_successors(SearchNode& node, const Point& start, const Mesh& mesh,
     assert(V[normalise(left_ind)] == node.left_vertex);
 
     // Find whether we can turn at either endpoint.
-    const Vertex& right_vertex_obj = mesh_vertices[node.right_vertex];
-    const Vertex& left_vertex_obj  = mesh_vertices[V[normalise(left_ind)]];
+    const int left_vertex = V[normalise(left_ind)];
+    const bool right_is_corner = mesh.vertex_is_corner[node.right_vertex];
+    const bool left_is_corner  = mesh.vertex_is_corner[left_vertex];
 
-    const Point& right_p = right_vertex_obj.p;
-    const Point& left_p  = left_vertex_obj.p;
+    const Point right_p = mesh.vertex_point(node.right_vertex);
+    const Point left_p  = mesh.vertex_point(left_vertex);
     const bool right_lies_vertex = right_p == node.right;
     const bool left_lies_vertex  = left_p == node.left;
 
     // Macro for getting a point from a polygon point index.
-    #define index2point(index) mesh_vertices[V[index]].p
+    #define index2point(index) mesh.vertex_point(V[index])
 
     // find the transition between non-observable-right and observable.
     // we will call this A, defined by:
@@ -515,11 +514,11 @@ int get_successors(SearchNode& node, const Point& start, const Mesh& mesh,
                 return right_ind + 1;
             }
         }
-        return binary_search(V, N, mesh_vertices, right_ind + 1, left_ind,
-            [&root_right, &node](const Vertex& v)
+        return binary_search(V, N, mesh, right_ind + 1, left_ind,
+            [&root_right, &node](const Point& p)
             {
                 // STRICTLY CCW.
-                return root_right * (v.p - node.right) > EPSILON;
+                return root_right * (p - node.right) > EPSILON;
             }, false
         );
     }();
@@ -527,8 +526,8 @@ int get_successors(SearchNode& node, const Point& start, const Mesh& mesh,
     const int normalised_A = normalise(A),
               normalised_Am1 = normalise(A-1);
 
-    const Point& A_p = index2point(normalised_A);
-    const Point& Am1_p = index2point(normalised_Am1);
+    const Point A_p = index2point(normalised_A);
+    const Point Am1_p = index2point(normalised_Am1);
     const Point right_intersect = right_lies_vertex && A == right_ind + 1 ? node.right : line_intersect(A_p, Am1_p, root, node.right);
 
     // find the transition between observable and non-observable-left.
@@ -552,24 +551,24 @@ int get_successors(SearchNode& node, const Point& start, const Mesh& mesh,
                 return left_ind - 1;
             }
         }
-        return binary_search(V, N, mesh_vertices, A - 1, left_ind - 1,
-            [&root_left, &node](const Vertex& v)
+        return binary_search(V, N, mesh, A - 1, left_ind - 1,
+            [&root_left, &node](const Point& p)
             {
                 // STRICTLY CW.
-                return root_left * (v.p - node.left) < -EPSILON;
+                return root_left * (p - node.left) < -EPSILON;
             }, true
         );
     }();
     assert(B != -1);
     const int normalised_B = normalise(B),
               normalised_Bp1 = normalise(B+1);
-    const Point& B_p = index2point(normalised_B);
-    const Point& Bp1_p = index2point(normalised_Bp1);
+    const Point B_p = index2point(normalised_B);
+    const Point Bp1_p = index2point(normalised_Bp1);
     const Point left_intersect = left_lies_vertex && B == left_ind - 1 ? node.left : line_intersect(B_p, Bp1_p, root, node.left);
 
     // Macro to update this_inde/last_ind.
     #define update_ind() last_ind = cur_ind++; if (cur_ind == N) cur_ind = 0
-    if (right_lies_vertex && right_vertex_obj.is_corner)
+    if (right_lies_vertex && right_is_corner)
     {
         // Generate non-observable.
 
@@ -677,7 +676,7 @@ int get_successors(SearchNode& node, const Point& start, const Mesh& mesh,
         };
     }
 
-    if (left_lies_vertex && left_vertex_obj.is_corner)
+    if (left_lies_vertex && left_is_corner)
     {
         // Generate non-observable from left_intersect to Bp1_p
         // if left_intersect != Bp1_p.
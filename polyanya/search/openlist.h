@@ -0,0 +1,108 @@
+#pragma once
+#include "searchnode.h"
+#include <vector>
+
+namespace polyanya
+{
+
+// The open list of the search: a min-heap of search nodes, ordered like
+// SearchNode (smallest f first, and biggest g first among equal f).
+//
+// Each heap entry keeps a copy of the node's f and g next to the pointer,
+// so sifting compares keys stored side by side instead of dereferencing
+// nodes scattered across the node pool. The heap is 4-ary: the children
+// of an entry are contiguous, which makes it shallower than a binary heap
+// and keeps each step of a sift down within a couple of cache lines.
+//
+// clear() keeps the memory of the heap, so a search instance reuses it
+// for every query.
+class OpenList
+{
+    private:
+        static const int ARITY = 4;
+
+        struct Entry
+        {
+            double f, g;
+            SearchNodePtr node;
+
+            bool operator<(const Entry& other) const
+            {
+                if (f == other.f)
+                {
+                    return g > other.g;
+                }
+                return f < other.f;
+            }
+        };
+
+        std::vector<Entry> heap;
+
+    public:
+        bool empty() const { return heap.empty(); }
+        int size() const { return (int) heap.size(); }
+        void clear() { heap.clear(); }
+
+        void push(SearchNodePtr node)
+        {
+            const Entry entry = {node->f, node->g, node};
+            int i = (int) heap.size();
+            heap.push_back(entry);
+            // Sift up.
+            while (i > 0)
+            {
+                const int parent = (i - 1) / ARITY;
+                if (!(entry < heap[parent]))
+                {
+                    break;
+                }
+                heap[i] = heap[parent];
+                i = parent;
+            }
+            heap[i] = entry;
+        }
+
+        SearchNodePtr top() const
+        {
+            return heap[0].node;
+        }
+
+        void pop()
+        {
+            const Entry last = heap.back();
+            heap.pop_back();
+            const int n = (int) heap.size();
+            if (n == 0)
+            {
+                return;
+            }
+            // Sift the last entry down from the root.
+            int i = 0;
+            while (true)
+            {
+                const int first = i * ARITY + 1;
+                if (first >= n)
+                {
+                    break;
+                }
+                const int end = first + ARITY < n ? first + ARITY : n;
+                int best = first;
+                for (int c = first + 1; c < end; c++)
+                {
+                    if (heap[c] < heap[best])
+                    {
+                        best = c;
+                    }
+                }
+                if (!(heap[best] < last))
+                {
+                    break;
+                }
+                heap[i] = heap[best];
+                i = best;
+            }
+            heap[i] = last;
+        }
+};
+
+}
@@ -77,9 +77,9 @@ int SearchInstance::succ_to_node(
   )
 {
   assert(mesh != nullptr);
-  const Polygon& polygon = mesh->mesh_polygons[parent->next_polygon];
-  const std::vector<int>& V = polygon.vertices;
-  const std::vector<int>& P = polygon.polygons;
+  const int* V = mesh->poly_vertex_list(parent->next_polygon);
+  const int* P = mesh->poly_polygon_list(parent->next_polygon);
+  const int N = mesh->poly_size(parent->next_polygon);
 
   double right_g = -1, left_g = -1;
 
@@ -95,7 +95,7 @@ int SearchInstance::succ_to_node(
 
     // If the successor we're about to push pushes into a one-way polygon,
     // and the polygon isn't the end polygon, just continue.
-    if (mesh->mesh_polygons[next_polygon].is_one_way &&
+    if (mesh->poly_is_one_way[next_polygon] &&
         next_polygon != end_polygon)
     {
       continue;
@@ -103,7 +103,7 @@ int SearchInstance::succ_to_node(
     const int left_vertex  = V[succ.poly_left_ind];
     const int right_vertex = succ.poly_left_ind ?
            V[succ.poly_left_ind - 1] :
-           V.back();
+           V[N - 1];
 
     // Note that g is evaluated twice here. (But this is a lambda!)
     // Always try to precompute before using this macro.
@@ -127,6 +127,7 @@ int SearchInstance::succ_to_node(
                    if (root_g_values[root] + EPSILON < g)
                    {
                      // We've done better!
+                     nodes_pruned_pre_push++;
                      return;
                    }
                    else
@@ -140,9 +141,9 @@ int SearchInstance::succ_to_node(
                    right_vertex, next_polygon, g, g};
              };
 
-    const Point& parent_root = (parent->root == -1 ?
+    const Point parent_root = (parent->root == -1 ?
               start :
-              mesh->mesh_vertices[parent->root].p);
+              mesh->vertex_point(parent->root));
   #define get_g(new_root) parent->g + parent_root.distance(new_root)
 
     switch (succ.type)
@@ -202,7 +203,6 @@ void SearchInstance::gen_initial_nodes()
   {nullptr, -1, start, start, left, right, next, h, 0 \
   }
 
-    #define v(vertex) mesh->mesh_vertices[vertex]
 
   const auto push_lazy = [&](SearchNodePtr lazy)
              {
@@ -225,12 +225,12 @@ void SearchInstance::gen_initial_nodes()
                  return;
                }
                // iterate over poly, throwing away vertices if needed
-               const std::vector<int>& vertices =
-                 mesh->mesh_polygons[poly].vertices;
-               Successor* successors = new Successor [vertices.size()];
-               int last_vertex = vertices.back();
+               const int* vertices = mesh->poly_vertex_list(poly);
+               const int num_vertices = mesh->poly_size(poly);
+               Successor* successors = new Successor [num_vertices];
+               int last_vertex = vertices[num_vertices - 1];
                int num_succ = 0;
-               for (int i = 0; i < (int) vertices.size(); i++)
+               for (int i = 0; i < num_vertices; i++)
                {
                  const int vertex = vertices[i];
                  if (vertex == lazy->right_vertex ||
@@ -240,8 +240,8 @@ void SearchInstance::gen_initial_nodes()
                    continue;
                  }
                  successors[num_succ++] =
-                 {Successor::OBSERVABLE, v(vertex).p,
-            v(last_vertex).p, i};
+                 {Successor::OBSERVABLE, mesh->vertex_point(vertex),
+            mesh->vertex_point(last_vertex), i};
                  last_vertex = vertex;
                }
                SearchNode* nodes = new SearchNode [num_succ];
@@ -250,11 +250,16 @@ void SearchInstance::gen_initial_nodes()
                delete[] successors;
                for (int i = 0; i < num_nodes; i++)
                {
+                 const Point n_root = (nodes[i].root == -1 ? start :
+                      mesh->vertex_point(nodes[i].root));
+                 nodes[i].f += get_h_value(n_root, goal, nodes[i].left,
+                      nodes[i].right);
+                 if (prune_on_push(nodes[i]))
+                 {
+                   continue;
+                 }
                  SearchNodePtr n = new (node_pool->allocate())
                  SearchNode(nodes[i]);
-                 const Point& n_root = (n->root == -1 ? start :
-                      mesh->mesh_vertices[n->root].p);
-                 n->f += get_h_value(n_root, goal, n->left, n->right);
                  n->parent = lazy;
       #ifndef NDEBUG
                  if (verbose)
@@ -280,10 +285,10 @@ void SearchInstance::gen_initial_nodes()
                  }
       #endif
                  open_list.push(n);
+                 nodes_pushed++;
                }
                delete[] nodes;
                nodes_generated += num_nodes;
-               nodes_pushed += num_nodes;
              };
 
   switch (pl.type)
@@ -329,8 +334,10 @@ void SearchInstance::gen_initial_nodes()
 
   case PointLocation::ON_NON_CORNER_VERTEX:
   {
-    for (int& poly : v(pl.vertex1).polygons)
+    for (int i = mesh->vertex_offsets[pl.vertex1];
+         i < mesh->vertex_offsets[pl.vertex1 + 1]; i++)
     {
+      const int poly = mesh->vertex_polygons[i];
       SearchNodePtr lazy = get_lazy(poly, pl.vertex1, pl.vertex1);
       push_lazy(lazy);
       nodes_generated++;
@@ -348,11 +355,10 @@ void SearchInstance::gen_initial_nodes()
     break;
   }
 
-    #undef v
     #undef get_lazy
 }
 
-#define root_to_point(root) ((root) == -1 ? start : mesh->mesh_vertices[root].p)
+#define root_to_point(root) ((root) == -1 ? start : mesh->vertex_point(root))
 
 bool SearchInstance::search()
 {
@@ -398,7 +404,7 @@ bool SearchInstance::search()
 
       const int final_root = [&]()
                  {
-                   const Point& root = root_to_point(node->root);
+                   const Point root = root_to_point(node->root);
                    const Point root_goal = goal - root;
                    // If root-left-goal is not CW, use left.
                    if (root_goal * (node->left - root) < -EPSILON)
@@ -532,11 +538,15 @@ bool SearchInstance::search()
     for (int i = 0; i < num_nodes; i++)
     {
       // We need to update the h value before we push!
-      const SearchNodePtr n = new (node_pool->allocate())
-            SearchNode(search_nodes_to_push[i]);
-      const Point& n_root = (n->root == -1 ? start :
-                 mesh->mesh_vertices[n->root].p);
-      n->f += get_h_value(n_root, goal, n->left, n->right);
+      SearchNode& to_push = search_nodes_to_push[i];
+      const Point n_root = (to_push.root == -1 ? start :
+                 mesh->vertex_point(to_push.root));
+      to_push.f += get_h_value(n_root, goal, to_push.left, to_push.right);
+      if (prune_on_push(to_push))
+      {
+        continue;
+      }
+      const SearchNodePtr n = new (node_pool->allocate()) SearchNode(to_push);
 
       // This node's parent should be nullptr, so we should set it.
       n->parent = node;
@@ -564,9 +574,9 @@ bool SearchInstance::search()
       #endif
 
       open_list.push(n);
+      nodes_pushed++;
     }
     nodes_generated += num_nodes;
-    nodes_pushed += num_nodes;
 
     if(verbose)
     {
@@ -3,32 +3,25 @@
 #include "successor.h"
 #include "mesh.h"
 #include "point.h"
+#include "openlist.h"
 #include "cpool.h"
 #include "timer.h"
-#include <queue>
+#include "consts.h"
 #include <vector>
 #include <ctime>
+#include <limits>
 #include "Debug.h"
 
 namespace polyanya
 {
 
-template<typename T, typename Compare = std::greater<T> >
-struct PointerComp
-{
-    bool operator()(const T* x,
-                    const T* y) const
-    {
-        return Compare()(*x, *y);
-    }
-};
-
-typedef Mesh* MeshPtr;
+// A search instance only reads the mesh, and keeps all state of a query to
+// itself. One mesh can be shared by many search instances, such as one per
+// thread.
+typedef const Mesh* MeshPtr;
 
 class SearchInstance
 {
-    typedef std::priority_queue<SearchNodePtr, std::vector<SearchNodePtr>,
-                                PointerComp<SearchNode> > pq;
     private:
 		Debugger debug;
         warthog::mem::cpool* node_pool;
@@ -37,7 +30,11 @@ class SearchInstance
 
         SearchNodePtr final_node;
         int end_polygon; // set by init_search
-        pq open_list;
+        OpenList open_list;
+        // Cost of the best path found so far: the smallest f of a node
+        // pushing into end_polygon. Such a node sees the goal from its
+        // interval, so its f is the length of an actual path.
+        double best_path_cost;
 
         // Best g value for a specific vertex.
         std::vector<double> root_g_values;
@@ -55,6 +52,7 @@ class SearchInstance
         void init()
         {
             verbose = false;
+            push_pruning = true;
             search_successors = new Successor [mesh->max_poly_sides + 2];
             search_nodes_to_push = new SearchNode [mesh->max_poly_sides + 2];
             node_pool = new warthog::mem::cpool(sizeof(SearchNode));
@@ -64,7 +62,7 @@ class SearchInstance
         {
             assert(mesh != nullptr);
             search_id = 0;
-            size_t num_vertices = mesh->mesh_vertices.size();
+            size_t num_vertices = mesh->num_vertices();
             root_g_values.resize(num_vertices);
             root_search_ids.resize(num_vertices);
         }
@@ -73,11 +71,13 @@ class SearchInstance
             assert(node_pool);
             node_pool->reclaim();
             search_id++;
-            open_list = pq();
+            open_list.clear(); // keeps its memory for the next search
+            best_path_cost = std::numeric_limits<double>::infinity();
             final_node = nullptr;
             nodes_generated = 0;
             nodes_pushed = 0;
             nodes_popped = 0;
+            nodes_pruned_pre_push = 0;
             nodes_pruned_post_pop = 0;
             successor_calls = 0;
             set_end_polygon();
@@ -92,13 +92,32 @@ class SearchInstance
         );
         void print_node(SearchNodePtr node, std::ostream& outfile);
 
+        // Whether a node, with its f value set, can be dropped instead of
+        // being pushed: its f is worse than the best path found so far,
+        // so it would never be popped before the search ends.
+        bool prune_on_push(const SearchNode& node)
+        {
+            if (push_pruning && node.f > best_path_cost + EPSILON)
+            {
+                nodes_pruned_pre_push++;
+                return true;
+            }
+            if (node.next_polygon == end_polygon && node.f < best_path_cost)
+            {
+                best_path_cost = node.f;
+            }
+            return false;
+        }
+
     public:
         int nodes_generated;        // Nodes stored in memory
         int nodes_pushed;           // Nodes pushed onto open
         int nodes_popped;           // Nodes popped off open
+        int nodes_pruned_pre_push;  // Nodes we prune instead of pushing
         int nodes_pruned_post_pop;  // Nodes we prune right after popping off
         int successor_calls;        // Times we call get_successors
         bool verbose;
+        bool push_pruning;          // Use prune_on_push (default: true)
 
         SearchInstance() { }
         SearchInstance(MeshPtr m) : mesh(m) { init(); }
@@ -134,6 +153,13 @@ class SearchInstance
             return final_node->f;
         }
 
+        // The smallest f of a node pushed into the end polygon, or
+        // infinity if there was none; see prune_on_push
+        double get_best_path_cost()
+        {
+            return best_path_cost;
+        }
+
         double get_search_micro()
         {
             return timer.elapsed_time_micro();
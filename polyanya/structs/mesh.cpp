@@ -6,6 +6,12 @@
 #include <cmath>
 #include <cassert>
 #include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace polyanya
 {
@@ -14,6 +20,7 @@ Mesh::Mesh(std::istream& infile)
 {
     read(infile);
     precalc_point_location();
+    flatten();
 }
 
 void Mesh::read(std::istream& infile)
@@ -221,43 +228,389 @@ void Mesh::read(std::istream& infile)
     #undef fail
 }
 
+// Buckets the polygons into a uniform grid over the mesh.
 void Mesh::precalc_point_location()
 {
-    for (Vertex& v : mesh_vertices)
+    // Square cells, about POINT_LOCATION_CELLS_PER_POLY of them per polygon.
+    const double width = std::max(max_x - min_x, EPSILON);
+    const double height = std::max(max_y - min_y, EPSILON);
+    const double num_cells =
+        POINT_LOCATION_CELLS_PER_POLY * mesh_polygons.size();
+    grid_scale = std::sqrt(num_cells / (width * height));
+    grid_width = (int) (width * grid_scale) + 1;
+    grid_height = (int) (height * grid_scale) + 1;
+
+    // Points within EPSILON of a polygon may lie on it, so grow each
+    // bounding box by EPSILON.
+    const auto cell_x = [&](double x) -> int
     {
-        slabs[v.p.x] = std::vector<int>(0); // initialises the vector
-    }
+        return std::min(std::max((int) ((x - min_x) * grid_scale), 0),
+                        grid_width - 1);
+    };
+    const auto cell_y = [&](double y) -> int
+    {
+        return std::min(std::max((int) ((y - min_y) * grid_scale), 0),
+                        grid_height - 1);
+    };
+    cells.assign(grid_width * grid_height, std::vector<int>());
     for (int i = 0; i < (int) mesh_polygons.size(); i++)
     {
         const Polygon& p = mesh_polygons[i];
-        const auto low_it = slabs.lower_bound(p.min_x);
-        const auto high_it = slabs.upper_bound(p.max_x);
+        const int x_end = cell_x(p.max_x + EPSILON);
+        const int y_end = cell_y(p.max_y + EPSILON);
+        for (int y = cell_y(p.min_y - EPSILON); y <= y_end; y++)
+        {
+            for (int x = cell_x(p.min_x - EPSILON); x <= x_end; x++)
+            {
+                cells[y * grid_width + x].push_back(i);
+            }
+        }
+    }
+}
+
+// Builds the image of the mesh from mesh_vertices, mesh_polygons and the
+// cells made by precalc_point_location.
+void Mesh::flatten()
+{
+    MeshImageHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MESH_IMAGE_MAGIC, sizeof(h.magic));
+    h.version = MESH_IMAGE_VERSION;
+    h.max_poly_sides = max_poly_sides;
+    h.num_vertices = (int) mesh_vertices.size();
+    h.num_polygons = (int) mesh_polygons.size();
+    for (const Vertex& v : mesh_vertices)
+    {
+        h.num_vertex_polygons += (int) v.polygons.size();
+    }
+    for (const Polygon& p : mesh_polygons)
+    {
+        h.num_poly_vertices += (int) p.vertices.size();
+    }
+    h.grid_width = grid_width;
+    h.grid_height = grid_height;
+    for (const std::vector<int>& cell : cells)
+    {
+        h.num_cell_polygons += (int) cell.size();
+    }
+    h.min_x = min_x;
+    h.max_x = max_x;
+    h.min_y = min_y;
+    h.max_y = max_y;
+    h.grid_scale = grid_scale;
+
+    // Give every array the next free offset, rounded up to a multiple of 8.
+    uint64_t size = sizeof(h);
+    const auto place = [&](uint64_t& offset, uint64_t bytes)
+    {
+        offset = (size + 7) & ~(uint64_t) 7;
+        size = offset + bytes;
+    };
+    const uint64_t V = h.num_vertices, P = h.num_polygons,
+                   C = (uint64_t) h.grid_width * h.grid_height;
+    place(h.vertex_x, sizeof(double) * V);
+    place(h.vertex_y, sizeof(double) * V);
+    place(h.poly_min_x, sizeof(double) * P);
+    place(h.poly_max_x, sizeof(double) * P);
+    place(h.poly_min_y, sizeof(double) * P);
+    place(h.poly_max_y, sizeof(double) * P);
+    place(h.vertex_offsets, sizeof(int) * (V + 1));
+    place(h.vertex_polygons, sizeof(int) * h.num_vertex_polygons);
+    place(h.poly_offsets, sizeof(int) * (P + 1));
+    place(h.poly_vertices, sizeof(int) * h.num_poly_vertices);
+    place(h.poly_polygons, sizeof(int) * h.num_poly_vertices);
+    place(h.cell_offsets, sizeof(int) * (C + 1));
+    place(h.cell_polygons, sizeof(int) * h.num_cell_polygons);
+    place(h.vertex_is_corner, V);
+    place(h.vertex_is_ambig, V);
+    place(h.poly_is_one_way, P);
+    place(h.image_size, 0);
+
+    // Allocate as 64-bit words so that every array is aligned.
+    uint64_t* words = new uint64_t[h.image_size / 8];
+    memset(words, 0, h.image_size);
+    char* data = (char*) words;
+    memcpy(data, &h, sizeof(h));
+    #define flat(type, name) ((type*) (data + h.name))
+
+    for (int i = 0; i < h.num_vertices; i++)
+    {
+        const Vertex& v = mesh_vertices[i];
+        flat(double, vertex_x)[i] = v.p.x;
+        flat(double, vertex_y)[i] = v.p.y;
+        flat(char, vertex_is_corner)[i] = v.is_corner;
+        flat(char, vertex_is_ambig)[i] = v.is_ambig;
+    }
+    int out = 0;
+    for (int i = 0; i < h.num_vertices; i++)
+    {
+        flat(int, vertex_offsets)[i] = out;
+        for (int poly : mesh_vertices[i].polygons)
+        {
+            flat(int, vertex_polygons)[out++] = poly;
+        }
+    }
+    flat(int, vertex_offsets)[h.num_vertices] = out;
+
+    out = 0;
+    for (int i = 0; i < h.num_polygons; i++)
+    {
+        const Polygon& p = mesh_polygons[i];
+        flat(char, poly_is_one_way)[i] = p.is_one_way;
+        flat(double, poly_min_x)[i] = p.min_x;
+        flat(double, poly_max_x)[i] = p.max_x;
+        flat(double, poly_min_y)[i] = p.min_y;
+        flat(double, poly_max_y)[i] = p.max_y;
+        flat(int, poly_offsets)[i] = out;
+        for (int j = 0; j < (int) p.vertices.size(); j++)
+        {
+            flat(int, poly_vertices)[out] = p.vertices[j];
+            flat(int, poly_polygons)[out] = p.polygons[j];
+            out++;
+        }
+    }
+    flat(int, poly_offsets)[h.num_polygons] = out;
 
-        for (auto it = low_it; it != high_it; it++)
+    out = 0;
+    for (uint64_t i = 0; i < C; i++)
+    {
+        flat(int, cell_offsets)[i] = out;
+        for (int poly : cells[i])
         {
-            it->second.push_back(i);
+            flat(int, cell_polygons)[out++] = poly;
         }
     }
-    for (auto& pair : slabs)
+    flat(int, cell_offsets)[C] = out;
+    #undef flat
+
+    cells.clear();
+    bind_image(std::shared_ptr<const char>(data,
+        [](const char* p) { delete[] (const uint64_t*) p; }));
+}
+
+// Points the flat arrays into an image.
+void Mesh::bind_image(std::shared_ptr<const char> data)
+{
+    image = data;
+    const char* base = image.get();
+    header = (const MeshImageHeader*) base;
+    #define bind_array(type, name) name = (const type*) (base + header->name)
+    bind_array(double, vertex_x);
+    bind_array(double, vertex_y);
+    bind_array(char, vertex_is_corner);
+    bind_array(char, vertex_is_ambig);
+    bind_array(int, vertex_offsets);
+    bind_array(int, vertex_polygons);
+    bind_array(int, poly_offsets);
+    bind_array(int, poly_vertices);
+    bind_array(int, poly_polygons);
+    bind_array(char, poly_is_one_way);
+    bind_array(double, poly_min_x);
+    bind_array(double, poly_max_x);
+    bind_array(double, poly_min_y);
+    bind_array(double, poly_max_y);
+    bind_array(int, cell_offsets);
+    bind_array(int, cell_polygons);
+    #undef bind_array
+    max_poly_sides = header->max_poly_sides;
+    min_x = header->min_x;
+    max_x = header->max_x;
+    min_y = header->min_y;
+    max_y = header->max_y;
+    grid_width = header->grid_width;
+    grid_height = header->grid_height;
+    grid_scale = header->grid_scale;
+}
+
+bool Mesh::write_binary(std::ostream& outfile)
+{
+    if (header == nullptr)
+    {
+        std::cerr << "No mesh to write" << std::endl;
+        return false;
+    }
+    outfile.write(image.get(), header->image_size);
+    if (!outfile.good())
+    {
+        std::cerr << "Error writing binary mesh" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Mesh::is_binary(const std::string& filename)
+{
+    std::ifstream infile(filename, std::ios::in | std::ios::binary);
+    char magic[sizeof(MESH_IMAGE_MAGIC)];
+    return infile.read(magic, sizeof(magic)) &&
+           memcmp(magic, MESH_IMAGE_MAGIC, sizeof(magic)) == 0;
+}
+
+// Whether every array of the image with header h (image_size bytes at h)
+// lies within the image, every offset array is monotone and ends at its
+// count, and every vertex, polygon and cell index is in range. Only then
+// can bind_image point into it.
+static bool valid_image(const MeshImageHeader& h)
+{
+    const char* base = (const char*) &h;
+    if (h.num_vertices < 0 || h.num_polygons < 0 ||
+        h.num_vertex_polygons < 0 || h.num_poly_vertices < 0 ||
+        h.num_cell_polygons < 0 || h.grid_width < 0 || h.grid_height < 0 ||
+        h.max_poly_sides < 0)
+    {
+        return false;
+    }
+    const uint64_t V = h.num_vertices, P = h.num_polygons,
+                   C = (uint64_t) h.grid_width * h.grid_height;
+    const auto fits = [&](uint64_t offset, uint64_t bytes, uint64_t align)
     {
-        std::sort(pair.second.begin(), pair.second.end(),
-            [&](const int& a, const int& b) -> bool
+        return offset % align == 0 && offset <= h.image_size &&
+               bytes <= h.image_size - offset;
+    };
+    if (!fits(h.vertex_x, sizeof(double) * V, sizeof(double)) ||
+        !fits(h.vertex_y, sizeof(double) * V, sizeof(double)) ||
+        !fits(h.poly_min_x, sizeof(double) * P, sizeof(double)) ||
+        !fits(h.poly_max_x, sizeof(double) * P, sizeof(double)) ||
+        !fits(h.poly_min_y, sizeof(double) * P, sizeof(double)) ||
+        !fits(h.poly_max_y, sizeof(double) * P, sizeof(double)) ||
+        !fits(h.vertex_offsets, sizeof(int) * (V + 1), sizeof(int)) ||
+        !fits(h.vertex_polygons, sizeof(int) * h.num_vertex_polygons,
+              sizeof(int)) ||
+        !fits(h.poly_offsets, sizeof(int) * (P + 1), sizeof(int)) ||
+        !fits(h.poly_vertices, sizeof(int) * h.num_poly_vertices,
+              sizeof(int)) ||
+        !fits(h.poly_polygons, sizeof(int) * h.num_poly_vertices,
+              sizeof(int)) ||
+        !fits(h.cell_offsets, sizeof(int) * (C + 1), sizeof(int)) ||
+        !fits(h.cell_polygons, sizeof(int) * h.num_cell_polygons,
+              sizeof(int)) ||
+        !fits(h.vertex_is_corner, V, 1) ||
+        !fits(h.vertex_is_ambig, V, 1) ||
+        !fits(h.poly_is_one_way, P, 1))
+    {
+        return false;
+    }
+
+    // Offsets start at 0, never decrease and end at the number of entries.
+    const auto monotone = [&](uint64_t offsets, uint64_t n, int total)
+    {
+        const int* o = (const int*) (base + offsets);
+        if (o[0] != 0 || o[n] != total)
+        {
+            return false;
+        }
+        for (uint64_t i = 0; i < n; i++)
+        {
+            if (o[i] > o[i + 1])
             {
-                // Sorts based on the midpoints.
-                // If tied, sort based on width of poly.
-                const Polygon& ap = mesh_polygons[a], bp = mesh_polygons[b];
-                const double as = ap.min_y + ap.max_y, bs = bp.min_y + ap.max_y;
-                if (as == bs) {
-                    return (ap.max_y - ap.min_y) > (bp.max_y - bp.min_y);
-                }
-                return as < bs;
+                return false;
             }
-        );
+        }
+        return true;
+    };
+    // Entries are in [lo, hi).
+    const auto in_range = [&](uint64_t entries, int n, int lo, int hi)
+    {
+        const int* e = (const int*) (base + entries);
+        for (int i = 0; i < n; i++)
+        {
+            if (e[i] < lo || e[i] >= hi)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (!monotone(h.vertex_offsets, V, h.num_vertex_polygons) ||
+        !monotone(h.poly_offsets, P, h.num_poly_vertices) ||
+        !monotone(h.cell_offsets, C, h.num_cell_polygons) ||
+        !in_range(h.vertex_polygons, h.num_vertex_polygons, -1, P) ||
+        !in_range(h.poly_vertices, h.num_poly_vertices, 0, V) ||
+        !in_range(h.poly_polygons, h.num_poly_vertices, -1, P) ||
+        !in_range(h.cell_polygons, h.num_cell_polygons, 0, P))
+    {
+        return false;
     }
+
+    // The search allocates room for max_poly_sides successors.
+    const int* poly_offsets = (const int*) (base + h.poly_offsets);
+    for (uint64_t i = 0; i < P; i++)
+    {
+        if (poly_offsets[i + 1] - poly_offsets[i] > h.max_poly_sides)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Mesh::read_binary(const std::string& filename)
+{
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        std::cerr << "Unable to open " << filename << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1)
+    {
+        std::cerr << "Unable to get the size of " << filename << std::endl;
+        close(fd);
+        return false;
+    }
+    const size_t size = st.st_size;
+    if (size < sizeof(MeshImageHeader))
+    {
+        std::cerr << "Not a binary mesh: " << filename << std::endl;
+        close(fd);
+        return false;
+    }
+
+    // A shared, read-only mapping: every process reading the file uses
+    // the same pages of the page cache.
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps its own reference to the file
+    if (addr == MAP_FAILED)
+    {
+        std::cerr << "Unable to map " << filename << std::endl;
+        return false;
+    }
+    std::shared_ptr<const char> data((const char*) addr,
+        [size](const char* p) { munmap((void*) p, size); });
+
+    const MeshImageHeader* h = (const MeshImageHeader*) addr;
+    if (memcmp(h->magic, MESH_IMAGE_MAGIC, sizeof(h->magic)) != 0)
+    {
+        std::cerr << "Not a binary mesh: " << filename << std::endl;
+        return false;
+    }
+    if (h->version != MESH_IMAGE_VERSION)
+    {
+        std::cerr << "Got binary mesh with version " << h->version
+                  << " (expecting " << MESH_IMAGE_VERSION << ")" << std::endl;
+        return false;
+    }
+    if (h->image_size != size)
+    {
+        std::cerr << "Binary mesh has " << size << " bytes (expecting "
+                  << h->image_size << ")" << std::endl;
+        return false;
+    }
+    if (!valid_image(*h))
+    {
+        std::cerr << "Binary mesh is corrupt: " << filename << std::endl;
+        return false;
+    }
+
+    mesh_vertices.clear();
+    mesh_polygons.clear();
+    bind_image(data);
+    return true;
 }
 
 // Finds out whether the polygon specified by "poly" contains point P.
-PolyContainment Mesh::poly_contains_point(int poly, Point& p)
+PolyContainment Mesh::poly_contains_point(int poly, const Point& p) const
 {
     // The below is taken from
     // "An Efficient Test for a Point to Be in a Convex Polygon"
@@ -265,26 +618,27 @@ PolyContainment Mesh::poly_contains_point(int poly, Point& p)
     // demonstrations.wolfram.com/AnEfficientTestForAPointToBeInAConvexPolygon/
 
     // Assume points are in counterclockwise order.
-    const Polygon& poly_ref = mesh_polygons[poly];
-    if (p.x < poly_ref.min_x - EPSILON || p.x > poly_ref.max_x + EPSILON ||
-        p.y < poly_ref.min_y - EPSILON || p.y > poly_ref.max_y + EPSILON)
+    if (p.x < poly_min_x[poly] - EPSILON || p.x > poly_max_x[poly] + EPSILON ||
+        p.y < poly_min_y[poly] - EPSILON || p.y > poly_max_y[poly] + EPSILON)
     {
         return {PolyContainment::OUTSIDE, -1, -1, -1};
     }
-    const Point& last_point_in_poly = mesh_vertices[poly_ref.vertices.back()].p;
+    const int* vertices = poly_vertex_list(poly);
+    const int N = poly_size(poly);
+    const Point last_point_in_poly = vertex_point(vertices[N - 1]);
     const Point ZERO = {0, 0};
 
     Point last = last_point_in_poly - p;
     if (last == ZERO)
     {
-        return {PolyContainment::ON_VERTEX, -1, poly_ref.vertices.back(), -1};
+        return {PolyContainment::ON_VERTEX, -1, vertices[N - 1], -1};
     }
 
-    int last_index = poly_ref.vertices.back();
-    for (int i = 0; i < (int) poly_ref.vertices.size(); i++)
+    int last_index = vertices[N - 1];
+    for (int i = 0; i < N; i++)
     {
-        const int point_index = poly_ref.vertices[i];
-        const Point cur = mesh_vertices[point_index].p - p;
+        const int point_index = vertices[i];
+        const Point cur = vertex_point(point_index) - p;
         if (cur == ZERO)
         {
             return {PolyContainment::ON_VERTEX, -1, point_index, -1};
@@ -318,7 +672,7 @@ PolyContainment Mesh::poly_contains_point(int poly, Point& p)
                     continue;
                 }
             }
-            return {PolyContainment::ON_EDGE, poly_ref.polygons[i],
+            return {PolyContainment::ON_EDGE, poly_polygon_list(poly)[i],
                     point_index, last_index};
         }
 
@@ -335,42 +689,23 @@ PolyContainment Mesh::poly_contains_point(int poly, Point& p)
 }
 
 // Finds where the point P lies in the mesh.
-PointLocation Mesh::get_point_location(Point& p)
+PointLocation Mesh::get_point_location(const Point& p) const
 {
     if (p.x < min_x - EPSILON || p.x > max_x + EPSILON ||
         p.y < min_y - EPSILON || p.y > max_y + EPSILON)
     {
         return {PointLocation::NOT_ON_MESH, -1, -1, -1, -1};
     }
-    auto slab = slabs.upper_bound(p.x);
-    if (slab == slabs.begin())
+    // Any polygon which P may lie on is listed in P's cell, in the same
+    // order as get_point_location_naive tries them.
+    const int x = std::min(std::max((int) ((p.x - min_x) * grid_scale), 0),
+                           grid_width - 1);
+    const int y = std::min(std::max((int) ((p.y - min_y) * grid_scale), 0),
+                           grid_height - 1);
+    const int cell = y * grid_width + x;
+    for (int i = cell_offsets[cell]; i < cell_offsets[cell + 1]; i++)
     {
-        return {PointLocation::NOT_ON_MESH, -1, -1, -1, -1};
-    }
-    slab--;
-    const std::vector<int>& polys = slab->second;
-    const auto close_it = std::lower_bound(polys.begin(), polys.end(), p.y,
-        [&](const int& poly_index, const double& y_coord) -> bool
-        {
-            // Sorts based on the midpoints.
-            // If tied, sort based on width of poly.
-            const Polygon& poly = mesh_polygons[poly_index];
-            return poly.min_y + poly.max_y < y_coord * 2;
-        }
-    );
-    const int close_index = close_it - polys.begin()
-                            - (close_it == polys.end());
-    // The plan is to take an index and repeatedly do:
-    // +1, -2, +3, -4, +5, -6, +7, -8, ...
-    // until it hits the edge. If it hits an edge, instead iterate normally.
-    const int ps = polys.size();
-    int i = close_index;
-    int next_delta = 1;
-    int walk_delta = 0; // way to go when walking normally
-
-    while (i >= 0 && i < ps)
-    {
-        const int polygon = polys[i];
+        const int polygon = cell_polygons[i];
         const PolyContainment result = poly_contains_point(polygon, p);
         switch (result.type)
         {
@@ -396,10 +731,9 @@ PointLocation Mesh::get_point_location(Point& p)
             case PolyContainment::ON_VERTEX:
                 // This one lies on a corner.
             {
-                const Vertex& v = mesh_vertices[result.vertex1];
-                if (v.is_corner)
+                if (vertex_is_corner[result.vertex1])
                 {
-                    if (v.is_ambig)
+                    if (vertex_is_ambig[result.vertex1])
                     {
                         return {PointLocation::ON_CORNER_VERTEX_AMBIG, -1, -1,
                                 result.vertex1, -1};
@@ -422,41 +756,14 @@ PointLocation Mesh::get_point_location(Point& p)
                 // This should not be reachable
                 assert(false);
         }
-
-
-        // do stuff
-        if (walk_delta == 0)
-        {
-            const int next_i = i + next_delta * (2 * (next_delta & 1) - 1);
-            if (next_i < 0)
-            {
-                // was going to go too far to the left.
-                // start going right
-                walk_delta = 1;
-            }
-            else if (next_i >= ps)
-            {
-                walk_delta = -1;
-            }
-            else
-            {
-                i = next_i;
-                next_delta++;
-            }
-        }
-
-        if (walk_delta != 0)
-        {
-            i += walk_delta;
-        }
     }
     // Haven't returned yet, therefore P does not lie on the mesh.
     return {PointLocation::NOT_ON_MESH, -1, -1, -1, -1};
 }
 
-PointLocation Mesh::get_point_location_naive(Point& p)
+PointLocation Mesh::get_point_location_naive(const Point& p) const
 {
-    for (int polygon = 0; polygon < (int) mesh_polygons.size(); polygon++)
+    for (int polygon = 0; polygon < num_polygons(); polygon++)
     {
         const PolyContainment result = poly_contains_point(polygon, p);
         switch (result.type)
@@ -483,10 +790,9 @@ PointLocation Mesh::get_point_location_naive(Point& p)
             case PolyContainment::ON_VERTEX:
                 // This one lies on a corner.
             {
-                const Vertex& v = mesh_vertices[result.vertex1];
-                if (v.is_corner)
+                if (vertex_is_corner[result.vertex1])
                 {
-                    if (v.is_ambig)
+                    if (vertex_is_ambig[result.vertex1])
                     {
                         return {PointLocation::ON_CORNER_VERTEX_AMBIG, -1, -1,
                                 result.vertex1, -1};
@@ -514,28 +820,30 @@ PointLocation Mesh::get_point_location_naive(Point& p)
     return {PointLocation::NOT_ON_MESH, -1, -1, -1, -1};
 }
 
-void Mesh::print(std::ostream& outfile)
+void Mesh::print(std::ostream& outfile) const
 {
-    outfile << "mesh with " << mesh_vertices.size() << " vertices, " \
-            << mesh_polygons.size() << " polygons" << std::endl;
+    outfile << "mesh with " << num_vertices() << " vertices, " \
+            << num_polygons() << " polygons" << std::endl;
     outfile << "vertices:" << std::endl;
-    for (Vertex vertex : mesh_vertices)
+    for (int i = 0; i < num_vertices(); i++)
     {
-        outfile << vertex.p << " " << vertex.is_corner << std::endl;
+        outfile << vertex_point(i) << " " << (bool) vertex_is_corner[i]
+                << std::endl;
     }
     outfile << std::endl;
     outfile << "polygons:" << std::endl;
-    for (Polygon polygon : mesh_polygons)
+    for (int i = 0; i < num_polygons(); i++)
     {
-        for (int vertex : polygon.vertices)
+        const int* vertices = poly_vertex_list(i);
+        for (int j = 0; j < poly_size(i); j++)
         {
-            outfile << mesh_vertices[vertex].p << " ";
+            outfile << vertex_point(vertices[j]) << " ";
         }
         outfile << std::endl;
     }
 }
 
-void Mesh::print_polygon(std::ostream& outfile, int index)
+void Mesh::print_polygon(std::ostream& outfile, int index) const
 {
     if (index == -1)
     {
@@ -543,9 +851,8 @@ void Mesh::print_polygon(std::ostream& outfile, int index)
         return;
     }
     outfile << "P" << index << " [";
-    Polygon& poly = mesh_polygons[index];
-    const auto vertices = poly.vertices;
-    const int size = (int) vertices.size();
+    const int* vertices = poly_vertex_list(index);
+    const int size = poly_size(index);
     for (int i = 0; i < size; i++)
     {
         print_vertex(outfile, vertices[i]);
@@ -557,9 +864,9 @@ void Mesh::print_polygon(std::ostream& outfile, int index)
     outfile << "]";
 }
 
-void Mesh::print_vertex(std::ostream& outfile, int index)
+void Mesh::print_vertex(std::ostream& outfile, int index) const
 {
-    outfile << "V" << index << " " <<  mesh_vertices[index].p;
+    outfile << "V" << index << " " <<  vertex_point(index);
 }
 
 }
@@ -5,6 +5,8 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <string>
+#include <stdint.h>
 
 namespace polyanya
 {
@@ -195,28 +197,168 @@ struct PointLocation
     }
 };
 
+// Header of a mesh image: the flat arrays of a mesh (see Mesh::flatten)
+// laid out in one block of memory, which is also the binary mesh file
+// format (see Mesh::write_binary). Every array starts at the given byte
+// offset from the start of the image, which is a multiple of 8.
+// Numbers are stored in the native byte order.
+struct MeshImageHeader
+{
+    char magic[8];
+    uint32_t version;
+    int32_t max_poly_sides;
+    uint64_t image_size;
+
+    int32_t num_vertices;
+    int32_t num_polygons;
+    int32_t num_vertex_polygons;
+    int32_t num_poly_vertices;
+    int32_t grid_width;
+    int32_t grid_height;
+    int32_t num_cell_polygons;
+    int32_t padding;
+    double min_x, max_x, min_y, max_y;
+    double grid_scale;
+
+    uint64_t vertex_x, vertex_y;
+    uint64_t vertex_is_corner, vertex_is_ambig;
+    uint64_t vertex_offsets, vertex_polygons;
+    uint64_t poly_offsets, poly_vertices, poly_polygons;
+    uint64_t poly_is_one_way;
+    uint64_t poly_min_x, poly_max_x, poly_min_y, poly_max_y;
+    uint64_t cell_offsets, cell_polygons;
+};
+
+const char MESH_IMAGE_MAGIC[8] = {'p', 'o', 'l', 'y', 'm', 'e', 's', 'h'};
+const uint32_t MESH_IMAGE_VERSION = 2;
+
+// Point location uses about this many grid cells per polygon.
+const double POINT_LOCATION_CELLS_PER_POLY = 1.0;
+
 class Mesh
 {
     private:
-        std::map<double, std::vector<int>> slabs;
+        // Only used while building the image; see precalc_point_location.
+        std::vector<std::vector<int>> cells;
+        int grid_width, grid_height;
+        double grid_scale;
         double min_x, max_x, min_y, max_y;
 
+        // The block of memory holding the flat arrays: either built by
+        // flatten() or a read-only mapping of a binary mesh file.
+        // It is never written to once built, so copies of a mesh share it.
+        std::shared_ptr<const char> image;
+
+        void bind_image(std::shared_ptr<const char> data);
+
     public:
-        Mesh() { }
+        Mesh() : grid_width(0), grid_height(0), grid_scale(0),
+                 min_x(0), max_x(0), min_y(0), max_y(0), max_poly_sides(0),
+                 header(nullptr) { }
         Mesh(std::istream& infile);
         std::vector<Vertex> mesh_vertices;
         std::vector<Polygon> mesh_polygons;
         int max_poly_sides;
 
+        // A frozen, flat copy of the mesh which the search runs on.
+        // It is built by flatten() once the mesh is read, or mapped
+        // straight from a binary mesh file by read_binary(), and keeps
+        // every list of the mesh in one contiguous array instead of one
+        // vector per vertex and polygon.
+        //
+        // The vertices of polygon p are
+        //   poly_vertices[poly_offsets[p]] ... poly_vertices[poly_offsets[p+1]-1]
+        // in counterclockwise order. poly_polygons has the same layout and
+        // holds the polygon adjacent to each edge (or -1), as in Polygon.
+        // The polygons around vertex v are listed the same way in
+        // vertex_polygons, using vertex_offsets.
+        //
+        // Vertex coordinates and polygon bounding boxes are stored as
+        // structure-of-arrays.
+        //
+        // Point location uses a uniform grid over the bounding box of the
+        // mesh, with grid_scale cells per unit length. Cell (x, y) has
+        // index y * grid_width + x, and the polygons whose bounding box
+        // (grown by EPSILON) overlaps it are listed in cell_polygons, using
+        // cell_offsets, in increasing order.
+        const MeshImageHeader* header;
+        const double* vertex_x;
+        const double* vertex_y;
+        const char* vertex_is_corner;
+        const char* vertex_is_ambig;
+        const int* vertex_offsets;
+        const int* vertex_polygons;
+
+        const int* poly_offsets;
+        const int* poly_vertices;
+        const int* poly_polygons;
+        const char* poly_is_one_way;
+        const double* poly_min_x;
+        const double* poly_max_x;
+        const double* poly_min_y;
+        const double* poly_max_y;
+
+        const int* cell_offsets;
+        const int* cell_polygons;
+
+        inline int num_vertices() const
+        {
+            return header->num_vertices;
+        }
+
+        inline int num_polygons() const
+        {
+            return header->num_polygons;
+        }
+
+        inline Point vertex_point(int vertex) const
+        {
+            return {vertex_x[vertex], vertex_y[vertex]};
+        }
+
+        // Number of vertices (and so of edges) of a polygon.
+        inline int poly_size(int poly) const
+        {
+            return poly_offsets[poly + 1] - poly_offsets[poly];
+        }
+
+        // The vertex list of a polygon; it has poly_size(poly) entries.
+        inline const int* poly_vertex_list(int poly) const
+        {
+            return poly_vertices + poly_offsets[poly];
+        }
+
+        // The neighbour list of a polygon; it has poly_size(poly) entries.
+        inline const int* poly_polygon_list(int poly) const
+        {
+            return poly_polygons + poly_offsets[poly];
+        }
+
         void read(std::istream& infile);
         void precalc_point_location();
-        void print(std::ostream& outfile);
-        PolyContainment poly_contains_point(int poly, Point& p);
-        PointLocation get_point_location(Point& p);
-        PointLocation get_point_location_naive(Point& p);
-
-        void print_polygon(std::ostream& outfile, int index);
-        void print_vertex(std::ostream& outfile, int index);
+        void flatten();
+
+        // Binary meshes hold the image built by flatten(). Reading one maps
+        // the file into memory: nothing is parsed or copied, and every
+        // process which reads the same file shares one copy of it.
+        // Only the flat arrays are available; mesh_vertices and
+        // mesh_polygons stay empty.
+        // Both functions print an error and return false on failure.
+        bool write_binary(std::ostream& outfile);
+        bool read_binary(const std::string& filename);
+        // Whether a file starts like a binary mesh.
+        static bool is_binary(const std::string& filename);
+
+        void print(std::ostream& outfile) const;
+        PolyContainment poly_contains_point(int poly, const Point& p) const;
+        // Both give the same answer: the first polygon, in index order,
+        // which does not have P outside of it. The naive one tests every
+        // polygon and is kept to test the other.
+        PointLocation get_point_location(const Point& p) const;
+        PointLocation get_point_location_naive(const Point& p) const;
+
+        void print_polygon(std::ostream& outfile, int index) const;
+        void print_vertex(std::ostream& outfile, int index) const;
 
 };
 
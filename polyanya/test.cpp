@@ -2,11 +2,13 @@
 #include "expansion.h"
 #include "mesh.h"
 #include "geometry.h"
+#include "searchinstance.h"
 #include <stdio.h>
 #include <sstream>
 #include <iomanip>
 #include <time.h>
 #include <random>
+#include <vector>
 
 using namespace std;
 using namespace polyanya;
@@ -27,7 +29,7 @@ void test_io()
 
 void test_containment(Point test_point)
 {
-    for (int i = 0; i < (int) m.mesh_polygons.size(); i++)
+    for (int i = 0; i < m.num_polygons(); i++)
     {
         cout << setw(4) << i << setw(0) << " "
              << m.poly_contains_point(i, test_point) << endl;
@@ -130,6 +132,79 @@ void test_h_value_asserts()
     }
 }
 
+// Push-time pruning drops nodes whose f exceeds the best path cost seen
+// so far. As f never overestimates, this must not change the cost of any
+// path. Check each query against a search without push-time pruning, and
+// check that the path returned really is as long as its cost.
+void test_push_pruning_keeps_optimal()
+{
+    cout << "Checking push-time pruning on random queries..." << endl;
+    Point lo = m.vertex_point(0), hi = lo;
+    for (int i = 1; i < m.num_vertices(); i++)
+    {
+        const Point p = m.vertex_point(i);
+        lo.x = min(lo.x, p.x);
+        lo.y = min(lo.y, p.y);
+        hi.x = max(hi.x, p.x);
+        hi.y = max(hi.y, p.y);
+    }
+    uniform_real_distribution<double> rand_x(lo.x, hi.x), rand_y(lo.y, hi.y);
+    SearchInstance si(&m), unpruned(&m);
+    unpruned.push_pruning = false;
+    int num_queries = 0, num_pruned = 0, num_wrong = 0;
+    long long pushed = 0, unpruned_pushed = 0;
+    for (int i = 0; i < MAX_ITER && num_queries < 1000; i++)
+    {
+        Point s = {rand_x(engine), rand_y(engine)},
+              g = {rand_x(engine), rand_y(engine)};
+        if (m.get_point_location(s).type == PointLocation::NOT_ON_MESH ||
+            m.get_point_location(g).type == PointLocation::NOT_ON_MESH)
+        {
+            continue;
+        }
+        num_queries++;
+        si.set_start_goal(s, g);
+        unpruned.set_start_goal(s, g);
+        const bool found = si.search();
+        if (found != unpruned.search())
+        {
+            cout << "Found discrepancy from " << s << " to " << g << endl;
+            cout << "Only one of the searches finds a path" << endl;
+            num_wrong++;
+            continue;
+        }
+        num_pruned += si.nodes_pruned_pre_push;
+        pushed += si.nodes_pushed;
+        unpruned_pushed += unpruned.nodes_pushed;
+        if (!found)
+        {
+            continue;
+        }
+
+        vector<Point> path;
+        si.get_path_points(path);
+        double len = 0;
+        for (size_t j = 1; j < path.size(); j++)
+        {
+            len += path[j - 1].distance(path[j]);
+        }
+        const double cost = si.get_cost();
+        const double optimal = unpruned.get_cost();
+        if (abs(len - cost) > 1e-6 * (1 + cost) ||
+            abs(optimal - cost) > 1e-6 * (1 + cost))
+        {
+            cout << "Found discrepancy from " << s << " to " << g << endl;
+            cout << "Search gives " << cost << ", path length " << len
+                 << ", without push-time pruning " << optimal << endl;
+            num_wrong++;
+        }
+    }
+    cout << num_queries << " queries, " << num_wrong << " discrepancies, "
+         << num_pruned << " nodes pruned before pushing; " << pushed
+         << " nodes pushed (" << unpruned_pushed << " without pruning)."
+         << endl;
+}
+
 int main(int argc, char* argv[])
 {
     m = Mesh(cin);
@@ -153,5 +228,6 @@ int main(int argc, char* argv[])
     test_projection_asserts();
     test_reflection_asserts();
     test_h_value_asserts();
+    test_push_pruning_keeps_optimal();
     return 0;
 }
@@ -24,7 +24,8 @@
 namespace warthog{
 
 class problem_instance;
-class search_node;
+template<typename COST_T> class search_node_base;
+typedef search_node_base<double> search_node;
 
 class bch_expansion_policy : public  expansion_policy
 {
@@ -0,0 +1,286 @@
+#include "bch_many_to_many.h"
+#include "constants.h"
+#include "timer.h"
+#include "work_queue.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <iostream>
+#include <thread>
+
+warthog::ch::bch_many_to_many::bch_many_to_many(
+        warthog::graph::xy_graph* g, std::vector<uint32_t>* rank)
+    : g_(g), rank_(rank), nodes_settled_(0), nodes_stalled_(0),
+      bucket_nano_(0), scan_nano_(0)
+{
+    assert(rank_->size() == g_->get_num_nodes());
+}
+
+warthog::ch::bch_many_to_many::~bch_many_to_many()
+{
+    for(uint32_t i = 0; i < contexts_.size(); i++)
+    {
+        delete contexts_[i];
+    }
+}
+
+bool
+warthog::ch::bch_many_to_many::distance_table(
+        std::vector<uint32_t>& sources, std::vector<uint32_t>& targets,
+        std::vector<double>& table, uint32_t num_threads)
+{
+    // from external ids to graph ids
+    std::vector<uint32_t> s_ids(sources.size());
+    std::vector<uint32_t> t_ids(targets.size());
+    for(uint32_t i = 0; i < sources.size(); i++)
+    {
+        s_ids[i] = g_->to_graph_id(sources[i]);
+        if(s_ids[i] == warthog::INF)
+        {
+            std::cerr << "err; source " << sources[i]
+                << " is not in the graph\n";
+            return false;
+        }
+    }
+    for(uint32_t i = 0; i < targets.size(); i++)
+    {
+        t_ids[i] = g_->to_graph_id(targets[i]);
+        if(t_ids[i] == warthog::INF)
+        {
+            std::cerr << "err; target " << targets[i]
+                << " is not in the graph\n";
+            return false;
+        }
+    }
+
+    if(num_threads == 0)
+    {
+        num_threads = std::thread::hardware_concurrency();
+        if(num_threads == 0) { num_threads = 1; }
+    }
+    while(contexts_.size() < num_threads)
+    {
+        search_context* ctx = new search_context();
+        ctx->dist_.resize(g_->get_num_nodes(), DBL_MAX);
+        contexts_.push_back(ctx);
+    }
+    for(uint32_t i = 0; i < contexts_.size(); i++)
+    {
+        contexts_[i]->entries_.clear();
+        contexts_[i]->settled_ = 0;
+        contexts_[i]->stalled_ = 0;
+    }
+
+    // phase 1: backward searches from the targets. each thread collects
+    // the entries of its own searches, which are then grouped by node
+    warthog::timer mytimer;
+    mytimer.start();
+    run_tasks(targets.size(), num_threads,
+        [this, &t_ids](search_context& ctx, uint32_t t_index)
+        {
+            auto fn_settle = [&ctx, t_index](uint32_t v, double dist)
+            {
+                bucket_entry be;
+                be.target_ = t_index;
+                be.dist_ = dist;
+                ctx.entries_.push_back(
+                    std::pair<uint32_t, bucket_entry>(v, be));
+            };
+            upward_search(ctx, t_ids[t_index], true, fn_settle);
+            clear(ctx);
+        });
+
+    bucket_index_.assign(g_->get_num_nodes() + 1, 0);
+    for(uint32_t i = 0; i < contexts_.size(); i++)
+    {
+        std::vector<std::pair<uint32_t, bucket_entry>>& entries =
+            contexts_[i]->entries_;
+        for(uint32_t j = 0; j < entries.size(); j++)
+        {
+            bucket_index_[entries[j].first + 1]++;
+        }
+    }
+    for(uint32_t v = 0; v < g_->get_num_nodes(); v++)
+    {
+        bucket_index_[v+1] += bucket_index_[v];
+    }
+    buckets_.resize(bucket_index_.back());
+    std::vector<uint32_t> next(bucket_index_.begin(), bucket_index_.end()-1);
+    for(uint32_t i = 0; i < contexts_.size(); i++)
+    {
+        std::vector<std::pair<uint32_t, bucket_entry>>& entries =
+            contexts_[i]->entries_;
+        for(uint32_t j = 0; j < entries.size(); j++)
+        {
+            buckets_[next[entries[j].first]++] = entries[j].second;
+        }
+        entries.clear();
+        entries.shrink_to_fit();
+    }
+    mytimer.stop();
+    bucket_nano_ = mytimer.elapsed_time_nano();
+
+    // phase 2: forward searches from the sources. each search owns one
+    // row of the table
+    table.assign(sources.size() * targets.size(), warthog::INF);
+    uint32_t num_targets = targets.size();
+    mytimer.start();
+    run_tasks(sources.size(), num_threads,
+        [this, &s_ids, &table, num_targets]
+        (search_context& ctx, uint32_t s_index)
+        {
+            double* row = &table[(size_t)s_index * num_targets];
+            auto fn_settle = [this, row](uint32_t v, double dist)
+            {
+                for(uint32_t i = bucket_index_[v];
+                        i < bucket_index_[v+1]; i++)
+                {
+                    bucket_entry& be = buckets_[i];
+                    double len = dist + be.dist_;
+                    if(len < row[be.target_]) { row[be.target_] = len; }
+                }
+            };
+            upward_search(ctx, s_ids[s_index], false, fn_settle);
+            clear(ctx);
+        });
+    mytimer.stop();
+    scan_nano_ = mytimer.elapsed_time_nano();
+
+    nodes_settled_ = nodes_stalled_ = 0;
+    for(uint32_t i = 0; i < contexts_.size(); i++)
+    {
+        nodes_settled_ += contexts_[i]->settled_;
+        nodes_stalled_ += contexts_[i]->stalled_;
+    }
+    return true;
+}
+
+template<class FN_SETTLE>
+void
+warthog::ch::bch_many_to_many::upward_search(search_context& ctx,
+        uint32_t from_id, bool backward, FN_SETTLE& fn_settle)
+{
+    // min-queue of (distance, node id) pairs. stale entries are skipped
+    std::greater<std::pair<double, uint32_t>> cmp;
+    ctx.open_.clear();
+    ctx.dist_[from_id] = 0;
+    ctx.touched_.push_back(from_id);
+    ctx.open_.push_back(std::pair<double, uint32_t>(0, from_id));
+
+    while(ctx.open_.size() > 0)
+    {
+        std::pop_heap(ctx.open_.begin(), ctx.open_.end(), cmp);
+        std::pair<double, uint32_t> top = ctx.open_.back();
+        ctx.open_.pop_back();
+
+        uint32_t cur_id = top.second;
+        if(top.first > ctx.dist_[cur_id]) { continue; } // stale
+        ctx.settled_++;
+
+        warthog::graph::node* n = g_->get_node(cur_id);
+        warthog::graph::edge_iter begin, end, rev_begin, rev_end;
+        if(backward)
+        {
+            begin = n->incoming_begin(); end = n->incoming_end();
+            rev_begin = n->outgoing_begin(); rev_end = n->outgoing_end();
+        }
+        else
+        {
+            begin = n->outgoing_begin(); end = n->outgoing_end();
+            rev_begin = n->incoming_begin(); rev_end = n->incoming_end();
+        }
+
+        // stall-on-demand: a higher node reaches this one by a shorter
+        // path, so its label is not a shortest distance
+        bool stalled = false;
+        for(warthog::graph::edge_iter it = rev_begin; it != rev_end; it++)
+        {
+            if(ctx.dist_[it->node_id_] + it->wt_ < top.first)
+            {
+                stalled = true;
+                break;
+            }
+        }
+        if(stalled) { ctx.stalled_++; continue; }
+
+        fn_settle(cur_id, top.first);
+        for(warthog::graph::edge_iter it = begin; it != end; it++)
+        {
+            uint32_t next_id = it->node_id_;
+            double len = top.first + it->wt_;
+            if(len >= ctx.dist_[next_id]) { continue; }
+            if(ctx.dist_[next_id] == DBL_MAX)
+            { ctx.touched_.push_back(next_id); }
+            ctx.dist_[next_id] = len;
+            ctx.open_.push_back(std::pair<double, uint32_t>(len, next_id));
+            std::push_heap(ctx.open_.begin(), ctx.open_.end(), cmp);
+        }
+    }
+}
+
+void
+warthog::ch::bch_many_to_many::clear(search_context& ctx)
+{
+    for(uint32_t i = 0; i < ctx.touched_.size(); i++)
+    {
+        ctx.dist_[ctx.touched_[i]] = DBL_MAX;
+    }
+    ctx.touched_.clear();
+}
+
+void
+warthog::ch::bch_many_to_many::run_tasks(uint32_t num_tasks,
+        uint32_t num_threads,
+        const std::function<void(search_context&, uint32_t)>& fn_task)
+{
+    if(num_tasks == 0) { return; }
+    uint32_t num_workers = std::min(num_threads, num_tasks);
+    assert(num_workers > 0 && num_workers <= contexts_.size());
+
+    warthog::util::work_queue tasks(num_tasks, num_workers);
+    auto thread_fn = [&] (uint32_t worker_id) -> void
+    {
+        uint32_t task_id;
+        while(tasks.next(worker_id, task_id))
+        {
+            fn_task(*contexts_[worker_id], task_id);
+        }
+    };
+
+    if(num_workers == 1)
+    {
+        thread_fn(0);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    for(uint32_t i = 0; i < num_workers; i++)
+    {
+        threads.push_back(std::thread(thread_fn, i));
+    }
+    for(uint32_t i = 0; i < num_workers; i++)
+    {
+        threads.at(i).join();
+    }
+}
+
+size_t
+warthog::ch::bch_many_to_many::mem()
+{
+    size_t bytes = sizeof(*this) +
+        sizeof(uint32_t) * bucket_index_.capacity() +
+        sizeof(bucket_entry) * buckets_.capacity() +
+        sizeof(search_context*) * contexts_.capacity();
+    for(uint32_t i = 0; i < contexts_.size(); i++)
+    {
+        search_context* ctx = contexts_[i];
+        bytes += sizeof(search_context) +
+            sizeof(double) * ctx->dist_.capacity() +
+            sizeof(uint32_t) * ctx->touched_.capacity() +
+            sizeof(std::pair<double, uint32_t>) * ctx->open_.capacity() +
+            sizeof(std::pair<uint32_t, bucket_entry>) *
+                ctx->entries_.capacity();
+    }
+    return bytes;
+}
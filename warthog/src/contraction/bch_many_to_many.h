@@ -0,0 +1,151 @@
+#ifndef WARTHOG_BCH_MANY_TO_MANY_H
+#define WARTHOG_BCH_MANY_TO_MANY_H
+
+// contraction/bch_many_to_many.h
+//
+// Computes tables of shortest distances between a set of sources and
+// a set of targets using a contraction hierarchy; i.e. many-to-many
+// queries answered with far fewer node expansions than one bch query
+// per (source, target) pair.
+//
+// The algorithm has two phases. First, an upward search is run
+// backward from every target. Each node v settled by the search for
+// target t receives a bucket entry (t, d(v, t)). Second, an upward
+// search is run forward from every source s. For each node v settled
+// by the search the entries in the bucket of v are scanned and the
+// table entry of (s, t) becomes min(d(s, v) + d(v, t)).
+// Both phases use stall-on-demand and both run in parallel: targets
+// (resp. sources) are handed out to worker threads via a work_queue.
+//
+// The input graph must be prepared by ch::optimise_graph_for_bch_v2,
+// same as for bch_expansion_policy.
+//
+// For more details see:
+// [Knopp, Sanders, Schultes, Schulz and Wagner. Computing Many-to-Many
+// Shortest Paths Using Highway Hierarchies. In Proceedings of the 2007
+// Workshop on Algorithm Engineering and Experiments (ALENEX)]
+//
+
+#include "xy_graph.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace warthog
+{
+
+namespace ch
+{
+
+class bch_many_to_many
+{
+    public:
+        // @param g: a contraction hierarchy whose outgoing edges go up
+        // and whose incoming edges are the reversed down edges
+        // (see ch::optimise_graph_for_bch_v2)
+        //
+        // @param rank: the contraction rank of each node in @param g
+        bch_many_to_many(warthog::graph::xy_graph* g,
+                std::vector<uint32_t>* rank);
+
+        ~bch_many_to_many();
+
+        // compute the distance from every node in @param sources to every
+        // node in @param targets. both are given as external (DIMACS)
+        // ids. the distance from sources[i] to targets[j] is written to
+        // table[i * targets.size() + j]; it is warthog::INF if targets[j]
+        // is not reachable.
+        //
+        // @param num_threads: worker threads (0 = one per hardware thread)
+        // @return false if some source or target is not in the graph
+        bool
+        distance_table(std::vector<uint32_t>& sources,
+                std::vector<uint32_t>& targets, std::vector<double>& table,
+                uint32_t num_threads=1);
+
+        // statistics about the last call to ::distance_table
+
+        // the number of bucket entries made by the backward searches
+        inline uint64_t
+        get_num_bucket_entries() { return buckets_.size(); }
+
+        // nodes settled and stalled by all backward and forward searches
+        inline uint64_t
+        get_nodes_settled() { return nodes_settled_; }
+
+        inline uint64_t
+        get_nodes_stalled() { return nodes_stalled_; }
+
+        // wallclock time of the backward (bucket filling) and forward
+        // (bucket scanning) phases
+        inline double
+        get_bucket_nano() { return bucket_nano_; }
+
+        inline double
+        get_scan_nano() { return scan_nano_; }
+
+        size_t
+        mem();
+
+    private:
+        struct bucket_entry
+        {
+            uint32_t target_;  // index into the targets of the table
+            double dist_;       // distance from the bucket node to target_
+        };
+
+        // the private state of one worker thread
+        struct search_context
+        {
+            std::vector<double> dist_; // DBL_MAX if not reached
+            std::vector<uint32_t> touched_;
+            std::vector<std::pair<double, uint32_t>> open_;
+            std::vector<std::pair<uint32_t, bucket_entry>> entries_;
+            uint64_t settled_;
+            uint64_t stalled_;
+        };
+
+        warthog::graph::xy_graph* g_;
+        std::vector<uint32_t>* rank_;
+
+        // the bucket of node v is [bucket_index_[v], bucket_index_[v+1])
+        std::vector<uint32_t> bucket_index_;
+        std::vector<bucket_entry> buckets_;
+
+        std::vector<search_context*> contexts_;
+        uint64_t nodes_settled_;
+        uint64_t nodes_stalled_;
+        double bucket_nano_;
+        double scan_nano_;
+
+        // an upward search from @param from_id, forward along outgoing
+        // edges or @param backward along incoming edges. every settled
+        // node that is not stalled is passed to @param fn_settle together
+        // with its distance. ctx.dist_ holds the distance labels until
+        // the next call to ::clear.
+        template<class FN_SETTLE>
+        void
+        upward_search(search_context& ctx, uint32_t from_id,
+                bool backward, FN_SETTLE& fn_settle);
+
+        void
+        clear(search_context& ctx);
+
+        // run tasks [0, @param num_tasks) on @param num_threads threads.
+        // every task is given the search context of the thread running it
+        void
+        run_tasks(uint32_t num_tasks, uint32_t num_threads,
+            const std::function<void(search_context&, uint32_t)>& fn_task);
+
+        // no copy
+        bch_many_to_many(const bch_many_to_many& other) { }
+        bch_many_to_many&
+        operator=(const bch_many_to_many& other) { return *this; }
+};
+
+}
+
+}
+
+#endif
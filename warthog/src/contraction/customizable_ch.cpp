@@ -0,0 +1,590 @@
+#include "constants.h"
+#include "customizable_ch.h"
+#include "work_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+bool
+warthog::ch::is_cch_file(const char* filename)
+{
+    std::ifstream ifs(filename, std::ios_base::in | std::ios_base::binary);
+    uint32_t magic = 0;
+    ifs.read((char*)&magic, sizeof(magic));
+    return ifs.good() && magic == warthog::ch::CCH_MAGIC;
+}
+
+bool
+warthog::ch::load_metis_order(const char* iperm_file,
+        warthog::graph::xy_graph* g, std::vector<uint32_t>& order)
+{
+    std::ifstream ifs(iperm_file, std::ios_base::in);
+    if(!ifs.good())
+    {
+        std::cerr << "err; cannot read METIS order file "
+            << iperm_file << std::endl;
+        return false;
+    }
+
+    uint32_t num_nodes = g->get_num_nodes();
+    order.assign(num_nodes, warthog::INF);
+    uint32_t metis_id = 0;
+    uint32_t pos;
+    while(ifs >> pos)
+    {
+        uint32_t node_id = g->to_graph_id(metis_id+1);
+        if(pos >= num_nodes || node_id == warthog::INF ||
+           order.at(pos) != warthog::INF)
+        {
+            std::cerr << "err; METIS order does not match the graph "
+                << "(vertex " << metis_id+1 << ")" << std::endl;
+            return false;
+        }
+        order.at(pos) = node_id;
+        metis_id++;
+    }
+    if(metis_id != num_nodes)
+    {
+        std::cerr << "err; METIS order has " << metis_id
+            << " vertices but graph has " << num_nodes << " nodes\n";
+        return false;
+    }
+    return true;
+}
+
+namespace
+{
+
+// recursive coordinate bisection; appends the nodes in @param nodes to
+// @param order, separator nodes last. @param side is scratch space
+// (one entry per node) and @param tag a unique value for each call
+void
+nested_dissection(warthog::graph::xy_graph* g,
+        std::vector<uint32_t>& adj_index, std::vector<uint32_t>& adj,
+        std::vector<uint32_t>& nodes, std::vector<uint32_t>& side,
+        uint32_t& tag, std::vector<uint32_t>& order)
+{
+    if(nodes.size() <= 8)
+    {
+        order.insert(order.end(), nodes.begin(), nodes.end());
+        return;
+    }
+
+    // split at the median of the wider axis
+    int32_t min_x = INT32_MAX, max_x = INT32_MIN;
+    int32_t min_y = INT32_MAX, max_y = INT32_MIN;
+    for(uint32_t i = 0; i < nodes.size(); i++)
+    {
+        int32_t x, y;
+        g->get_xy(nodes[i], x, y);
+        min_x = std::min(min_x, x); max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y); max_y = std::max(max_y, y);
+    }
+    bool split_x = ((int64_t)max_x - min_x) >= ((int64_t)max_y - min_y);
+    std::vector<uint32_t>::iterator mid = nodes.begin() + nodes.size() / 2;
+    std::nth_element(nodes.begin(), mid, nodes.end(),
+        [g, split_x](uint32_t a, uint32_t b) -> bool
+        {
+            int32_t ax, ay, bx, by;
+            g->get_xy(a, ax, ay);
+            g->get_xy(b, bx, by);
+            return split_x ?
+                (ax < bx || (ax == bx && a < b)) :
+                (ay < by || (ay == by && a < b));
+        });
+
+    // the separator: nodes of the first half adjacent to the second half
+    uint32_t side_b = tag++;
+    for(std::vector<uint32_t>::iterator it = mid; it != nodes.end(); it++)
+    {
+        side[*it] = side_b;
+    }
+    std::vector<uint32_t> part_a, part_b(mid, nodes.end()), separator;
+    for(std::vector<uint32_t>::iterator it = nodes.begin(); it != mid; it++)
+    {
+        bool cut = false;
+        for(uint32_t i = adj_index[*it]; i < adj_index[*it+1]; i++)
+        {
+            if(side[adj[i]] == side_b) { cut = true; break; }
+        }
+        if(cut) { separator.push_back(*it); }
+        else { part_a.push_back(*it); }
+    }
+    nodes.clear();
+    nodes.shrink_to_fit();
+
+    nested_dissection(g, adj_index, adj, part_a, side, tag, order);
+    nested_dissection(g, adj_index, adj, part_b, side, tag, order);
+    order.insert(order.end(), separator.begin(), separator.end());
+}
+
+}
+
+void
+warthog::ch::make_nested_dissection_order(warthog::graph::xy_graph* g,
+        std::vector<uint32_t>& order)
+{
+    // undirected adjacency lists
+    uint32_t num_nodes = g->get_num_nodes();
+    std::vector<uint32_t> adj_index(num_nodes+1, 0);
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        warthog::graph::node* n = g->get_node(i);
+        for(uint32_t j = 0; j < n->out_degree(); j++)
+        {
+            adj_index[i+1]++;
+            adj_index[(n->outgoing_begin() + j)->node_id_+1]++;
+        }
+    }
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        adj_index[i+1] += adj_index[i];
+    }
+    std::vector<uint32_t> adj(adj_index[num_nodes]);
+    std::vector<uint32_t> next(adj_index.begin(), adj_index.end()-1);
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        warthog::graph::node* n = g->get_node(i);
+        for(uint32_t j = 0; j < n->out_degree(); j++)
+        {
+            uint32_t head_id = (n->outgoing_begin() + j)->node_id_;
+            adj[next[i]++] = head_id;
+            adj[next[head_id]++] = i;
+        }
+    }
+
+    std::vector<uint32_t> nodes(num_nodes);
+    for(uint32_t i = 0; i < num_nodes; i++) { nodes[i] = i; }
+    std::vector<uint32_t> side(num_nodes, warthog::INF);
+    uint32_t tag = 0;
+    order.clear();
+    order.reserve(num_nodes);
+    nested_dissection(g, adj_index, adj, nodes, side, tag, order);
+}
+
+warthog::ch::customizable_ch::customizable_ch()
+{
+    up_index_.push_back(0);
+    level_index_.push_back(0);
+}
+
+warthog::ch::customizable_ch::~customizable_ch()
+{
+}
+
+bool
+warthog::ch::customizable_ch::contract(warthog::graph::xy_graph* g,
+        std::vector<uint32_t>& order)
+{
+    uint32_t num_nodes = g->get_num_nodes();
+    rank_.assign(num_nodes, warthog::INF);
+    for(uint32_t i = 0; i < order.size(); i++)
+    {
+        if(order.at(i) >= num_nodes || rank_.at(order.at(i)) != warthog::INF)
+        {
+            std::cerr << "err; invalid node order (position " << i << ")\n";
+            return false;
+        }
+        rank_.at(order.at(i)) = i;
+    }
+    if(order.size() != num_nodes)
+    {
+        std::cerr << "err; node order has " << order.size() 
+            << " nodes but graph has " << num_nodes << std::endl;
+        return false;
+    }
+    order_ = order;
+
+    // the higher-ranked neighbours of each rank
+    std::vector<std::vector<uint32_t>> up(num_nodes);
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        warthog::graph::node* n = g->get_node(i);
+        for(uint32_t j = 0; j < n->out_degree(); j++)
+        {
+            uint32_t r1 = rank_[i];
+            uint32_t r2 = rank_[(n->outgoing_begin() + j)->node_id_];
+            if(r1 == r2) { continue; }
+            up[std::min(r1, r2)].push_back(std::max(r1, r2));
+        }
+    }
+
+    // contracting rank r makes its upper neighbours a clique. it is
+    // enough to connect them all to the lowest one, because that node
+    // is contracted next among them and passes the rest on in turn
+    up_index_.assign(1, 0);
+    up_head_.clear();
+    for(uint32_t r = 0; r < num_nodes; r++)
+    {
+        std::vector<uint32_t>& neis = up[r];
+        std::sort(neis.begin(), neis.end());
+        neis.erase(std::unique(neis.begin(), neis.end()), neis.end());
+        if(neis.size() > 1)
+        {
+            std::vector<uint32_t>& parent = up[neis[0]];
+            parent.insert(parent.end(), neis.begin()+1, neis.end());
+        }
+        up_head_.insert(up_head_.end(), neis.begin(), neis.end());
+        up_index_.push_back(up_head_.size());
+        neis.clear();
+        neis.shrink_to_fit();
+    }
+    init_index();
+    return true;
+}
+
+void
+warthog::ch::customizable_ch::init_index()
+{
+    uint32_t num_nodes = order_.size();
+    uint32_t num_arcs = up_head_.size();
+
+    down_index_.assign(num_nodes+1, 0);
+    for(uint32_t a = 0; a < num_arcs; a++)
+    {
+        down_index_[up_head_[a]+1]++;
+    }
+    for(uint32_t r = 0; r < num_nodes; r++)
+    {
+        down_index_[r+1] += down_index_[r];
+    }
+    down_tail_.resize(num_arcs);
+    down_arc_.resize(num_arcs);
+    std::vector<uint32_t> next(down_index_.begin(), down_index_.end()-1);
+    std::vector<uint32_t> level(num_nodes, 0);
+    uint32_t num_levels = num_nodes ? 1 : 0;
+    for(uint32_t r = 0; r < num_nodes; r++)
+    {
+        for(uint32_t a = up_index_[r]; a < up_index_[r+1]; a++)
+        {
+            uint32_t head = up_head_[a];
+            down_tail_[next[head]] = r;
+            down_arc_[next[head]] = a;
+            next[head]++;
+            level[head] = std::max(level[head], level[r]+1);
+            num_levels = std::max(num_levels, level[head]+1);
+        }
+    }
+
+    level_index_.assign(num_levels+1, 0);
+    for(uint32_t r = 0; r < num_nodes; r++)
+    {
+        level_index_[level[r]+1]++;
+    }
+    for(uint32_t l = 0; l < num_levels; l++)
+    {
+        level_index_[l+1] += level_index_[l];
+    }
+    level_ranks_.resize(num_nodes);
+    next.assign(level_index_.begin(), level_index_.end()-1);
+    for(uint32_t r = 0; r < num_nodes; r++)
+    {
+        level_ranks_[next[level[r]]++] = r;
+    }
+}
+
+uint32_t
+warthog::ch::customizable_ch::find_arc(uint32_t lo, uint32_t hi)
+{
+    std::vector<uint32_t>::iterator begin = up_head_.begin() + up_index_[lo];
+    std::vector<uint32_t>::iterator end = up_head_.begin() + up_index_[lo+1];
+    std::vector<uint32_t>::iterator it = std::lower_bound(begin, end, hi);
+    if(it == end || *it != hi) { return warthog::INF; }
+    return it - up_head_.begin();
+}
+
+bool
+warthog::ch::customizable_ch::customize(
+        warthog::graph::xy_graph* metric, uint32_t num_threads)
+{
+    if(metric->get_num_nodes() != order_.size())
+    {
+        std::cerr << "err; metric has " << metric->get_num_nodes()
+            << " nodes but the topology has " << order_.size() << std::endl;
+        return false;
+    }
+    if(num_threads == 0)
+    {
+        num_threads = std::thread::hardware_concurrency();
+        if(num_threads == 0) { num_threads = 1; }
+    }
+
+    // the weight of every input edge goes to the arc between its endpoints.
+    // the task of each node writes only the arc directions leaving it
+    fwd_wt_.assign(up_head_.size(), warthog::INF);
+    bwd_wt_.assign(up_head_.size(), warthog::INF);
+    std::atomic<uint32_t> num_missing(0);
+    run_tasks(order_.size(), num_threads,
+        [this, metric, &num_missing](std::vector<uint32_t>&, uint32_t id)
+        {
+            warthog::graph::node* n = metric->get_node(id);
+            for(uint32_t i = 0; i < n->out_degree(); i++)
+            {
+                warthog::graph::edge& e = *(n->outgoing_begin() + i);
+                uint32_t r1 = rank_[id];
+                uint32_t r2 = rank_[e.node_id_];
+                if(r1 == r2) { continue; }
+
+                uint32_t arc = find_arc(std::min(r1, r2), std::max(r1, r2));
+                if(arc == warthog::INF) { num_missing++; continue; }
+                uint32_t& wt = r1 < r2 ? fwd_wt_[arc] : bwd_wt_[arc];
+                wt = std::min<uint32_t>(wt, e.wt_);
+            }
+        });
+    if(num_missing > 0)
+    {
+        std::cerr << "err; metric has " << num_missing.load()
+            << " edges that are not in the topology" << std::endl;
+        return false;
+    }
+
+    // lower triangles. the arcs leaving lower neighbours are final
+    // before their level is processed, so each node only reads them
+    // and writes its own upward arcs
+    for(uint32_t l = 0; l+1 < level_index_.size(); l++)
+    {
+        uint32_t level_begin = level_index_[l];
+        run_tasks(level_index_[l+1] - level_begin, num_threads,
+            [this, level_begin](std::vector<uint32_t>& slot, uint32_t i)
+            {
+                uint32_t u = level_ranks_[level_begin + i];
+                for(uint32_t a = up_index_[u]; a < up_index_[u+1]; a++)
+                {
+                    slot[up_head_[a]] = a;
+                }
+
+                for(uint32_t d = down_index_[u]; d < down_index_[u+1]; d++)
+                {
+                    uint32_t v = down_tail_[d];
+                    uint32_t a_vu = down_arc_[d];
+                    uint64_t u_to_v = bwd_wt_[a_vu];
+                    uint64_t v_to_u = fwd_wt_[a_vu];
+                    for(uint32_t a_vw = a_vu+1; a_vw < up_index_[v+1]; a_vw++)
+                    {
+                        // upper neighbours of v form a clique, so u and
+                        // w are adjacent
+                        uint32_t a_uw = slot[up_head_[a_vw]];
+                        assert(a_uw != warthog::INF);
+
+                        uint64_t via = u_to_v + fwd_wt_[a_vw];
+                        if(via < fwd_wt_[a_uw]) { fwd_wt_[a_uw] = via; }
+                        via = bwd_wt_[a_vw] + v_to_u;
+                        if(via < bwd_wt_[a_uw]) { bwd_wt_[a_uw] = via; }
+                    }
+                }
+
+                for(uint32_t a = up_index_[u]; a < up_index_[u+1]; a++)
+                {
+                    slot[up_head_[a]] = warthog::INF;
+                }
+            });
+    }
+    return true;
+}
+
+void
+warthog::ch::customizable_ch::make_hierarchy(
+        warthog::graph::xy_graph* metric, warthog::graph::xy_graph* ch,
+        std::vector<uint32_t>* rank)
+{
+    uint32_t num_nodes = order_.size();
+    ch->clear();
+    ch->capacity(num_nodes);
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        int32_t x, y;
+        metric->get_xy(i, x, y);
+        ch->add_node(x, y, metric->to_external_id(i));
+    }
+
+    std::vector<uint32_t> in_deg(num_nodes, 0);
+    std::vector<uint32_t> out_deg(num_nodes, 0);
+    for(uint32_t r = 0; r < num_nodes; r++)
+    {
+        for(uint32_t a = up_index_[r]; a < up_index_[r+1]; a++)
+        {
+            uint32_t lo = order_[r];
+            uint32_t hi = order_[up_head_[a]];
+            if(fwd_wt_[a] < (uint32_t)warthog::INF)
+            { out_deg[lo]++; in_deg[hi]++; }
+            if(bwd_wt_[a] < (uint32_t)warthog::INF)
+            { out_deg[hi]++; in_deg[lo]++; }
+        }
+    }
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        ch->get_node(i)->capacity(in_deg[i], out_deg[i]);
+    }
+
+    for(uint32_t r = 0; r < num_nodes; r++)
+    {
+        for(uint32_t a = up_index_[r]; a < up_index_[r+1]; a++)
+        {
+            uint32_t lo = order_[r];
+            uint32_t hi = order_[up_head_[a]];
+            if(fwd_wt_[a] < (uint32_t)warthog::INF)
+            {
+                ch->get_node(lo)->add_outgoing(
+                        warthog::graph::edge(hi, fwd_wt_[a]));
+                ch->get_node(hi)->add_incoming(
+                        warthog::graph::edge(lo, fwd_wt_[a]));
+            }
+            if(bwd_wt_[a] < (uint32_t)warthog::INF)
+            {
+                ch->get_node(hi)->add_outgoing(
+                        warthog::graph::edge(lo, bwd_wt_[a]));
+                ch->get_node(lo)->add_incoming(
+                        warthog::graph::edge(hi, bwd_wt_[a]));
+            }
+        }
+    }
+    if(rank) { *rank = rank_; }
+}
+
+bool
+warthog::ch::customizable_ch::save(const char* filename)
+{
+    std::ofstream ofs(filename,
+            std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+    if(!ofs.good())
+    {
+        std::cerr << "err; cannot write to file " << filename << std::endl;
+        return false;
+    }
+
+    warthog::ch::cch_header header;
+    header.magic_ = warthog::ch::CCH_MAGIC;
+    header.version_ = warthog::ch::CCH_VERSION;
+    header.num_nodes_ = order_.size();
+    header.num_arcs_ = up_head_.size();
+    ofs.write((char*)&header, sizeof(header));
+    ofs.write((char*)order_.data(), sizeof(uint32_t) * order_.size());
+    ofs.write((char*)up_index_.data(), sizeof(uint32_t) * up_index_.size());
+    ofs.write((char*)up_head_.data(), sizeof(uint32_t) * up_head_.size());
+    return ofs.good();
+}
+
+bool
+warthog::ch::customizable_ch::load(const char* filename)
+{
+    std::ifstream ifs(filename, std::ios_base::in | std::ios_base::binary);
+    warthog::ch::cch_header header;
+    ifs.read((char*)&header, sizeof(header));
+    if(!ifs.good() || header.magic_ != warthog::ch::CCH_MAGIC ||
+       header.version_ != warthog::ch::CCH_VERSION)
+    {
+        std::cerr << "err; not a CCH topology file (or wrong version) "
+            << filename << std::endl;
+        return false;
+    }
+
+    order_.resize(header.num_nodes_);
+    up_index_.resize(header.num_nodes_+1);
+    up_head_.resize(header.num_arcs_);
+    ifs.read((char*)order_.data(), sizeof(uint32_t) * order_.size());
+    ifs.read((char*)up_index_.data(), sizeof(uint32_t) * up_index_.size());
+    ifs.read((char*)up_head_.data(), sizeof(uint32_t) * up_head_.size());
+    if(!ifs.good() || up_index_.back() != header.num_arcs_)
+    {
+        std::cerr << "err; truncated CCH topology file "
+            << filename << std::endl;
+        return false;
+    }
+
+    // init_index and find_arc index by rank without checks: the order
+    // must be a permutation, and the upward arcs of every rank must be
+    // sorted and lead to higher ranks
+    uint32_t num_nodes = header.num_nodes_;
+    rank_.assign(num_nodes, warthog::INF);
+    bool valid = up_index_.front() == 0;
+    for(uint32_t i = 0; valid && i < num_nodes; i++)
+    {
+        valid = order_[i] < num_nodes && rank_[order_[i]] == warthog::INF;
+        if(valid) { rank_[order_[i]] = i; }
+    }
+    for(uint32_t r = 0; valid && r < num_nodes; r++)
+    {
+        valid = up_index_[r] <= up_index_[r+1];
+        for(uint32_t a = up_index_[r]; valid && a < up_index_[r+1]; a++)
+        {
+            valid = up_head_[a] > r && up_head_[a] < num_nodes &&
+                (a == up_index_[r] || up_head_[a-1] < up_head_[a]);
+        }
+    }
+    if(!valid)
+    {
+        std::cerr << "err; corrupt CCH topology file "
+            << filename << std::endl;
+        order_.clear();
+        rank_.clear();
+        up_index_.clear();
+        up_head_.clear();
+        return false;
+    }
+
+    fwd_wt_.clear();
+    bwd_wt_.clear();
+    init_index();
+    return true;
+}
+
+void
+warthog::ch::customizable_ch::run_tasks(uint32_t num_tasks,
+        uint32_t num_threads,
+        const std::function<void(std::vector<uint32_t>&, uint32_t)>& fn_task)
+{
+    if(num_tasks == 0) { return; }
+    uint32_t num_workers = std::min(num_threads, num_tasks);
+    if(num_workers == 0) { num_workers = 1; }
+    if(scratch_.size() < num_workers) { scratch_.resize(num_workers); }
+    for(uint32_t i = 0; i < num_workers; i++)
+    {
+        scratch_[i].resize(order_.size(), warthog::INF);
+    }
+
+    warthog::util::work_queue tasks(num_tasks, num_workers);
+    auto thread_fn = [&] (uint32_t worker_id) -> void
+    {
+        uint32_t task_id;
+        while(tasks.next(worker_id, task_id))
+        {
+            fn_task(scratch_[worker_id], task_id);
+        }
+    };
+
+    if(num_workers == 1)
+    {
+        thread_fn(0);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    for(uint32_t i = 0; i < num_workers; i++)
+    {
+        threads.push_back(std::thread(thread_fn, i));
+    }
+    for(uint32_t i = 0; i < num_workers; i++)
+    {
+        threads.at(i).join();
+    }
+}
+
+size_t
+warthog::ch::customizable_ch::mem()
+{
+    size_t bytes = sizeof(*this) + sizeof(uint32_t) * (
+        order_.capacity() + rank_.capacity() +
+        up_index_.capacity() + up_head_.capacity() +
+        down_index_.capacity() + down_tail_.capacity() +
+        down_arc_.capacity() + level_index_.capacity() +
+        level_ranks_.capacity() + fwd_wt_.capacity() + bwd_wt_.capacity());
+    for(uint32_t i = 0; i < scratch_.size(); i++)
+    {
+        bytes += sizeof(uint32_t) * scratch_[i].capacity();
+    }
+    return bytes;
+}
@@ -0,0 +1,184 @@
+#ifndef WARTHOG_CUSTOMIZABLE_CH_H
+#define WARTHOG_CUSTOMIZABLE_CH_H
+
+// contraction/customizable_ch.h
+//
+// Customizable contraction hierarchies (CCH). Preprocessing is split
+// into a metric-independent phase, which runs once per road network,
+// and a customization phase, which runs every time the arc weights
+// change.
+//
+// The metric-independent phase needs a node order. Nested dissection
+// orders work best: they contract the nodes of small balanced separators
+// last. ::load_metis_order reads the order computed by METIS (ndmetis)
+// for the graph written by dimacs2metis. ::make_nested_dissection_order
+// computes a simpler order from the node coordinates instead.
+//
+// ::contract then contracts the undirected topology of the input graph
+// in that order. Weights play no role: when node v is contracted, its
+// higher-ranked neighbours become pairwise adjacent. The result is a
+// set of arcs {v, u}, each stored once at the lower-ranked endpoint.
+// It can be saved and loaded with ::save and ::load.
+//
+// ::customize reads the arc weights of a graph with the same nodes and
+// computes the weight of every arc, in both directions, by processing
+// lower triangles {v, u, w} with rank(v) < rank(u) < rank(w) from the
+// bottom up. Nodes are grouped into levels so that the upward arcs of
+// the nodes in one level can be computed in parallel.
+//
+// ::make_hierarchy turns the customized arcs into a regular contraction
+// hierarchy (xy_graph plus rank) that the bch and fch expansion policies
+// can search.
+//
+// For more details see:
+// [Dibbelt, Strasser and Wagner. Customizable Contraction Hierarchies.
+// ACM Journal of Experimental Algorithmics, 21(1), 2016]
+//
+
+#include "xy_graph.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace warthog
+{
+
+namespace ch
+{
+
+const uint32_t CCH_MAGIC = 0x48434357; // "WCCH"
+const uint32_t CCH_VERSION = 1;
+
+struct cch_header
+{
+    uint32_t magic_;
+    uint32_t version_;
+    uint32_t num_nodes_;
+    uint32_t num_arcs_;
+};
+
+// @return true if @param filename starts with the magic number of
+// a CCH topology file written by customizable_ch::save
+bool
+is_cch_file(const char* filename);
+
+// load a nested dissection order computed by METIS. @param iperm_file
+// is the .iperm file that ndmetis writes for a graph converted by
+// dimacs2metis: line i gives the position of METIS vertex i+1 (i.e.
+// DIMACS node i+1) in the order. the result is an order-of-contraction
+// over the ids of @param g, as read by ::load_node_order.
+bool
+load_metis_order(const char* iperm_file, warthog::graph::xy_graph* g,
+        std::vector<uint32_t>& order);
+
+// compute a nested dissection order of @param g by recursive coordinate
+// bisection. each step splits the nodes at the median of the wider
+// axis and contracts the nodes of one side which have neighbours on the
+// other side (a vertex separator) after everything else.
+void
+make_nested_dissection_order(warthog::graph::xy_graph* g,
+        std::vector<uint32_t>& order);
+
+class customizable_ch
+{
+    public:
+        customizable_ch();
+        ~customizable_ch();
+
+        // metric-independent contraction of the (undirected) topology
+        // of @param g, using the order-of-contraction @param order
+        // @return false if @param order is not a permutation of the nodes
+        bool
+        contract(warthog::graph::xy_graph* g, std::vector<uint32_t>& order);
+
+        // compute the weight of every arc from the edge weights of
+        // @param metric, which must have the same nodes as the graph
+        // given to ::contract. edges of @param metric whose endpoints are
+        // not adjacent in the topology are an error.
+        //
+        // @param num_threads: worker threads (0 = one per hardware thread)
+        // @return false if @param metric does not fit the topology
+        bool
+        customize(warthog::graph::xy_graph* metric, uint32_t num_threads=1);
+
+        // create a contraction hierarchy with the nodes of @param metric
+        // and one edge for every customized arc direction whose weight
+        // is finite. @param rank receives the rank of each node.
+        void
+        make_hierarchy(warthog::graph::xy_graph* metric,
+                warthog::graph::xy_graph* ch, std::vector<uint32_t>* rank);
+
+        // @return the order-of-contraction used by ::contract
+        void
+        get_order(std::vector<uint32_t>& order) { order = order_; }
+
+        bool
+        save(const char* filename);
+
+        bool
+        load(const char* filename);
+
+        inline uint32_t
+        get_num_nodes() { return order_.size(); }
+
+        inline uint32_t
+        get_num_arcs() { return up_head_.size(); }
+
+        // the number of levels processed one after the other by ::customize
+        inline uint32_t
+        get_num_levels() { return level_index_.size() - 1; }
+
+        size_t
+        mem();
+
+    private:
+        // every array below is indexed by rank, not by node id
+        std::vector<uint32_t> order_;   // node id of each rank
+        std::vector<uint32_t> rank_;    // rank of each node id
+
+        // upward arcs; the arcs of rank r are [up_index_[r], up_index_[r+1]),
+        // sorted by head rank
+        std::vector<uint32_t> up_index_;
+        std::vector<uint32_t> up_head_;
+
+        // downward arcs; for each rank u, the lower ranked endpoints of
+        // its arcs and the index of each arc in up_head_
+        std::vector<uint32_t> down_index_;
+        std::vector<uint32_t> down_tail_;
+        std::vector<uint32_t> down_arc_;
+
+        // ranks grouped by level; level 0 have no lower neighbours and
+        // level l+1 only have lower neighbours at level l or below
+        std::vector<uint32_t> level_index_;
+        std::vector<uint32_t> level_ranks_;
+
+        // customized weights of each arc {v, u}, rank(v) < rank(u)
+        std::vector<uint32_t> fwd_wt_; // v to u
+        std::vector<uint32_t> bwd_wt_; // u to v
+
+        // per-thread scratch space for ::run_tasks
+        std::vector<std::vector<uint32_t>> scratch_;
+
+        // build the downward arcs and levels from the upward arcs
+        void
+        init_index();
+
+        // @return the index of arc {@param lo, @param hi} or warthog::INF
+        uint32_t
+        find_arc(uint32_t lo, uint32_t hi);
+
+        // run tasks [0, @param num_tasks) on @param num_threads threads.
+        // each thread gets a scratch array with one entry per rank,
+        // which tasks must leave as they found it (all warthog::INF)
+        void
+        run_tasks(uint32_t num_tasks, uint32_t num_threads,
+            const std::function<void(std::vector<uint32_t>&, uint32_t)>&
+                fn_task);
+};
+
+}
+
+}
+
+#endif
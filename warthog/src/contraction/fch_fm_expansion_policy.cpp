@@ -6,7 +6,7 @@
 warthog::fch_fm_expansion_policy::fch_fm_expansion_policy(
         warthog::graph::xy_graph* g, 
         std::vector<uint32_t>* rank,
-        warthog::label::firstmove_labelling* lab,
+        warthog::label::firstmove_table* lab,
         bool sort_successors)
     : expansion_policy(g->get_num_nodes()), g_(g) 
 {
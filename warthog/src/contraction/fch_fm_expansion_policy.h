@@ -12,7 +12,7 @@
 //
 
 #include "xy_graph.h"
-#include "firstmove_labelling.h"
+#include "firstmove_table.h"
 #include "expansion_policy.h"
 
 #include <vector>
@@ -26,7 +26,7 @@ class fch_fm_expansion_policy : public expansion_policy
         fch_fm_expansion_policy(
                 warthog::graph::xy_graph* graph,
                 std::vector<uint32_t>* rank, 
-                warthog::label::firstmove_labelling* lab,
+                warthog::label::firstmove_table* lab,
                 bool sort_successors=true);
 
         ~fch_fm_expansion_policy();
@@ -57,7 +57,7 @@ class fch_fm_expansion_policy : public expansion_policy
         warthog::graph::xy_graph* g_;
         uint8_t* heads_;
 
-        warthog::label::firstmove_labelling* lab_;
+        warthog::label::firstmove_table* lab_;
         int32_t t_graph_id;
 
         inline uint32_t
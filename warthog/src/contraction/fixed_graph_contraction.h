@@ -12,6 +12,7 @@
 
 #include "contraction.h"
 #include "flexible_astar.h"
+#include "graph_expansion_policy.h"
 
 #include <vector>
 
@@ -6,8 +6,14 @@
 #include "zero_heuristic.h"
 #include "euclidean_heuristic.h"
 
+#include "timer.h"
+#include "work_queue.h"
+
 #include <algorithm>
+#include <cfloat>
+#include <ctime>
 #include <functional>
+#include <thread>
 #include <utility>
 
 bool
@@ -20,16 +26,7 @@ warthog::ch::lazy_graph_contraction::lazy_graph_contraction(
         warthog::graph::xy_graph* g) : g_(g)
 {
     heuristic_ = new warthog::euclidean_heuristic(g_);
-    c_filter_ = new warthog::apriori_filter(g_->get_num_nodes());
     u_filter_ = new warthog::apriori_filter(g_->get_num_nodes());
-    fexpander_ = new warthog::graph_expansion_policy<warthog::apriori_filter>(
-                g_, c_filter_);
-    bexpander_ = new warthog::graph_expansion_policy<warthog::apriori_filter>(
-                g_, c_filter_);
-
-    alg_ = new bidirectional_search< warthog::euclidean_heuristic,
-                 warthog::graph_expansion_policy<warthog::apriori_filter>>(
-                         fexpander_, bexpander_, heuristic_);
 
     uint32_t sz_g = g_->get_num_nodes();
     heap_ = new warthog::heap<ch_pair>(sz_g, true);
@@ -37,12 +34,18 @@ warthog::ch::lazy_graph_contraction::lazy_graph_contraction(
 
     terms_ = new niv_metrics[sz_g];
 
-    ws_max_expansions_ = warthog::INF;
+    ws_type_ = warthog::ch::WS_ONE_TO_MANY;
+    ws_max_expansions_ = 500; // as recommended by RoutingKit's implementation
+    ws_max_hops_ = 0;
     verbose_ = false;
+    serial_secs_ = 0;
+    set_num_contexts(1);
 }
 
 warthog::ch::lazy_graph_contraction::~lazy_graph_contraction()
 {
+    set_num_contexts(0);
+
     delete [] terms_;
     terms_ = 0;
 
@@ -52,17 +55,42 @@ warthog::ch::lazy_graph_contraction::~lazy_graph_contraction()
     delete heap_;
     heap_ = 0;
 
-    delete alg_;
-    alg_ = 0;
-
-    delete c_filter_;
-    c_filter_ = 0;
-    
     delete u_filter_;
     u_filter_ = 0;
 
     delete heuristic_;
     heuristic_ = 0;
+}
+
+warthog::ch::lazy_graph_contraction::witness_context::witness_context(
+        lazy_graph_contraction* parent)
+{
+    warthog::graph::xy_graph* g = parent->g_;
+    c_filter_ = new warthog::apriori_filter(g->get_num_nodes());
+    fexpander_ = new warthog::graph_expansion_policy<warthog::apriori_filter>(
+                g, c_filter_);
+    bexpander_ = new warthog::graph_expansion_policy<warthog::apriori_filter>(
+                g, c_filter_);
+
+    alg_ = new bidirectional_search< warthog::euclidean_heuristic,
+                 warthog::graph_expansion_policy<warthog::apriori_filter>>(
+                         fexpander_, bexpander_, parent->heuristic_);
+    uc_neis_incoming_begin_ = 0;
+    dist_.resize(g->get_num_nodes(), DBL_MAX);
+    hops_.resize(g->get_num_nodes(), 0);
+    target_.resize(g->get_num_nodes(), 0);
+    total_expansions_ = 0;
+    total_searches_ = 0;
+    busy_secs_ = 0;
+}
+
+warthog::ch::lazy_graph_contraction::witness_context::~witness_context()
+{
+    delete alg_;
+    alg_ = 0;
+
+    delete c_filter_;
+    c_filter_ = 0;
 
     delete fexpander_;
     fexpander_ = 0;
@@ -71,6 +99,29 @@ warthog::ch::lazy_graph_contraction::~lazy_graph_contraction()
     bexpander_ = 0;
 }
 
+void
+warthog::ch::lazy_graph_contraction::set_num_contexts(uint32_t num_threads)
+{
+    for(uint32_t i = 0; i < contexts_.size(); i++)
+    {
+        delete contexts_.at(i);
+    }
+    contexts_.clear();
+    for(uint32_t i = 0; i < num_threads; i++)
+    {
+        contexts_.push_back(new witness_context(this));
+    }
+}
+
+void
+warthog::ch::lazy_graph_contraction::set_contracted(uint32_t node_id)
+{
+    for(uint32_t i = 0; i < contexts_.size(); i++)
+    {
+        contexts_.at(i)->c_filter_->set_flag_true(node_id);
+    }
+}
+
 void
 warthog::ch::lazy_graph_contraction::contract(
         bool verify_priorities, uint32_t c_pct)
@@ -85,7 +136,13 @@ warthog::ch::lazy_graph_contraction::contract(
 
     warthog::timer mytimer;
     double t_begin = mytimer.get_time_micro();
+    set_num_contexts(1);
+    witness_context& ctx = *contexts_.at(0);
     preliminaries();
+    for(uint32_t i = 0; i < g_->get_num_nodes(); i++)
+    {
+        heap_->push(&hn_pool_[i]);
+    }
 
     // contract nodes in the order produced by ::next
     uint32_t total_nodes = (g_->get_num_nodes()*c_pct) / 100;
@@ -96,18 +153,22 @@ warthog::ch::lazy_graph_contraction::contract(
     {
         // contract the highest priority node  +
         // record some search effort metrics
-        uint64_t num_expansions = total_expansions_;
-        uint64_t num_searches = total_searches_;
+        uint64_t num_expansions = ctx.total_expansions_;
+        uint64_t num_searches = ctx.total_searches_;
         uint64_t num_lazy = total_lazy_updates_;
         mytimer.start();
 
         uint32_t best_id = next(verify_priorities, c_pct); 
         if(best_id == warthog::INF) { break; }
-        terms_[best_id] = contract_node(best_id, false);
+        shorts_.in_.clear();
+        shorts_.out_.clear();
+        terms_[best_id] = contract_node(ctx, best_id, &shorts_);
+        add_shortcuts(shorts_, best_id);
+        terms_[best_id].level_ = order_.size();
 
         // mark adjacent un-contracted neighbours as needing to be updated
         update_neis.clear();
-        for(auto& e : uc_neis_) 
+        for(auto& e : ctx.uc_neis_) 
         { 
             update_neis.push_back(e.node_id_); 
             u_filter_->set_flag_true(e.node_id_);
@@ -121,7 +182,7 @@ warthog::ch::lazy_graph_contraction::contract(
 
             // re-compute importance metrics
             niv_metrics niv = 
-            contract_node(neighbour_id, true);
+            contract_node(ctx, neighbour_id, 0);
 
             // update the "search space size" estimate
             niv.depth_ = std::max(niv.depth_, terms_[best_id].depth_+1);
@@ -145,8 +206,8 @@ warthog::ch::lazy_graph_contraction::contract(
         }
         mytimer.stop();
 
-        num_expansions = total_expansions_ - num_expansions;
-        num_searches = total_searches_ - num_searches;
+        num_expansions = ctx.total_expansions_ - num_expansions;
+        num_searches = ctx.total_searches_ - num_searches;
         num_lazy = total_lazy_updates_ - num_lazy;
 
         if((mytimer.get_time_micro() - t_last) > 1000000)
@@ -174,7 +235,253 @@ warthog::ch::lazy_graph_contraction::contract(
     std::cerr << "edges before " << edges_before 
         << "; edges after " << g_->get_num_edges_out() << std::endl;
 
-    postliminaries();
+    postliminaries((mytimer.get_time_micro() - t_begin) / 1e6);
+}
+
+void
+warthog::ch::lazy_graph_contraction::contract_parallel(
+        uint32_t num_threads, uint32_t c_pct)
+{
+    if(order_.size() > 0) { return; } // graph already contracted
+    if(num_threads == 0)
+    {
+        num_threads = std::thread::hardware_concurrency();
+        if(num_threads == 0) { num_threads = 1; }
+    }
+
+    if(c_pct < 100)
+    { std::cerr << "partially " << "("<<c_pct<<"% of nodes) "; }
+    std::cerr << "contracting graph " << g_->get_filename() 
+        << " with " << num_threads << " threads" << std::endl;
+    uint32_t edges_before = g_->get_num_edges_out();
+    std::cerr << " edges before " << edges_before << " ";
+
+    warthog::timer wallclock;
+    wallclock.start();
+    serial_secs_ = 0;
+    set_num_contexts(num_threads);
+    preliminaries();
+
+    uint32_t total_nodes = (g_->get_num_nodes()*c_pct) / 100;
+    std::vector<uint32_t> remaining;
+    for(uint32_t i = 0; i < g_->get_num_nodes(); i++)
+    {
+        remaining.push_back(i);
+    }
+
+    std::vector<uint32_t> iset;
+    std::vector<niv_metrics> iset_terms;
+    std::vector<shortcut_list> iset_shorts;
+    std::vector<uint32_t> update_neis;
+    std::vector<niv_metrics> update_terms;
+    uint32_t num_rounds = 0;
+    warthog::timer mytimer;
+    double t_last = mytimer.get_time_micro();
+    while(remaining.size() > 0 && order_.size() < total_nodes)
+    {
+        // select the next batch of nodes to contract
+        mytimer.start();
+        iset.clear();
+        for(uint32_t i = 0; i < remaining.size(); i++)
+        {
+            if(is_local_minimum(remaining.at(i)))
+            {
+                iset.push_back(remaining.at(i));
+            }
+        }
+        if(order_.size() + iset.size() > total_nodes)
+        {
+            // partial contraction: keep only the best candidates
+            std::sort(iset.begin(), iset.end(), 
+                [this](uint32_t a, uint32_t b) -> bool
+                {
+                    int32_t cval_a = hn_pool_[a].get_element().cval_;
+                    int32_t cval_b = hn_pool_[b].get_element().cval_;
+                    return cval_a < cval_b || (cval_a == cval_b && a < b);
+                });
+            iset.resize(total_nodes - order_.size());
+        }
+        for(uint32_t i = 0; i < iset.size(); i++)
+        {
+            set_contracted(iset.at(i));
+        }
+        mytimer.stop();
+        serial_secs_ += mytimer.elapsed_time_micro() / 1e6;
+
+        // contract
+        iset_terms.resize(iset.size());
+        iset_shorts.resize(iset.size());
+        run_tasks(iset.size(), 
+            [&] (witness_context& ctx, uint32_t i) -> void
+            {
+                iset_shorts.at(i).in_.clear();
+                iset_shorts.at(i).out_.clear();
+                iset_terms.at(i) = 
+                    contract_node(ctx, iset.at(i), &iset_shorts.at(i));
+            });
+
+        // add shortcuts and mark adjacent un-contracted neighbours as 
+        // needing to be updated
+        mytimer.start();
+        update_neis.clear();
+        for(uint32_t i = 0; i < iset.size(); i++)
+        {
+            uint32_t node_id = iset.at(i);
+            add_shortcuts(iset_shorts.at(i), node_id);
+            terms_[node_id] = iset_terms.at(i);
+            terms_[node_id].level_ = order_.size();
+
+            warthog::graph::node* n = g_->get_node(node_id);
+            for(uint32_t j = 0; j < n->out_degree() + n->in_degree(); j++)
+            {
+                uint32_t nei_id = j < n->out_degree() ? 
+                    (n->outgoing_begin() + j)->node_id_ :
+                    (n->incoming_begin() + (j - n->out_degree()))->node_id_;
+                if(contexts_.at(0)->c_filter_->get_flag(nei_id)) { continue; }
+
+                // update the "search space size" estimate
+                terms_[nei_id].depth_ = 
+                    std::max(terms_[nei_id].depth_, terms_[node_id].depth_+1);
+                if(u_filter_->get_flag(nei_id)) { continue; }
+                u_filter_->set_flag_true(nei_id);
+                update_neis.push_back(nei_id);
+            }
+        }
+        mytimer.stop();
+        serial_secs_ += mytimer.elapsed_time_micro() / 1e6;
+
+        // re-compute importance metrics
+        update_terms.resize(update_neis.size());
+        run_tasks(update_neis.size(), 
+            [&] (witness_context& ctx, uint32_t i) -> void
+            {
+                update_terms.at(i) = contract_node(ctx, update_neis.at(i), 0);
+            });
+
+        mytimer.start();
+        for(uint32_t i = 0; i < update_neis.size(); i++)
+        {
+            uint32_t nei_id = update_neis.at(i);
+            terms_[nei_id] = update_terms.at(i);
+            hn_pool_[nei_id].get_element().cval_ = 
+                compute_contraction_priority(terms_[nei_id]);
+            u_filter_->set_flag_false(nei_id);
+        }
+        total_lazy_updates_ += update_neis.size();
+
+        // drop the contracted nodes 
+        uint32_t num_remaining = 0;
+        for(uint32_t i = 0; i < remaining.size(); i++)
+        {
+            uint32_t node_id = remaining.at(i);
+            if(contexts_.at(0)->c_filter_->get_flag(node_id)) { continue; }
+            remaining.at(num_remaining++) = node_id;
+        }
+        remaining.resize(num_remaining);
+        num_rounds++;
+        mytimer.stop();
+        serial_secs_ += mytimer.elapsed_time_micro() / 1e6;
+
+        if((mytimer.get_time_micro() - t_last) > 1000000 || verbose_)
+        {
+            t_last = mytimer.get_time_micro();
+            std::cerr 
+                << "round: " << num_rounds 
+                << "; contracted: " << iset.size()
+                << "; updated: " << update_neis.size()
+                << "; " << order_.size() << " /  " << total_nodes 
+                << std::endl;
+        }
+    }
+    wallclock.stop();
+
+    std::cerr << "\ngraph, contracted. ";
+    std::cerr << "edges before " << edges_before 
+        << "; edges after " << g_->get_num_edges_out() << std::endl;
+
+    postliminaries(wallclock.elapsed_time_micro() / 1e6);
+
+    // a single thread would need the time spent on tasks by all threads
+    // plus the time spent outside of them
+    double wallclock_secs = wallclock.elapsed_time_micro() / 1e6;
+    double busy_secs = 0;
+    for(uint32_t i = 0; i < contexts_.size(); i++)
+    {
+        busy_secs += contexts_.at(i)->busy_secs_;
+    }
+    std::cout 
+        << "\trounds: " << num_rounds << std::endl
+        << "\tthreads: " << contexts_.size() << std::endl
+        << "\twallclock (s): " << wallclock_secs << std::endl
+        << "\tthread time (s): " << busy_secs + serial_secs_ << std::endl
+        << "\tspeedup: " 
+        << (wallclock_secs > 0 ? 
+            (busy_secs + serial_secs_) / wallclock_secs : 1) << std::endl;
+}
+
+void
+warthog::ch::lazy_graph_contraction::run_tasks(uint32_t num_tasks, 
+        const std::function<void(witness_context&, uint32_t)>& fn_task)
+{
+    if(num_tasks == 0) { return; }
+    uint32_t num_workers = 
+        std::min<uint32_t>(contexts_.size(), num_tasks);
+    warthog::util::work_queue tasks(num_tasks, num_workers);
+
+    auto thread_fn = [&] (uint32_t worker_id) -> void
+    {
+        // measure cpu time rather than wallclock time, so that the
+        // estimate holds when there are more threads than cores
+        witness_context& ctx = *contexts_.at(worker_id);
+        timespec t_begin, t_end;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t_begin);
+        uint32_t task_id;
+        while(tasks.next(worker_id, task_id))
+        {
+            fn_task(ctx, task_id);
+        }
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t_end);
+        ctx.busy_secs_ += (t_end.tv_sec - t_begin.tv_sec) + 
+            (t_end.tv_nsec - t_begin.tv_nsec) / 1e9;
+    };
+
+    if(num_workers == 1)
+    {
+        thread_fn(0);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    for(uint32_t i = 0; i < num_workers; i++)
+    {
+        threads.push_back(std::thread(thread_fn, i));
+    }
+    for(uint32_t i = 0; i < num_workers; i++)
+    {
+        threads.at(i).join();
+    }
+}
+
+bool
+warthog::ch::lazy_graph_contraction::is_local_minimum(uint32_t node_id)
+{
+    warthog::apriori_filter* c_filter = contexts_.at(0)->c_filter_;
+    int32_t cval = hn_pool_[node_id].get_element().cval_;
+    warthog::graph::node* n = g_->get_node(node_id);
+    for(uint32_t i = 0; i < n->out_degree() + n->in_degree(); i++)
+    {
+        uint32_t nei_id = i < n->out_degree() ? 
+            (n->outgoing_begin() + i)->node_id_ :
+            (n->incoming_begin() + (i - n->out_degree()))->node_id_;
+        if(nei_id == node_id || c_filter->get_flag(nei_id)) { continue; }
+
+        int32_t nei_cval = hn_pool_[nei_id].get_element().cval_;
+        if(nei_cval < cval || (nei_cval == cval && nei_id < node_id))
+        {
+            return false;
+        }
+    }
+    return true;
 }
 
 void
@@ -199,34 +506,53 @@ warthog::ch::lazy_graph_contraction::preliminaries()
     // create an initial ordering by performing on each node
     // a faux contraction operation
     std::cerr << "creating initial contraction order" << std::endl;
-    total_searches_ = 0;
-    total_expansions_ = 0;
     total_lazy_updates_ = 0;
-   
-    for(uint32_t i = 0;
-        i < g_->get_num_nodes(); i++)
+    total_shortcuts_ = 0;
+    for(uint32_t i = 0; i < contexts_.size(); i++)
     {
-        if((i % 1000) == 0)
-        {
-            std::cerr << i << " / " << g_->get_num_nodes() << "\r";
-        }
-        niv_metrics niv = contract_node(i, true);
-        int32_t priority = compute_contraction_priority(niv);
-        hn_pool_[i] = heap_node<ch_pair>(ch_pair(i, priority));
-        heap_->push(&hn_pool_[i]);
-        terms_[i] = niv;
+        contexts_.at(i)->total_searches_ = 0;
+        contexts_.at(i)->total_expansions_ = 0;
+        contexts_.at(i)->busy_secs_ = 0;
     }
+   
+    run_tasks(g_->get_num_nodes(), 
+        [this] (witness_context& ctx, uint32_t i) -> void
+        {
+            if(contexts_.size() == 1 && (i % 1000) == 0)
+            {
+                std::cerr << i << " / " << g_->get_num_nodes() << "\r";
+            }
+            niv_metrics niv = contract_node(ctx, i, 0);
+            int32_t priority = compute_contraction_priority(niv);
+            hn_pool_[i] = heap_node<ch_pair>(ch_pair(i, priority));
+            terms_[i] = niv;
+        });
     std::cerr << "all " << g_->get_num_nodes() 
         << " nodes contracted " << std::endl;
 }
 
 void
-warthog::ch::lazy_graph_contraction::postliminaries()
+warthog::ch::lazy_graph_contraction::postliminaries(double secs)
 {
+    uint64_t total_searches = 0;
+    uint64_t total_expansions = 0;
+    for(uint32_t i = 0; i < contexts_.size(); i++)
+    {
+        total_searches += contexts_.at(i)->total_searches_;
+        total_expansions += contexts_.at(i)->total_expansions_;
+    }
+
     std::cout << "lazy contraction summary:" << std::endl
-        << "\twitness searches: " << total_searches_ << std::endl 
+        << "\twitness searches: " << total_searches << std::endl 
+        << "\twitness search: " 
+        << (ws_type_ == warthog::ch::WS_ONE_TO_MANY ? 
+                "one-to-many" : "pairwise") 
+        << " (max settled " << ws_max_expansions_ 
+        << "; max hops " << ws_max_hops_ << ")" << std::endl
         << "\tlazy updates: "<< total_lazy_updates_ << std::endl
-        << "\tnode expansions " << total_expansions_ << std::endl;
+        << "\tnode expansions " << total_expansions << std::endl
+        << "\tshortcuts: " << total_shortcuts_ << std::endl
+        << "\ttime (s): " << secs << std::endl;
 }
 
 // identifies the node that should be contracted next NB: nodes are ranked in a
@@ -263,14 +589,14 @@ warthog::ch::lazy_graph_contraction::next(
 // NB: assumes the via-node is already marked as contracted
 // (and will thus not be expanded)
 double
-warthog::ch::lazy_graph_contraction::witness_search(
+warthog::ch::lazy_graph_contraction::witness_search(witness_context& ctx, 
         uint32_t from_id, uint32_t to_id, double via_len)
 {
     // only search for witness paths between uncontracted neighbours
     //if(c_filter_->get_flag(from_id) || c_filter_->get_flag(to_id)) { return 0; }
 
-    alg_->set_cost_cutoff(via_len);
-    alg_->set_max_expansions_cutoff(ws_max_expansions_);
+    ctx.alg_->set_cost_cutoff(via_len);
+    ctx.alg_->set_max_expansions_cutoff(ws_max_expansions_);
     warthog::graph::xy_graph* g = this->g_;
 
     // need to specify start + target ids using the identifier
@@ -278,78 +604,169 @@ warthog::ch::lazy_graph_contraction::witness_search(
     warthog::problem_instance pi(
             g->to_external_id(from_id), 
             g->to_external_id(to_id));
-    sol_.reset();
+    ctx.sol_.reset();
 
     // gogogo
-    alg_->get_distance(pi, sol_);
-    total_expansions_ += sol_.nodes_expanded_;
-    total_searches_++;
-    return sol_.sum_of_edge_costs_;
+    ctx.alg_->get_distance(pi, ctx.sol_);
+    ctx.total_expansions_ += ctx.sol_.nodes_expanded_;
+    ctx.total_searches_++;
+    return ctx.sol_.sum_of_edge_costs_;
+}
+
+// NB: contracted nodes, including the node being contracted, are never
+// settled.
+// targets that are not settled keep their tentative distance, which is
+// the length of a real path; stopping early can only add shortcuts
+void
+warthog::ch::lazy_graph_contraction::witness_search_one_to_many(
+        witness_context& ctx, uint32_t from_id, double max_len)
+{
+    std::vector<warthog::graph::edge>& uc_neis = ctx.uc_neis_;
+    uint32_t targets_left = 0;
+    for(uint32_t i = 0; i < ctx.uc_neis_incoming_begin_; i++)
+    {
+        uint32_t target_id = uc_neis.at(i).node_id_;
+        if(target_id == from_id || ctx.target_[target_id]) { continue; }
+        ctx.target_[target_id] = 1;
+        targets_left++;
+    }
+
+    // min-queue of (distance, node id) pairs. stale entries are skipped
+    std::greater<std::pair<double, uint32_t>> cmp;
+    ctx.open_.clear();
+    ctx.dist_[from_id] = 0;
+    ctx.hops_[from_id] = 0;
+    ctx.touched_.push_back(from_id);
+    ctx.open_.push_back(std::pair<double, uint32_t>(0, from_id));
+
+    uint32_t num_settled = 0;
+    while(ctx.open_.size() > 0 && targets_left > 0 && 
+          num_settled < ws_max_expansions_)
+    {
+        std::pop_heap(ctx.open_.begin(), ctx.open_.end(), cmp);
+        std::pair<double, uint32_t> top = ctx.open_.back();
+        ctx.open_.pop_back();
+
+        uint32_t cur_id = top.second;
+        if(top.first > ctx.dist_[cur_id]) { continue; } // stale
+        if(top.first > max_len) { break; }
+        num_settled++;
+
+        if(ctx.target_[cur_id])
+        {
+            ctx.target_[cur_id] = 0;
+            targets_left--;
+        }
+        if(ws_max_hops_ && ctx.hops_[cur_id] >= ws_max_hops_) { continue; }
+
+        warthog::graph::node* n = g_->get_node(cur_id);
+        for(uint32_t i = 0; i < n->out_degree(); i++)
+        {
+            warthog::graph::edge& e = *(n->outgoing_begin() + i);
+            if(ctx.c_filter_->get_flag(e.node_id_)) { continue; }
+
+            double len = top.first + e.wt_;
+            if(len > max_len || len >= ctx.dist_[e.node_id_]) { continue; }
+            if(ctx.dist_[e.node_id_] == DBL_MAX) 
+            { ctx.touched_.push_back(e.node_id_); }
+            ctx.dist_[e.node_id_] = len;
+            ctx.hops_[e.node_id_] = ctx.hops_[cur_id] + 1;
+            ctx.open_.push_back(std::pair<double, uint32_t>(len, e.node_id_));
+            std::push_heap(ctx.open_.begin(), ctx.open_.end(), cmp);
+        }
+    }
+
+    for(uint32_t i = 0; i < ctx.uc_neis_incoming_begin_; i++)
+    {
+        ctx.target_[uc_neis.at(i).node_id_] = 0;
+    }
+    ctx.total_expansions_ += num_settled;
+    ctx.total_searches_++;
+}
+
+void
+warthog::ch::lazy_graph_contraction::clear_witness_labels(
+        witness_context& ctx)
+{
+    for(uint32_t i = 0; i < ctx.touched_.size(); i++)
+    {
+        ctx.dist_[ctx.touched_[i]] = DBL_MAX;
+    }
+    ctx.touched_.clear();
 }
 
 // calculate the net number of edges that result from contracting
 // a given node 
 //
 // @param n: the id of the node to contract
-// @param estimate: when true, witness searches are truncated after
-// a fixed number of node expansions. when false, witness searches
-// are run in full. 
+// @param shorts: when null, only the importance metrics of the node 
+// are computed. otherwise, the node remains marked as contracted and 
+// the shortcuts that are needed to bypass it are appended to the list
+// (see ::add_shortcuts)
 warthog::ch::lazy_graph_contraction::niv_metrics
 warthog::ch::lazy_graph_contraction::contract_node( 
-        uint32_t node_id, bool metrics_only)
+        witness_context& ctx, uint32_t node_id, shortcut_list* shorts)
 {
     niv_metrics niv;
     warthog::graph::node* n = g_->get_node(node_id);
+    warthog::apriori_filter* c_filter = ctx.c_filter_;
+    std::vector<warthog::graph::edge>& uc_neis = ctx.uc_neis_;
 
     // make a list of all uncontracted neighbours whose priorities 
     // will need to be updated due to contracting @param node_id.
     // here we also track some importance metrics related to "deleted" edges
-    uc_neis_.clear();
+    uc_neis.clear();
     niv.hops_removed_ = 1; // i.e. the current node
     niv.edel_ = 1; // as per routingkit
     for(uint32_t i = 0; i < n->out_degree(); i++)
     {
         warthog::graph::edge& e_out = *(n->outgoing_begin() + i);
-        if(c_filter_->get_flag(e_out.node_id_)) { niv.nc_++; continue; }
+        if(c_filter->get_flag(e_out.node_id_)) { niv.nc_++; continue; }
         niv.edel_++;
         niv.hops_removed_ += e_out.label_;
-        uc_neis_.push_back(e_out);
+        uc_neis.push_back(e_out);
     }
-    uc_neis_incoming_begin_ = uc_neis_.size();
+    ctx.uc_neis_incoming_begin_ = uc_neis.size();
     for(uint32_t i = 0; i < n->in_degree(); i++)
     {
         warthog::graph::edge& e_in = *(n->incoming_begin() + i);
-        if(c_filter_->get_flag(e_in.node_id_)) { niv.nc_++; continue; }
+        if(c_filter->get_flag(e_in.node_id_)) { niv.nc_++; continue; }
         niv.edel_++;
         niv.hops_removed_ += e_in.label_;
-        uc_neis_.push_back(e_in);
-    }
-
-    // temporary storage for shortcuts that will be added
-    if(!metrics_only)
-    {
-        in_shorts.clear();
-        out_shorts.clear();
+        uc_neis.push_back(e_in);
     }
 
     // witness searches (i.e. between every pair of (in, out) neighbours)
     // NB: during each witness search, we never expand the current node
-    c_filter_->set_flag_true(node_id);
-    //ws_max_expansions_ = (metrics_only ? 1000 : warthog::INF); // ddh
-    ws_max_expansions_ = 500; // as recommended by RoutingKit's implementation
-
-    for(uint32_t i = uc_neis_incoming_begin_; i < uc_neis_.size(); i++)
+    c_filter->set_flag_true(node_id);
+    for(uint32_t i = ctx.uc_neis_incoming_begin_; i < uc_neis.size(); i++)
     {
-        warthog::graph::edge& e_in = uc_neis_.at(i);
+        warthog::graph::edge& e_in = uc_neis.at(i);
 
-        for(uint32_t j = 0; j < uc_neis_incoming_begin_; j++)
+        // one search settles the distances to all outgoing neighbours
+        if(ws_type_ == warthog::ch::WS_ONE_TO_MANY)
         {
-            warthog::graph::edge& e_out = uc_neis_.at(j);
+            double max_len = 0;
+            for(uint32_t j = 0; j < ctx.uc_neis_incoming_begin_; j++)
+            {
+                warthog::graph::edge& e_out = uc_neis.at(j);
+                if(e_in.node_id_ == e_out.node_id_) { continue; }
+                max_len = std::max<double>(max_len, e_in.wt_ + e_out.wt_);
+            }
+            witness_search_one_to_many(ctx, e_in.node_id_, max_len);
+        }
+
+        for(uint32_t j = 0; j < ctx.uc_neis_incoming_begin_; j++)
+        {
+            warthog::graph::edge& e_out = uc_neis.at(j);
             if(e_in.node_id_ == e_out.node_id_) { continue; }
 
-           double cost_cutoff = e_in.wt_ + e_out.wt_;
+            double cost_cutoff = e_in.wt_ + e_out.wt_;
             double witness_len = 
-                witness_search(e_in.node_id_, e_out.node_id_, cost_cutoff);
+                ws_type_ == warthog::ch::WS_ONE_TO_MANY ?
+                ctx.dist_[e_out.node_id_] :
+                witness_search(
+                    ctx, e_in.node_id_, e_out.node_id_, cost_cutoff);
 
             // contraction will introduce a shortcut edge only if
             // the path <in, n, out> is the only shortest path
@@ -359,15 +776,15 @@ warthog::ch::lazy_graph_contraction::contract_node(
                 // importance metrics related to the newly added edge
                 niv.eadd_++;
                 niv.hops_added_ += e_in.label_ + e_out.label_;
-                if(!metrics_only)
+                if(shorts)
                 {
-                    out_shorts.push_back(
+                    shorts->out_.push_back(
                         std::pair<warthog::graph::node*, 
                             warthog::graph::edge>(
                                 g_->get_node(e_in.node_id_),
                                 warthog::graph::edge(e_out.node_id_, 
                                           via_len, niv.hops_added_)));
-                    in_shorts.push_back(
+                    shorts->in_.push_back(
                         std::pair<warthog::graph::node*, 
                             warthog::graph::edge>(
                                 g_->get_node(e_out.node_id_),
@@ -376,18 +793,13 @@ warthog::ch::lazy_graph_contraction::contract_node(
                 }
             }
         }
-    }
-    if(metrics_only) { c_filter_->set_flag_false(node_id); }
-    else 
-    { 
-        for(auto& pair : out_shorts) 
-        { (pair.first)->add_outgoing(pair.second); }
-        for(auto& pair : in_shorts) 
-        { (pair.first)->add_incoming(pair.second); }
 
-        order_.push_back(node_id); 
+        if(ws_type_ == warthog::ch::WS_ONE_TO_MANY)
+        {
+            clear_witness_labels(ctx);
+        }
     }
-
+    if(!shorts) { c_filter->set_flag_false(node_id); }
 
     // another metric is the level estimate for the current node 
     // (at least equal to [#contractions], assuming first level is zero)
@@ -398,6 +810,22 @@ warthog::ch::lazy_graph_contraction::contract_node(
     return niv;
 }
 
+// add the shortcuts needed to bypass the node @param node_id and 
+// append it to the contraction order
+void
+warthog::ch::lazy_graph_contraction::add_shortcuts(
+        shortcut_list& shorts, uint32_t node_id)
+{
+    for(auto& pair : shorts.out_) 
+    { (pair.first)->add_outgoing(pair.second); }
+    for(auto& pair : shorts.in_) 
+    { (pair.first)->add_incoming(pair.second); }
+    total_shortcuts_ += shorts.out_.size();
+
+    set_contracted(node_id);
+    order_.push_back(node_id); 
+}
+
 void
 warthog::ch::lazy_graph_contraction::get_order(std::vector<uint32_t>& order)
 {
@@ -408,11 +836,21 @@ warthog::ch::lazy_graph_contraction::get_order(std::vector<uint32_t>& order)
 size_t
 warthog::ch::lazy_graph_contraction::mem()
 {
-    return 
+    size_t bytes = 
         heap_->mem() +
-        alg_->mem() + 
         sizeof(*hn_pool_)*g_->get_num_nodes() +
         sizeof(this);
+    for(uint32_t i = 0; i < contexts_.size(); i++)
+    {
+        witness_context& ctx = *contexts_.at(i);
+        bytes += ctx.alg_->mem() + 
+            sizeof(double) * ctx.dist_.capacity() +
+            sizeof(uint32_t) * 
+                (ctx.hops_.capacity() + ctx.touched_.capacity()) +
+            sizeof(uint8_t) * ctx.target_.capacity() + 
+            sizeof(std::pair<double, uint32_t>) * ctx.open_.capacity();
+    }
+    return bytes;
 }
 
 // compute the contraction value of node @param nid
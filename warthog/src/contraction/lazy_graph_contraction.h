@@ -36,9 +36,12 @@
 #include "heap.h"
 #include "solution.h"
 #include "bidirectional_search.h"
+#include "graph_expansion_policy.h"
 
 #include <cstdint>
+#include <functional>
 #include <unordered_map>
+#include <vector>
 
 //using namespace warthog::ch;
 
@@ -69,6 +72,17 @@ class ch_pair
 bool
 operator<(const ch_pair& first, const ch_pair& second);
 
+// witness searches decide whether the path <u, v, w> through a node v
+// that is being contracted needs a shortcut. WS_PAIRWISE runs one 
+// bidirectional search per (u, w) pair; WS_ONE_TO_MANY runs one bounded 
+// Dijkstra search per incoming neighbour u and checks every outgoing 
+// neighbour w against its distance labels.
+typedef enum
+{
+    WS_PAIRWISE = 0,
+    WS_ONE_TO_MANY = 1
+} witness_search_type;
+
 class lazy_graph_contraction 
 {
     public:
@@ -88,6 +102,24 @@ class lazy_graph_contraction
         void
         contract(bool verify_priorities=false, uint32_t c_pct=100);
 
+        // contract the graph in rounds, using @param num_threads threads
+        // (zero means one per hardware thread). each round selects an
+        // independent set of nodes whose priority is smaller than that 
+        // of every uncontracted neighbour. these nodes are contracted 
+        // concurrently; every thread runs its witness searches with 
+        // state of its own. the priorities of their neighbours are then
+        // recomputed, again concurrently.
+        //
+        // witness searches in a round treat every node of the set as
+        // contracted already. a shortcut may thus be added where the
+        // sequential algorithm finds a witness, but no shortcut that is
+        // needed is ever skipped.
+        //
+        // @param c_pct: limit contraction to k% of nodes with 
+        // highest priority
+        void
+        contract_parallel(uint32_t num_threads, uint32_t c_pct=100);
+
         // @return the order in which nodes were contracted
         void  
         get_order(std::vector<uint32_t>& order);
@@ -98,6 +130,29 @@ class lazy_graph_contraction
         bool 
         get_verbose() { return verbose_; } 
 
+        void
+        set_witness_search(warthog::ch::witness_search_type ws_type)
+        { ws_type_ = ws_type; }
+
+        warthog::ch::witness_search_type
+        get_witness_search() { return ws_type_; }
+
+        // each witness search stops after settling (or, when pairwise,
+        // expanding) @param max_settled nodes. one-to-many searches also 
+        // ignore paths with more than @param max_hops edges (0 = no limit).
+        // stopping early never makes the hierarchy incorrect; it can 
+        // only add shortcuts that are not needed.
+        void
+        set_witness_limits(uint32_t max_settled, uint32_t max_hops)
+        { 
+            ws_max_expansions_ = max_settled; 
+            ws_max_hops_ = max_hops;
+        }
+
+        // @return the number of shortcut edges added by the last contraction
+        uint64_t
+        get_num_shortcuts() { return total_shortcuts_; }
+
         size_t
         mem();
 
@@ -110,15 +165,52 @@ class lazy_graph_contraction
         warthog::heap_node<ch_pair>* hn_pool_;
         std::vector<uint32_t> order_; // node ids, as retured by ::next
 
-        std::vector<std::pair<warthog::graph::node*, warthog::graph::edge>>
-            in_shorts;
-        std::vector<std::pair<warthog::graph::node*, warthog::graph::edge>>
-            out_shorts;
+        // the shortcuts that result from contracting a node
+        struct shortcut_list
+        {
+            std::vector<std::pair<warthog::graph::node*, warthog::graph::edge>>
+                in_;
+            std::vector<std::pair<warthog::graph::node*, warthog::graph::edge>>
+                out_;
+        };
+        shortcut_list shorts_;
 
-        // these objects get recycled across all witness searches
-        warthog::solution sol_;
-        std::vector<warthog::graph::edge> uc_neis_;
-        uint32_t uc_neis_incoming_begin_;
+        // witness search state. there is one context per thread and
+        // each context has its own copy of the contraction flags.
+        // these objects get recycled across all witness searches.
+        struct witness_context
+        {
+            witness_context(lazy_graph_contraction* parent);
+            ~witness_context();
+
+            warthog::apriori_filter* c_filter_; // track contractions 
+            warthog::graph_expansion_policy<warthog::apriori_filter>* 
+                fexpander_;
+            warthog::graph_expansion_policy<warthog::apriori_filter>* 
+                bexpander_;
+            warthog::bidirectional_search<
+                warthog::euclidean_heuristic,
+                warthog::graph_expansion_policy<warthog::apriori_filter>>* 
+                    alg_;
+            warthog::solution sol_;
+            std::vector<warthog::graph::edge> uc_neis_;
+            uint32_t uc_neis_incoming_begin_;
+
+            // one-to-many search state. labels are indexed by node id 
+            // and reset after every search using the list of touched nodes
+            std::vector<double> dist_;
+            std::vector<uint32_t> hops_;
+            std::vector<uint32_t> touched_;
+            std::vector<uint8_t> target_;
+            std::vector<std::pair<double, uint32_t>> open_;
+
+            // metrics
+            uint64_t total_expansions_;
+            uint64_t total_searches_;
+
+            double busy_secs_; // cpu time spent on parallel tasks
+        };
+        std::vector<witness_context*> contexts_;
 
         // a variety of "node importance values" are computed for each node
         // in order to determine the order of contraction
@@ -171,38 +263,68 @@ class lazy_graph_contraction
         niv_metrics* terms_;
 
         // witness search stuff
+        warthog::ch::witness_search_type ws_type_;
         uint32_t ws_max_expansions_; 
+        uint32_t ws_max_hops_;
         warthog::euclidean_heuristic* heuristic_;
-        warthog::graph_expansion_policy<warthog::apriori_filter>* fexpander_;
-        warthog::graph_expansion_policy<warthog::apriori_filter>* bexpander_;
-        warthog::apriori_filter* c_filter_; // track contractions 
         warthog::apriori_filter* u_filter_; // track updates
-        warthog::bidirectional_search<
-            warthog::euclidean_heuristic,
-            warthog::graph_expansion_policy<warthog::apriori_filter>>* alg_;
 
         // metrics
-        uint64_t total_expansions_;
-        uint64_t total_searches_;
         uint64_t total_lazy_updates_;
+        uint64_t total_shortcuts_;
+        double serial_secs_; // time spent outside of parallel tasks
 
         void
         preliminaries();
 
+        // print a summary; @param secs is the total contraction time
         void
-        postliminaries();
+        postliminaries(double secs);
 
         uint32_t
         next(bool verify_priorities, uint32_t c_pct);
 
         double
-        witness_search(uint32_t from_id, uint32_t to_id, double via_len);
+        witness_search(witness_context& ctx, 
+                uint32_t from_id, uint32_t to_id, double via_len);
+
+        // bounded Dijkstra search from @param from_id to the outgoing 
+        // neighbours in ctx.uc_neis_. the distance labels remain in 
+        // @param ctx until ::clear_witness_labels
+        void
+        witness_search_one_to_many(witness_context& ctx, 
+                uint32_t from_id, double max_len);
+
+        void
+        clear_witness_labels(witness_context& ctx);
 
         int32_t
         compute_contraction_priority(niv_metrics& niv);
 
         niv_metrics
-        contract_node(uint32_t node_id, bool metrics_only);
+        contract_node(witness_context& ctx, uint32_t node_id, 
+                shortcut_list* shorts);
+
+        void
+        add_shortcuts(shortcut_list& shorts, uint32_t node_id);
+
+        // create @param num_threads witness search contexts
+        void
+        set_num_contexts(uint32_t num_threads);
+
+        // mark @param node_id as contracted in every context
+        void
+        set_contracted(uint32_t node_id);
+
+        // run tasks [0, @param num_tasks) on one thread per context
+        void
+        run_tasks(uint32_t num_tasks, 
+            const std::function<void(witness_context&, uint32_t)>& fn_task);
+
+        // true if the priority of @param node_id is smaller than that 
+        // of every uncontracted neighbour (ties are broken by id)
+        bool
+        is_local_minimum(uint32_t node_id);
 };
 
 }
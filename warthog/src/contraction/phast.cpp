@@ -0,0 +1,241 @@
+#include "constants.h"
+#include "phast.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define WARTHOG_PHAST_AVX2
+#include <immintrin.h>
+#endif
+
+namespace
+{
+
+// relax the incoming downward arcs of every rank, from the highest,
+// for LANES sources at once. the lanes of a node are copied to a local
+// array so the compiler can see they don't alias those of the tail
+template<uint32_t LANES>
+void
+sweep_lanes(uint32_t* dist, uint32_t num_ranks, const uint32_t* index,
+        const uint32_t* tail, const uint32_t* wt)
+{
+    for(uint32_t r = num_ranks; r-- > 0; )
+    {
+        uint32_t* d = dist + (size_t)r * LANES;
+        uint32_t acc[LANES];
+        for(uint32_t i = 0; i < LANES; i++) { acc[i] = d[i]; }
+
+        for(uint32_t a = index[r]; a < index[r+1]; a++)
+        {
+            const uint32_t* t = dist + (size_t)tail[a] * LANES;
+            for(uint32_t i = 0; i < LANES; i++)
+            {
+                uint32_t len = t[i] + wt[a];
+                acc[i] = len < acc[i] ? len : acc[i];
+            }
+        }
+        for(uint32_t i = 0; i < LANES; i++) { d[i] = acc[i]; }
+    }
+}
+
+#ifdef WARTHOG_PHAST_AVX2
+// as above, with the lanes of a node held in vector registers:
+// one 128bit register for 4 lanes or one 256bit register per 8 lanes.
+// NB: no lane overflows; distances are at most warthog::INF (2^31-1)
+// and so are arc weights
+template<uint32_t LANES>
+__attribute__((target("avx2"))) void
+sweep_lanes_avx2(uint32_t* dist, uint32_t num_ranks, const uint32_t* index,
+        const uint32_t* tail, const uint32_t* wt)
+{
+    const uint32_t VECS = LANES >= 8 ? LANES / 8 : 1;
+    for(uint32_t r = num_ranks; r-- > 0; )
+    {
+        uint32_t* d = dist + (size_t)r * LANES;
+        if(LANES == 4)
+        {
+            __m128i acc = _mm_loadu_si128((__m128i*)d);
+            for(uint32_t a = index[r]; a < index[r+1]; a++)
+            {
+                __m128i t = _mm_loadu_si128(
+                        (__m128i*)(dist + (size_t)tail[a] * LANES));
+                acc = _mm_min_epu32(acc,
+                        _mm_add_epi32(t, _mm_set1_epi32(wt[a])));
+            }
+            _mm_storeu_si128((__m128i*)d, acc);
+            continue;
+        }
+
+        __m256i acc[VECS];
+        for(uint32_t v = 0; v < VECS; v++)
+        {
+            acc[v] = _mm256_loadu_si256((__m256i*)d + v);
+        }
+        for(uint32_t a = index[r]; a < index[r+1]; a++)
+        {
+            const __m256i* t =
+                (const __m256i*)(dist + (size_t)tail[a] * LANES);
+            __m256i w = _mm256_set1_epi32(wt[a]);
+            for(uint32_t v = 0; v < VECS; v++)
+            {
+                acc[v] = _mm256_min_epu32(acc[v],
+                        _mm256_add_epi32(_mm256_loadu_si256(t + v), w));
+            }
+        }
+        for(uint32_t v = 0; v < VECS; v++)
+        {
+            _mm256_storeu_si256((__m256i*)d + v, acc[v]);
+        }
+    }
+}
+#endif
+
+}
+
+warthog::ch::phast::phast(warthog::graph::xy_graph* g,
+        std::vector<uint32_t>* rank)
+{
+    uint32_t num_nodes = g->get_num_nodes();
+    assert(rank->size() == num_nodes);
+    rank_ = *rank;
+
+    std::vector<uint32_t> order(num_nodes);
+    for(uint32_t i = 0; i < num_nodes; i++) { order[rank_[i]] = i; }
+
+    up_index_.push_back(0);
+    down_index_.push_back(0);
+    for(uint32_t r = 0; r < num_nodes; r++)
+    {
+        warthog::graph::node* n = g->get_node(order[r]);
+        for(warthog::graph::edge_iter it = n->outgoing_begin();
+                it != n->outgoing_end(); it++)
+        {
+            up_head_.push_back(rank_[it->node_id_]);
+            up_wt_.push_back(it->wt_);
+        }
+        for(warthog::graph::edge_iter it = n->incoming_begin();
+                it != n->incoming_end(); it++)
+        {
+            assert(rank_[it->node_id_] > r);
+            down_tail_.push_back(rank_[it->node_id_]);
+            down_wt_.push_back(it->wt_);
+        }
+        up_index_.push_back(up_head_.size());
+        down_index_.push_back(down_tail_.size());
+    }
+
+    dist_ = new uint32_t[(size_t)num_nodes * MAX_SOURCES];
+    lanes_ = 1;
+    nodes_settled_ = 0;
+    simd_ = cpu_has_avx2();
+}
+
+warthog::ch::phast::~phast()
+{
+    delete [] dist_;
+}
+
+bool
+warthog::ch::phast::cpu_has_avx2()
+{
+#ifdef WARTHOG_PHAST_AVX2
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+void
+warthog::ch::phast::many_to_all(const uint32_t* sources,
+        uint32_t num_sources)
+{
+    assert(num_sources > 0 && num_sources <= MAX_SOURCES);
+    lanes_ = num_sources == 1 ? 1 : num_sources <= 4 ? 4 :
+             num_sources <= 8 ? 8 : 16;
+
+    // lanes beyond num_sources stay unreachable
+    std::fill(dist_, dist_ + (size_t)rank_.size() * lanes_, warthog::INF);
+    nodes_settled_ = 0;
+    for(uint32_t i = 0; i < num_sources; i++)
+    {
+        upward_search(rank_.at(sources[i]), i);
+    }
+    sweep();
+}
+
+void
+warthog::ch::phast::upward_search(uint32_t source_rank, uint32_t lane)
+{
+    // min-queue of (distance, rank) pairs. stale entries are skipped
+    std::greater<std::pair<uint32_t, uint32_t>> cmp;
+    open_.clear();
+    dist_[(size_t)source_rank * lanes_ + lane] = 0;
+    open_.push_back(std::pair<uint32_t, uint32_t>(0, source_rank));
+
+    while(open_.size() > 0)
+    {
+        std::pop_heap(open_.begin(), open_.end(), cmp);
+        std::pair<uint32_t, uint32_t> top = open_.back();
+        open_.pop_back();
+
+        uint32_t r = top.second;
+        if(top.first > dist_[(size_t)r * lanes_ + lane]) { continue; }
+        nodes_settled_++;
+
+        for(uint32_t a = up_index_[r]; a < up_index_[r+1]; a++)
+        {
+            uint32_t& head_dist = dist_[(size_t)up_head_[a] * lanes_ + lane];
+            uint32_t len = top.first + up_wt_[a];
+            if(len >= head_dist) { continue; }
+            head_dist = len;
+            open_.push_back(std::pair<uint32_t, uint32_t>(len, up_head_[a]));
+            std::push_heap(open_.begin(), open_.end(), cmp);
+        }
+    }
+}
+
+void
+warthog::ch::phast::sweep()
+{
+    uint32_t num_ranks = rank_.size();
+    const uint32_t* index = &down_index_[0];
+    const uint32_t* tail = down_tail_.size() ? &down_tail_[0] : 0;
+    const uint32_t* wt = down_wt_.size() ? &down_wt_[0] : 0;
+
+#ifdef WARTHOG_PHAST_AVX2
+    if(simd_ && lanes_ > 1)
+    {
+        switch(lanes_)
+        {
+            case 4: sweep_lanes_avx2<4>(dist_, num_ranks, index, tail, wt);
+                    return;
+            case 8: sweep_lanes_avx2<8>(dist_, num_ranks, index, tail, wt);
+                    return;
+            default: sweep_lanes_avx2<16>(dist_, num_ranks, index, tail, wt);
+                    return;
+        }
+    }
+#endif
+
+    switch(lanes_)
+    {
+        case 1: sweep_lanes<1>(dist_, num_ranks, index, tail, wt); break;
+        case 4: sweep_lanes<4>(dist_, num_ranks, index, tail, wt); break;
+        case 8: sweep_lanes<8>(dist_, num_ranks, index, tail, wt); break;
+        default: sweep_lanes<16>(dist_, num_ranks, index, tail, wt); break;
+    }
+}
+
+size_t
+warthog::ch::phast::mem()
+{
+    return sizeof(*this) +
+        sizeof(uint32_t) * (rank_.capacity() +
+            up_index_.capacity() + up_head_.capacity() + up_wt_.capacity() +
+            down_index_.capacity() + down_tail_.capacity() +
+            down_wt_.capacity() + rank_.size() * MAX_SOURCES) +
+        sizeof(std::pair<uint32_t, uint32_t>) * open_.capacity();
+}
@@ -0,0 +1,139 @@
+#ifndef WARTHOG_PHAST_H
+#define WARTHOG_PHAST_H
+
+// contraction/phast.h
+//
+// PHAST computes the distance from a source node to every other node
+// of a graph using its contraction hierarchy. An upward search from
+// the source, which settles only a few hundred nodes, is followed by a
+// sweep over all nodes in decreasing order of rank. The sweep relaxes
+// the incoming downward arcs of each node, whose tails have higher
+// rank and thus have final distances already.
+//
+// The sweep reads every node and arc exactly once, in order. To make
+// this cache friendly, nodes are renumbered by rank: distances and arcs
+// are stored in rank order and the tail of every downward arc is given
+// as a rank.
+//
+// Up to MAX_SOURCES sources can share a single sweep. Their distances
+// are interleaved, one lane per source, so that every arc is relaxed
+// for all sources at once; with AVX2 8 lanes are relaxed per instruction.
+//
+// Distances are 32bit: warthog::INF means not reachable and all
+// shortest distances must be smaller.
+//
+// For more details see:
+// [Delling, Goldberg, Nowatzyk and Werneck. PHAST: Hardware-Accelerated
+// Shortest Path Trees. Journal of Parallel and Distributed Computing,
+// 73(7), 2013]
+//
+
+#include "xy_graph.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace warthog
+{
+
+namespace ch
+{
+
+class phast
+{
+    public:
+        static const uint32_t MAX_SOURCES = 16;
+
+        // @param g: a contraction hierarchy whose outgoing edges go up
+        // and whose incoming edges are the reversed down edges
+        // (see ch::optimise_graph_for_bch_v2). @param g is only read by
+        // the constructor.
+        //
+        // @param rank: the contraction rank of each node in @param g,
+        // as read by ch::load_node_order
+        phast(warthog::graph::xy_graph* g, std::vector<uint32_t>* rank);
+
+        ~phast();
+
+        // compute distances from the nodes [@param sources,
+        // @param sources + @param num_sources), given by graph id, to
+        // every node. 1 <= @param num_sources <= MAX_SOURCES.
+        void
+        many_to_all(const uint32_t* sources, uint32_t num_sources);
+
+        inline void
+        one_to_all(uint32_t source_id) { many_to_all(&source_id, 1); }
+
+        // the distance from source number @param source_index of the last
+        // call to ::many_to_all to the node with graph id @param node_id
+        inline uint32_t
+        get_distance(uint32_t source_index, uint32_t node_id)
+        {
+            return dist_[(size_t)rank_[node_id] * lanes_ + source_index];
+        }
+
+        // the number of distance lanes per node in the last sweep;
+        // ::many_to_all rounds the number of sources up to 1, 4, 8 or 16
+        inline uint32_t
+        get_num_lanes() { return lanes_; }
+
+        // nodes settled by the upward searches of the last call
+        inline uint32_t
+        get_nodes_settled() { return nodes_settled_; }
+
+        inline uint32_t
+        get_num_nodes() { return rank_.size(); }
+
+        inline uint32_t
+        get_num_down_arcs() { return down_tail_.size(); }
+
+        // use AVX2 for the sweep if the cpu supports it (default: yes)
+        inline void
+        set_simd(bool simd) { simd_ = simd && cpu_has_avx2(); }
+
+        static bool
+        cpu_has_avx2();
+
+        size_t
+        mem();
+
+    private:
+        std::vector<uint32_t> rank_;        // rank of each node id
+
+        // upward arcs of each rank: [up_index_[r], up_index_[r+1])
+        std::vector<uint32_t> up_index_;
+        std::vector<uint32_t> up_head_;     // head rank
+        std::vector<uint32_t> up_wt_;
+
+        // incoming downward arcs of each rank
+        std::vector<uint32_t> down_index_;
+        std::vector<uint32_t> down_tail_;   // tail rank (> head rank)
+        std::vector<uint32_t> down_wt_;
+
+        // distances by rank; lanes_ per rank
+        uint32_t* dist_;
+        uint32_t lanes_;
+        uint32_t nodes_settled_;
+        bool simd_;
+
+        std::vector<std::pair<uint32_t, uint32_t>> open_;
+
+        // upward search from rank @param source_rank, writing to
+        // lane @param lane
+        void
+        upward_search(uint32_t source_rank, uint32_t lane);
+
+        // the downward sweep over all ranks, from the highest
+        void
+        sweep();
+
+        // no copy
+        phast(const phast& other) { }
+        phast& operator=(const phast& other) { return *this; }
+};
+
+}
+
+}
+
+#endif
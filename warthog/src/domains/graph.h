@@ -99,6 +99,7 @@ class node
 
         node(const node& other)
         {
+            init(0, 0);
             *this = other;
         }
 
@@ -123,11 +124,12 @@ class node
 
         ~node()
         {
-            delete [] incoming_;
+            // edges held in borrowed memory are not ours to free
+            if(in_cap_) { delete [] incoming_; }
             incoming_ = 0;
             in_cap_ = in_deg_ = 0;
 
-            delete [] outgoing_;
+            if(out_cap_) { delete [] outgoing_; }
             outgoing_ = 0;
             out_cap_ = out_deg_ = 0;
         }
@@ -155,15 +157,16 @@ class node
         warthog::graph::node&
         operator=(const warthog::graph::node& other)
         {
+            if(in_cap_) { delete [] incoming_; }
+            if(out_cap_) { delete [] outgoing_; }
+
             in_deg_ = other.in_deg_;
             in_cap_ = other.in_deg_;
             out_deg_ = other.out_deg_;
             out_cap_ = other.out_deg_;
 
-            delete [] incoming_;
-            delete [] outgoing_;
-            incoming_ = new edge[other.in_cap_];
-            outgoing_ = new edge[other.out_cap_];
+            incoming_ = in_cap_ ? new edge[in_cap_] : 0;
+            outgoing_ = out_cap_ ? new edge[out_cap_] : 0;
 
             for(ECAP_T i = 0; i < other.in_deg_; i++)
             { incoming_[i] = other.incoming_[i]; }
@@ -194,6 +197,7 @@ class node
         inline warthog::graph::edge_iter
         insert_outgoing(warthog::graph::edge e, uint32_t index)
         {
+            own(out_deg_, out_cap_, outgoing_);
             if(out_deg_ == out_cap_)
             {
                 out_cap_ = increase_capacity(2*out_cap_, out_cap_, outgoing_);
@@ -213,13 +217,43 @@ class node
         inline void
         del_incoming(warthog::graph::edge_iter iter)
         {
-            del_edge(iter, in_deg_, incoming_);
+            uint32_t index = iter - incoming_;
+            own(in_deg_, in_cap_, incoming_);
+            del_edge(incoming_ + index, in_deg_, incoming_);
         }
 
         inline void
         del_outgoing(warthog::graph::edge_iter iter)
         {
-            del_edge(iter, out_deg_, outgoing_);
+            uint32_t index = iter - outgoing_;
+            own(out_deg_, out_cap_, outgoing_);
+            del_edge(outgoing_ + index, out_deg_, outgoing_);
+        }
+
+        // use edges stored in memory that the node does not own, such
+        // as a memory-mapped graph file. the edges are not copied, and
+        // the memory must outlive the node. edges can be modified in
+        // place; any change to the number of edges first moves them
+        // into memory owned by the node.
+        inline void
+        attach(edge* incoming, ECAP_T in_deg, edge* outgoing, ECAP_T out_deg)
+        {
+            if(in_cap_) { delete [] incoming_; }
+            if(out_cap_) { delete [] outgoing_; }
+            incoming_ = in_deg ? incoming : 0;
+            in_deg_ = in_deg;
+            in_cap_ = 0;
+            outgoing_ = out_deg ? outgoing : 0;
+            out_deg_ = out_deg;
+            out_cap_ = 0;
+        }
+
+        // @return false if all edges of this node are held in borrowed
+        // memory (see ::attach)
+        inline bool
+        owns_edges() const
+        {
+            return in_cap_ > 0 || out_cap_ > 0;
         }
 
         inline edge_iter
@@ -313,8 +347,8 @@ class node
             for(uint32_t i = 0; i < out_deg_; i++)
             { tmp_out[i] = outgoing_[i]; }
 
-            delete [] incoming_;
-            delete [] outgoing_; 
+            if(in_cap_) { delete [] incoming_; }
+            if(out_cap_) { delete [] outgoing_; }
             incoming_ = tmp_in;
             outgoing_ = tmp_out;
             out_cap_ = out_deg_;
@@ -333,6 +367,8 @@ class node
         inline void
         capacity(uint32_t new_in_cap, uint32_t new_out_cap)
         {
+            own(in_deg_, in_cap_, incoming_);
+            own(out_deg_, out_cap_, outgoing_);
             if(new_in_cap > in_cap_)
             {
                 in_cap_ = increase_capacity(new_in_cap, in_cap_, incoming_);
@@ -420,6 +456,22 @@ class node
             return newcap;
         }
 
+        // edges held in borrowed memory (see ::attach) have a capacity
+        // of zero. this function copies them into memory owned by the
+        // node, so that edges can be added or removed.
+        inline void
+        own(ECAP_T deg, ECAP_T& cap, edge*& elts)
+        {
+            if(cap || !elts) { return; }
+            edge* borrowed = elts;
+            elts = 0;
+            cap = increase_capacity(deg, 0, elts);
+            for(uint32_t i = 0; i < deg; i++)
+            {
+                elts[i] = borrowed[i];
+            }
+        }
+
         // remove an edge and shift the remaining edges
         // to plug the hole 
         // NB: doesn't free any memory!!
@@ -448,6 +500,7 @@ class node
                 std::cerr << "warthog::graph::node edge-capacity reached!\n";
                 return &elts[deg];
             }
+            own(deg, max_elts, elts);
          
             // don't add redundant edges; we only want one:
             // the one with lowest cost
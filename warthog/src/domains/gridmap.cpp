@@ -59,18 +59,19 @@ warthog::gridmap::init_db()
 	this->db_size_ = this->dbwidth_ * this->dbheight_;
 
 	// create a one dimensional dbword array to store the grid
-	this->db_ = new warthog::dbword[db_size_];
-	for(unsigned int i=0; i < db_size_; i++)
+	this->raw_db_ = new warthog::dbword[db_size_ + 2*DB_GUARD_WORDS];
+	for(unsigned int i=0; i < db_size_ + 2*DB_GUARD_WORDS; i++)
 	{
-		db_[i] = 0;
+		raw_db_[i] = 0;
 	}
+	this->db_ = raw_db_ + DB_GUARD_WORDS;
 
 	max_id_ = db_size_-1;
 }
 
 warthog::gridmap::~gridmap()
 {
-	delete [] db_;
+	delete [] raw_db_;
 }
 
 void 
@@ -132,17 +132,18 @@ class gridmap
 			// 1. calculate the dbword offset for the node at index padded_id
 			// 2. convert padded_id into a dbword index.
 			uint32_t bit_offset = (padded_id & warthog::DBWORD_BITS_MASK);
-			uint32_t dbindex = padded_id >> warthog::LOG2_DBWORD_BITS;
+			int32_t dbindex = padded_id >> warthog::LOG2_DBWORD_BITS;
 			
 			// start reading from a prior index. this way everything
-			// up to padded_id is cached.
+			// up to padded_id is cached. on narrow maps the index can
+			// fall before the first padded row, into the guard words.
 			dbindex -= 4;
 
 			// compute dbword indexes for tiles immediately above 
 			// and immediately below node_id
-			uint32_t pos1 = dbindex - dbwidth_;
-			uint32_t pos2 = dbindex;
-			uint32_t pos3 = dbindex + dbwidth_;
+			int32_t pos1 = dbindex - (int32_t)dbwidth_;
+			int32_t pos2 = dbindex;
+			int32_t pos3 = dbindex + (int32_t)dbwidth_;
 
 			// read 32bits of memory; padded_id is in the 
 			// highest bit position of tiles[1]
@@ -151,6 +152,46 @@ class gridmap
 			tiles[2] = (uint32_t)(*((uint64_t*)(db_+pos3)) >> (bit_offset+1));
 		}
 
+		// fetches 64 contiguous tiles from each of three adjacent rows.
+		// reading starts at the dbword that contains padded_id, so
+		// padded_id is at bit position (padded_id & DBWORD_BITS_MASK)
+		// of tiles[1]. tiles[0] and tiles[2] hold the tiles directly
+		// above and below.
+		inline void
+		get_neighbours_64bit(uint32_t padded_id, uint64_t tiles[3])
+		{
+			uint32_t dbindex = padded_id >> warthog::LOG2_DBWORD_BITS;
+			tiles[0] = *((uint64_t*)(db_+(dbindex-dbwidth_)));
+			tiles[1] = *((uint64_t*)(db_+dbindex));
+			tiles[2] = *((uint64_t*)(db_+(dbindex+dbwidth_)));
+		}
+
+		// similar to get_neighbours_64bit but reading ends with the
+		// dbword that contains padded_id. padded_id is at bit position
+		// 56 + (padded_id & DBWORD_BITS_MASK) of tiles[1].
+		inline void
+		get_neighbours_upper_64bit(uint32_t padded_id, uint64_t tiles[3])
+		{
+			int32_t dbindex = (padded_id >> warthog::LOG2_DBWORD_BITS);
+			dbindex -= 7;
+			tiles[0] = *((uint64_t*)(db_+(dbindex-(int32_t)dbwidth_)));
+			tiles[1] = *((uint64_t*)(db_+dbindex));
+			tiles[2] = *((uint64_t*)(db_+(dbindex+(int32_t)dbwidth_)));
+		}
+
+		// get pointers to the dbword that contains padded_id and to the
+		// dbwords directly above and below it. code that reads more
+		// than 64 tiles at a time may read up to DB_GUARD_WORDS
+		// dbwords before or after the padded map.
+		inline void
+		get_dbword_ptrs(uint32_t padded_id, const warthog::dbword* rows[3])
+		{
+			uint32_t dbindex = padded_id >> warthog::LOG2_DBWORD_BITS;
+			rows[0] = db_ + (dbindex - dbwidth_);
+			rows[1] = db_ + dbindex;
+			rows[2] = db_ + (dbindex + dbwidth_);
+		}
+
 		// get the label associated with the padded coordinate pair (x, y)
 		inline bool
 		get_label(uint32_t x, unsigned int y)
@@ -249,13 +290,18 @@ class gridmap
 		mem()
 		{
 			return sizeof(*this) +
-			sizeof(warthog::dbword) * db_size_;
+			sizeof(warthog::dbword) * (db_size_ + 2*DB_GUARD_WORDS);
 		}
 
+		// zeroed dbwords allocated before and after the padded map.
+		// they allow unaligned reads of several words to run past
+		// the first and last rows (see ::get_dbword_ptrs)
+		static const uint32_t DB_GUARD_WORDS = 64;
 
 	private:
 		warthog::gm_header header_;
 		warthog::dbword* db_;
+		warthog::dbword* raw_db_; // db_ plus guard words
 		char filename_[256];
 
 		uint32_t dbwidth_;
@@ -24,7 +24,13 @@
 #include "graph.h"
 #include "gridmap_expansion_policy.h"
 #include "constants.h"
+#include "mapped_file.h"
+#include "xy_graph_image.h"
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
 #include <ostream>
 #include <unordered_map>
 #include <vector>
@@ -40,7 +46,8 @@ class xy_graph_base
 {
     public:
         // create an empty graph
-        xy_graph_base(uint32_t num_nodes=0) : verbose_(false)
+        xy_graph_base(uint32_t num_nodes=0) 
+            : dense_ids_(false), verbose_(false)
         {
             grow(num_nodes);
         }
@@ -372,8 +379,232 @@ class xy_graph_base
             return is_euclidean(enforce_euclidean);
         }
 
+        // load a graph from a file written by ::save_image. the file is
+        // memory-mapped and the nodes use the edges in the mapping
+        // directly; nothing is parsed, sorted or allocated per edge.
+        // see domains/xy_graph_image.h for the format.
+        //
+        // @param rank: if not null, receives the CH rank of every node.
+        // loading fails if the image has no rank data.
+        // @param layout: if not null, receives the layout of the edges
+        // (one of warthog::graph::xyg_layout)
+        bool
+        load_from_image(const char* filename, 
+                std::vector<uint32_t>* rank = 0, uint32_t* layout = 0)
+        {
+            clear();
+
+            std::shared_ptr<warthog::util::mapped_file> image(
+                    new warthog::util::mapped_file());
+            if(!image->open(filename)) { return false; }
+
+            const char* base = image->data();
+            const warthog::graph::xyg_header* hdr = 
+                (const warthog::graph::xyg_header*)base;
+            if(image->size() < sizeof(*hdr) || 
+                    hdr->magic_ != warthog::graph::XYG_MAGIC)
+            {
+                std::cerr << "err; not a graph image: " << filename << "\n";
+                return false;
+            }
+            if(hdr->version_ != warthog::graph::XYG_VERSION || 
+                    hdr->edge_size_ != sizeof(T_EDGE))
+            {
+                std::cerr << "err; unsupported graph image version " 
+                    << hdr->version_ << " (edge size " << hdr->edge_size_ 
+                    << "); expected version " << warthog::graph::XYG_VERSION
+                    << " (edge size " << sizeof(T_EDGE) << ")\n";
+                return false;
+            }
+            if(hdr->file_size_ != image->size())
+            {
+                std::cerr << "err; graph image truncated; expected " 
+                    << hdr->file_size_ << " bytes but read " 
+                    << image->size() << "\n";
+                return false;
+            }
+
+            if(!valid_image(*hdr, base))
+            {
+                std::cerr << "err; graph image corrupt: " << filename << "\n";
+                return false;
+            }
+
+            uint32_t num_nodes = hdr->num_nodes_;
+            const int32_t* xy = (const int32_t*)(base + hdr->xy_offset_);
+            const uint32_t* ids = 
+                (const uint32_t*)(base + hdr->id_map_offset_);
+            const uint32_t* out_index = 
+                (const uint32_t*)(base + hdr->out_index_offset_);
+            const uint32_t* in_index = 
+                (const uint32_t*)(base + hdr->in_index_offset_);
+            T_EDGE* out_edges = (T_EDGE*)(image->data() + hdr->out_edges_offset_);
+            T_EDGE* in_edges = (T_EDGE*)(image->data() + hdr->in_edges_offset_);
+
+            if(rank)
+            {
+                if(!(hdr->flags_ & warthog::graph::XYG_HAS_RANK))
+                {
+                    std::cerr << "err; graph image has no node ranks\n";
+                    return false;
+                }
+                const uint32_t* r = 
+                    (const uint32_t*)(base + hdr->rank_offset_);
+                rank->assign(r, r + num_nodes);
+            }
+
+            xy_.assign(xy, xy + 2*num_nodes);
+            id_map_.assign(ids, ids + num_nodes);
+            index_external_ids();
+
+            nodes_.resize(num_nodes);
+            for(uint32_t i = 0; i < num_nodes; i++)
+            {
+                uint32_t in_deg = in_index[i+1] - in_index[i];
+                uint32_t out_deg = out_index[i+1] - out_index[i];
+                if(in_deg > warthog::graph::ECAP_MAX || 
+                        out_deg > warthog::graph::ECAP_MAX)
+                {
+                    std::cerr << "err; node " << i << " has too many edges\n";
+                    clear();
+                    return false;
+                }
+                nodes_[i].attach(
+                        in_edges + in_index[i], in_deg, 
+                        out_edges + out_index[i], out_deg);
+            }
+
+            if(layout) { *layout = hdr->layout_; }
+            image_ = image;
+            filename_.assign(filename);
+            return true;
+        }
+
+        // write the graph in the format read by ::load_from_image.
+        //
+        // @param rank: (optional) the CH rank of every node
+        // @param layout: how the edges are currently arranged
+        // (one of warthog::graph::xyg_layout)
+        bool
+        save_image(const char* filename, 
+                std::vector<uint32_t>* rank = 0, 
+                uint32_t layout = warthog::graph::XYG_LAYOUT_PLAIN)
+        {
+            uint32_t num_nodes = get_num_nodes();
+            if(xy_.size() != 2*num_nodes || id_map_.size() != num_nodes)
+            {
+                std::cerr << "err; graph has missing xy or id data\n";
+                return false;
+            }
+            if(rank && rank->size() != num_nodes)
+            {
+                std::cerr << "err; rank data has " << rank->size() 
+                    << " entries but graph has " << num_nodes << " nodes\n";
+                return false;
+            }
+
+            std::vector<uint32_t> out_index(num_nodes+1, 0);
+            std::vector<uint32_t> in_index(num_nodes+1, 0);
+            for(uint32_t i = 0; i < num_nodes; i++)
+            {
+                out_index[i+1] = out_index[i] + nodes_[i].out_degree();
+                in_index[i+1] = in_index[i] + nodes_[i].in_degree();
+            }
+
+            warthog::graph::xyg_header hdr;
+            memset(&hdr, 0, sizeof(hdr));
+            hdr.magic_ = warthog::graph::XYG_MAGIC;
+            hdr.version_ = warthog::graph::XYG_VERSION;
+            hdr.layout_ = layout;
+            hdr.flags_ = rank ? warthog::graph::XYG_HAS_RANK : 0;
+            hdr.num_nodes_ = num_nodes;
+            hdr.edge_size_ = sizeof(T_EDGE);
+            hdr.num_out_edges_ = out_index[num_nodes];
+            hdr.num_in_edges_ = in_index[num_nodes];
+
+            uint64_t offset = warthog::graph::xyg_align(sizeof(hdr));
+            hdr.xy_offset_ = offset;
+            offset = warthog::graph::xyg_align(
+                    offset + sizeof(int32_t) * 2 * num_nodes);
+            hdr.id_map_offset_ = offset;
+            offset = warthog::graph::xyg_align(
+                    offset + sizeof(uint32_t) * num_nodes);
+            hdr.rank_offset_ = offset;
+            offset = warthog::graph::xyg_align(
+                    offset + (rank ? sizeof(uint32_t) * num_nodes : 0));
+            hdr.out_index_offset_ = offset;
+            offset = warthog::graph::xyg_align(
+                    offset + sizeof(uint32_t) * (num_nodes+1));
+            hdr.in_index_offset_ = offset;
+            offset = warthog::graph::xyg_align(
+                    offset + sizeof(uint32_t) * (num_nodes+1));
+            hdr.out_edges_offset_ = offset;
+            offset = warthog::graph::xyg_align(
+                    offset + sizeof(T_EDGE) * hdr.num_out_edges_);
+            hdr.in_edges_offset_ = offset;
+            offset = warthog::graph::xyg_align(
+                    offset + sizeof(T_EDGE) * hdr.num_in_edges_);
+            hdr.file_size_ = offset;
+
+            std::ofstream ofs(filename, 
+                    std::ios_base::out | std::ios_base::binary |
+                    std::ios_base::trunc);
+            if(!ofs.good())
+            {
+                std::cerr << "err; cannot open " << filename 
+                    << " for writing\n";
+                return false;
+            }
+
+            // pads the output with zeroes up to the next array offset
+            auto seek = [&ofs] (uint64_t to) -> void
+            {
+                const char zero[warthog::graph::XYG_ALIGNMENT] = {0};
+                uint64_t at = ofs.tellp();
+                assert(to >= at && to - at <= sizeof(zero));
+                ofs.write(zero, to - at);
+            };
+
+            ofs.write((char*)&hdr, sizeof(hdr));
+            seek(hdr.xy_offset_);
+            ofs.write((char*)xy_.data(), sizeof(int32_t) * 2 * num_nodes);
+            seek(hdr.id_map_offset_);
+            ofs.write((char*)id_map_.data(), sizeof(uint32_t) * num_nodes);
+            seek(hdr.rank_offset_);
+            if(rank)
+            {
+                ofs.write((char*)rank->data(), sizeof(uint32_t) * num_nodes);
+            }
+            seek(hdr.out_index_offset_);
+            ofs.write((char*)out_index.data(), 
+                    sizeof(uint32_t) * (num_nodes+1));
+            seek(hdr.in_index_offset_);
+            ofs.write((char*)in_index.data(), 
+                    sizeof(uint32_t) * (num_nodes+1));
+            seek(hdr.out_edges_offset_);
+            for(uint32_t i = 0; i < num_nodes; i++)
+            {
+                ofs.write((char*)nodes_[i].outgoing_begin(), 
+                        sizeof(T_EDGE) * nodes_[i].out_degree());
+            }
+            seek(hdr.in_edges_offset_);
+            for(uint32_t i = 0; i < num_nodes; i++)
+            {
+                ofs.write((char*)nodes_[i].incoming_begin(), 
+                        sizeof(T_EDGE) * nodes_[i].in_degree());
+            }
+            seek(hdr.file_size_);
+
+            if(!ofs.good())
+            {
+                std::cerr << "err; writing graph image " << filename << "\n";
+                return false;
+            }
+            return true;
+        }
+
         warthog::graph::xy_graph_base<T_NODE, T_EDGE>&
-        operator=(const warthog::graph::xy_graph_base<T_NODE, T_EDGE>&& other)
+        operator=(warthog::graph::xy_graph_base<T_NODE, T_EDGE>&& other)
         {
             // my memory, not want
             clear();
@@ -385,6 +616,9 @@ class xy_graph_base
             xy_ = std::move(other.xy_);
             id_map_ = std::move(other.id_map_);
             ext_id_map_ = std::move(other.ext_id_map_);
+            dense_ids_ = other.dense_ids_;
+            image_ = other.image_;
+            csr_ = std::move(other.csr_);
 
             return *this;
         }
@@ -434,6 +668,9 @@ class xy_graph_base
             xy_.clear();
             id_map_.clear();
             ext_id_map_.clear();
+            dense_ids_ = false;
+            image_.reset();
+            csr_.clear();
         }
 
         // grow the graph so that the number of vertices is equal to 
@@ -558,6 +795,12 @@ class xy_graph_base
             if(graph_id != warthog::INF) { return graph_id; } 
 
             graph_id = get_num_nodes();
+            if(dense_ids_) 
+            {
+                // the new id may not follow on from the others
+                dense_ids_ = false;
+                index_external_ids();
+            }
 
             nodes_.push_back(warthog::graph::node());
             xy_.push_back(x);
@@ -602,6 +845,7 @@ class xy_graph_base
             {
                 mem += nodes_[i].mem();
             }
+            mem += sizeof(T_EDGE) * csr_.capacity();
             mem += sizeof(int32_t) * xy_.size() * 2;
             mem += sizeof(char)*filename_.length() +
                 sizeof(*this);
@@ -620,6 +864,11 @@ class xy_graph_base
         to_graph_id(uint32_t ext_id) 
         { 
             if(id_map_.size() == 0) { return warthog::INF; }
+            if(dense_ids_)
+            {
+                uint32_t id = ext_id - id_map_[0];
+                return id < id_map_.size() ? id : warthog::INF;
+            }
 
             std::unordered_map<uint32_t, uint32_t>::iterator it 
                     = ext_id_map_.find(ext_id);
@@ -807,23 +1056,64 @@ class xy_graph_base
 
 
 
-        //inline void
-        //shrink_to_fit()
-        //{
-        //    edge* tmp = new edge[get_num_edges()];
-        //    uint32_t e_index = 0;
-        //    for(uint32_t i = 0; i < this->get_num_nodes(); i++)
-        //    { 
-        //        uint32_t in_deg = nodes_[i].in_degree();
-        //        uint32_t out_deg = nodes_[i].out_degree();
-        //        nodes_[i].relocate(&tmp[e_index], &tmp[e_index + in_deg]);
-        //        e_index += (in_deg + out_deg);
-        //    }
-        //}
+        // pack the edges of every node into one array, in compressed
+        // sparse row order: the outgoing edges of all nodes, by node id,
+        // followed by the incoming edges of all nodes. nodes then point
+        // into this array instead of owning separate allocations, and 
+        // the edges of nodes with nearby ids share cache lines.
+        //
+        // call this once loading and preprocessing are done; the usual
+        // node interface still works, so expansion policies need no
+        // changes. a node whose edge count changes later moves its
+        // edges back into memory of its own (see graph::node::attach).
+        void
+        freeze()
+        {
+            uint32_t num_out = get_num_edges_out();
+            uint32_t num_in = get_num_edges_in();
+            std::vector<T_EDGE> csr(num_out + num_in);
+
+            T_EDGE* out = csr.data();
+            T_EDGE* in = csr.data() + num_out;
+            for(uint32_t i = 0; i < get_num_nodes(); i++)
+            {
+                T_NODE& n = nodes_[i];
+                uint32_t out_deg = n.out_degree();
+                uint32_t in_deg = n.in_degree();
+                std::copy(n.outgoing_begin(), n.outgoing_end(), out);
+                std::copy(n.incoming_begin(), n.incoming_end(), in);
+                n.attach(in, in_deg, out, out_deg);
+                out += out_deg;
+                in += in_deg;
+            }
+
+            // the old edges (if any) are released at the end of scope
+            csr_.swap(csr);
+            image_.reset();
+        }
+
+        // @return true if every edge lives in the array built by 
+        // ::freeze or in a memory-mapped image
+        bool
+        is_frozen()
+        {
+            for(uint32_t i = 0; i < get_num_nodes(); i++)
+            {
+                if(nodes_[i].owns_edges()) { return false; }
+            }
+            return true;
+        }
 
     private:
         // the set of nodes that comprise the graph
         std::vector<T_NODE> nodes_;
+
+        // a memory-mapped graph image (see ::load_from_image). the edges
+        // of each node are stored here.
+        std::shared_ptr<warthog::util::mapped_file> image_;
+
+        // the edges of every node, in CSR order (see ::freeze)
+        std::vector<T_EDGE> csr_;
         
         // xy coordinates stored as adjacent pairs (x, then y)
         std::vector<int32_t> xy_;
@@ -833,6 +1123,92 @@ class xy_graph_base
         std::vector<uint32_t> id_map_; 
         std::unordered_map<uint32_t, uint32_t> ext_id_map_; 
 
+        // true when the external ids are consecutive, i.e. when 
+        // id_map_[i] == id_map_[0] + i. lookups are then a subtraction
+        // and ext_id_map_ is left empty.
+        bool dense_ids_;
+
+        // build the lookup table from external to internal ids, unless
+        // the external ids are consecutive (as in most DIMACS files)
+        void
+        index_external_ids()
+        {
+            ext_id_map_.clear();
+            dense_ids_ = id_map_.size() > 0;
+            for(uint32_t i = 0; dense_ids_ && i < id_map_.size(); i++)
+            {
+                dense_ids_ = (id_map_[i] == id_map_[0] + i);
+            }
+            if(dense_ids_) { return; }
+
+            ext_id_map_.reserve(id_map_.size()*0.8);
+            for(uint32_t i = 0; i < id_map_.size(); i++)
+            {
+                ext_id_map_.insert(
+                        std::pair<uint32_t, uint32_t>(id_map_[i], i));
+            }
+        }
+
+        // check that every array of the image @param hdr, mapped at
+        // @param base, lies within the file and that every index and
+        // node id in it is in range, so the nodes can point into the
+        // mapping without further checks
+        static bool
+        valid_image(const warthog::graph::xyg_header& hdr, const char* base)
+        {
+            uint64_t n = hdr.num_nodes_;
+            auto fits = [&hdr] (uint64_t offset, uint64_t bytes,
+                    uint64_t align) -> bool
+            {
+                return offset % align == 0 && offset <= hdr.file_size_ &&
+                    bytes <= hdr.file_size_ - offset;
+            };
+            if(!fits(hdr.xy_offset_, sizeof(int32_t) * 2 * n,
+                        sizeof(int32_t)) ||
+               !fits(hdr.id_map_offset_, sizeof(uint32_t) * n,
+                   sizeof(uint32_t)) ||
+               ((hdr.flags_ & warthog::graph::XYG_HAS_RANK) &&
+                !fits(hdr.rank_offset_, sizeof(uint32_t) * n,
+                    sizeof(uint32_t))) ||
+               !fits(hdr.out_index_offset_, sizeof(uint32_t) * (n+1),
+                   sizeof(uint32_t)) ||
+               !fits(hdr.in_index_offset_, sizeof(uint32_t) * (n+1),
+                   sizeof(uint32_t)) ||
+               !fits(hdr.out_edges_offset_,
+                   sizeof(T_EDGE) * (uint64_t)hdr.num_out_edges_,
+                   alignof(T_EDGE)) ||
+               !fits(hdr.in_edges_offset_,
+                   sizeof(T_EDGE) * (uint64_t)hdr.num_in_edges_,
+                   alignof(T_EDGE)))
+            {
+                return false;
+            }
+
+            // CSR offsets are non-decreasing and stay within the edges;
+            // every edge leads to a node of the graph
+            auto valid_edges = [n, base] (uint64_t index_offset,
+                    uint64_t edges_offset, uint32_t num_edges) -> bool
+            {
+                const uint32_t* index =
+                    (const uint32_t*)(base + index_offset);
+                const T_EDGE* edges = (const T_EDGE*)(base + edges_offset);
+                if(index[0] != 0 || index[n] > num_edges) { return false; }
+                for(uint64_t i = 0; i < n; i++)
+                {
+                    if(index[i] > index[i+1]) { return false; }
+                }
+                for(uint32_t i = 0; i < index[n]; i++)
+                {
+                    if(edges[i].node_id_ >= n) { return false; }
+                }
+                return true;
+            };
+            return valid_edges(hdr.out_index_offset_,
+                        hdr.out_edges_offset_, hdr.num_out_edges_) &&
+                   valid_edges(hdr.in_index_offset_,
+                        hdr.in_edges_offset_, hdr.num_in_edges_);
+        }
+
         std::string filename_;
         bool verbose_;
 };
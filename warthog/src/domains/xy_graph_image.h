@@ -0,0 +1,112 @@
+#ifndef WARTHOG_XY_GRAPH_IMAGE_H
+#define WARTHOG_XY_GRAPH_IMAGE_H
+
+// domains/xy_graph_image.h
+//
+// A versioned binary file format for xy_graph objects. The format is
+// designed to be memory-mapped (see util/mapped_file.h) and used
+// without parsing or copying. Compare this with
+// xy_graph_base::load_from_blob, which reads, allocates and inserts
+// every adjacency list separately.
+//
+// The file is a fixed-size header followed by a set of flat arrays.
+// Each array begins at an offset that is a multiple of
+// XYG_ALIGNMENT:
+//
+//   xy        int32_t[2*num_nodes]   x and y coordinates of every node
+//   id_map    uint32_t[num_nodes]    external id of every node
+//   rank      uint32_t[num_nodes]    CH rank (only if XYG_HAS_RANK)
+//   out_index uint32_t[num_nodes+1]  CSR offsets into out_edges
+//   in_index  uint32_t[num_nodes+1]  CSR offsets into in_edges
+//   out_edges graph::edge[num_out_edges]
+//   in_edges  graph::edge[num_in_edges]
+//
+// The outgoing edges of node i are out_edges[out_index[i],
+// out_index[i+1]). Incoming edges are indexed in the same way.
+// Edges are stored as warthog::graph::edge, so nodes can point into
+// the mapped file directly.
+//
+// The layout field records how the edges were arranged when the
+// image was written. Search code can check it and skip its own
+// preprocessing:
+//
+//   XYG_LAYOUT_PLAIN: edges as loaded from the input graph
+//   XYG_LAYOUT_FCH:   outgoing edges sorted by rank, highest first
+//                     (see ch::fch_sort_successors)
+//   XYG_LAYOUT_BCH:   outgoing edges lead up; every down edge is
+//                     stored reversed as an incoming edge of its head
+//                     (see ch::optimise_graph_for_bch_v2)
+//
+// All values are written in host byte order. Readers reject files
+// whose magic number or version does not match.
+//
+
+#include "graph.h"
+
+#include <cstdint>
+#include <fstream>
+
+namespace warthog
+{
+
+namespace graph
+{
+
+const uint32_t XYG_MAGIC = 0x47595857; // "WXYG"
+const uint32_t XYG_VERSION = 1;
+const uint64_t XYG_ALIGNMENT = 64;
+
+// flags
+const uint32_t XYG_HAS_RANK = 1;
+
+typedef enum
+{
+    XYG_LAYOUT_PLAIN = 0,
+    XYG_LAYOUT_FCH = 1,
+    XYG_LAYOUT_BCH = 2
+} xyg_layout;
+
+struct xyg_header
+{
+    uint32_t magic_;
+    uint32_t version_;
+    uint32_t layout_;
+    uint32_t flags_;
+    uint32_t num_nodes_;
+    uint32_t edge_size_;    // sizeof(warthog::graph::edge) of the writer
+    uint32_t num_out_edges_;
+    uint32_t num_in_edges_;
+
+    // byte offsets of each array from the start of the file
+    uint64_t xy_offset_;
+    uint64_t id_map_offset_;
+    uint64_t rank_offset_;
+    uint64_t out_index_offset_;
+    uint64_t in_index_offset_;
+    uint64_t out_edges_offset_;
+    uint64_t in_edges_offset_;
+    uint64_t file_size_;
+};
+
+inline uint64_t
+xyg_align(uint64_t offset)
+{
+    return (offset + XYG_ALIGNMENT - 1) & ~(XYG_ALIGNMENT - 1);
+}
+
+// @return true if @param filename starts with the magic number of
+// a graph image. no other part of the file is checked.
+inline bool
+is_xyg_image(const char* filename)
+{
+    std::ifstream ifs(filename, std::ios_base::in | std::ios_base::binary);
+    uint32_t magic = 0;
+    ifs.read((char*)&magic, sizeof(magic));
+    return ifs.good() && magic == XYG_MAGIC;
+}
+
+}
+
+}
+
+#endif
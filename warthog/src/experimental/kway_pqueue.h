@@ -3,37 +3,45 @@
 
 // kway_pqueue.h
 //
-// An attempt at an priority queue with k-arity. Based on
-// the binary heap implementation of warthog::kway_pqueue 
+// A priority queue with k-arity. Based on the binary heap
+// implementation of warthog::pqueue.
+//
+// Each node has 2^LOG_K children. Compared to a binary heap, the tree
+// is shallower, so there are fewer swaps per push and decrease_key.
+// Children of a node are also adjacent in memory, so comparing them
+// during a pop touches fewer cache lines. The default, LOG_K = 2
+// (a 4-ary heap), tends to work best in practice.
 //
 // @author: dharabor
 // @created: 2018-05-05
 //
 
+#include "pqueue.h"
 #include "search_node.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
 namespace warthog
 {
 
-class search_node;
-
-struct min_q 
-{ static const bool is_min_ = true; };
-
-struct max_q
-{ static const bool is_min_ = false; };
-
-
 template <class Comparator = warthog::cmp_less_search_node,
-          class QType = warthog::min_q>
-class kway_pqueue 
+          class QType = warthog::min_q,
+          class NODE = warthog::search_node,
+          uint32_t LOG_K = 2>
+class kway_pqueue
 {
 	public:
-		kway_pqueue(unsigned int size)
-            : maxsize_(size), minqueue_(QType().is_min_), queuesize_(0), 
+        typedef NODE node;
+
+        // the same queue, but for search nodes of type N
+        template<class N>
+        struct rebind
+        { typedef kway_pqueue<Comparator, QType, N, LOG_K> other; };
+
+		kway_pqueue(unsigned int size=1024)
+            : maxsize_(size), minqueue_(QType().is_min_), queuesize_(0),
             elts_(0)
         {
             resize(size);
@@ -52,27 +60,27 @@ class kway_pqueue
         }
 
 		// reprioritise the specified element (up or down)
-        void 
-        decrease_key(warthog::search_node* val)
-        {	
+        void
+        decrease_key(NODE* val)
+        {
             assert(val->get_priority() < queuesize_);
-            minqueue_ ?  
+            minqueue_ ?
                 heapify_up(val->get_priority()) :
                 heapify_down(val->get_priority());
         }
 
-        void 
-        increase_key(warthog::search_node* val)
+        void
+        increase_key(NODE* val)
         {
             assert(val->get_priority() < queuesize_);
-            minqueue_ ? 
+            minqueue_ ?
                 heapify_down(val->get_priority()) :
                 heapify_up(val->get_priority());
         }
 
 		// add a new element to the kway_pqueue
-        void 
-        push(warthog::search_node* val)
+        void
+        push(NODE* val)
         {
             if(contains(val))
             {
@@ -81,7 +89,7 @@ class kway_pqueue
 
             if(queuesize_+1 > maxsize_)
             {
-                resize(maxsize_*2);
+                resize(std::max(1u, maxsize_*2));
             }
             unsigned int priority = queuesize_;
             elts_[priority] = val;
@@ -91,7 +99,7 @@ class kway_pqueue
         }
 
 		// remove the top element from the kway_pqueue
-        warthog::search_node*
+        NODE*
         pop()
         {
             if (queuesize_ == 0)
@@ -99,7 +107,7 @@ class kway_pqueue
                 return 0;
             }
 
-            warthog::search_node *ans = elts_[0];
+            NODE *ans = elts_[0];
             queuesize_--;
 
             if(queuesize_ > 0)
@@ -111,10 +119,10 @@ class kway_pqueue
             return ans;
         }
 
-		// @return true if the priority of the element is 
+		// @return true if the priority of the element is
 		// otherwise
 		inline bool
-		contains(warthog::search_node* n)
+		contains(NODE* n)
 		{
 			unsigned int priority = n->get_priority();
 			if(priority < queuesize_ && &*n == &*elts_[priority])
@@ -125,7 +133,7 @@ class kway_pqueue
 		}
 
 		// retrieve the top element without removing it
-		inline warthog::search_node*
+		inline NODE*
 		peek()
 		{
 			if(queuesize_ > 0)
@@ -142,12 +150,12 @@ class kway_pqueue
 		}
 
 		inline bool
-		is_minqueue() 
-		{ 
-			return minqueue_; 
-		} 
-		
-        void 
+		is_minqueue()
+		{
+			return minqueue_;
+		}
+
+        void
         print(std::ostream& out)
         {
             for(unsigned int i=0; i < queuesize_; i++)
@@ -160,68 +168,68 @@ class kway_pqueue
 		unsigned int
 		mem()
 		{
-			return maxsize_*sizeof(warthog::search_node*)
+			return maxsize_*sizeof(NODE*)
 				+ sizeof(*this);
 		}
 
 	private:
+        static const uint32_t arity_ = 1 << LOG_K;
+
 		unsigned int maxsize_;
 		bool minqueue_;
 		unsigned int queuesize_;
-		warthog::search_node** elts_;
+		NODE** elts_;
         Comparator cmp_;
-        uint32_t arity_ = 4;
-        uint32_t log_arity_ = 2;
 
-		// reorders the subkway_pqueue containing elts_[index]
-        void 
+		// reorders the subkway_pqueue containing elts_[index].
+        // the element moves into a hole that travels up the tree; each
+        // displaced parent is written once instead of being swapped.
+        void
         heapify_up(unsigned int index)
         {
             assert(index < queuesize_);
+            NODE* val = elts_[index];
             while(index > 0)
             {
-                unsigned int parent = (index-1) >> log_arity_;
-                if(cmp_(*elts_[index], *elts_[parent]))
-                {
-                    swap(parent, index);
-                    index = parent;
-                }
-                else { break; }
+                unsigned int parent = (index-1) >> LOG_K;
+                if(!cmp_(*val, *elts_[parent])) { break; }
+                elts_[index] = elts_[parent];
+                elts_[index]->set_priority(index);
+                index = parent;
             }
+            elts_[index] = val;
+            val->set_priority(index);
         }
-		
+
 		// reorders the subkway_pqueue under elts_[index]
-        void 
+        void
         heapify_down(unsigned int index)
         {
-            unsigned int first_leaf_index = queuesize_ >> log_arity_;
-            while(index < first_leaf_index)
+            NODE* val = elts_[index];
+            while(true)
             {
+                // the children of index are adjacent in memory
+                unsigned int first_c = (index << LOG_K) + 1;
+                if(first_c >= queuesize_) { break; }
+                unsigned int last_c = first_c + arity_;
+                if(last_c > queuesize_) { last_c = queuesize_; }
+
                 // find smallest (or largest, depending on heap type) child
-                uint32_t max_c = (queuesize_ - (index<<log_arity_));
-                max_c = index + (max_c > arity_ ? arity_ : max_c);
-                uint32_t best_c = index+1;
-                for(uint32_t next_c = index+2; next_c <= max_c; next_c++)
+                unsigned int best_c = first_c;
+                for(unsigned int next_c = first_c+1; next_c < last_c; next_c++)
                 {
-                    best_c = cmp_(*elts_[best_c], *elts_[next_c]) ?
-                                    best_c : next_c;
+                    if(cmp_(*elts_[next_c], *elts_[best_c]))
+                    { best_c = next_c; }
                 }
 
-                //unsigned int best_c = (index<<1)+1;
-                //unsigned int next_c = (index<<1)+2;
-                //if((next_c < queuesize_) && *elts_[next_c] < *elts_[best_c])
-                //{
-                //    best_c = next_c;
-                //}
-
-                // swap child with parent if necessary
-                if(cmp_(*elts_[best_c], *elts_[index]))
-                {
-                    swap(index, best_c);
-                    index = best_c;
-                }
-                else { break; }
+                // move the child up if necessary
+                if(!cmp_(*elts_[best_c], *val)) { break; }
+                elts_[index] = elts_[best_c];
+                elts_[index]->set_priority(index);
+                index = best_c;
             }
+            elts_[index] = val;
+            val->set_priority(index);
         }
 
 		// allocates more memory so the kway_pqueue can grow
@@ -230,13 +238,13 @@ class kway_pqueue
         {
             if(newsize < queuesize_)
             {
-                std::cerr 
-                    << "err; kway_pqueue::resize newsize < queuesize " 
+                std::cerr
+                    << "err; kway_pqueue::resize newsize < queuesize "
                     << std::endl;
                 exit(1);
             }
 
-            warthog::search_node** tmp = new search_node*[newsize];
+            NODE** tmp = new NODE*[newsize];
             for(unsigned int i=0; i < queuesize_; i++)
             {
                 tmp[i] = elts_[i];
@@ -245,19 +253,6 @@ class kway_pqueue
             elts_ = tmp;
             maxsize_ = newsize;
         }
-
-		// swap the positions of two nodes in the underlying array
-		inline void 
-		swap(unsigned int index1, unsigned int index2)
-		{
-			assert(index1 < queuesize_ && index2 < queuesize_);
-
-			warthog::search_node* tmp = elts_[index1];
-			elts_[index1] = elts_[index2];
-			elts_[index1]->set_priority(index1);
-			elts_[index2] = tmp;
-			tmp->set_priority(index2);
-		}
 };
 
 typedef kway_pqueue<warthog::cmp_less_search_node, warthog::min_q> kway_pqueue_min;
@@ -266,4 +261,3 @@ typedef kway_pqueue<warthog::cmp_greater_search_node, warthog::max_q> kway_pqueu
 }
 
 #endif
-
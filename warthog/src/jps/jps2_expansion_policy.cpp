@@ -80,7 +80,12 @@ warthog::jps2_expansion_policy::generate_start_node(
     uint32_t max_id = map_->header_width() * map_->header_height();
     if(pi->start_id_ >= max_id) { return 0; }
     uint32_t padded_id = map_->to_padded_id(pi->start_id_);
-    return generate(padded_id);
+
+    // the start node has no parent; clear any direction left over from 
+    // an earlier search or else some successors are wrongly pruned
+    warthog::search_node* start = generate(padded_id);
+    start->set_pdir(warthog::jps::NONE);
+    return start;
 }
 
 warthog::search_node*
@@ -0,0 +1,39 @@
+#ifndef WARTHOG_JPS2_LISTENER_H
+#define WARTHOG_JPS2_LISTENER_H
+
+// jps/jps2_listener.h
+//
+// JPS2 and JPS2+ store the direction of travel of each node alongside
+// its parent pointer. This listener keeps the two in sync whenever
+// flexible_astar relaxes a node.
+//
+// E is the expansion policy: jps2_expansion_policy or
+// jps2plus_expansion_policy
+//
+
+#include "dummy_listener.h"
+#include "search_node.h"
+
+namespace warthog
+{
+
+template<class E>
+class jps2_listener : public warthog::dummy_listener
+{
+    public:
+        jps2_listener(E* expander) : expander_(expander) { }
+        ~jps2_listener() { }
+
+        inline void
+        relax_node(warthog::search_node* current)
+        {
+            expander_->update_parent_direction(current);
+        }
+
+    private:
+        E* expander_;
+};
+
+}
+
+#endif
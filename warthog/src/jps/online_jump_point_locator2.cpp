@@ -5,12 +5,219 @@
 #include <cassert>
 #include <climits>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define WARTHOG_JPS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace
+{
+
+// a straight jump that reads the map one window of tiles at a time
+struct scan_state
+{
+	warthog::gridmap* map_;
+	uint32_t start_;	// the tile where the jump began
+	uint32_t pos_;		// the tile that identifies the next window
+	bool deadend_;
+};
+
+// identify forced neighbours and dead-end tiles in 64 tiles from each
+// of three adjacent rows. bit i of each word is the tile with the i-th
+// smallest id. the rules are the same as in ::__jump_east (forward
+// jumps) and ::__rjump_east (reversed jumps), and their mirror images
+// when jumping west. at one end of the window a tile is missing the 
+// neighbour it needs; such tiles are never reported.
+template<bool WEST, bool REVERSE>
+inline void
+stop_bits_64bit(const uint64_t neis[3], 
+		uint64_t& forced_bits, uint64_t& deadend_bits)
+{
+	// a forced neighbour follows an obstacle tile. when WEST != REVERSE
+	// that obstacle has the next higher id, otherwise the next lower id.
+	if(WEST != REVERSE)
+	{
+		forced_bits = (~neis[0] >> 1) & neis[0];
+		forced_bits |= (~neis[2] >> 1) & neis[2];
+	}
+	else
+	{
+		forced_bits = (~neis[0] << 1) & neis[0];
+		forced_bits |= (~neis[2] << 1) & neis[2];
+	}
+	deadend_bits = ~neis[1];
+	if(REVERSE)
+	{
+		deadend_bits = WEST ? (deadend_bits << 1) : (deadend_bits >> 1);
+	}
+}
+
+// clear the bits of tiles that lie behind @param off, the position of
+// the start tile in its window. in forward jumps the start tile itself
+// cannot have a forced neighbour (cf. ::__jump_east).
+template<bool WEST, bool REVERSE>
+inline void
+mask_start_64bit(uint32_t off, uint64_t& forced_bits, uint64_t& deadend_bits)
+{
+	if(WEST)
+	{
+		deadend_bits &= ~0ull >> (63 - off);
+		forced_bits &= ~0ull >> (63 - off + !REVERSE);
+	}
+	else
+	{
+		deadend_bits &= ~0ull << off;
+		forced_bits &= ~0ull << (off + !REVERSE);
+	}
+}
+
+// examine the next 64 tiles of a straight jump.
+// @return true if the jump stops in this window. s.pos_ is then the id
+// of the stop tile. otherwise s.pos_ moves to the next window.
+template<bool WEST, bool REVERSE>
+inline bool
+scan_64bit(scan_state& s)
+{
+	// id of the tile at bit 0 of the window
+	uint32_t base = s.pos_ & ~warthog::DBWORD_BITS_MASK;
+	uint64_t neis[3];
+	if(WEST)
+	{
+		s.map_->get_neighbours_upper_64bit(s.pos_, neis);
+		base -= 56;
+	}
+	else
+	{
+		s.map_->get_neighbours_64bit(s.pos_, neis);
+	}
+
+	uint64_t forced_bits, deadend_bits;
+	stop_bits_64bit<WEST, REVERSE>(neis, forced_bits, deadend_bits);
+	if(s.pos_ == s.start_)
+	{
+		mask_start_64bit<WEST, REVERSE>(
+				s.start_ - base, forced_bits, deadend_bits);
+	}
+
+	uint64_t stop_bits = forced_bits | deadend_bits;
+	if(stop_bits)
+	{
+		uint32_t stop_pos = WEST ? 
+			63 - __builtin_clzll(stop_bits) : __builtin_ctzll(stop_bits);
+		s.pos_ = base + stop_pos;
+		s.deadend_ = (deadend_bits >> stop_pos) & 1;
+		return true;
+	}
+
+	// consecutive windows overlap by 8 tiles, so the tiles at the end 
+	// of this window that were never reported are examined again
+	s.pos_ = WEST ? base + 7 : base + 56;
+	return false;
+}
+
+#ifdef WARTHOG_JPS_AVX2
+// examine the next 256 tiles of a straight jump. same as ::scan_64bit
+// but every tile is examined exactly once: the neighbour that decides
+// whether a tile is forced is read from an overlapping load, even when
+// it lies outside the window. most jumps are short, so the first window 
+// of every jump is read with ::scan_64bit. 
+template<bool WEST, bool REVERSE>
+__attribute__((target("avx2"))) inline bool
+scan_256bit(scan_state& s)
+{
+	assert(s.pos_ != s.start_);
+	const warthog::dbword* rows[3];
+	s.map_->get_dbword_ptrs(s.pos_, rows);
+	uint32_t base = s.pos_ & ~warthog::DBWORD_BITS_MASK;
+	if(WEST)
+	{
+		rows[0] -= 31; rows[1] -= 31; rows[2] -= 31;
+		base -= 248;
+	}
+
+	// tile i of adj[k] is the tile next to tile i of tiles[k], in
+	// the direction used by stop_bits_64bit
+	__m256i tiles[3], adj[3];
+	for(uint32_t k = 0; k < 3; k++)
+	{
+		tiles[k] = _mm256_loadu_si256((const __m256i*)rows[k]);
+		if(WEST != REVERSE)
+		{
+			__m256i next = _mm256_loadu_si256((const __m256i*)(rows[k]+8));
+			adj[k] = _mm256_or_si256(_mm256_srli_epi64(tiles[k], 1),
+					_mm256_slli_epi64(next, 63));
+		}
+		else
+		{
+			__m256i prev = _mm256_loadu_si256((const __m256i*)(rows[k]-8));
+			adj[k] = _mm256_or_si256(_mm256_slli_epi64(tiles[k], 1),
+					_mm256_srli_epi64(prev, 63));
+		}
+	}
+
+	__m256i ones = _mm256_set1_epi32(-1);
+	__m256i deadend = _mm256_andnot_si256(REVERSE ? adj[1] : tiles[1], ones);
+	__m256i stop = _mm256_or_si256(deadend, _mm256_or_si256(
+			_mm256_andnot_si256(adj[0], tiles[0]),
+			_mm256_andnot_si256(adj[2], tiles[2])));
+	if(_mm256_testz_si256(stop, stop))
+	{
+		s.pos_ = WEST ? base - 1 : base + 256;
+		return false;
+	}
+
+	// find the first 64-bit word with a stop tile, then the tile
+	uint32_t nonzero = ~_mm256_movemask_pd(_mm256_castsi256_pd(
+			_mm256_cmpeq_epi64(stop, _mm256_setzero_si256()))) & 15;
+	uint32_t word = WEST ? 31 - __builtin_clz(nonzero) : __builtin_ctz(nonzero);
+	uint64_t stop_bits[4], deadend_bits[4];
+	_mm256_storeu_si256((__m256i*)stop_bits, stop);
+	_mm256_storeu_si256((__m256i*)deadend_bits, deadend);
+
+	uint32_t stop_pos = WEST ? 
+		63 - __builtin_clzll(stop_bits[word]) : 
+		__builtin_ctzll(stop_bits[word]);
+	s.pos_ = base + word*64 + stop_pos;
+	s.deadend_ = (deadend_bits[word] >> stop_pos) & 1;
+	return true;
+}
+#endif
+
+// set the jump point and the cost of a straight jump that has stopped.
+// same as the last part of ::__jump_east and ::__jump_west.
+template<bool WEST>
+inline void
+jump_result(const scan_state& s, uint32_t goal_id, 
+		uint32_t& jumpnode_id, double& jumpcost)
+{
+	uint32_t num_steps = WEST ? s.start_ - s.pos_ : s.pos_ - s.start_;
+	uint32_t goal_dist = WEST ? s.start_ - goal_id : goal_id - s.start_;
+	if(num_steps > goal_dist)
+	{
+		jumpnode_id = goal_id;
+		jumpcost = goal_dist;
+		return;
+	}
+
+	jumpnode_id = s.pos_;
+	if(s.deadend_)
+	{
+		num_steps -= (1 && num_steps);
+		jumpnode_id = warthog::INF;
+	}
+	jumpcost = num_steps;
+}
+
+}
+
 warthog::jps::online_jump_point_locator2::online_jump_point_locator2(
         warthog::gridmap* map) : map_(map)//, jumplimit_(UINT32_MAX)
 {
 	rmap_ = create_rmap();
 	current_node_id_ = current_rnode_id_ = warthog::INF;
 	current_goal_id_ = current_rgoal_id_ = warthog::INF;
+	set_scan_width(best_scan_width());
+	fns_ = &forward_fns_;
 }
 
 warthog::jps::online_jump_point_locator2::~online_jump_point_locator2()
@@ -18,6 +225,124 @@ warthog::jps::online_jump_point_locator2::~online_jump_point_locator2()
 	delete rmap_;
 }
 
+warthog::jps::scan_width
+warthog::jps::online_jump_point_locator2::cpu_scan_width()
+{
+#ifdef WARTHOG_JPS_AVX2
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2")) { return warthog::jps::SCAN_256BIT; }
+#endif
+	return warthog::jps::SCAN_64BIT;
+}
+
+warthog::jps::scan_width
+warthog::jps::online_jump_point_locator2::best_scan_width()
+{
+	if(cpu_scan_width() != warthog::jps::SCAN_256BIT)
+	{
+		return warthog::jps::SCAN_64BIT;
+	}
+
+	// count the traversable tiles and the runs they form, in every
+	// row of the map and of the rotated map (i.e. in every column)
+	uint64_t num_tiles = 0;
+	uint64_t num_runs = 0;
+	warthog::gridmap* maps[2] = { map_, rmap_ };
+	for(warthog::gridmap* gm : maps)
+	{
+		for(uint32_t y = 0; y < gm->header_height(); y++)
+		{
+			bool prev = false;
+			for(uint32_t x = 0; x < gm->header_width(); x++)
+			{
+				bool label = gm->get_label(gm->to_padded_id(x, y));
+				num_tiles += label;
+				num_runs += (label && !prev);
+				prev = label;
+			}
+		}
+	}
+
+	if(num_runs && num_tiles / num_runs >= warthog::jps::SCAN_256BIT)
+	{
+		return warthog::jps::SCAN_256BIT;
+	}
+	return warthog::jps::SCAN_64BIT;
+}
+
+void
+warthog::jps::online_jump_point_locator2::set_scan_width(
+		warthog::jps::scan_width width)
+{
+	typedef warthog::jps::online_jump_point_locator2 jpl;
+	if(width == warthog::jps::SCAN_256BIT && 
+			cpu_scan_width() != warthog::jps::SCAN_256BIT)
+	{
+		width = warthog::jps::SCAN_64BIT;
+	}
+	scan_width_ = width;
+
+	switch(width)
+	{
+		case warthog::jps::SCAN_32BIT:
+		{
+			jump_fns fwd = { &jpl::__jump_east, &jpl::__jump_west,
+				&jpl::__jump_pair_seq<false, false>,
+				&jpl::__jump_pair_seq<false, true>,
+				&jpl::__jump_pair_seq<true, false>,
+				&jpl::__jump_pair_seq<true, true> };
+			forward_fns_ = fwd;
+			reverse_fns_ = fwd;
+			reverse_fns_.east_ = &jpl::__rjump_east;
+			reverse_fns_.west_ = &jpl::__rjump_west;
+			break;
+		}
+#ifdef WARTHOG_JPS_AVX2
+		case warthog::jps::SCAN_256BIT:
+		{
+			jump_fns fwd = { 
+				&jpl::__jump_256bit<false, false>, 
+				&jpl::__jump_256bit<true, false>,
+				&jpl::__jump_pair_256bit<false, false, false>,
+				&jpl::__jump_pair_256bit<false, true, false>,
+				&jpl::__jump_pair_256bit<true, false, false>,
+				&jpl::__jump_pair_256bit<true, true, false> };
+			jump_fns rev = { 
+				&jpl::__jump_256bit<false, true>, 
+				&jpl::__jump_256bit<true, true>,
+				&jpl::__jump_pair_256bit<false, false, true>,
+				&jpl::__jump_pair_256bit<false, true, true>,
+				&jpl::__jump_pair_256bit<true, false, true>,
+				&jpl::__jump_pair_256bit<true, true, true> };
+			forward_fns_ = fwd;
+			reverse_fns_ = rev;
+			break;
+		}
+#endif
+		default:
+		{
+			scan_width_ = warthog::jps::SCAN_64BIT;
+			jump_fns fwd = { 
+				&jpl::__jump_64bit<false, false>, 
+				&jpl::__jump_64bit<true, false>,
+				&jpl::__jump_pair_64bit<false, false, false>,
+				&jpl::__jump_pair_64bit<false, true, false>,
+				&jpl::__jump_pair_64bit<true, false, false>,
+				&jpl::__jump_pair_64bit<true, true, false> };
+			jump_fns rev = { 
+				&jpl::__jump_64bit<false, true>, 
+				&jpl::__jump_64bit<true, true>,
+				&jpl::__jump_pair_64bit<false, false, true>,
+				&jpl::__jump_pair_64bit<false, true, true>,
+				&jpl::__jump_pair_64bit<true, false, true>,
+				&jpl::__jump_pair_64bit<true, true, true> };
+			forward_fns_ = fwd;
+			reverse_fns_ = rev;
+			break;
+		}
+	}
+}
+
 // create a copy of the grid map which is rotated by 90 degrees clockwise.
 // this version will be used when jumping North or South. 
 warthog::gridmap*
@@ -56,8 +381,7 @@ warthog::jps::online_jump_point_locator2::jump(warthog::jps::direction d,
 		std::vector<uint32_t>& jpoints,
 		std::vector<double>& costs)
 {
-    __jump_east_fp = &warthog::jps::online_jump_point_locator2::__jump_east;
-    __jump_west_fp = &warthog::jps::online_jump_point_locator2::__jump_west;
+    fns_ = &forward_fns_;
 
 	// cache node and goal ids so we don't need to convert all the time
 	if(goal_id != current_goal_id_)
@@ -114,8 +438,7 @@ warthog::jps::online_jump_point_locator2::rjump(warthog::jps::direction d,
 		std::vector<uint32_t>& jpoints,
 		std::vector<double>& costs)
 {
-    __jump_east_fp = &warthog::jps::online_jump_point_locator2::__rjump_east;
-    __jump_west_fp = &warthog::jps::online_jump_point_locator2::__rjump_west;
+    fns_ = &reverse_fns_;
 
 	// cache node and goal ids so we don't need to convert all the time
 	if(goal_id != current_goal_id_)
@@ -189,7 +512,7 @@ warthog::jps::online_jump_point_locator2::__jump_north(uint32_t node_id,
 {
 	// jumping north in the original map is the same as jumping
 	// east when we use a version of the map rotated 90 degrees.
-	(this->*(__jump_east_fp))(node_id, goal_id, jumpnode_id, jumpcost, mymap);
+	(this->*(fns_->east_))(node_id, goal_id, jumpnode_id, jumpcost, mymap);
 }
 
 void
@@ -220,7 +543,7 @@ warthog::jps::online_jump_point_locator2::__jump_south(uint32_t node_id,
 {
 	// jumping north in the original map is the same as jumping
 	// west when we use a version of the map rotated 90 degrees.
-	(this->*(__jump_west_fp))(node_id, goal_id, jumpnode_id, jumpcost, mymap);
+	(this->*(fns_->west_))(node_id, goal_id, jumpnode_id, jumpcost, mymap);
 }
 
 void
@@ -233,7 +556,7 @@ warthog::jps::online_jump_point_locator2::jump_east(
 	uint32_t jumpnode_id;
 	double jumpcost;
 
-	(this->*(__jump_east_fp))(node_id, goal_id, jumpnode_id, jumpcost, map_);
+	(this->*(fns_->east_))(node_id, goal_id, jumpnode_id, jumpcost, map_);
 
 	if(jumpnode_id != warthog::INF)
 	{
@@ -392,7 +715,7 @@ warthog::jps::online_jump_point_locator2::jump_west(
 	uint32_t jumpnode_id;
 	double jumpcost;
 
-	(this->*(__jump_west_fp))(node_id, goal_id, jumpnode_id, jumpcost, map_);
+	(this->*(fns_->west_))(node_id, goal_id, jumpnode_id, jumpcost, map_);
 
 	if(jumpnode_id != warthog::INF)
 	{
@@ -593,8 +916,8 @@ warthog::jps::online_jump_point_locator2::__jump_northeast(
 
 		// recurse straight before stepping again diagonally;
 		// (ensures we do not miss any optimal turning points)
-		__jump_north(rnode_id, rgoal_id, jp_id1, cost1, rmap_);
-		(this->*(__jump_east_fp))(node_id, goal_id, jp_id2, cost2, map_);
+		(this->*(fns_->northeast_))(rnode_id, rgoal_id, jp_id1, cost1, 
+				node_id, goal_id, jp_id2, cost2);
 		if((jp_id1 & jp_id2) != warthog::INF) { break; }
 
 		// couldn't move in a straight dir; next step is an obstacle
@@ -684,8 +1007,8 @@ warthog::jps::online_jump_point_locator2::__jump_northwest(
 
 		// recurse straight before stepping again diagonally;
 		// (ensures we do not miss any optimal turning points)
-		__jump_north(rnode_id, rgoal_id, jp_id1, cost1, rmap_);
-		(this->*(__jump_west_fp))(node_id, goal_id, jp_id2, cost2, map_);
+		(this->*(fns_->northwest_))(rnode_id, rgoal_id, jp_id1, cost1, 
+				node_id, goal_id, jp_id2, cost2);
 		if((jp_id1 & jp_id2) != warthog::INF) { break; }
 
 		// couldn't move in a straight dir; next step is an obstacle
@@ -774,8 +1097,8 @@ warthog::jps::online_jump_point_locator2::__jump_southeast(
 
 		// recurse straight before stepping again diagonally;
 		// (ensures we do not miss any optimal turning points)
-		__jump_south(rnode_id, rgoal_id, jp_id1, cost1, rmap_);
-		(this->*(__jump_east_fp))(node_id, goal_id, jp_id2, cost2, map_);
+		(this->*(fns_->southeast_))(rnode_id, rgoal_id, jp_id1, cost1, 
+				node_id, goal_id, jp_id2, cost2);
 		if((jp_id1 & jp_id2) != warthog::INF) { break; }
 
 		// couldn't move in a straight dir; next step is an obstacle
@@ -861,8 +1184,8 @@ warthog::jps::online_jump_point_locator2::__jump_southwest(
 
 		// recurse straight before stepping again diagonally;
 		// (ensures we do not miss any optimal turning points)
-		__jump_south(rnode_id, rgoal_id, jp_id1, cost1, rmap_);
-		(this->*(__jump_west_fp))(node_id, goal_id, jp_id2, cost2, map_);
+		(this->*(fns_->southwest_))(rnode_id, rgoal_id, jp_id1, cost1, 
+				node_id, goal_id, jp_id2, cost2);
 		if((jp_id1 & jp_id2) != warthog::INF) { break; }
 
 		// couldn't move in a straight dir; next step is an obstacle
@@ -875,3 +1198,85 @@ warthog::jps::online_jump_point_locator2::__jump_southwest(
 	jumpnode_id = node_id;
 	jumpcost = num_steps*warthog::DBL_ROOT_TWO;
 }
+
+template<bool WEST, bool REVERSE>
+void
+warthog::jps::online_jump_point_locator2::__jump_64bit(uint32_t node_id, 
+		uint32_t goal_id, uint32_t& jumpnode_id, double& jumpcost, 
+		warthog::gridmap* mymap)
+{
+	scan_state s = { mymap, node_id, node_id, false };
+	while(!scan_64bit<WEST, REVERSE>(s)) { }
+	jump_result<WEST>(s, goal_id, jumpnode_id, jumpcost);
+}
+
+template<bool RWEST, bool WEST>
+void
+warthog::jps::online_jump_point_locator2::__jump_pair_seq(
+		uint32_t rnode_id, uint32_t rgoal_id,
+		uint32_t& jp1_id, double& jp1_cost,
+		uint32_t node_id, uint32_t goal_id,
+		uint32_t& jp2_id, double& jp2_cost)
+{
+	(this->*(RWEST ? fns_->west_ : fns_->east_))(
+			rnode_id, rgoal_id, jp1_id, jp1_cost, rmap_);
+	(this->*(WEST ? fns_->west_ : fns_->east_))(
+			node_id, goal_id, jp2_id, jp2_cost, map_);
+}
+
+template<bool RWEST, bool WEST, bool REVERSE>
+void
+warthog::jps::online_jump_point_locator2::__jump_pair_64bit(
+		uint32_t rnode_id, uint32_t rgoal_id,
+		uint32_t& jp1_id, double& jp1_cost,
+		uint32_t node_id, uint32_t goal_id,
+		uint32_t& jp2_id, double& jp2_cost)
+{
+	// the two jumps read different parts of memory and are independent.
+	// most of them stop in the first window, so the first windows are
+	// read together and the cpu can work on both at once. the jumps
+	// that go further are finished one at a time; advancing them in
+	// lockstep costs more in branch mispredictions than it saves.
+	scan_state s1 = { rmap_, rnode_id, rnode_id, false };
+	scan_state s2 = { map_, node_id, node_id, false };
+	bool done1 = scan_64bit<RWEST, REVERSE>(s1);
+	bool done2 = scan_64bit<WEST, REVERSE>(s2);
+	while(!done1) { done1 = scan_64bit<RWEST, REVERSE>(s1); }
+	while(!done2) { done2 = scan_64bit<WEST, REVERSE>(s2); }
+	jump_result<RWEST>(s1, rgoal_id, jp1_id, jp1_cost);
+	jump_result<WEST>(s2, goal_id, jp2_id, jp2_cost);
+}
+
+#ifdef WARTHOG_JPS_AVX2
+template<bool WEST, bool REVERSE>
+__attribute__((target("avx2"))) void
+warthog::jps::online_jump_point_locator2::__jump_256bit(uint32_t node_id, 
+		uint32_t goal_id, uint32_t& jumpnode_id, double& jumpcost, 
+		warthog::gridmap* mymap)
+{
+	scan_state s = { mymap, node_id, node_id, false };
+	if(!scan_64bit<WEST, REVERSE>(s))
+	{
+		while(!scan_256bit<WEST, REVERSE>(s)) { }
+	}
+	jump_result<WEST>(s, goal_id, jumpnode_id, jumpcost);
+}
+
+template<bool RWEST, bool WEST, bool REVERSE>
+__attribute__((target("avx2"))) void
+warthog::jps::online_jump_point_locator2::__jump_pair_256bit(
+		uint32_t rnode_id, uint32_t rgoal_id,
+		uint32_t& jp1_id, double& jp1_cost,
+		uint32_t node_id, uint32_t goal_id,
+		uint32_t& jp2_id, double& jp2_cost)
+{
+	scan_state s1 = { rmap_, rnode_id, rnode_id, false };
+	scan_state s2 = { map_, node_id, node_id, false };
+	bool done1 = scan_64bit<RWEST, REVERSE>(s1);
+	bool done2 = scan_64bit<WEST, REVERSE>(s2);
+	while(!done1) { done1 = scan_256bit<RWEST, REVERSE>(s1); }
+	while(!done2) { done2 = scan_256bit<WEST, REVERSE>(s2); }
+	jump_result<RWEST>(s1, rgoal_id, jp1_id, jp1_cost);
+	jump_result<WEST>(s2, goal_id, jp2_id, jp2_cost);
+}
+#endif
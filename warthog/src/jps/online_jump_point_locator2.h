@@ -10,6 +10,13 @@
 // [Harabor D. and Grastien A, 2011, 
 // Online Graph Pruning Pathfinding on Grid Maps, AAAI]
 //
+// Straight jumps read the map in windows of 32, 64 or 256 tiles
+// (see warthog::jps::scan_width). The widest variant that the cpu
+// supports is selected at runtime; all variants find the same jump
+// points. When scanning 64 or 256 tiles at a time, each step of a
+// diagonal jump reads the first window of its two straight sub-scans
+// together, so that their memory reads overlap.
+//
 // @author: dharabor
 // @created: 03/09/2012
 //
@@ -24,12 +31,41 @@ namespace warthog
 namespace jps
 {
 
+// the number of tiles examined by each step of a straight jump.
+// SCAN_256BIT requires a cpu with AVX2.
+typedef enum
+{
+	SCAN_32BIT = 32,
+	SCAN_64BIT = 64,
+	SCAN_256BIT = 256
+} scan_width;
+
 class online_jump_point_locator2
 {
 	public: 
 		online_jump_point_locator2(warthog::gridmap* map);
 		~online_jump_point_locator2();
 
+		// the widest scan supported by the current cpu
+		static warthog::jps::scan_width
+		cpu_scan_width();
+
+		// the scan width expected to be fastest on the current map.
+		// this is the default. 256-tile windows only pay off when 
+		// straight jumps are long, so SCAN_256BIT is chosen only for 
+		// maps whose rows and columns of traversable tiles are, on 
+		// average, at least 256 tiles long.
+		warthog::jps::scan_width
+		best_scan_width();
+
+		// choose how many tiles to examine per step during straight
+		// jumps. widths the cpu cannot run fall back to SCAN_64BIT.
+		void
+		set_scan_width(warthog::jps::scan_width width);
+
+		inline warthog::jps::scan_width
+		get_scan_width() { return scan_width_; }
+
 		void
 		jump(warthog::jps::direction d, uint32_t node_id, uint32_t goalid, 
 				std::vector<uint32_t>& jpoints,
@@ -146,6 +182,48 @@ class online_jump_point_locator2
 				uint32_t& jumpnode_id, double& jumpcost, 
 				warthog::gridmap* mymap);
 
+		// straight jumps that read 64 or 256 tiles at a time.
+		// WEST selects the direction of travel and REVERSE selects
+		// the ::rjump variant.
+		template<bool WEST, bool REVERSE>
+		void
+		__jump_64bit(uint32_t node_id, uint32_t goal_id, 
+				uint32_t& jumpnode_id, double& jumpcost, 
+				warthog::gridmap* mymap);
+
+		template<bool WEST, bool REVERSE>
+		void
+		__jump_256bit(uint32_t node_id, uint32_t goal_id, 
+				uint32_t& jumpnode_id, double& jumpcost, 
+				warthog::gridmap* mymap);
+
+		// the two straight jumps made at every step of a diagonal
+		// jump: one on rmap_ (north or south) and one on map_ (east 
+		// or west). RWEST and WEST give the direction of travel on 
+		// each map. the _seq variant makes one jump after the other.
+		// the others examine the first window of both jumps before
+		// finishing either one.
+		template<bool RWEST, bool WEST>
+		void
+		__jump_pair_seq(uint32_t rnode_id, uint32_t rgoal_id,
+				uint32_t& jp1_id, double& jp1_cost,
+				uint32_t node_id, uint32_t goal_id,
+				uint32_t& jp2_id, double& jp2_cost);
+
+		template<bool RWEST, bool WEST, bool REVERSE>
+		void
+		__jump_pair_64bit(uint32_t rnode_id, uint32_t rgoal_id,
+				uint32_t& jp1_id, double& jp1_cost,
+				uint32_t node_id, uint32_t goal_id,
+				uint32_t& jp2_id, double& jp2_cost);
+
+		template<bool RWEST, bool WEST, bool REVERSE>
+		void
+		__jump_pair_256bit(uint32_t rnode_id, uint32_t rgoal_id,
+				uint32_t& jp1_id, double& jp1_cost,
+				uint32_t node_id, uint32_t goal_id,
+				uint32_t& jp2_id, double& jp2_cost);
+
 
 		// functions to convert map indexes to rmap indexes
 		inline uint32_t
@@ -187,15 +265,34 @@ class online_jump_point_locator2
 		uint32_t current_node_id_;
 		uint32_t current_rnode_id_;
 
-        // these function pointers allow us to switch between forward jumping
-        // and backward jumping (i.e. with the parent direction reversed)
-        void (warthog::jps::online_jump_point_locator2::*__jump_east_fp)
+        typedef void (warthog::jps::online_jump_point_locator2::*straight_fn)
             (uint32_t node_id, uint32_t goal_id, uint32_t& jumpnode_id, 
              double& jumpcost, warthog::gridmap* mymap);
 
-        void (warthog::jps::online_jump_point_locator2::*__jump_west_fp)
-            (uint32_t node_id, uint32_t goal_id, uint32_t& jumpnode_id, 
-             double& jumpcost, warthog::gridmap* mymap);
+        typedef void (warthog::jps::online_jump_point_locator2::*pair_fn)
+            (uint32_t rnode_id, uint32_t rgoal_id, 
+             uint32_t& jp1_id, double& jp1_cost,
+             uint32_t node_id, uint32_t goal_id,
+             uint32_t& jp2_id, double& jp2_cost);
+
+        // the jump functions for one scan width and one parent direction
+        struct jump_fns
+        {
+            straight_fn east_;
+            straight_fn west_;
+            pair_fn northeast_;
+            pair_fn northwest_;
+            pair_fn southeast_;
+            pair_fn southwest_;
+        };
+
+        // these function pointers allow us to switch between forward jumping
+        // and backward jumping (i.e. with the parent direction reversed).
+        // fns_ points to one of the other two.
+        jump_fns forward_fns_;
+        jump_fns reverse_fns_;
+        jump_fns* fns_;
+        warthog::jps::scan_width scan_width_;
 
 };
 }
@@ -22,6 +22,7 @@
 //  @created: 2017-04-15
 //
 
+#include "callback_listener.h"
 #include "flexible_astar.h"
 #include "helpers.h"
 #include "xy_graph.h"
@@ -147,7 +148,8 @@ class af_labelling
                 warthog::flexible_astar< 
                     warthog::zero_heuristic, 
                     t_expander, 
-                    warthog::pqueue_min>
+                    warthog::pqueue_min,
+                    warthog::callback_listener>
                         dijkstra(&heuristic, expander.get(), &open);
             
                 // helper function to track the first edge on the path from 
@@ -174,20 +176,15 @@ class af_labelling
                         }
                     };
 
-                dijkstra.apply_on_relax(relax_fn);
+                dijkstra.get_listener()->apply_on_relax(relax_fn);
 
-                for(uint32_t i = 0; 
-                        i < shared->workload_->num_flags_set(); i++)
+                uint32_t i;
+                while(warthog::helpers::next_task(par, i))
                 {
                     // skip any nodes not part of the precomputation workload
                     if(!shared->workload_->get_flag(i))
                     { continue; }
 
-                    // source nodes are evenly divided among all threads;
-                    // skip any source nodes not intended for current thread
-                    if((i % par->max_threads_) != par->thread_id_) 
-                    { continue; }
-
                     // process the source
                     uint32_t source_id = i;
                     warthog::graph::node* source = 
@@ -221,7 +218,7 @@ class af_labelling
                     for(uint32_t i = 0; i < source->out_degree(); i++)
                     {
                         uint8_t* label = 
-                            new uint8_t[shared->lab_->bytes_per_label_];
+                            new uint8_t[shared->lab_->bytes_per_label_]();
                         shared->lab_->flags_->at(source_id).push_back(label);
                     }
 
@@ -250,7 +247,8 @@ class af_labelling
                             label[part_id >> 3] |= (1 << (part_id & 7));
                         };
                     dijkstra.apply_to_closed(fn_arcflags);
-                    par->nprocessed_++;
+                    __atomic_fetch_add(
+                            &par->nprocessed_, 1, __ATOMIC_RELAXED);
                 }
                 return 0;
             };
@@ -262,7 +260,8 @@ class af_labelling
             shared.fn_new_expander_ = fn_new_expander;
             shared.workload_ = workload;
             warthog::helpers::parallel_compute(thread_compute_fn, 
-                    &shared, workload->num_flags_set());
+                    &shared, workload->num_flags_set(),
+                    g->get_num_nodes());
             std::cerr << "\nall done\n"<< std::endl;
             return lab;
         }
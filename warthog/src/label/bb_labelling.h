@@ -17,6 +17,7 @@
 // @created: 2017-04-18
 //
 
+#include "callback_listener.h"
 #include "flexible_astar.h"
 #include "helpers.h"
 #include "geom.h"
@@ -100,7 +101,8 @@ class bb_labelling
                 warthog::flexible_astar<
                     warthog::zero_heuristic, 
                     t_expander, 
-                    warthog::pqueue_min>
+                    warthog::pqueue_min,
+                    warthog::callback_listener>
                          dijkstra(&heuristic, expander.get(), &open);
 
                 // need to keep track of the first edge on the way to the 
@@ -126,18 +128,14 @@ class bb_labelling
                         }
                     };
 
-                dijkstra.apply_on_relax(relax_fn);
+                dijkstra.get_listener()->apply_on_relax(relax_fn);
 
-                for(uint32_t i = 0; 
-                        i < shared->workload_->num_flags_set(); i++)
+                uint32_t i;
+                while(warthog::helpers::next_task(par, i))
                 {
                     // skip nodes not in the workload
                     if(!shared->workload_->get_flag(i)) { continue; }
 
-                    // source nodes are evenly divided among all threads;
-                    // skip any source nodes not intended for current thread
-                    if((i % par->max_threads_) != par->thread_id_) { continue; }
-
                     // process the source
                     uint32_t source_id = i;
                     uint32_t ext_source_id = 
@@ -206,7 +204,8 @@ class bb_labelling
                                     (*it).second).is_valid());
                     };
                     dijkstra.apply_to_closed(bbox_fn);
-                    par->nprocessed_++;
+                    __atomic_fetch_add(
+                            &par->nprocessed_, 1, __ATOMIC_RELAXED);
                 }
                 return 0;
             };
@@ -216,7 +215,8 @@ class bb_labelling
             shared.fn_new_expander_ = fn_new_expander;
             shared.workload_ = workload;
             warthog::helpers::parallel_compute(
-                    thread_compute_fn, &shared, workload->num_flags_set());
+                    thread_compute_fn, &shared, 
+                    workload->num_flags_set(), g->get_num_nodes());
             return shared.lab_;
         }
 
@@ -9,6 +9,7 @@
 // @created: 2017-04-22
 //
 
+#include "callback_listener.h"
 #include "flexible_astar.h"
 #include "geom.h"
 #include "helpers.h"
@@ -165,7 +166,8 @@ class bbaf_labelling
                 warthog::flexible_astar<
                     warthog::zero_heuristic, 
                     t_expander,
-                    warthog::pqueue_min>
+                    warthog::pqueue_min,
+                    warthog::callback_listener>
                         dijkstra(&heuristic, expander.get(), &open);
 
                 // need to keep track of the first edge on the way to the 
@@ -190,21 +192,16 @@ class bbaf_labelling
                     }
                 };
 
-                dijkstra.apply_on_relax(relax_fn);
+                dijkstra.get_listener()->apply_on_relax(relax_fn);
 
                 // run a dijkstra search from each node
                 warthog::graph::xy_graph* g_ = shared->lab_->g_;
-                for(uint32_t i = 0;
-                        i < shared->workload_->num_flags_set(); i++)
+                uint32_t i;
+                while(warthog::helpers::next_task(par, i))
                 {
                     // skip nodes not in the workload
                     if(!shared->workload_->get_flag(i)) { continue; }
 
-                    // source nodes are evenly divided among all threads;
-                    // skip any source nodes not intended for current thread
-                    if((i % par->max_threads_) != par->thread_id_) 
-                    { continue; }
-
                     // process the source node (i.e. run a dijkstra search)
                     uint32_t source_id = i;
                     uint32_t ext_source_id = g_->to_external_id(source_id);
@@ -234,7 +231,7 @@ class bbaf_labelling
                     {
                         bbaf_label label;
                         label.flags_= 
-                            new uint8_t[shared->lab_->bytes_per_af_label_];
+                            new uint8_t[shared->lab_->bytes_per_af_label_]();
                         shared->lab_->labels_.at(source_id).push_back(label);
                     }
 
@@ -273,7 +270,8 @@ class bbaf_labelling
                                 e_idx).bbox_.is_valid());
                     };
                     dijkstra.apply_to_closed(fn_arcflags);
-                    par->nprocessed_++;
+                    __atomic_fetch_add(
+                            &par->nprocessed_, 1, __ATOMIC_RELAXED);
                 }
                 return 0;
             };
@@ -285,7 +283,8 @@ class bbaf_labelling
             shared.fn_new_expander_ = fn_new_expander;
             shared.workload_ = workload;
             warthog::helpers::parallel_compute(thread_compute_fn, &shared, 
-                    workload->num_flags_set());
+                    workload->num_flags_set(),
+                    g->get_num_nodes());
             return lab;
         }
 
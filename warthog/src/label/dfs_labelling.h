@@ -21,6 +21,7 @@
 // 
 
 #include "bbaf_labelling.h"
+#include "callback_listener.h"
 #include "fch_expansion_policy.h"
 #include "geom.h"
 #include "solution.h"
@@ -346,22 +347,19 @@ class dfs_labelling
                 warthog::flexible_astar 
                     <warthog::zero_heuristic, 
                     warthog::fch_expansion_policy,
-                    warthog::pqueue_min>
+                    warthog::pqueue_min,
+                    warthog::callback_listener>
                         dijk(&h, expander.get(), &open);
-                dijk.apply_on_generate(on_generate_fn);
-                dijk.apply_on_expand(on_expand_fn);
+                dijk.get_listener()->apply_on_generate(on_generate_fn);
+                dijk.get_listener()->apply_on_expand(on_expand_fn);
 
-                for(uint32_t i = 0; i < lab->g_->get_num_nodes(); i++)
+                uint32_t i;
+                while(warthog::helpers::next_task(par, i))
                 {
                     // skip any nodes not part of the precomputation workload
                     if(!workload->get_flag(i))
                     { continue; }
 
-                    // source nodes are evenly divided among all threads;
-                    // skip any source nodes not intended for current thread
-                    if((i % par->max_threads_) != par->thread_id_) 
-                    { continue; }
-
                     source_id = i;
                     uint32_t ext_source_id = 
                         lab->g_->to_external_id(source_id);
@@ -370,7 +368,8 @@ class dfs_labelling
                     //problem.verbose_ = true;
                     warthog::solution sol;
                     dijk.get_path(problem, sol);
-                    par->nprocessed_++;
+                    __atomic_fetch_add(
+                            &par->nprocessed_, 1, __ATOMIC_RELAXED);
                 }
                 return 0;
             };
@@ -387,7 +386,8 @@ class dfs_labelling
             std::cerr << "computing dijkstra labels\n";
             warthog::helpers::parallel_compute(
                     thread_compute_fn, &shared, 
-                    workload->num_flags_set());
+                    workload->num_flags_set(),
+                    g->get_num_nodes());
 
             std::cerr << "computing dfs labels...\n";
             workload->set_all_flags_complement();
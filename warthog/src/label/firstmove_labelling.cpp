@@ -3,6 +3,7 @@
 #include "xy_graph.h"
 
 #include <algorithm>
+#include <cstdio>
 
 warthog::label::firstmove_labelling::firstmove_labelling(
         warthog::graph::xy_graph* g)
@@ -95,7 +96,7 @@ warthog::label::operator<<(std::ostream& out,
     uint32_t num_rows = 0;
     for(uint32_t n_id = 0; n_id < lab.g_->get_num_nodes(); n_id++)
     {
-        if(lab.lab_->size() > 0) { num_rows++; }
+        if(lab.lab_->at(n_id).size() > 0) { num_rows++; }
     }
     out.write((char*)(&num_rows), 4);
 
@@ -133,6 +134,143 @@ warthog::label::operator<<(std::ostream& out,
     return out;
 }
 
+std::string
+warthog::label::firstmove_labelling::shard_name(
+        const char* filename, uint32_t shard_id)
+{
+    return std::string(filename) + ".shard." + std::to_string(shard_id);
+}
+
+void
+warthog::label::firstmove_labelling::write_row(
+        std::ostream& out, uint32_t row_id, std::vector<fm_run>& row)
+{
+    uint32_t num_runs = row.size();
+    out.write((char*)(&row_id), 4);
+    out.write((char*)(&num_runs), 4);
+    for(uint32_t run = 0; run < num_runs; run++)
+    {
+        out << row.at(run);
+    }
+}
+
+bool
+warthog::label::firstmove_labelling::scan_shards(
+        const char* filename, uint32_t num_nodes,
+        std::vector<shard_row>& index, uint32_t& num_shards)
+{
+    const uint64_t RUN_BYTES = 5;
+    index.assign(num_nodes, shard_row{UINT32_MAX, 0});
+
+    for(num_shards = 0; ; num_shards++)
+    {
+        std::string shard_file = shard_name(filename, num_shards);
+        std::ifstream ifs(shard_file.c_str(), 
+                std::ios_base::in | std::ios_base::binary);
+        if(!ifs.good()) { break; }
+
+        ifs.seekg(0, std::ios_base::end);
+        uint64_t file_size = ifs.tellg();
+        ifs.seekg(0, std::ios_base::beg);
+
+        uint64_t offset = 0;
+        while(offset + 8 <= file_size)
+        {
+            uint32_t row_id, num_runs;
+            ifs.read((char*)(&row_id), 4);
+            ifs.read((char*)(&num_runs), 4);
+            if(!ifs.good()) { break; }
+
+            // a row cut short by an interrupted run
+            uint64_t row_end = offset + 8 + num_runs * RUN_BYTES;
+            if(row_end > file_size) { break; }
+
+            if(row_id >= num_nodes)
+            {
+                std::cerr << "err; " << shard_file << " contains invalid "
+                    << "row id " << row_id << ". aborting.\n";
+                return false;
+            }
+            if(index[row_id].shard_ == UINT32_MAX)
+            {
+                index[row_id] = shard_row{num_shards, offset};
+            }
+
+            ifs.seekg(row_end, std::ios_base::beg);
+            offset = row_end;
+        }
+    }
+    return true;
+}
+
+bool
+warthog::label::firstmove_labelling::merge_shards(
+        const char* filename, uint32_t num_nodes)
+{
+    std::vector<shard_row> index;
+    uint32_t num_shards;
+    if(!scan_shards(filename, num_nodes, index, num_shards)) 
+    { return false; }
+
+    std::cerr << "merging " << num_shards << " shards into " 
+        << filename << "\n";
+    std::vector<std::ifstream> shards(num_shards);
+    for(uint32_t i = 0; i < num_shards; i++)
+    {
+        shards[i].open(shard_name(filename, i).c_str(), 
+                std::ios_base::in | std::ios_base::binary);
+    }
+
+    std::ofstream out(filename, 
+            std::ios_base::out | std::ios_base::binary | 
+            std::ios_base::trunc);
+    uint32_t num_rows = 0;
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        num_rows += (index[i].shard_ != UINT32_MAX);
+    }
+    out.write((char*)(&num_rows), 4);
+
+    // copy rows in order of node id, one row in memory at a time
+    std::vector<fm_run> row;
+    for(uint32_t row_id = 0; row_id < num_nodes; row_id++)
+    {
+        if(index[row_id].shard_ == UINT32_MAX) { continue; }
+        std::ifstream& in = shards[index[row_id].shard_];
+        in.seekg(index[row_id].offset_ + 4, std::ios_base::beg);
+
+        uint32_t num_runs;
+        in.read((char*)(&num_runs), 4);
+        row.resize(num_runs);
+        for(uint32_t run = 0; run < num_runs; run++)
+        {
+            in >> row[run];
+        }
+        if(!in.good())
+        {
+            std::cerr << "err; while reading row " << row_id 
+                << " from shard " << index[row_id].shard_ << "\n";
+            return false;
+        }
+        write_row(out, row_id, row);
+    }
+
+    out.close();
+    if(!out.good())
+    {
+        std::cerr << "\nerror trying to write to file " 
+            << filename << std::endl;
+        return false;
+    }
+
+    for(uint32_t i = 0; i < num_shards; i++)
+    {
+        shards[i].close();
+        std::remove(shard_name(filename, i).c_str());
+    }
+    return true;
+}
+
 void
 warthog::label::compute_fm_dfs_preorder(
         warthog::graph::xy_graph& g, 
@@ -332,7 +470,8 @@ warthog::label::compute_fm_fch_dijkstra_dfs_preorder(
     warthog::flexible_astar<
         warthog::zero_heuristic, 
         warthog::fch_expansion_policy,
-        warthog::pqueue_min>
+        warthog::pqueue_min,
+        warthog::callback_listener>
             dijk(&heur, &exp, &open);
 
     uint32_t source_id;
@@ -367,7 +506,7 @@ warthog::label::compute_fm_fch_dijkstra_dfs_preorder(
         }
     };
 
-    dijk.apply_on_generate(on_generate_fn);
+    dijk.get_listener()->apply_on_generate(on_generate_fn);
     source_id = rand() % g.get_num_nodes();
     uint32_t ext_source_id = g.to_external_id(source_id);
     warthog::problem_instance problem(ext_source_id, warthog::INF);
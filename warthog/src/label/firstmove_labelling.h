@@ -21,11 +21,13 @@
 // 
 
 #include "bbaf_labelling.h"
+#include "callback_listener.h"
 #include "geom.h"
 #include "solution.h"
 #include "timer.h"
 
 #include <fstream>
+#include <string>
 #include <vector>
 #include <cstdint>
 
@@ -149,7 +151,7 @@ struct fm_coll
 
         for(uint32_t i = 0; i < NUM_QUAD_WORDS; i++)
         { 
-            retval.moves_[i*8] = 
+            *(uint64_t*)(&retval.moves_[i*8]) = 
             *(uint64_t*)(&moves_[i*8]) & *(uint64_t*)(&other.moves_[i*8]); 
         }
 
@@ -190,7 +192,7 @@ struct fm_coll
     {
         // __builtin_ffs takes 32bit operands; stride label 4 bytes at a time
         const uint32_t NUM_DOUBLE_WORDS = FM_MAX_BYTES >> 2;
-        for(uint32_t i = 0; i < NUM_DOUBLE_WORDS; i+=4)
+        for(uint32_t i = 0; i < NUM_DOUBLE_WORDS; i++)
         {
             uint32_t index = __builtin_ffs(*(uint32_t*)(&moves_[i*4]));
             if(index)
@@ -205,7 +207,7 @@ struct fm_coll
             uint32_t index = __builtin_ffs(moves_[i]);
             if(index)
             {
-                return NUM_DOUBLE_WORDS*32 + i*8 + index;
+                return i*8 + index;
             }
         }
         
@@ -254,6 +256,8 @@ class firstmove_labelling
     friend std::istream&
     operator>>(std::istream& in, firstmove_labelling& lab);
 
+    friend class firstmove_table;
+
     public:
 
         ~firstmove_labelling();
@@ -265,7 +269,9 @@ class firstmove_labelling
         }
 
         // @param node_id: the current node
-        // @param target_id: the target node
+        // @param target_id: the column of the target node in the column
+        // order used for compression (see firstmove_table, which also
+        // maps node ids to columns)
         //
         // @return the index of the first optimal move, from @param 
         // node_id to @param target_id
@@ -356,18 +362,101 @@ class firstmove_labelling
                 std::vector<uint32_t>* column_order,
                 std::function<t_expander*(void)>& fn_new_expander,
                 warthog::util::workload_manager* workload)
+        {
+            if(g == 0 || column_order == 0) { return 0; } 
+
+            warthog::label::firstmove_labelling* lab = 
+                new warthog::label::firstmove_labelling(g);
+            compute_rows(lab, column_order, fn_new_expander, workload, 0, 0);
+            return lab;
+        }
+
+        // compute labels for all nodes specified by the given workload
+        // and save them to @param filename, in the format read by ::load.
+        //
+        // unlike ::compute, rows are not kept in memory. each thread
+        // appends every row it finishes to a shard file of its own
+        // (@param filename.shard.N), so memory use stays at about one
+        // uncompressed row per thread. once all rows are done, the 
+        // shards are merged into @param filename and deleted. 
+        //
+        // if a previous run was interrupted, the rows already in its
+        // shards are removed from @param workload and are not computed
+        // again.
+        //
+        // @return true if every row in the workload was written
+        template <typename t_expander>
+        static bool
+        compute_to_file(const char* filename, 
+                warthog::graph::xy_graph* g, 
+                std::vector<uint32_t>* column_order,
+                std::function<t_expander*(void)>& fn_new_expander,
+                warthog::util::workload_manager* workload)
+        {
+            if(g == 0 || column_order == 0) { return false; } 
+
+            // pick up where any earlier run left off
+            std::vector<shard_row> index;
+            uint32_t num_shards = 0;
+            if(!scan_shards(filename, g->get_num_nodes(), index, num_shards))
+            { return false; }
+
+            uint32_t num_done = 0;
+            for(uint32_t i = 0; i < index.size(); i++)
+            {
+                if(index[i].shard_ == UINT32_MAX || !workload->get_flag(i))
+                { continue; }
+                workload->set_flag(i, false);
+                num_done++;
+            }
+            if(num_shards > 0)
+            {
+                std::cerr << "resuming; " << num_done << " rows found in "
+                    << num_shards << " existing shards\n";
+            }
+
+            warthog::label::firstmove_labelling lab(g);
+            if(!compute_rows(&lab, column_order, fn_new_expander, 
+                        workload, filename, num_shards))
+            { return false; }
+
+            return merge_shards(filename, g->get_num_nodes());
+        }
+
+    private:
+        // the location of one row in a shard file
+        struct shard_row
+        {
+            uint32_t shard_;
+            uint64_t offset_;
+        };
+
+        // compute the rows of @param lab selected by @param workload.
+        // when @param shard_prefix is not null, rows are appended to
+        // shard files, numbered from @param first_shard, rather than 
+        // stored in @param lab
+        //
+        // @return false if a shard could not be written
+        template <typename t_expander>
+        static bool
+        compute_rows(warthog::label::firstmove_labelling* lab,
+                std::vector<uint32_t>* column_order,
+                std::function<t_expander*(void)>& fn_new_expander,
+                warthog::util::workload_manager* workload,
+                const char* shard_prefix, uint32_t first_shard)
         {
             warthog::timer t;
             t.start();
 
-            if(g == 0 || column_order == 0) { return 0; } 
-
             struct shared_data
             {
                 std::function<t_expander*(void)> fn_new_expander_;
                 warthog::label::firstmove_labelling* lab_;
                 warthog::util::workload_manager* workload_;
                 std::vector<uint32_t>* column_order_;
+                const char* shard_prefix_;
+                uint32_t first_shard_;
+                bool shard_error_;
             };
 
             // The actual precompute function. We construct a 
@@ -448,26 +537,29 @@ class firstmove_labelling
 
                 // run-length encoding to compress the firstmove data
                 // if there are several optimal moves available we (greedily)
-                // choose the one that maximises run length
+                // choose the one that maximises run length. a run keeps 
+                // only the moves that are optimal for all its columns;
+                // columns without any move (FM_NONE) also form runs
                 auto compress_fn = [&c_order] 
                     (std::vector<fm_coll>& row, 
                     std::vector<fm_run>& rle_row) -> void
                 {
                     fm_coll current = row.at(c_order->at(0));
                     uint32_t head = 0;
-                    for(uint32_t index = 0; index < row.size(); index++)
+                    for(uint32_t index = 1; index < row.size(); index++)
                     {
-                        uint32_t next_id = c_order->at(index);
-                        fm_coll tmp = current & row.at(next_id);
-                        if(!tmp.ffs())
-                        {
-                            uint32_t firstmove = current.ffs() - 1;
-                            rle_row.push_back(
-                                    fm_run{head, (uint8_t)firstmove});
-                            current = row.at(next_id);
-                            head = index;
-                        }
+                        fm_coll& next = row.at(c_order->at(index));
+                        fm_coll tmp = current & next;
+                        if(tmp.ffs()) { current = tmp; continue; }
+                        if(!current.ffs() && !next.ffs()) { continue; }
+
+                        uint32_t firstmove = current.ffs() - 1;
+                        rle_row.push_back(fm_run{head, (uint8_t)firstmove});
+                        current = next;
+                        head = index;
                     } 
+                    rle_row.push_back(
+                            fm_run{head, (uint8_t)(current.ffs() - 1)});
                 };
 
                 std::shared_ptr<t_expander> 
@@ -479,22 +571,38 @@ class firstmove_labelling
                 warthog::flexible_astar <
                     warthog::zero_heuristic, 
                     t_expander, 
-                    warthog::pqueue_min>
+                    warthog::pqueue_min,
+                    warthog::callback_listener>
                         dijk(&h, expander.get(), &open);
 
-                dijk.apply_on_generate(on_generate_fn);
+                dijk.get_listener()->apply_on_generate(on_generate_fn);
 
-                for(uint32_t i = 0; i < lab->g_->get_num_nodes(); i++)
+                // in streaming mode, rows go to a shard of our own
+                std::ofstream shard;
+                std::vector<fm_run> rle_row;
+                if(shared->shard_prefix_)
+                {
+                    std::string shard_file = shard_name(shared->shard_prefix_, 
+                            shared->first_shard_ + par->thread_id_);
+                    shard.open(shard_file.c_str(), 
+                            std::ios_base::out | std::ios_base::binary | 
+                            std::ios_base::trunc);
+                    if(!shard.good())
+                    {
+                        std::cerr << "err; cannot write to file " 
+                            << shard_file << std::endl;
+                        shared->shard_error_ = true;
+                        return 0;
+                    }
+                }
+
+                uint32_t i;
+                while(warthog::helpers::next_task(par, i))
                 {
                     // skip any nodes not part of the precomputation workload
                     if(!workload->get_flag(i))
                     { continue; }
 
-                    // source nodes are evenly divided among all threads;
-                    // skip any source nodes not intended for current thread
-                    if((i % par->max_threads_) != par->thread_id_) 
-                    { continue; }
-
                     source_id = i;
                     uint32_t ext_source_id = 
                         lab->g_->to_external_id(source_id);
@@ -506,39 +614,87 @@ class firstmove_labelling
                     s_row.clear();
                     s_row.resize(lab->g_->get_num_nodes());
                     dijk.get_path(problem, sol);
-                    compress_fn(s_row, lab->lab_->at(i));
+
+                    if(shard.is_open())
+                    {
+                        // the row is flushed whole, so an interrupted 
+                        // run loses at most the row being written
+                        rle_row.clear();
+                        compress_fn(s_row, rle_row);
+                        write_row(shard, i, rle_row);
+                        shard.flush();
+                        if(!shard.good())
+                        {
+                            std::cerr << "err; while writing row " << i 
+                                << " to shard\n";
+                            shared->shard_error_ = true;
+                            return 0;
+                        }
+                    }
+                    else
+                    {
+                        compress_fn(s_row, lab->lab_->at(i));
+                    }
 //                    std::cerr 
 //                        << "compressed row " << i
 //                        << " into " << lab->lab_->at(i).size() << " runs "
 //                        << std::endl;
-                    par->nprocessed_++;
+                    __atomic_fetch_add(
+                            &par->nprocessed_, 1, __ATOMIC_RELAXED);
                 }
                 return 0;
             };
 
-            warthog::label::firstmove_labelling* lab = 
-                new warthog::label::firstmove_labelling(g);
-
             shared_data shared;
             shared.fn_new_expander_ = fn_new_expander;
             shared.lab_ = lab;
             shared.workload_ = workload;
             shared.column_order_ = column_order;
+            shared.shard_prefix_ = shard_prefix;
+            shared.first_shard_ = first_shard;
+            shared.shard_error_ = false;
 
             std::cerr << "computing dijkstra labels\n";
             warthog::helpers::parallel_compute(
                     thread_compute_fn, &shared, 
-                    workload->num_flags_set());
+                    workload->num_flags_set(),
+                    lab->g_->get_num_nodes());
 
             t.stop();
             std::cerr 
                 << "total preproc time (seconds): "
                 << t.elapsed_time_micro() / 1000000 << "\n";
 
-            return lab;
+            return !shared.shard_error_;
         }
 
-    private:
+        // @return the name of shard number @param shard_id of the 
+        // labelling being written to @param filename
+        static std::string
+        shard_name(const char* filename, uint32_t shard_id);
+
+        // write a single row: its id, its length and then its runs.
+        // rows in shard files and in the final labelling file look
+        // the same.
+        static void
+        write_row(std::ostream& out, uint32_t row_id, 
+                std::vector<fm_run>& row);
+
+        // find the complete rows in the shards of @param filename.
+        // a row that is cut short (e.g. by a crash) is ignored.
+        // @param index: for each node, where its row is stored (rows
+        // not yet computed have shard_ == UINT32_MAX)
+        // @param num_shards: the number of shard files found
+        // @return false if a shard is invalid
+        static bool
+        scan_shards(const char* filename, uint32_t num_nodes,
+                std::vector<shard_row>& index, uint32_t& num_shards);
+
+        // combine all shards into @param filename, with rows in order
+        // of node id, and delete the shards.
+        static bool
+        merge_shards(const char* filename, uint32_t num_nodes);
+
         // only via ::compute or ::load please
         firstmove_labelling(warthog::graph::xy_graph* g);
 
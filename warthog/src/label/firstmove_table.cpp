@@ -0,0 +1,217 @@
+#include "firstmove_table.h"
+#include "xy_graph.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+
+inline uint64_t
+fmt_align(uint64_t offset)
+{
+    return (offset + warthog::label::FMT_ALIGNMENT - 1) &
+        ~(warthog::label::FMT_ALIGNMENT - 1);
+}
+
+// true if every array of the table @param hdr, mapped at @param base,
+// lies within the file and every row offset and column is in range
+bool
+valid_table(const warthog::label::fmt_header& hdr, const char* base)
+{
+    auto fits = [&hdr] (uint64_t offset, uint64_t bytes, uint64_t align)
+    {
+        return offset % align == 0 && offset <= hdr.file_size_ &&
+            bytes <= hdr.file_size_ - offset;
+    };
+    if(hdr.num_rows_ != hdr.num_nodes_ ||
+       !fits(hdr.col_offset_, sizeof(uint32_t) * (uint64_t)hdr.num_nodes_,
+           sizeof(uint32_t)) ||
+       !fits(hdr.row_index_offset_,
+           sizeof(uint64_t) * ((uint64_t)hdr.num_rows_ + 1),
+           sizeof(uint64_t)) ||
+       hdr.num_runs_ > hdr.file_size_ ||
+       !fits(hdr.heads_offset_, sizeof(uint32_t) * hdr.num_runs_,
+           sizeof(uint32_t)) ||
+       !fits(hdr.labels_offset_, sizeof(uint8_t) * hdr.num_runs_, 1))
+    {
+        return false;
+    }
+
+    const uint64_t* row_index =
+        (const uint64_t*)(base + hdr.row_index_offset_);
+    if(row_index[0] != 0 || row_index[hdr.num_rows_] != hdr.num_runs_)
+    {
+        return false;
+    }
+    for(uint32_t i = 0; i < hdr.num_rows_; i++)
+    {
+        if(row_index[i] > row_index[i+1]) { return false; }
+    }
+
+    const uint32_t* col = (const uint32_t*)(base + hdr.col_offset_);
+    for(uint32_t i = 0; i < hdr.num_nodes_; i++)
+    {
+        if(col[i] >= hdr.num_nodes_) { return false; }
+    }
+    return true;
+}
+
+}
+
+warthog::label::firstmove_table::firstmove_table()
+    : hdr_(0), col_(0), row_index_(0), heads_(0), labels_(0)
+{ }
+
+warthog::label::firstmove_table::~firstmove_table()
+{ }
+
+bool
+warthog::label::firstmove_table::save(const char* filename,
+        warthog::label::firstmove_labelling& lab,
+        std::vector<uint32_t>& column_order)
+{
+    std::vector< std::vector<fm_run> >& rows = *lab.lab_;
+    uint32_t num_nodes = lab.g_->get_num_nodes();
+    if(column_order.size() != num_nodes)
+    {
+        std::cerr << "err; column order has " << column_order.size()
+            << " entries but graph has " << num_nodes << " nodes\n";
+        return false;
+    }
+
+    std::vector<uint32_t> col(num_nodes, warthog::INF);
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        assert(column_order[i] < num_nodes);
+        col[column_order[i]] = i;
+    }
+
+    std::vector<uint64_t> row_index(num_nodes+1, 0);
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        row_index[i+1] = row_index[i] + rows[i].size();
+    }
+
+    warthog::label::fmt_header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic_ = warthog::label::FMT_MAGIC;
+    hdr.version_ = warthog::label::FMT_VERSION;
+    hdr.num_nodes_ = num_nodes;
+    hdr.num_rows_ = num_nodes;
+    hdr.num_runs_ = row_index[num_nodes];
+
+    uint64_t offset = fmt_align(sizeof(hdr));
+    hdr.col_offset_ = offset;
+    offset = fmt_align(offset + sizeof(uint32_t) * num_nodes);
+    hdr.row_index_offset_ = offset;
+    offset = fmt_align(offset + sizeof(uint64_t) * (num_nodes+1));
+    hdr.heads_offset_ = offset;
+    offset = fmt_align(offset + sizeof(uint32_t) * hdr.num_runs_);
+    hdr.labels_offset_ = offset;
+    offset = fmt_align(offset + sizeof(uint8_t) * hdr.num_runs_);
+    hdr.file_size_ = offset;
+
+    std::cerr << "writing firstmove table to file " << filename << "\n";
+    std::ofstream ofs(filename,
+            std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if(!ofs.good())
+    {
+        std::cerr << "err; cannot open " << filename << " for writing\n";
+        return false;
+    }
+
+    // pads the output with zeroes up to the next array offset
+    auto seek = [&ofs] (uint64_t to) -> void
+    {
+        const char zero[warthog::label::FMT_ALIGNMENT] = {0};
+        uint64_t at = ofs.tellp();
+        assert(to >= at && to - at <= sizeof(zero));
+        ofs.write(zero, to - at);
+    };
+
+    ofs.write((char*)&hdr, sizeof(hdr));
+    seek(hdr.col_offset_);
+    ofs.write((char*)col.data(), sizeof(uint32_t) * num_nodes);
+    seek(hdr.row_index_offset_);
+    ofs.write((char*)row_index.data(), sizeof(uint64_t) * (num_nodes+1));
+    seek(hdr.heads_offset_);
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        for(uint32_t j = 0; j < rows[i].size(); j++)
+        {
+            ofs.write((char*)&rows[i][j].head_, sizeof(uint32_t));
+        }
+    }
+    seek(hdr.labels_offset_);
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        for(uint32_t j = 0; j < rows[i].size(); j++)
+        {
+            ofs.write((char*)&rows[i][j].label_, sizeof(uint8_t));
+        }
+    }
+    seek(hdr.file_size_);
+
+    if(!ofs.good())
+    {
+        std::cerr << "err; writing firstmove table " << filename << "\n";
+        return false;
+    }
+    return true;
+}
+
+warthog::label::firstmove_table*
+warthog::label::firstmove_table::load(const char* filename)
+{
+    std::cerr << "loading firstmove table from file " << filename << "\n";
+    warthog::label::firstmove_table* tab =
+        new warthog::label::firstmove_table();
+    if(!tab->image_.open(filename))
+    {
+        delete tab;
+        return 0;
+    }
+
+    const char* base = tab->image_.data();
+    const warthog::label::fmt_header* hdr =
+        (const warthog::label::fmt_header*)base;
+    if(tab->image_.size() < sizeof(*hdr) ||
+            hdr->magic_ != warthog::label::FMT_MAGIC)
+    {
+        std::cerr << "err; not a firstmove table: " << filename << "\n";
+        delete tab;
+        return 0;
+    }
+    if(hdr->version_ != warthog::label::FMT_VERSION)
+    {
+        std::cerr << "err; unsupported firstmove table version "
+            << hdr->version_ << "; expected version "
+            << warthog::label::FMT_VERSION << "\n";
+        delete tab;
+        return 0;
+    }
+    if(hdr->file_size_ != tab->image_.size())
+    {
+        std::cerr << "err; firstmove table truncated; expected "
+            << hdr->file_size_ << " bytes but read "
+            << tab->image_.size() << "\n";
+        delete tab;
+        return 0;
+    }
+
+    if(!valid_table(*hdr, base))
+    {
+        std::cerr << "err; firstmove table corrupt: " << filename << "\n";
+        delete tab;
+        return 0;
+    }
+
+    tab->hdr_ = hdr;
+    tab->col_ = (const uint32_t*)(base + hdr->col_offset_);
+    tab->row_index_ = (const uint64_t*)(base + hdr->row_index_offset_);
+    tab->heads_ = (const uint32_t*)(base + hdr->heads_offset_);
+    tab->labels_ = (const uint8_t*)(base + hdr->labels_offset_);
+    return tab;
+}
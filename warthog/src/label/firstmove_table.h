@@ -0,0 +1,155 @@
+#ifndef WARTHOG_FIRSTMOVE_TABLE_H
+#define WARTHOG_FIRSTMOVE_TABLE_H
+
+// label/firstmove_table.h
+//
+// A read-only, query-time layout for the run-length encoded first-move
+// data computed by warthog::label::firstmove_labelling.
+//
+// firstmove_labelling keeps one std::vector<fm_run> per row, and each
+// run pads to 8 bytes. Here all rows are frozen into flat arrays:
+//
+//   col       uint32_t[num_nodes]    column of each node id
+//   row_index uint64_t[num_rows+1]   offsets of each row into heads
+//   heads     uint32_t[num_runs]     first column of each run
+//   labels    uint8_t[num_runs]      first move of each run
+//
+// The runs of row i are [row_index[i], row_index[i+1]). A row is
+// searched only through its heads, 4 bytes per run, so a row spans half
+// as many cache lines as before; the label byte is read once at the end.
+//
+// Unlike firstmove_labelling, the table records the column order that
+// was used for compression. Lookups translate the target id to a column
+// before searching the row.
+//
+// A table exists only as a file, written by ::save: a fixed-size header
+// followed by the arrays above, each aligned to FMT_ALIGNMENT bytes.
+// ::load memory-maps the file and uses it in place, so a table can be
+// shared by several processes and loads in constant time. All values
+// are in host byte order.
+//
+
+#include "constants.h"
+#include "firstmove_labelling.h"
+#include "mapped_file.h"
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace warthog
+{
+
+namespace label
+{
+
+const uint32_t FMT_MAGIC = 0x544d4657; // "WFMT"
+const uint32_t FMT_VERSION = 1;
+const uint64_t FMT_ALIGNMENT = 64;
+
+struct fmt_header
+{
+    uint32_t magic_;
+    uint32_t version_;
+    uint32_t num_nodes_;
+    uint32_t num_rows_;
+    uint64_t num_runs_;
+
+    // byte offsets of each array from the start of the file
+    uint64_t col_offset_;
+    uint64_t row_index_offset_;
+    uint64_t heads_offset_;
+    uint64_t labels_offset_;
+    uint64_t file_size_;
+};
+
+class firstmove_table
+{
+    public:
+        ~firstmove_table();
+
+        // write the rows of @param lab to @param filename as a table.
+        // @param column_order: the column order given to
+        // firstmove_labelling::compute, i.e. the node id of each column
+        static bool
+        save(const char* filename, warthog::label::firstmove_labelling& lab,
+                std::vector<uint32_t>& column_order);
+
+        // map a table written by ::save.
+        // @return null if the file is missing or not a valid table
+        static warthog::label::firstmove_table*
+        load(const char* filename);
+
+        // @return the index of the first optimal move from @param node_id
+        // to @param target_id, FM_NONE if there is no such move, or
+        // warthog::INF if there is no row for @param node_id
+        inline uint32_t
+        get_label(uint32_t node_id, uint32_t target_id)
+        {
+            assert(node_id < hdr_->num_rows_ && target_id < hdr_->num_nodes_);
+            uint64_t begin = row_index_[node_id];
+            uint32_t num = row_index_[node_id+1] - begin;
+            if(num == 0) { return warthog::INF; }
+            return labels_[find_run(begin, num, col_[target_id])];
+        }
+
+        inline uint32_t
+        get_num_nodes() { return hdr_->num_nodes_; }
+
+        inline uint64_t
+        get_num_runs() { return hdr_->num_runs_; }
+
+        // the number of runs in row @param node_id
+        inline uint32_t
+        get_row_length(uint32_t node_id)
+        {
+            return row_index_[node_id+1] - row_index_[node_id];
+        }
+
+        // the size of the table file
+        inline uint64_t
+        get_file_size() { return hdr_->file_size_; }
+
+        size_t
+        mem() { return sizeof(*this) + hdr_->file_size_; }
+
+    private:
+        warthog::util::mapped_file image_;
+
+        const warthog::label::fmt_header* hdr_;
+        const uint32_t* col_;
+        const uint64_t* row_index_;
+        const uint32_t* heads_;
+        const uint8_t* labels_;
+
+        // only via ::load please
+        firstmove_table();
+
+        // the last run of the @param num runs starting at @param begin
+        // whose head is not greater than @param col.
+        // a branchless binary search: every step halves the range with a
+        // conditional move, so there are no mispredicted branches
+        inline uint64_t
+        find_run(uint64_t begin, uint32_t num, uint32_t col)
+        {
+            const uint32_t* base = heads_ + begin;
+            while(num > 1)
+            {
+                uint32_t half = num >> 1;
+                base = (base[half] <= col) ? base + half : base;
+                num -= half;
+            }
+            return base - heads_;
+        }
+
+        // no copy
+        firstmove_table(const firstmove_table& other) { }
+        firstmove_table& operator=(const firstmove_table& other)
+        { return *this; }
+};
+
+}
+
+}
+
+#endif
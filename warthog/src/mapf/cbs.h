@@ -13,6 +13,7 @@
 #include "pqueue.h"
 #include "reservation_table.h"
 #include "search_node.h"
+#include "sparse_reservation_table.h"
 
 namespace warthog
 {
@@ -119,15 +120,24 @@ class time_constraints
 // 2. larger g-value and !is_reserved, then
 // 3. !is_reserved, then
 // 4. larger g-value
+//
+// Reservations come from either a (dense) warthog::reservation_table
+// or a warthog::sparse_reservation_table.
 class cmp_cbs_ll_lessthan
 {
     public:
         cmp_cbs_ll_lessthan(warthog::reservation_table* restab)
-            : restab_(restab)
+            : restab_(restab), sparse_restab_(0)
         { 
             is_reserved_fn_ = &cmp_cbs_ll_lessthan::__is_reserved;
         }
 
+        cmp_cbs_ll_lessthan(warthog::sparse_reservation_table* restab)
+            : restab_(0), sparse_restab_(restab)
+        { 
+            is_reserved_fn_ = &cmp_cbs_ll_lessthan::__is_reserved_sparse;
+        }
+
         bool
         operator()(const warthog::search_node& first, const warthog::search_node& second)
         {
@@ -187,6 +197,7 @@ class cmp_cbs_ll_lessthan
         typedef bool(cmp_cbs_ll_lessthan::*fn_is_reserved)(uint32_t time_indexed_id);
 
         warthog::reservation_table* restab_;
+        warthog::sparse_reservation_table* sparse_restab_;
         fn_is_reserved  is_reserved_fn_;
 
         bool
@@ -197,6 +208,12 @@ class cmp_cbs_ll_lessthan
         { 
             return restab_->is_reserved(map_id);
         }
+
+        bool
+        __is_reserved_sparse(uint32_t map_id)
+        { 
+            return sparse_restab_->is_reserved(map_id);
+        }
 };
 
 typedef pqueue<cmp_cbs_ll_lessthan> pqueue_cbs_ll;
@@ -20,6 +20,7 @@
 #include "expansion_policy.h"
 #include "forward.h"
 #include "gridmap.h"
+#include "node_pool.h"
 #include "search_node.h"
 
 #include <memory>
@@ -101,6 +102,10 @@ class cbs_ll_expansion_policy
         warthog::cbs::time_constraints*
         get_time_constraints() { return cons_; }
 
+        // nodes stay in the pool until destruction; nothing to reclaim
+        inline void
+        reclaim() { }
+
 		size_t 
         mem();
 
@@ -1,158 +1,372 @@
 #include "cbs_ll_heuristic.h"
+#include "callback_listener.h"
 #include "flexible_astar.h"
 #include "gridmap.h"
-#include "gridmap_expansion_policy.h"
 #include "labelled_gridmap.h"
 #include "evl_gridmap_expansion_policy.h"
 #include "vl_gridmap_expansion_policy.h"
 #include "zero_heuristic.h"
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
+#include <limits>
 #include <stdint.h>
 
+// default size of the table cache
+static const size_t DEFAULT_MEM_LIMIT = (size_t)256 * 1024 * 1024;
+
+warthog::cbs_ll_heuristic::cbs_ll_heuristic()
+{
+    gm_ = 0;
+    vlgm_ = 0;
+    evlgm_ = 0;
+    map_sz_ = 0;
+    max_target_id_ = 0;
+
+    mem_used_ = 0;
+    mem_limit_ = DEFAULT_MEM_LIMIT;
+    hits_ = 0;
+    misses_ = 0;
+
+    cur16_ = 0;
+    cur32_ = 0;
+    cur64_ = 0;
+    id_mask_ = UINT64_MAX;
+
+    stride_ = 0;
+    num_words_ = 0;
+    traversable_ = visited_ = frontier_ = next_ = 0;
+}
+
+warthog::cbs_ll_heuristic::~cbs_ll_heuristic()
+{
+    clear();
+}
+
 void
 warthog::cbs_ll_heuristic::compute_h_values(
         std::vector<uint32_t>& targets,
         warthog::gridmap* map)
 {
-    t_map_.clear();
-    h_.clear();
-    h_.resize(targets.size());
-    t_index_ = 0;
+    set_map(map, 0, 0, map->width(), map->height(),
+            map->header_width() * map->header_height());
+}
+
+void
+warthog::cbs_ll_heuristic::compute_h_values(
+        std::vector<uint32_t>& targets,
+        warthog::vl_gridmap* map)
+{
+    set_map(0, map, 0, map->width(), map->height(),
+            map->header_width() * map->header_height());
+}
+
+void
+warthog::cbs_ll_heuristic::compute_h_values(
+        std::vector<uint32_t>& targets,
+        warthog::evl_gridmap* map)
+{
+    set_map(0, 0, map, map->width(), map->height(),
+            map->header_width() * map->header_height());
+}
+
+void
+warthog::cbs_ll_heuristic::set_map(warthog::gridmap* gm,
+        warthog::vl_gridmap* vlgm, warthog::evl_gridmap* evlgm,
+        uint32_t width, uint32_t height, uint32_t max_target_id)
+{
+    if(gm == gm_ && vlgm == vlgm_ && evlgm == evlgm_ &&
+       map_sz_ == width * height)
+    {
+        return;
+    }
+
+    clear();
+    gm_ = gm;
+    vlgm_ = vlgm;
+    evlgm_ = evlgm;
+    map_sz_ = width * height;
+    max_target_id_ = max_target_id;
 
-    uint32_t bitwidth_map = 
-        32 - __builtin_clz(map->width() * map->height());
+    uint32_t bitwidth_map = 32 - __builtin_clz(map_sz_);
     id_mask_ = (1 << bitwidth_map)-1;
 
-    warthog::pqueue_min open;
-    warthog::zero_heuristic h;
-    warthog::gridmap_expansion_policy expander(map, true);
+    if(!gm_) { return; }
 
-    warthog::flexible_astar<
-        warthog::zero_heuristic, 
-        warthog::gridmap_expansion_policy,
-        warthog::pqueue_min> 
-            alg(&h, &expander, &open);
+    // copy the traversable cells of the map into rows of 64-bit words.
+    // each row of the gridmap is width/8 bytes, bit b of byte k being
+    // cell 8*k + b, so on a little-endian machine the bytes of a row
+    // are already the words we need
+    assert(width % 8 == 0);
+    stride_ = (width + 63) / 64;
+    num_words_ = (height + 2) * stride_;
+    traversable_ = new uint64_t[num_words_];
+    visited_ = new uint64_t[num_words_];
+    frontier_ = new uint64_t[num_words_];
+    next_ = new uint64_t[num_words_];
+    memset(traversable_, 0, sizeof(uint64_t) * num_words_);
+    memset(frontier_, 0, sizeof(uint64_t) * num_words_);
+    memset(next_, 0, sizeof(uint64_t) * num_words_);
+    for(uint32_t y = 0; y < height; y++)
+    {
+        memcpy(&traversable_[(y+1) * stride_],
+                gm_->get_mem_ptr(y * width), width / 8);
+    }
+}
 
-    std::function<void(warthog::search_node*)> on_expand_fn = 
-        [&] (warthog::search_node* current) -> void
-        {
-            uint32_t t_index = t_map_.size() - 1;
-            //uint32_t h_sz = h_.size();
-            //uint32_t h_sz_2 = h_.at(t_index).size();
-            //h_sz = h_sz + 1 - 1;
-            //h_sz_2 = h_sz_2 + 1 - 1;
-            h_[t_index][current->get_id()] = current->get_g();
-            //uint32_t tmp = h_[t_index][current->get_id()];
-            //assert(tmp == current->get_g());
-        };
-    alg.apply_on_expand(on_expand_fn);
+void
+warthog::cbs_ll_heuristic::clear()
+{
+    while(lru_.size()) { pop_lru(); }
+    index_.clear();
+    cur16_ = 0;
+    cur32_ = 0;
+    cur64_ = 0;
+    gm_ = 0;
+    vlgm_ = 0;
+    evlgm_ = 0;
+    map_sz_ = 0;
+
+    delete [] traversable_;
+    delete [] visited_;
+    delete [] frontier_;
+    delete [] next_;
+    traversable_ = visited_ = frontier_ = next_ = 0;
+    stride_ = 0;
+    num_words_ = 0;
+    std::vector<uint32_t>().swap(scratch_);
+}
+
+void
+warthog::cbs_ll_heuristic::pop_lru()
+{
+    h_table& tab = lru_.back();
+    delete [] tab.d16_;
+    delete [] tab.d32_;
+    delete [] tab.d64_;
+    mem_used_ -= tab.bytes_;
+    index_.erase(tab.target_id_);
+    lru_.pop_back();
+}
+
+void
+warthog::cbs_ll_heuristic::make_room(size_t bytes)
+{
+    while(lru_.size() && mem_used_ + bytes > mem_limit_)
+    {
+        pop_lru();
+    }
+}
 
-    for(uint32_t target_id : targets)
+bool
+warthog::cbs_ll_heuristic::set_current_target(uint32_t target_id)
+{
+    if(map_sz_ == 0 || target_id >= max_target_id_) { return false; }
+
+    std::unordered_map<uint32_t, std::list<h_table>::iterator>::iterator it
+        = index_.find(target_id);
+    if(it != index_.end())
     {
-        uint32_t t_index = t_map_.size();
-        t_map_[target_id] = t_index;
-        h_[t_index_].resize(map->width() * map->height(), warthog::INF);
-        warthog::problem_instance problem(target_id, warthog::INF);
-        warthog::solution sol;
-        alg.get_distance(problem, sol);
+        hits_++;
+        lru_.splice(lru_.begin(), lru_, it->second);
     }
+    else
+    {
+        misses_++;
+        h_table tab;
+        tab.target_id_ = target_id;
+        tab.d16_ = 0;
+        tab.d32_ = 0;
+        tab.d64_ = 0;
+        compute(tab);
+        lru_.push_front(tab);
+        index_[target_id] = lru_.begin();
+        mem_used_ += tab.bytes_;
+    }
+
+    cur16_ = lru_.front().d16_;
+    cur32_ = lru_.front().d32_;
+    cur64_ = lru_.front().d64_;
+    return true;
 }
 
 void
-warthog::cbs_ll_heuristic::compute_h_values(
-        std::vector<uint32_t>& targets,
-        warthog::vl_gridmap* map)
+warthog::cbs_ll_heuristic::set_memory_limit(size_t bytes)
 {
-    t_map_.clear();
-    h_.clear();
-    h_.resize(targets.size());
-    t_index_ = 0;
+    mem_limit_ = bytes;
+    while(lru_.size() > 1 && mem_used_ > mem_limit_) { pop_lru(); }
+}
 
-    uint32_t bitwidth_map = 
-        32 - __builtin_clz(map->width() * map->height());
-    id_mask_ = (1 << bitwidth_map)-1;
+size_t
+warthog::cbs_ll_heuristic::mem()
+{
+    return sizeof(*this) + mem_used_ +
+        sizeof(uint64_t) * num_words_ * 4 +
+        sizeof(uint32_t) * scratch_.capacity() +
+        (sizeof(h_table) + 4 * sizeof(void*)) * lru_.size();
+}
 
-    warthog::pqueue_min open;
-    warthog::zero_heuristic h;
-    warthog::vl_gridmap_expansion_policy expander(map);
+void
+warthog::cbs_ll_heuristic::compute(h_table& tab)
+{
+    if(gm_)
+    {
+        // search in 32 bits, then store 16 bits per cell if every 
+        // distance fits (UINT16_MAX marks unreachable cells)
+        scratch_.resize(map_sz_);
+        uint32_t max_d = bfs<uint32_t>(
+                gm_->to_padded_id(tab.target_id_), &scratch_[0]);
+        bool wide = max_d >= UINT16_MAX;
+        tab.bytes_ = map_sz_ * (wide ? sizeof(uint32_t) : sizeof(uint16_t));
+        make_room(tab.bytes_);
+        if(wide)
+        {
+            tab.d32_ = new uint32_t[map_sz_];
+            std::copy(scratch_.begin(), scratch_.end(), tab.d32_);
+        }
+        else
+        {
+            tab.d16_ = new uint16_t[map_sz_];
+            for(uint32_t i = 0; i < map_sz_; i++)
+            {
+                tab.d16_[i] = scratch_[i] != UINT32_MAX 
+                    ? (uint16_t)scratch_[i] : UINT16_MAX;
+            }
+        }
+        return;
+    }
 
-    warthog::flexible_astar<
-        warthog::zero_heuristic, 
-        warthog::vl_gridmap_expansion_policy,
-        warthog::pqueue_min> 
-            alg(&h, &expander, &open);
+    tab.bytes_ = map_sz_ * sizeof(double);
+    make_room(tab.bytes_);
+    if(vlgm_)
+    {
+        tab.d64_ = new double[map_sz_];
+        dijkstra<warthog::vl_gridmap_expansion_policy>(
+                vlgm_, tab.target_id_, tab.d64_);
+    }
+    else
+    {
+        tab.d64_ = new double[map_sz_];
+        dijkstra<warthog::evl_gridmap_expansion_policy>(
+                evlgm_, tab.target_id_, tab.d64_);
+    }
+}
 
-    std::function<void(warthog::search_node*)> on_expand_fn = 
-        [&] (warthog::search_node* current) -> void
+// a breadth-first search over bitsets. every word holds 64 cells; the
+// next layer of the search is the union of the current layer shifted
+// one cell in each of the four directions, minus obstacles and cells
+// already visited. only the rows next to the current layer are scanned.
+// the padding of the gridmap means every row ends with an obstacle, so
+// a shift to the east or west that crosses into another row only ever
+// reaches obstacles.
+template<class T>
+T
+warthog::cbs_ll_heuristic::bfs(uint32_t padded_target_id, T* dist)
+{
+    std::fill(dist, dist + map_sz_, std::numeric_limits<T>::max());
+    memset(visited_, 0, sizeof(uint64_t) * num_words_);
+
+    uint32_t width = gm_->width();
+    uint32_t height = gm_->height();
+    uint32_t ty = padded_target_id / width;
+    uint32_t tx = padded_target_id % width;
+    uint32_t tw = (ty+1) * stride_ + (tx >> 6);
+    if(!(traversable_[tw] & (1ull << (tx & 63)))) { return 0; }
+    frontier_[tw] = visited_[tw] = 1ull << (tx & 63);
+    dist[padded_target_id] = 0;
+
+    // the rows of the bitsets where the frontier is not empty, in order
+    rows_.clear();
+    rows_.push_back(ty+1);
+    T max_d = 0;
+    for(T d = 1; rows_.size(); d++)
+    {
+        // scan each row next to the frontier once
+        next_rows_.clear();
+        uint32_t scanned = 0;
+        for(uint32_t frow : rows_)
         {
-            uint32_t t_index = t_map_.size() - 1;
-            //uint32_t h_sz = h_.size();
-            //uint32_t h_sz_2 = h_.at(t_index).size();
-            //h_sz = h_sz + 1 - 1;
-            //h_sz_2 = h_sz_2 + 1 - 1;
-            h_[t_index][current->get_id()] = current->get_g();
-            //uint32_t tmp = h_[t_index][current->get_id()];
-            //assert(tmp == current->get_g());
-        };
-    alg.apply_on_expand(on_expand_fn);
+            uint32_t to = std::min<uint32_t>(frow + 1, height);
+            for(uint32_t row = std::max<uint32_t>(frow - 1, scanned + 1);
+                    row <= to; row++)
+            {
+                scanned = row;
+                if(bfs_row(row, d, dist)) { next_rows_.push_back(row); }
+            }
+        }
 
-    for(uint32_t target_id : targets)
+        for(uint32_t frow : rows_)
+        {
+            memset(&frontier_[frow * stride_], 0, sizeof(uint64_t) * stride_);
+        }
+        std::swap(frontier_, next_);
+        std::swap(rows_, next_rows_);
+        if(rows_.size()) { max_d = d; }
+    }
+    return max_d;
+}
+
+// add to next_ the cells of @param row not yet visited and next to the
+// frontier; they are at distance @param d.
+// @return true if there are any
+template<class T>
+bool
+warthog::cbs_ll_heuristic::bfs_row(uint32_t row, T d, T* dist)
+{
+    bool any = false;
+    uint32_t row_begin = row * stride_;
+    for(uint32_t w = row_begin; w < row_begin + stride_; w++)
     {
-        uint32_t t_index = t_map_.size();
-        t_map_[target_id] = t_index;
-        h_[t_index_].resize(map->width() * map->height(), warthog::INF);
-        warthog::problem_instance problem(target_id, warthog::INF);
-        warthog::solution sol;
-        alg.get_distance(problem, sol);
+        uint64_t f = frontier_[w];
+        // cells whose neighbour to the west, east, north or
+        // south is in the frontier
+        uint64_t n =
+            (f << 1) | (frontier_[w-1] >> 63) |
+            (f >> 1) | (frontier_[w+1] << 63) |
+            frontier_[w - stride_] |
+            frontier_[w + stride_];
+        n &= traversable_[w] & ~visited_[w];
+        next_[w] = n;
+        if(!n) { continue; }
+
+        any = true;
+        visited_[w] |= n;
+        uint32_t base = (row-1) * gm_->width() + (w - row_begin) * 64;
+        while(n)
+        {
+            dist[base + __builtin_ctzll(n)] = d;
+            n &= n - 1;
+        }
     }
+    return any;
 }
 
+template<class E, class M>
 void
-warthog::cbs_ll_heuristic::compute_h_values(
-        std::vector<uint32_t>& targets,
-        warthog::evl_gridmap* map)
+warthog::cbs_ll_heuristic::dijkstra(M* map, uint32_t target_id, double* dist)
 {
-    t_map_.clear();
-    h_.clear();
-    h_.resize(targets.size());
-    t_index_ = 0;
-
-    uint32_t bitwidth_map = 
-        32 - __builtin_clz(map->width() * map->height());
-    id_mask_ = (1 << bitwidth_map)-1;
+    std::fill(dist, dist + map_sz_, (double)warthog::INF);
 
     warthog::pqueue_min open;
     warthog::zero_heuristic h;
-    warthog::evl_gridmap_expansion_policy expander(map);
+    E expander(map);
 
     warthog::flexible_astar<
-        warthog::zero_heuristic, 
-        warthog::evl_gridmap_expansion_policy,
-        warthog::pqueue_min> 
+        warthog::zero_heuristic,
+        E,
+        warthog::pqueue_min,
+        warthog::callback_listener>
             alg(&h, &expander, &open);
 
-    std::function<void(warthog::search_node*)> on_expand_fn = 
-        [&] (warthog::search_node* current) -> void
+    std::function<void(warthog::search_node*)> on_expand_fn =
+        [dist] (warthog::search_node* current) -> void
         {
-            uint32_t t_index = t_map_.size() - 1;
-            //uint32_t h_sz = h_.size();
-            //uint32_t h_sz_2 = h_.at(t_index).size();
-            //h_sz = h_sz + 1 - 1;
-            //h_sz_2 = h_sz_2 + 1 - 1;
-            h_[t_index][current->get_id()] = current->get_g();
-            //uint32_t tmp = h_[t_index][current->get_id()];
-            //assert(tmp == current->get_g());
+            dist[current->get_id()] = current->get_g();
         };
-    alg.apply_on_expand(on_expand_fn);
+    alg.get_listener()->apply_on_expand(on_expand_fn);
 
-    for(uint32_t target_id : targets)
-    {
-        uint32_t t_index = t_map_.size();
-        t_map_[target_id] = t_index;
-        h_[t_index_].resize(map->width() * map->height(), warthog::INF);
-        warthog::problem_instance problem(target_id, warthog::INF);
-        warthog::solution sol;
-        alg.get_distance(problem, sol);
-    }
+    warthog::problem_instance problem(target_id, warthog::INF);
+    warthog::solution sol;
+    alg.get_distance(problem, sol);
 }
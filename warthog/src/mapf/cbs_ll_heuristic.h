@@ -3,24 +3,42 @@
 
 // mapf/cbs_ll_heuristic.h
 //
-// The low-level (i.e. single-agent) heuristic function used in 
-// Conflict-based Search. Pre-computes all distances, from every 
-// target node to every other node in the input graph. 
+// The low-level (i.e. single-agent) heuristic function used in
+// Conflict-based Search. For each target it stores the distance from
+// the target to every other node in the input graph.
 //
-// This implementation assumes the input graph is a 4-connected 
-// uniform-cost grid. 
+// Distances are computed lazily, the first time a target is made
+// current (see ::set_current_target), and kept in a cache of bounded
+// size that evicts the least recently used target. One heuristic can
+// thus serve many agents on a large map without holding a table for
+// every one of them.
 //
-// For more details see: 
-// Sharon, Guni, et al. "Conflict-based search for optimal multi-agent pathfinding." 
+// The main implementation assumes the input graph is a 4-connected
+// uniform-cost grid. Its distances are integers, found by a
+// bit-parallel breadth-first search that advances 64 cells per
+// operation. Each table is stored in 16 bits per cell if its largest
+// distance fits, and in 32 bits otherwise; the width is chosen per
+// target, so only targets with very long paths pay for 32 bits.
+// Weighted grids (vl_gridmap and evl_gridmap) are searched with
+// Dijkstra and keep 64-bit distances.
+//
+// Not thread-safe: ::set_current_target may compute and evict tables.
+//
+// For more details see:
+// Sharon, Guni, et al. "Conflict-based search for optimal multi-agent pathfinding."
 // Artificial Intelligence 219 (2015): 40-66.
 //
 // @author: dharabor
 // @created: 2018-11-04
 //
 
+#include "constants.h"
 #include "forward.h"
 #include "labelled_gridmap.h"
-#include <map>
+
+#include <list>
+#include <unordered_map>
+#include <vector>
 
 namespace warthog
 {
@@ -28,26 +46,31 @@ namespace warthog
 class cbs_ll_heuristic
 {
     public:
-        cbs_ll_heuristic() 
-        {
-            id_mask_ = UINT64_MAX;
-        }
-
-        ~cbs_ll_heuristic() 
-        {
-        }
+        cbs_ll_heuristic();
+        ~cbs_ll_heuristic();
 
         inline double
         h(unsigned int id, unsigned int id2)
         {
-            return h_[t_index_][id & id_mask_];
+            uint32_t xy_id = id & id_mask_;
+            if(cur16_)
+            {
+                uint16_t d = cur16_[xy_id];
+                return d != UINT16_MAX ? d : warthog::INF;
+            }
+            if(cur32_)
+            {
+                uint32_t d = cur32_[xy_id];
+                return d != UINT32_MAX ? d : warthog::INF;
+            }
+            return cur64_[xy_id];
         }
 
-        // run a Dijkstra grid search (not time expanded!) from each 
-        // target whose identifier is  in @param target_nodes. 
-        // We store the g-value from each target to every node in the grid.
-        // These precomputed g-values are a lower-bound on the
-        // distance from any location@time to each target.
+        // prepare to answer ::h queries on the map @param gm.
+        // distances are computed only when a target becomes current, so
+        // @param target_nodes is no longer needed; it remains for the
+        // callers of the eager version. tables computed for earlier
+        // calls are kept if the map has not changed.
         void
         compute_h_values(
                 std::vector<uint32_t>& target_nodes,
@@ -62,41 +85,121 @@ class cbs_ll_heuristic
                 warthog::evl_gridmap*);
 
         // the current target specifies which set of g-values to
-        // refer to when answering ::h queries
-        // this function returns true if @param padded_id
-        // corresponds to one of the nodes for which a set
-        // of pre-computed g-values exist. 
-        // Otherwise the function returns false.
+        // refer to when answering ::h queries. the g-values are
+        // computed now if they are not in the cache.
+        // this function returns false if @param target_id is not
+        // a node of the current map (or there is no map yet).
         //
         // @param target_id: unpadded xy index specifying the current target
         bool
-        set_current_target(uint32_t target_id)
-        {
-            std::map<uint32_t, uint32_t>::iterator it = t_map_.find(target_id);
-            if(it == t_map_.end()) { return false; }
-            t_index_ = it->second;
-            return true;
-        }
+        set_current_target(uint32_t target_id);
+
+        // keep at most @param bytes of distance tables in memory.
+        // the table of the current target is always kept.
+        void
+        set_memory_limit(size_t bytes);
+
+        inline size_t
+        get_memory_limit() { return mem_limit_; }
+
+        // number of targets made current whose table was computed
+        // (misses) or found in the cache (hits)
+        inline uint64_t
+        get_num_misses() { return misses_; }
+
+        inline uint64_t
+        get_num_hits() { return hits_; }
 
         size_t
-        mem() 
-        { 
-            size_t sz = 0;
-            for(uint32_t i = 0; i < h_.size(); i++)
-            {
-                sz += sizeof(uint32_t) * h_[i].size();
-            }
-            sz += sizeof(void*)*h_.size();
-            sz += sizeof(uint32_t)*2*t_map_.size();
-            sz += sizeof(this);
-            return sz;
-        }
+        mem();
 
     private:
-        std::vector<std::vector<double>> h_;
-        std::map<uint32_t, uint32_t> t_map_;
-        uint32_t t_index_;
+        // the distances from one target; exactly one array is non-null
+        struct h_table
+        {
+            uint32_t target_id_;
+            uint16_t* d16_;
+            uint32_t* d32_;
+            double* d64_;
+            size_t bytes_;
+        };
+
+        // the current map; exactly one pointer is non-null
+        warthog::gridmap* gm_;
+        warthog::vl_gridmap* vlgm_;
+        warthog::evl_gridmap* evlgm_;
+        uint32_t map_sz_;
+        uint32_t max_target_id_;
+
+        // cached tables, most recently used first
+        std::list<h_table> lru_;
+        std::unordered_map<uint32_t, std::list<h_table>::iterator> index_;
+        size_t mem_used_;
+        size_t mem_limit_;
+        uint64_t hits_;
+        uint64_t misses_;
+
+        uint16_t* cur16_;
+        uint32_t* cur32_;
+        double* cur64_;
         uint64_t id_mask_;
+
+        // bitsets of the bit-parallel search, with stride_ words per row
+        // of the padded map plus one empty row above and one below.
+        // bit b of word (y+1)*stride_ + k is padded cell (64*k + b, y)
+        uint32_t stride_;
+        uint32_t num_words_;
+        uint64_t* traversable_;
+        uint64_t* visited_;
+        uint64_t* frontier_;
+        uint64_t* next_;
+        std::vector<uint32_t> rows_;
+        std::vector<uint32_t> next_rows_;
+
+        // 32-bit distances of the last breadth-first search; they are
+        // copied to a table of the width they need
+        std::vector<uint32_t> scratch_;
+
+        void
+        set_map(warthog::gridmap* gm, warthog::vl_gridmap* vlgm,
+                warthog::evl_gridmap* evlgm, uint32_t width, uint32_t height,
+                uint32_t max_target_id);
+
+        void
+        clear();
+
+        // free the least recently used table
+        void
+        pop_lru();
+
+        // free tables, least recently used first, until a new table of
+        // @param bytes fits under the memory limit
+        void
+        make_room(size_t bytes);
+
+        // compute the distances to the target of @param tab and set its
+        // size. tables are freed (see ::pop_lru) to keep the cache under
+        // its limit before the new one is allocated
+        void
+        compute(h_table& tab);
+
+        // @return the largest finite distance found
+        template<class T>
+        T
+        bfs(uint32_t padded_target_id, T* dist);
+
+        template<class T>
+        bool
+        bfs_row(uint32_t row, T d, T* dist);
+
+        template<class E, class M>
+        void
+        dijkstra(M* map, uint32_t target_id, double* dist);
+
+        // no copy
+        cbs_ll_heuristic(const cbs_ll_heuristic& other) { }
+        cbs_ll_heuristic& operator=(const cbs_ll_heuristic& other)
+        { return *this; }
 };
 
 }
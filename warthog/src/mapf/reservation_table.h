@@ -10,7 +10,9 @@
 // they can plan without colliding into one another.
 //
 // This implementation uses a single bit to represent each
-// cell in a time-expanded grid graph.
+// cell in a time-expanded grid graph. For long horizons on large
+// maps see warthog::sparse_reservation_table, which has the same
+// interface.
 //
 // For more details see: 
 // Sharon, Guni, et al. "Conflict-based search for optimal multi-agent pathfinding." 
@@ -22,6 +24,7 @@
 
 #include "cpool.h"
 
+#include <algorithm>
 #include <stdint.h>
 #include <vector>
 
@@ -37,7 +40,8 @@ class reservation_table
             map_bitwidth_ = 32 - __builtin_clz(map_sz);
             id_mask_ = (1 << map_bitwidth_) - 1;
             map_sz_in_qwords_ = (map_sz_ >> LOG2_QWORD_SZ)+1;
-            pool_ = new warthog::mem::cpool(map_sz_in_qwords_);
+            pool_ = new warthog::mem::cpool(
+                    sizeof(uint64_t) * map_sz_in_qwords_);
         }
         ~reservation_table() 
         {
@@ -49,7 +53,7 @@ class reservation_table
         {
             if(timestep >= table_.size()) { return false; }
             return table_[timestep][xy_id >> LOG2_QWORD_SZ] & 
-                   (1 << (xy_id & 63));
+                   (1ull << (xy_id & 63));
         }
 
         inline bool
@@ -71,7 +75,7 @@ class reservation_table
                 { map[i] = 0; }
                 table_.push_back(map);
             }
-            table_[timestep][xy_id >> LOG2_QWORD_SZ] |= (1 << (xy_id & 63));
+            table_[timestep][xy_id >> LOG2_QWORD_SZ] |= (1ull << (xy_id & 63));
         }
 
         inline void
@@ -87,7 +91,7 @@ class reservation_table
         {
             assert(timestep < table_.size());
             assert(xy_id < map_sz_);
-            table_[timestep][xy_id >> LOG2_QWORD_SZ] &= ~(1 << (xy_id & 63));
+            table_[timestep][xy_id >> LOG2_QWORD_SZ] &= ~(1ull << (xy_id & 63));
         }
 
         inline void
@@ -98,6 +102,23 @@ class reservation_table
             unreserve(xy_id, timestep);
         }
 
+        // the free timesteps [@param begin, @param end) of cell
+        // @param xy_id around @param timestep. @param end is UINT32_MAX
+        // if the cell is free from @param begin onwards.
+        // @return false if the cell is reserved at @param timestep
+        bool
+        get_safe_interval(uint32_t xy_id, uint32_t timestep,
+                uint32_t& begin, uint32_t& end)
+        {
+            if(is_reserved(xy_id, timestep)) { return false; }
+            begin = std::min<uint32_t>(timestep, table_.size());
+            while(begin > 0 && !is_reserved(xy_id, begin-1)) { begin--; }
+            end = timestep + 1;
+            while(end < table_.size() && !is_reserved(xy_id, end)) { end++; }
+            if(end >= table_.size()) { end = UINT32_MAX; }
+            return true;
+        }
+
         inline void
         clear_reservations()
         {
@@ -108,6 +129,13 @@ class reservation_table
             }
         }
 
+        size_t
+        mem()
+        {
+            return sizeof(*this) + pool_->mem() + 
+                sizeof(uint64_t*) * table_.capacity();
+        }
+
     private:
         std::vector<uint64_t*> table_;
         uint32_t id_mask_;
@@ -0,0 +1,130 @@
+#include "sparse_reservation_table.h"
+
+#include <algorithm>
+
+warthog::sparse_reservation_table::sparse_reservation_table(uint32_t map_sz)
+    : map_sz_(map_sz), num_slots_(0)
+{
+    map_bitwidth_ = 32 - __builtin_clz(map_sz);
+    id_mask_ = (1 << map_bitwidth_) - 1;
+    slot_.resize(map_sz_, (uint32_t)NO_SLOT);
+}
+
+warthog::sparse_reservation_table::~sparse_reservation_table()
+{ }
+
+void
+warthog::sparse_reservation_table::reserve(
+        uint32_t xy_id, uint32_t begin, uint32_t end)
+{
+    assert(xy_id < map_sz_);
+    if(begin >= end) { return; }
+
+    uint32_t slot = slot_[xy_id];
+    if(slot == NO_SLOT)
+    {
+        if(num_slots_ == lists_.size())
+        {
+            lists_.push_back(std::vector<interval>());
+            cell_.push_back(xy_id);
+        }
+        slot = num_slots_++;
+        cell_[slot] = xy_id;
+        slot_[xy_id] = slot;
+    }
+    std::vector<interval>& ivs = lists_[slot];
+
+    // merge with every interval that overlaps or touches [begin, end)
+    uint32_t i = find(ivs, begin);
+    if(i > 0 && ivs[i-1].end_ == begin) { i--; }
+    uint32_t j = i;
+    interval merged = {begin, end};
+    while(j < ivs.size() && ivs[j].begin_ <= end)
+    {
+        merged.begin_ = std::min(merged.begin_, ivs[j].begin_);
+        merged.end_ = std::max(merged.end_, ivs[j].end_);
+        j++;
+    }
+
+    if(i == j) 
+    { 
+        ivs.insert(ivs.begin() + i, merged); 
+        return;
+    }
+    ivs[i] = merged;
+    ivs.erase(ivs.begin() + i + 1, ivs.begin() + j);
+}
+
+void
+warthog::sparse_reservation_table::unreserve(
+        uint32_t xy_id, uint32_t begin, uint32_t end)
+{
+    assert(xy_id < map_sz_);
+    uint32_t slot = slot_[xy_id];
+    if(slot == NO_SLOT || begin >= end) { return; }
+    std::vector<interval>& ivs = lists_[slot];
+
+    // cut [begin, end) out of every interval that overlaps it
+    uint32_t i = find(ivs, begin);
+    while(i < ivs.size() && ivs[i].begin_ < end)
+    {
+        interval iv = ivs[i];
+        bool left = iv.begin_ < begin;
+        bool right = iv.end_ > end;
+        if(left && right)
+        {
+            ivs[i].end_ = begin;
+            interval rest = {end, iv.end_};
+            ivs.insert(ivs.begin() + i + 1, rest);
+            return;
+        }
+        if(left) { ivs[i].end_ = begin; i++; }
+        else if(right) { ivs[i].begin_ = end; return; }
+        else { ivs.erase(ivs.begin() + i); }
+    }
+}
+
+bool
+warthog::sparse_reservation_table::get_safe_interval(
+        uint32_t xy_id, uint32_t timestep, uint32_t& begin, uint32_t& end)
+{
+    assert(xy_id < map_sz_);
+    uint32_t slot = slot_[xy_id];
+    if(slot == NO_SLOT)
+    {
+        begin = 0;
+        end = UINT32_MAX;
+        return true;
+    }
+
+    std::vector<interval>& ivs = lists_[slot];
+    uint32_t i = find(ivs, timestep);
+    if(i < ivs.size() && ivs[i].begin_ <= timestep) { return false; }
+    begin = i > 0 ? ivs[i-1].end_ : 0;
+    end = i < ivs.size() ? ivs[i].begin_ : UINT32_MAX;
+    return true;
+}
+
+void
+warthog::sparse_reservation_table::clear_reservations()
+{
+    for(uint32_t i = 0; i < num_slots_; i++)
+    {
+        slot_[cell_[i]] = NO_SLOT;
+        lists_[i].clear();
+    }
+    num_slots_ = 0;
+}
+
+size_t
+warthog::sparse_reservation_table::mem()
+{
+    size_t sz = sizeof(*this) + 
+        sizeof(uint32_t) * (slot_.capacity() + cell_.capacity()) +
+        sizeof(std::vector<interval>) * lists_.capacity();
+    for(uint32_t i = 0; i < lists_.size(); i++)
+    {
+        sz += sizeof(interval) * lists_[i].capacity();
+    }
+    return sz;
+}
@@ -0,0 +1,158 @@
+#ifndef WARTHOG_SPARSE_RESERVATION_TABLE_H
+#define WARTHOG_SPARSE_RESERVATION_TABLE_H
+
+// mapf/sparse_reservation_table.h
+//
+// A reservation table for long planning horizons on large maps.
+// Same interface as warthog::reservation_table, which stores one
+// full-map bitmap per timestep. Here the reservations are kept per
+// cell instead, as a sorted list of disjoint intervals of reserved
+// timesteps. Memory grows with the number of reservations rather than
+// with map size times horizon, and ::clear_reservations takes time
+// proportional to the number of cells reserved.
+//
+// An interval can be reserved in one go (e.g. an agent parked at its
+// target forever) and the table can answer safe-interval queries: the
+// maximal run of free timesteps at a cell around a given time.
+//
+// The only per-map memory is one 32-bit index per cell, which maps
+// each reserved cell to its list of intervals.
+//
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace warthog
+{
+
+class sparse_reservation_table
+{
+    public:
+        // timesteps from @param begin up to (not including) @param end
+        struct interval
+        {
+            uint32_t begin_;
+            uint32_t end_;
+        };
+
+        sparse_reservation_table(uint32_t map_sz);
+        ~sparse_reservation_table();
+
+        inline bool
+        is_reserved(uint32_t xy_id, uint32_t timestep)
+        {
+            assert(xy_id < map_sz_);
+            uint32_t slot = slot_[xy_id];
+            if(slot == NO_SLOT) { return false; }
+            std::vector<interval>& ivs = lists_[slot];
+            uint32_t i = find(ivs, timestep);
+            return i < ivs.size() && ivs[i].begin_ <= timestep;
+        }
+
+        inline bool
+        is_reserved(uint32_t time_indexed_map_id)
+        {
+            uint32_t timestep = time_indexed_map_id >> map_bitwidth_;
+            uint32_t xy_id = time_indexed_map_id & id_mask_;
+            return is_reserved(xy_id, timestep);
+        }
+
+        inline void
+        reserve(uint32_t xy_id, uint32_t timestep)
+        {
+            reserve(xy_id, timestep, timestep + 1);
+        }
+
+        inline void
+        reserve(uint32_t time_indexed_map_id)
+        {
+            uint32_t timestep = time_indexed_map_id >> map_bitwidth_;
+            uint32_t xy_id = time_indexed_map_id & id_mask_;
+            reserve(xy_id, timestep);
+        }
+
+        // reserve cell @param xy_id at every timestep in
+        // [@param begin, @param end). UINT32_MAX as @param end
+        // reserves the cell from @param begin onwards
+        void
+        reserve(uint32_t xy_id, uint32_t begin, uint32_t end);
+
+        inline void
+        unreserve(uint32_t xy_id, uint32_t timestep)
+        {
+            unreserve(xy_id, timestep, timestep + 1);
+        }
+
+        inline void
+        unreserve(uint32_t time_indexed_map_id)
+        {
+            uint32_t timestep = time_indexed_map_id >> map_bitwidth_;
+            uint32_t xy_id = time_indexed_map_id & id_mask_;
+            unreserve(xy_id, timestep);
+        }
+
+        // free cell @param xy_id at every timestep in
+        // [@param begin, @param end)
+        void
+        unreserve(uint32_t xy_id, uint32_t begin, uint32_t end);
+
+        // the safe interval of cell @param xy_id that contains
+        // @param timestep: the free timesteps [@param begin, @param end)
+        // around it. @param end is UINT32_MAX if the cell is free from
+        // @param begin onwards.
+        // @return false (and leave @param begin and @param end as they
+        // are) if the cell is reserved at @param timestep
+        bool
+        get_safe_interval(uint32_t xy_id, uint32_t timestep,
+                uint32_t& begin, uint32_t& end);
+
+        void
+        clear_reservations();
+
+        // number of cells reserved since the last clear
+        inline uint32_t
+        get_num_reserved_cells() { return num_slots_; }
+
+        size_t
+        mem();
+
+    private:
+        static const uint32_t NO_SLOT = UINT32_MAX;
+
+        uint32_t map_sz_;
+        uint32_t map_bitwidth_;
+        uint32_t id_mask_;
+
+        // slot_[xy_id] is the index in lists_ of the intervals of
+        // xy_id. slots [0, num_slots_) are in use; cell_[slot] is the
+        // cell of each. the lists of unused slots keep their memory
+        std::vector<uint32_t> slot_;
+        std::vector< std::vector<interval> > lists_;
+        std::vector<uint32_t> cell_;
+        uint32_t num_slots_;
+
+        // the first interval of @param ivs that ends after @param timestep
+        inline uint32_t
+        find(std::vector<interval>& ivs, uint32_t timestep)
+        {
+            uint32_t lo = 0, hi = ivs.size();
+            while(lo < hi)
+            {
+                uint32_t mid = (lo + hi) >> 1;
+                if(ivs[mid].end_ <= timestep) { lo = mid + 1; }
+                else { hi = mid; }
+            }
+            return lo;
+        }
+
+        // no copy
+        sparse_reservation_table(const sparse_reservation_table& other) { }
+        sparse_reservation_table&
+        operator=(const sparse_reservation_table& other) { return *this; }
+};
+
+}
+
+#endif
@@ -12,6 +12,9 @@ warthog::txevl_gridmap_expansion_policy::txevl_gridmap_expansion_policy(
 		warthog::evl_gridmap* map, warthog::cbs_ll_heuristic* h) 
     : map_(map), h_(h)
 {
+    restab_ = 0;
+    sparse_restab_ = 0;
+
     neis_ = new warthog::arraylist<neighbour_record>(32);
 
     map_xy_sz_ = map->height() * map->width();
@@ -12,6 +12,9 @@
 // location to an adjacent grid location. Each action (including wait)
 // advances time by one time-step.
 //
+// Optionally, the cells reserved by other agents (in a dense or a
+// sparse reservation table) are blocked at the times they are reserved.
+//
 // @author: dharabor
 // @created: 2018-11-08
 //
@@ -20,7 +23,10 @@
 #include "expansion_policy.h"
 #include "forward.h"
 #include "labelled_gridmap.h"
+#include "node_pool.h"
+#include "reservation_table.h"
 #include "search_node.h"
+#include "sparse_reservation_table.h"
 
 #include <memory>
 
@@ -97,6 +103,27 @@ class txevl_gridmap_expansion_policy
             return ((n->get_id() & id_mask_) == pi->target_id_);
         }
 
+        // nodes stay in the pool until destruction; nothing to reclaim
+        inline void
+        reclaim() { }
+
+        // do not generate successors that are reserved in @param restab
+        // at the time they are reached (default: no reservations).
+        // at most one table is used; setting one unsets the other
+        void
+        set_reservation_table(warthog::reservation_table* restab)
+        {
+            restab_ = restab;
+            sparse_restab_ = 0;
+        }
+
+        void
+        set_reservation_table(warthog::sparse_reservation_table* restab)
+        {
+            restab_ = 0;
+            sparse_restab_ = restab;
+        }
+
 		size_t 
         mem();
 
@@ -109,6 +136,10 @@ class txevl_gridmap_expansion_policy
         std::vector<warthog::mem::node_pool*>* time_map_;
         warthog::cbs_ll_heuristic* h_;
 
+        // null unless set; both lookups are inlined into ::add_neighbour
+        warthog::reservation_table* restab_;
+        warthog::sparse_reservation_table* sparse_restab_;
+
         struct neighbour_record
         {
             neighbour_record(warthog::search_node* node, double cost)
@@ -141,6 +172,16 @@ class txevl_gridmap_expansion_policy
         inline void 
         add_neighbour(warthog::search_node* nei, double cost)
         {
+            if(restab_ && restab_->is_reserved(
+                    nei->get_id() & id_mask_, nei->get_id() >> bitwidth_map_))
+            {
+                return;
+            }
+            if(sparse_restab_ && sparse_restab_->is_reserved(
+                    nei->get_id() & id_mask_, nei->get_id() >> bitwidth_map_))
+            {
+                return;
+            }
             neis_->push_back(neighbour_record(nei, cost));
             //std::cout << " neis_.size() == " << neis_->size() << std::endl;
         }
@@ -3,7 +3,8 @@
 
 // memory/node_pool.h
 //
-// A memory pool of warthog::search_node objects.
+// A memory pool of search node objects (warthog::search_node by
+// default; see node_pool_base for pools of other node types).
 //
 // This implementation uses ragged two-dimensional array 
 // allocator. Memory for the pool is reserved but nodes
@@ -41,36 +42,123 @@ namespace node_pool_ns
 	static const uint32_t NBS_MASK = 7;
 }
 
-class node_pool
+// NODE is the type of search node held by the pool; see search_node.h
+template<class NODE>
+class node_pool_base
 {
 	public:
-        node_pool(uint32_t num_nodes);
-		~node_pool();
-
-		// return a warthog::search_node object corresponding to the given id.
+        node_pool_base(uint32_t num_nodes)
+            : blocks_(0)
+        {
+            init(num_nodes);
+        }
+
+		~node_pool_base()
+        {
+            blockspool_->reclaim();
+            delete blockspool_;
+
+            for(uint32_t i=0; i < num_blocks_; i++)
+            {
+                if(blocks_[i] != 0)
+                {
+                    blocks_[i] = 0;
+                }
+            }
+            delete [] blocks_;
+        }
+
+		// return a search node object corresponding to the given id.
 		// if the node has already been generated, return a pointer to the 
 		// previous instance; otherwise allocate memory for a new object.
-		warthog::search_node*
-		generate(uint32_t node_id);
+		NODE*
+		generate(uint32_t node_id)
+        {
+            uint32_t block_id = node_id >> warthog::mem::node_pool_ns::LOG2_NBS;
+            uint32_t list_id = node_id &  warthog::mem::node_pool_ns::NBS_MASK;
+            assert(block_id <= num_blocks_);
+
+            // add a new block of nodes if necessary
+            if(!blocks_[block_id])
+            {
+                blocks_[block_id] = new (blockspool_->allocate())
+                    NODE[warthog::mem::node_pool_ns::NBS];
+
+                // initialise memory 
+                uint32_t current_id = node_id - list_id;
+                for( uint32_t i  = 0; i < warthog::mem::node_pool_ns::NBS; i+=8)
+                {
+                    new (&blocks_[block_id][i]) NODE(current_id++);
+                    new (&blocks_[block_id][i+1]) NODE(current_id++);
+                    new (&blocks_[block_id][i+2]) NODE(current_id++);
+                    new (&blocks_[block_id][i+3]) NODE(current_id++);
+                    new (&blocks_[block_id][i+4]) NODE(current_id++);
+                    new (&blocks_[block_id][i+5]) NODE(current_id++);
+                    new (&blocks_[block_id][i+6]) NODE(current_id++);
+                    new (&blocks_[block_id][i+7]) NODE(current_id++);
+                }
+            }
+
+            // return the node from its position in the assocated block 
+            return &(blocks_[block_id][list_id]);
+        }
 
         // return a pre-allocated pointer. if the corresponding node has not
         // been allocated yet, return null
-        warthog::search_node*
-        get_ptr(uint32_t node_id);
+        NODE*
+        get_ptr(uint32_t node_id)
+        {
+            uint32_t block_id = node_id >> warthog::mem::node_pool_ns::LOG2_NBS;
+            uint32_t list_id = node_id &  warthog::mem::node_pool_ns::NBS_MASK;
+            assert(block_id <= num_blocks_);
+
+            if(!blocks_[block_id])
+            {
+                return 0;
+            }
+            return &(blocks_[block_id][list_id]);
+        }
 
 		uint32_t
-		mem();
+		mem()
+        {
+            uint32_t bytes = 
+                sizeof(*this) + 
+                blockspool_->mem() +
+                num_blocks_*sizeof(void*);
+
+            return bytes;
+        }
 
 	private:
-        void init(uint32_t nblocks);
+        void 
+        init(uint32_t num_nodes)
+        {
+            num_blocks_ = 
+                ((num_nodes) >> warthog::mem::node_pool_ns::LOG2_NBS)+1;
+            blocks_ = new NODE*[num_blocks_];
+            for(uint32_t i=0; i < num_blocks_; i++)
+            {
+                blocks_[i] = 0;
+            }
+
+            // by default: 
+            // allocate one chunk of memory of size
+            // warthog::mem::DEFAULT_CHUNK_SIZE and assign addresses
+            // from that pool in order to generate blocks of nodes. when the 
+            // pool is full, cpool pre-allocates more, one chunk at a time. 
+            uint32_t block_sz = 
+                warthog::mem::node_pool_ns::NBS * sizeof(NODE);
+            blockspool_ = new warthog::mem::cpool(block_sz, 1);
+        }
 
 		uint32_t num_blocks_;
-		warthog::search_node** blocks_;
+		NODE** blocks_;
 		warthog::mem::cpool* blockspool_;
-//        uint64_t* node_init_;
-//        uint64_t node_init_sz_;
 };
 
+typedef node_pool_base<warthog::search_node> node_pool;
+
 }
 
 }
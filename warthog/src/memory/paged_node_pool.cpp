@@ -0,0 +1,3 @@
+#include "paged_node_pool.h"
+
+template class warthog::mem::paged_node_pool_base<warthog::search_node>;
@@ -0,0 +1,252 @@
+#ifndef WARTHOG_PAGED_NODE_POOL_H
+#define WARTHOG_PAGED_NODE_POOL_H
+
+// memory/paged_node_pool.h
+//
+// A sparse pool of search node objects which serves as the private
+// search context of one thread.
+//
+// Node ids are divided into pages of PAGE_SIZE consecutive ids and
+// pages are indexed by a two-level directory: a small top-level array
+// of pointers to directory blocks, each of which covers DIR_SIZE pages.
+// Pages and directory blocks are allocated the first time a node they
+// cover is generated, so memory is proportional to the part of the
+// domain reached by the search, not to the size of the domain.
+//
+// The pool keeps a list of the pages touched since the last ::reset.
+// ::reset moves these pages to a free list in O(touched pages) time.
+// Free pages are re-initialised and reused by subsequent searches, or
+// returned to the system via ::reclaim.
+//
+// Unlike warthog::mem::node_pool, nodes remain valid only until the
+// next call to ::reset. A pool must not be shared by two searches that
+// run at the same time, e.g. by the forward and backward expansion
+// policies of a bidirectional search.
+//
+
+#include "search_node.h"
+
+#include <cassert>
+#include <new>
+#include <stdint.h>
+#include <vector>
+
+namespace warthog
+{
+
+namespace mem
+{
+
+namespace paged_node_pool_ns
+{
+    static const uint32_t LOG2_PAGE_SIZE = 3;
+    static const uint32_t PAGE_SIZE = 1 << LOG2_PAGE_SIZE; // nodes per page
+    static const uint32_t PAGE_MASK = PAGE_SIZE - 1;
+    static const uint32_t LOG2_DIR_SIZE = 9;
+    static const uint32_t DIR_SIZE = 1 << LOG2_DIR_SIZE; // pages per block
+    static const uint32_t DIR_MASK = DIR_SIZE - 1;
+}
+
+// NODE is the type of search node held by the pool; see search_node.h
+template<class NODE>
+class paged_node_pool_base
+{
+    public:
+        paged_node_pool_base(uint32_t num_nodes)
+        {
+            num_nodes_ = num_nodes;
+            num_dirs_ = (num_nodes >>
+                (warthog::mem::paged_node_pool_ns::LOG2_PAGE_SIZE +
+                 warthog::mem::paged_node_pool_ns::LOG2_DIR_SIZE)) + 1;
+            dirs_ = new NODE**[num_dirs_]();
+        }
+
+        ~paged_node_pool_base()
+        {
+            reset();
+            reclaim();
+            delete [] dirs_;
+        }
+
+        // return a search node object corresponding to the given id.
+        // if the node has already been generated since the last ::reset,
+        // return a pointer to the previous instance; otherwise allocate
+        // (or reuse) a page of nodes that contains it.
+        // ids outside the pool (e.g. warthog::NODE_NONE, the parent of a
+        // start node) yield null.
+        inline NODE*
+        generate(uint32_t node_id)
+        {
+            NODE* node = get_ptr(node_id);
+            if(node) { return node; }
+            if(!in_range(node_id)) { return 0; }
+            return &add_page(node_id)
+                [node_id & warthog::mem::paged_node_pool_ns::PAGE_MASK];
+        }
+
+        // return a pointer to the node with id @param node_id if its page
+        // was touched since the last ::reset, and null otherwise
+        inline NODE*
+        get_ptr(uint32_t node_id)
+        {
+            if(!in_range(node_id)) { return 0; }
+            uint32_t page_id =
+                node_id >> warthog::mem::paged_node_pool_ns::LOG2_PAGE_SIZE;
+            uint32_t dir_id =
+                page_id >> warthog::mem::paged_node_pool_ns::LOG2_DIR_SIZE;
+
+            NODE** dir = dirs_[dir_id];
+            if(!dir) { return 0; }
+            NODE* page = dir[page_id & warthog::mem::paged_node_pool_ns::DIR_MASK];
+            if(!page) { return 0; }
+            return &page[node_id & warthog::mem::paged_node_pool_ns::PAGE_MASK];
+        }
+
+        // forget every node generated since the last reset.
+        // runs in time proportional to the number of touched pages.
+        void
+        reset()
+        {
+            for(uint32_t i = 0; i < touched_.size(); i++)
+            {
+                NODE*& page = page_ref(touched_[i]);
+                free_.push_back(page);
+                page = 0;
+            }
+            touched_.clear();
+        }
+
+        // release the memory of every page on the free list. directory
+        // blocks are released too if no page is in use.
+        void
+        reclaim()
+        {
+            for(uint32_t i = 0; i < free_.size(); i++)
+            {
+                destroy_page(free_[i]);
+                operator delete(free_[i]);
+            }
+            free_.clear();
+            free_.shrink_to_fit();
+
+            if(touched_.size() == 0)
+            {
+                for(uint32_t i = 0; i < used_dirs_.size(); i++)
+                {
+                    delete [] dirs_[used_dirs_[i]];
+                    dirs_[used_dirs_[i]] = 0;
+                }
+                used_dirs_.clear();
+                used_dirs_.shrink_to_fit();
+                touched_.shrink_to_fit();
+            }
+        }
+
+        // the number of node ids covered by the pool
+        inline uint32_t
+        get_num_nodes() { return num_nodes_; }
+
+        // the number of pages touched since the last reset
+        inline uint32_t
+        get_num_touched_pages() { return touched_.size(); }
+
+        size_t
+        mem()
+        {
+            return sizeof(*this) +
+                sizeof(NODE**) * num_dirs_ +
+                sizeof(NODE*) * warthog::mem::paged_node_pool_ns::DIR_SIZE *
+                    used_dirs_.size() +
+                sizeof(uint32_t) *
+                    (touched_.capacity() + used_dirs_.capacity()) +
+                sizeof(NODE*) * free_.capacity() +
+                page_bytes() * (touched_.size() + free_.size());
+        }
+
+    private:
+        uint32_t num_nodes_;
+        uint32_t num_dirs_;
+        NODE*** dirs_;
+        std::vector<uint32_t> used_dirs_;   // allocated directory blocks
+        std::vector<uint32_t> touched_;     // pages in use
+        std::vector<NODE*> free_;           // pages not in use
+
+        // true if the directory has an entry for @param node_id
+        inline bool
+        in_range(uint32_t node_id)
+        {
+            return (node_id >> (warthog::mem::paged_node_pool_ns::LOG2_PAGE_SIZE +
+                    warthog::mem::paged_node_pool_ns::LOG2_DIR_SIZE)) < num_dirs_;
+        }
+
+        static inline size_t
+        page_bytes()
+        { return sizeof(NODE) * warthog::mem::paged_node_pool_ns::PAGE_SIZE; }
+
+        // the directory entry of page @param page_id. the directory
+        // block must exist.
+        inline NODE*&
+        page_ref(uint32_t page_id)
+        {
+            return dirs_[page_id >>
+                warthog::mem::paged_node_pool_ns::LOG2_DIR_SIZE]
+                [page_id & warthog::mem::paged_node_pool_ns::DIR_MASK];
+        }
+
+        NODE*
+        add_page(uint32_t node_id)
+        {
+            uint32_t page_id =
+                node_id >> warthog::mem::paged_node_pool_ns::LOG2_PAGE_SIZE;
+            uint32_t dir_id =
+                page_id >> warthog::mem::paged_node_pool_ns::LOG2_DIR_SIZE;
+            if(!dirs_[dir_id])
+            {
+                dirs_[dir_id] =
+                    new NODE*[warthog::mem::paged_node_pool_ns::DIR_SIZE]();
+                used_dirs_.push_back(dir_id);
+            }
+
+            NODE* page;
+            if(free_.size())
+            {
+                page = free_.back();
+                free_.pop_back();
+                destroy_page(page);
+            }
+            else
+            {
+                page = (NODE*)operator new(page_bytes());
+            }
+
+            uint32_t current_id = page_id <<
+                warthog::mem::paged_node_pool_ns::LOG2_PAGE_SIZE;
+            for(uint32_t i = 0;
+                i < warthog::mem::paged_node_pool_ns::PAGE_SIZE; i++)
+            {
+                new (&page[i]) NODE(current_id++);
+            }
+
+            page_ref(page_id) = page;
+            touched_.push_back(page_id);
+            return page;
+        }
+
+        void
+        destroy_page(NODE* page)
+        {
+            for(uint32_t i = 0;
+                i < warthog::mem::paged_node_pool_ns::PAGE_SIZE; i++)
+            {
+                page[i].~NODE();
+            }
+        }
+};
+
+typedef paged_node_pool_base<warthog::search_node> paged_node_pool;
+
+}
+
+}
+
+#endif
@@ -1,9 +1,11 @@
 #include "cfg.h"
 #include "bch_expansion_policy.h"
+#include "customizable_ch.h"
 #include "dimacs_parser.h"
 #include "fixed_graph_contraction.h"
 #include "graph.h"
 #include "lazy_graph_contraction.h"
+#include "timer.h"
 #include "xy_graph.h"
 
 #include <iostream>
@@ -20,13 +22,95 @@ help()
         "create a contraction hierarchy from " <<
         "a given (currently, DIMACS-format only) input graph\n";
 	std::cerr << "valid parameters:\n"
-	<< "\t--order [ fixed | lazy ]\n"
+	<< "\t--order [ fixed | lazy | nd ]\n"
+    << "\t\tnd [METIS .iperm file] (optional) creates a customizable CH:\n"
+    << "\t\tthe topology is contracted in nested dissection order and saved\n"
+    << "\t\tto [gr file].cch, then customized with the input weights.\n"
+    << "\t\twithout a METIS order, a geometric nested dissection is used\n"
+    << "\t--customize [cch file] (re-weight a customizable CH with the\n"
+    << "\t\tweights of the --input graph; the nodes must be the same)\n"
     << "\t--partial [1-100] (optional; percentage of nodes to contract)\n"
     << "\t--input [gr file] [co file] (IN THIS ORDER!!)\n"
+	<< "\t--threads [int] (optional; lazy order: contract independent\n"
+    << "\t\tsets of nodes in parallel; nd order and --customize: threads\n"
+    << "\t\tused for customization; 0 = one thread per core)\n"
+	<< "\t--witness [ one-to-many | pairwise ] (optional; lazy order only.\n"
+    << "\t\twitness search method; default is one-to-many)\n"
+    << "\t--ws-settle [int] (optional; nodes settled per witness search;\n"
+    << "\t\tdefault is 500)\n"
+    << "\t--ws-hops [int] (optional; max edges on a one-to-many witness path;\n"
+    << "\t\tdefault is 0, i.e. no limit)\n"
 	<< "\t--verbose (optional)\n"
 	<< "\t--verify (verify lazy node priorities before contraction)\n";
 }
 
+// customize @param cch with the weights of @param g and save the 
+// resulting hierarchy to [@param grfile].ch and its order to [..].ch.ooc
+bool
+customize_and_save(warthog::ch::customizable_ch& cch, 
+        warthog::graph::xy_graph& g, std::string grfile)
+{
+    std::string threads = cfg.get_param_value("threads");
+    uint32_t num_threads = threads == "" ? 1 : atoi(threads.c_str());
+
+    warthog::timer mytimer;
+    mytimer.start();
+    if(!cch.customize(&g, num_threads)) { return false; }
+    mytimer.stop();
+    std::cerr << "customized " << cch.get_num_arcs() << " arcs in "
+        << cch.get_num_levels() << " levels; time (s): " 
+        << mytimer.elapsed_time_micro() / 1e6 << std::endl;
+
+    warthog::graph::xy_graph ch;
+    cch.make_hierarchy(&g, &ch, 0);
+
+    grfile.append(".ch");
+    std::cerr << "saving contracted graph to file " << grfile << std::endl;
+    std::fstream ch_out(grfile.c_str(), std::ios_base::out | std::ios_base::trunc);
+    if(!ch_out.good())
+    {
+        std::cerr << "\nerror exporting ch to file " << grfile << std::endl;
+        return false;
+    }
+    ch.print_dimacs_gr(ch_out, 0, ch.get_num_nodes());
+    ch_out.close();
+
+    std::vector<uint32_t> order;
+    cch.get_order(order);
+    std::string orderfile = grfile + ".ooc";
+    std::cerr << "saving order to file " << orderfile << std::endl;
+    warthog::ch::write_node_order(orderfile.c_str(), order);
+    return true;
+}
+
+void
+customize_graph()
+{
+    std::string cchfile = cfg.get_param_value("customize");
+    std::string grfile = cfg.get_param_value("input");
+    std::string cofile = cfg.get_param_value("input");
+    if(grfile == "" || cofile == "")
+    {
+        std::cerr << "err; insufficient input parameters."
+                  << " required, in order:\n"
+                  << " --input [gr file] [co file]\n";
+        return;
+    }
+
+    warthog::ch::customizable_ch cch;
+    if(!cch.load(cchfile.c_str())) { return; }
+
+    warthog::graph::xy_graph g;
+    if(!g.load_from_dimacs(grfile.c_str(), cofile.c_str()))
+    {
+        std::cerr 
+            << "err; could not load gr or co input files (one or both)\n";
+        return;
+    }
+    if(!customize_and_save(cch, g, grfile)) { return; }
+    std::cerr << "all done!\n";
+}
+
 void 
 contract_graph()
 {
@@ -111,7 +195,33 @@ contract_graph()
         }
         warthog::ch::lazy_graph_contraction contractor(&g);
         contractor.set_verbose(verbose);
-        contractor.contract(verify, pct_nodes_to_contract);
+
+        std::string witness = cfg.get_param_value("witness");
+        if(witness == "pairwise")
+        {
+            contractor.set_witness_search(warthog::ch::WS_PAIRWISE);
+        }
+        else if(witness != "" && witness != "one-to-many")
+        {
+            std::cerr << "err; unknown parameter for --witness\n";
+            return;
+        }
+        std::string ws_settle = cfg.get_param_value("ws-settle");
+        std::string ws_hops = cfg.get_param_value("ws-hops");
+        contractor.set_witness_limits(
+                ws_settle == "" ? 500 : atoi(ws_settle.c_str()),
+                ws_hops == "" ? 0 : atoi(ws_hops.c_str()));
+
+        std::string threads = cfg.get_param_value("threads");
+        if(threads != "")
+        {
+            contractor.contract_parallel(
+                    atoi(threads.c_str()), pct_nodes_to_contract);
+        }
+        else
+        {
+            contractor.contract(verify, pct_nodes_to_contract);
+        }
 
 
         // save the result
@@ -141,6 +251,42 @@ contract_graph()
         //warthog::ch::write_node_order(std::cout, order);
 
     }
+    else if(order_type == "nd")
+    {
+        // customizable CH: metric-independent order and contraction
+        if(!g.load_from_dimacs(grfile.c_str(), cofile.c_str()))
+        {
+            std::cerr 
+                << "err; could not load gr or co input files (one or both)\n";
+            return;
+        }
+
+        warthog::timer mytimer;
+        mytimer.start();
+        std::string orderfile = cfg.get_param_value("order");
+        if(orderfile != "")
+        {
+            if(!warthog::ch::load_metis_order(orderfile.c_str(), &g, order))
+            { return; }
+        }
+        else
+        {
+            warthog::ch::make_nested_dissection_order(&g, order);
+        }
+
+        warthog::ch::customizable_ch cch;
+        if(!cch.contract(&g, order)) { return; }
+        mytimer.stop();
+        std::cerr << "contracted topology; arcs: " << cch.get_num_arcs()
+            << "; time (s): " << mytimer.elapsed_time_micro() / 1e6
+            << std::endl;
+
+        std::string cchfile = grfile + ".cch";
+        std::cerr << "saving topology to file " << cchfile << std::endl;
+        if(!cch.save(cchfile.c_str())) { return; }
+
+        if(!customize_and_save(cch, g, grfile)) { return; }
+    }
     else
     {
         std::cerr << "unknown parameter for --order\n";
@@ -160,7 +306,12 @@ int main(int argc, char** argv)
 		{"verify", no_argument, &verify, 1},
 		{"input",  required_argument, 0, 2},
 		{"order",  required_argument, 0, 3},
-		{"partial",  required_argument, 0, 4}
+		{"partial",  required_argument, 0, 4},
+		{"threads",  required_argument, 0, 5},
+		{"witness",  required_argument, 0, 6},
+		{"ws-settle",  required_argument, 0, 7},
+		{"ws-hops",  required_argument, 0, 8},
+		{"customize",  required_argument, 0, 9}
 	};
 	cfg.parse_args(argc, argv, "-hvd:o:", valid_args);
 
@@ -170,5 +321,12 @@ int main(int argc, char** argv)
         exit(0);
     }
 
-    contract_graph();
+    if(cfg.get_num_values("customize") > 0)
+    {
+        customize_graph();
+    }
+    else
+    {
+        contract_graph();
+    }
 }
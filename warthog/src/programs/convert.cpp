@@ -6,38 +6,79 @@
 
 #include <fstream>
 
+// convert a DIMACS graph into a graph image that can be memory-mapped
+// by xy_graph::load_from_image (see domains/xy_graph_image.h). 
+// when a contraction order is given, the rank of every node is stored
+// in the image and the edges are arranged for FCH or BCH search.
 int
 main_dimacs_to_binary(int argc, char** argv)
 {
-    if(argc < 3)
+    if(argc < 4)
     {
         std::cerr 
             << argv[0] 
-            << " [dimacs gr file] [dimacs co file] [output file]\n";
+            << " [dimacs gr file] [dimacs co file] [output file]"
+            << " [contraction order file (optional)]"
+            << " [plain | fch | bch (edge layout; default: bch)]\n";
         exit(EINVAL);
     }
 
     warthog::graph::xy_graph g;
-    g.load_from_dimacs(argv[1], argv[2]);
+    if(!g.load_from_dimacs(argv[1], argv[2], false, true))
+    {
+        std::cerr << "err; could not load gr or co input files\n";
+        return EINVAL;
+    }
+
+    std::vector<uint32_t> order;
+    uint32_t layout = warthog::graph::XYG_LAYOUT_PLAIN;
+    if(argc > 4)
+    {
+        if(!warthog::ch::load_node_order(argv[4], order, true))
+        {
+            std::cerr << "err; could not load node order input file\n";
+            return EINVAL;
+        }
+        if(order.size() != g.get_num_nodes())
+        {
+            std::cerr << "contraction order length not equal to "
+                << " number of graph nodes\n";
+            return EINVAL;
+        }
+
+        std::string layout_name = argc > 5 ? argv[5] : "bch";
+        if(layout_name == "bch")
+        {
+            warthog::ch::optimise_graph_for_bch_v2(&g, &order);
+            layout = warthog::graph::XYG_LAYOUT_BCH;
+        }
+        else if(layout_name == "fch")
+        {
+            warthog::ch::fch_sort_successors(&g, &order);
+            layout = warthog::graph::XYG_LAYOUT_FCH;
+        }
+        else if(layout_name != "plain")
+        {
+            std::cerr << "err; unknown edge layout " << layout_name << "\n";
+            return EINVAL;
+        }
+    }
 
-    std::ofstream ofs(argv[3], std::ofstream::binary);
-    g.save(ofs),
-    ofs.close();
+    if(!g.save_image(argv[3], order.size() ? &order : 0, layout))
+    {
+        return EINVAL;
+    }
 
+    // verify the result
     warthog::graph::xy_graph g2;
-    std::ifstream ifs(argv[3], std::ifstream::binary);
-    g2.load_from_blob(ifs, true, true);
-    ifs.close();
-
-//    if(g == g2)
-//    {
-//        std::cout << "conversion finished and verified. all good!" 
-//            << std::endl;
-//    }
-//    else
-//    {
-//        std::cout << "conversion failed" << std::endl;
-//    }
+    std::vector<uint32_t> order2;
+    if(!g2.load_from_image(argv[3], order.size() ? &order2 : 0) || 
+        !(g == g2) || order != order2)
+    {
+        std::cerr << "conversion failed" << std::endl;
+        return EINVAL;
+    }
+    std::cerr << "conversion finished and verified. all good!" << std::endl;
     return 0; 
 }
 
@@ -405,6 +446,6 @@ main_bbaf_convert(int argc, char** argv)
 int
 main(int argc, char** argv)
 {
-    main_dimacs_to_binary(argc, argv);
+    return main_dimacs_to_binary(argc, argv);
 }
 
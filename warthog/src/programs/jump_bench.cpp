@@ -0,0 +1,197 @@
+// programs/jump_bench.cpp
+//
+// Measures the cost of online jumps (online_jump_point_locator2) when
+// straight jumps read 32, 64 or 256 tiles at a time. For every instance
+// in each movingai scenario file the start node is jumped from in all
+// eight directions, once with ::jump and once with ::rjump. Results are
+// grouped by map family, i.e. the directory that holds the map file, and
+// all scan widths must agree on every jump point and cost. The column
+// "wide" counts the maps where SCAN_256BIT is the default width.
+//
+
+#include "gridmap.h"
+#include "jps.h"
+#include "online_jump_point_locator2.h"
+#include "scenario_manager.h"
+#include "timer.h"
+
+#include <cerrno>
+#include <cfloat>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+const uint32_t NUM_RUNS = 5;
+const uint32_t NUM_WIDTHS = 3;
+const warthog::jps::scan_width widths[NUM_WIDTHS] = {
+    warthog::jps::SCAN_32BIT,
+    warthog::jps::SCAN_64BIT,
+    warthog::jps::SCAN_256BIT };
+
+void
+help()
+{
+    std::cerr
+        << "Measures the cost of online jumps for each scan width\n"
+        << "Usage: ./jump_bench [scen file] [scen file] ...\n"
+        << "Each scan width is timed " << NUM_RUNS << " times per scenario "
+        << "file; the fastest run is reported\n";
+}
+
+struct family_result
+{
+    uint32_t maps_;
+    uint32_t wide_maps_; // maps where SCAN_256BIT is the default
+    uint64_t jumps_;
+    double nanos_[NUM_WIDTHS];
+};
+
+// make every jump for the instances in @param scenmgr once.
+// @return the time taken; @param checksum summarises the jump points
+double
+run_jumps(warthog::scenario_manager& scenmgr, warthog::gridmap& map,
+        warthog::jps::online_jump_point_locator2& jpl, double& checksum)
+{
+    std::vector<uint32_t> jpoints;
+    std::vector<double> costs;
+    checksum = 0;
+
+    warthog::timer mytimer;
+    mytimer.start();
+    for(uint32_t i = 0; i < scenmgr.num_experiments(); i++)
+    {
+        warthog::experiment* exp = scenmgr.get_experiment(i);
+        uint32_t node_id = map.to_padded_id(exp->startx(), exp->starty());
+        uint32_t goal_id = map.to_padded_id(exp->goalx(), exp->goaly());
+        for(uint32_t d = warthog::jps::NORTH;
+                d <= warthog::jps::SOUTHWEST; d <<= 1)
+        {
+            jpoints.clear();
+            costs.clear();
+            jpl.jump((warthog::jps::direction)d, node_id, goal_id,
+                    jpoints, costs);
+            jpl.rjump((warthog::jps::direction)d, node_id, goal_id,
+                    jpoints, costs);
+            for(uint32_t j = 0; j < jpoints.size(); j++)
+            {
+                checksum += (jpoints[j] & warthog::jps::ID_MASK) *
+                    (j+1) + costs[j];
+            }
+        }
+    }
+    mytimer.stop();
+    return mytimer.elapsed_time_nano();
+}
+
+int
+main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        help();
+        return EINVAL;
+    }
+
+    uint32_t num_widths = NUM_WIDTHS;
+    if(warthog::jps::online_jump_point_locator2::cpu_scan_width() !=
+            warthog::jps::SCAN_256BIT)
+    {
+        std::cerr << "cpu does not support SCAN_256BIT; skipping\n";
+        num_widths--;
+    }
+
+    std::map<std::string, family_result> families;
+    for(int arg = 1; arg < argc; arg++)
+    {
+        warthog::scenario_manager scenmgr;
+        scenmgr.load_scenario(argv[arg]);
+        if(scenmgr.num_experiments() == 0)
+        {
+            std::cerr << "err; scenario file has no instances: "
+                << argv[arg] << "\n";
+            return EINVAL;
+        }
+
+        std::string mapfile = scenmgr.get_experiment(0)->map();
+        warthog::gridmap map(mapfile.c_str());
+        warthog::jps::online_jump_point_locator2 jpl(&map);
+
+        std::string family = ".";
+        size_t pos = mapfile.find_last_of('/');
+        if(pos != std::string::npos && pos > 0)
+        {
+            family = mapfile.substr(0, pos);
+            size_t dir = family.find_last_of('/');
+            if(dir != std::string::npos) { family = family.substr(dir+1); }
+        }
+
+        family_result& fr = families[family];
+        fr.maps_++;
+        fr.wide_maps_ += 
+            jpl.best_scan_width() == warthog::jps::SCAN_256BIT;
+        fr.jumps_ += (uint64_t)scenmgr.num_experiments() * 16;
+
+        // interleave the widths so that each sees the same machine state
+        double best[NUM_WIDTHS] = { DBL_MAX, DBL_MAX, DBL_MAX };
+        double checksum[NUM_WIDTHS];
+        for(uint32_t run = 0; run < NUM_RUNS; run++)
+        {
+            for(uint32_t w = 0; w < num_widths; w++)
+            {
+                jpl.set_scan_width(widths[w]);
+                double nanos = run_jumps(scenmgr, map, jpl, checksum[w]);
+                if(nanos < best[w]) { best[w] = nanos; }
+            }
+        }
+
+        for(uint32_t w = 0; w < num_widths; w++)
+        {
+            if(checksum[w] != checksum[0])
+            {
+                std::cerr << "err; scan width " << widths[w]
+                    << " disagrees with " << widths[0]
+                    << " on " << mapfile << "\n";
+                return 1;
+            }
+            fr.nanos_[w] += best[w];
+        }
+    }
+
+    std::cout
+        << std::setw(12) << std::left << "family"
+        << std::setw(6) << std::right << "maps"
+        << std::setw(6) << "wide"
+        << std::setw(12) << "jumps";
+    for(uint32_t w = 0; w < num_widths; w++)
+    {
+        std::cout << std::setw(10) << "ns/" + std::to_string(widths[w]);
+    }
+    for(uint32_t w = 1; w < num_widths; w++)
+    {
+        std::cout << std::setw(10) << "x" + std::to_string(widths[w]);
+    }
+    std::cout << std::endl;
+
+    for(auto& it : families)
+    {
+        family_result& fr = it.second;
+        std::cout
+            << std::setw(12) << std::left << it.first
+            << std::setw(6) << std::right << fr.maps_
+            << std::setw(6) << fr.wide_maps_
+            << std::setw(12) << fr.jumps_
+            << std::fixed << std::setprecision(2);
+        for(uint32_t w = 0; w < num_widths; w++)
+        {
+            std::cout << std::setw(10) << fr.nanos_[w] / fr.jumps_;
+        }
+        for(uint32_t w = 1; w < num_widths; w++)
+        {
+            std::cout << std::setw(10) << fr.nanos_[0] / fr.nanos_[w];
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
@@ -3,6 +3,7 @@
 #include "bbaf_labelling.h"
 #include "dfs_labelling.h"
 #include "firstmove_labelling.h"
+#include "firstmove_table.h"
 #include "cfg.h"
 #include "contraction.h"
 #include "corner_point_graph.h"
@@ -21,6 +22,7 @@
 #include <string>
 
 int verbose=false;
+int stream_labels=false;
 warthog::util::cfg cfg;
 
 void
@@ -35,6 +37,10 @@ help()
     << "\t--type [ af | bb | bbaf | fm | fch-af | fch-bb "
     << "| fch-bbaf | fch-bb-jpg | fch-dfs | fch-fm ] \n"
     << "\t--input [ algorithm-specific input files (omit to show options) ]\n" 
+    << "\t--threads [ int (worker threads; default: one per hardware thread) ]\n"
+	<< "\t--stream (fm and fch-fm only; write rows to disk as they are\n"
+    << "\t\tcomputed. an interrupted run resumes when restarted)\n"
+    << "\tfm and fch-fm also write a firstmove table (.fmt) for roadhog\n"
 	<< "\t--verbose (optional)\n";
 }
 
@@ -1017,6 +1023,29 @@ compute_fch_dfs_labels(std::string alg_name)
     std::cerr << "done.\n";
 }
 
+// write the firstmove labelling in @param arclab_file to a firstmove
+// table (see label/firstmove_table.h), which is what the search programs
+// load. @param lab is read from @param arclab_file if null.
+void
+save_fm_table(std::string arclab_file, warthog::graph::xy_graph& g,
+        std::vector<uint32_t>& column_order,
+        warthog::label::firstmove_labelling* lab = 0)
+{
+    std::shared_ptr<warthog::label::firstmove_labelling> loaded;
+    if(lab == 0)
+    {
+        loaded.reset(warthog::label::firstmove_labelling::load(
+                    arclab_file.c_str(), &g, 0));
+        if(!loaded) { return; }
+        lab = loaded.get();
+    }
+
+    std::string table_file = 
+        arclab_file.substr(0, arclab_file.rfind(".label")) + ".fmt";
+    warthog::label::firstmove_table::save(
+            table_file.c_str(), *lab, column_order);
+}
+
 void
 compute_fch_fm_labels(std::string alg_name)
 {
@@ -1098,14 +1127,30 @@ compute_fch_fm_labels(std::string alg_name)
     warthog::label::compute_fm_fch_dfs_preorder(g, order, column_order);
     //warthog::label::compute_fm_fch_dijkstra_dfs_preorder(g, order, column_order);
     
+    std::string arclab_file =  grfile + "." + alg_name + "." + "label";
+    if(stream_labels)
+    {
+        if(!warthog::label::firstmove_labelling::compute_to_file
+                <warthog::fch_expansion_policy> 
+                    (arclab_file.c_str(), &g, &column_order, 
+                     fn_new_expander, &workload))
+        {
+            std::cerr << "err; labelling incomplete\n";
+            return;
+        }
+        save_fm_table(arclab_file, g, column_order);
+        std::cerr << "done.\n";
+        return;
+    }
+
     // gogogogo
     std::shared_ptr<warthog::label::firstmove_labelling> lab(
             warthog::label::firstmove_labelling::compute
                 <warthog::fch_expansion_policy> 
                     (&g, &column_order, fn_new_expander, &workload));
 
-    std::string arclab_file =  grfile + "." + alg_name + "." + "label";
     warthog::label::firstmove_labelling::save(arclab_file.c_str(), *lab);
+    save_fm_table(arclab_file, g, column_order, lab.get());
     std::cerr << "done.\n";
 }
 
@@ -1165,14 +1210,30 @@ compute_fm_labels(std::string alg_name)
             return new warthog::graph_expansion_policy<warthog::dummy_filter>(&g);
         };
     
+    std::string arclab_file =  grfile + "." + alg_name + "." + "label";
+    if(stream_labels)
+    {
+        if(!warthog::label::firstmove_labelling::compute_to_file
+                <warthog::graph_expansion_policy<warthog::dummy_filter>> 
+                    (arclab_file.c_str(), &g, &column_order, 
+                     fn_new_expander, &workload))
+        {
+            std::cerr << "err; labelling incomplete\n";
+            return;
+        }
+        save_fm_table(arclab_file, g, column_order);
+        std::cerr << "done.\n";
+        return;
+    }
+
     // gogogogo
     std::shared_ptr<warthog::label::firstmove_labelling> lab(
             warthog::label::firstmove_labelling::compute
                 <warthog::graph_expansion_policy<warthog::dummy_filter>> 
                     (&g, &column_order, fn_new_expander, &workload));
 
-    std::string arclab_file =  grfile + "." + alg_name + "." + "label";
     warthog::label::firstmove_labelling::save(arclab_file.c_str(), *lab);
+    save_fm_table(arclab_file, g, column_order, lab.get());
     std::cerr << "done.\n";
 }
 
@@ -1185,8 +1246,10 @@ int main(int argc, char** argv)
 	{
 		{"help", no_argument, &print_help, 1},
 		{"verbose", no_argument, &verbose, 1},
+		{"stream", no_argument, &stream_labels, 1},
 		{"input",  required_argument, 0, 2},
-        {"type", required_argument, 0, 1}
+        {"type", required_argument, 0, 1},
+        {"threads", required_argument, 0, 1}
 	};
 	cfg.parse_args(argc, argv, "-hvd:o:p:a:", valid_args);
 
@@ -1196,6 +1259,14 @@ int main(int argc, char** argv)
         return EINVAL;
     }
 
+    std::string par_threads = cfg.get_param_value("threads");
+    if(par_threads != "")
+    {
+        char* end;
+        warthog::helpers::set_parallel_threads(
+                strtol(par_threads.c_str(), &end, 10));
+    }
+
     // parse the type of labelling and the source nodes to be processed
     // source nodes are in the range: [first_id, last_id)
     std::string arclabel = cfg.get_param_value("type");
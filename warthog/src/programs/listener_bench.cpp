@@ -0,0 +1,153 @@
+// programs/listener_bench.cpp
+//
+// Measures the per-expansion cost of the listener hooks in flexible_astar.
+// Every instance in a movingai scenario file is solved with A*
+// (8-connected grid, octile heuristic) under three listeners:
+//
+//  dummy: the default listener; hooks are inlined away
+//  callback (unset): callback_listener with no callbacks installed.
+//  This is the cost every search paid when flexible_astar kept
+//  std::function pointers as members.
+//  callback (no-op): callback_listener with empty callbacks installed,
+//  i.e. the cost paid by tools like labelmaker.
+//
+
+#include "callback_listener.h"
+#include "dummy_listener.h"
+#include "flexible_astar.h"
+#include "gridmap.h"
+#include "gridmap_expansion_policy.h"
+#include "octile_heuristic.h"
+#include "scenario_manager.h"
+#include "timer.h"
+
+#include <cerrno>
+#include <cfloat>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+void
+help()
+{
+    std::cerr
+        << "Measures the per-expansion overhead of flexible_astar listeners\n"
+        << "Usage: ./listener_bench [scen file] [optional: nruns (default=3)]\n"
+        << "Each listener is timed nruns times; the fastest run is reported\n";
+}
+
+// the fastest of several runs over all instances, for one listener
+struct bench_result
+{
+    std::string name_;
+    double nanos_;
+    uint64_t expanded_;
+    double cost_;
+};
+
+// solve every instance in @param scenmgr once and keep the time if it
+// improves on earlier runs
+template<class L>
+void
+run_bench(warthog::scenario_manager& scenmgr, warthog::gridmap& map,
+        L listener, bench_result& result)
+{
+    warthog::gridmap_expansion_policy expander(&map);
+    warthog::octile_heuristic heuristic(map.width(), map.height());
+    warthog::pqueue_min open;
+
+    warthog::flexible_astar<
+        warthog::octile_heuristic,
+        warthog::gridmap_expansion_policy,
+        warthog::pqueue_min,
+        L> astar(&heuristic, &expander, &open, listener);
+
+    double nanos = 0;
+    result.expanded_ = 0;
+    result.cost_ = 0;
+    for(uint32_t i = 0; i < scenmgr.num_experiments(); i++)
+    {
+        warthog::experiment* exp = scenmgr.get_experiment(i);
+        warthog::problem_instance pi = exp->get_instance();
+        warthog::solution sol;
+        astar.get_distance(pi, sol);
+
+        nanos += sol.time_elapsed_nano_;
+        result.expanded_ += sol.nodes_expanded_;
+        result.cost_ += sol.sum_of_edge_costs_;
+    }
+    result.nanos_ = nanos < result.nanos_ ? nanos : result.nanos_;
+}
+
+int
+main(int argc, char** argv)
+{
+    if(argc < 2 || argc > 3)
+    {
+        help();
+        return EINVAL;
+    }
+
+    uint32_t nruns = 3;
+    if(argc == 3) { nruns = strtol(argv[2], 0, 10); }
+    if(nruns == 0) { nruns = 1; }
+
+    warthog::scenario_manager scenmgr;
+    scenmgr.load_scenario(argv[1]);
+    if(scenmgr.num_experiments() == 0)
+    {
+        std::cerr << "err; scenario file has no instances\n";
+        return EINVAL;
+    }
+    warthog::gridmap map(scenmgr.get_experiment(0)->map().c_str());
+
+    std::function<void(warthog::search_node*)> on_relax_fn =
+        [] (warthog::search_node*) -> void { };
+    std::function<void(warthog::search_node*)> on_expand_fn =
+        [] (warthog::search_node*) -> void { };
+    std::function<void(warthog::search_node*, warthog::search_node*,
+            double, uint32_t)> on_generate_fn =
+        [] (warthog::search_node*, warthog::search_node*,
+            double, uint32_t) -> void { };
+    warthog::callback_listener noop;
+    noop.apply_on_relax(on_relax_fn);
+    noop.apply_on_expand(on_expand_fn);
+    noop.apply_on_generate(on_generate_fn);
+
+    bench_result results[3] = {
+        {"dummy", DBL_MAX, 0, 0},
+        {"callback (unset)", DBL_MAX, 0, 0},
+        {"callback (no-op)", DBL_MAX, 0, 0} };
+
+    // interleave the listeners so that each sees the same machine state
+    for(uint32_t run = 0; run < nruns; run++)
+    {
+        run_bench(scenmgr, map, warthog::dummy_listener(), results[0]);
+        run_bench(scenmgr, map, warthog::callback_listener(), results[1]);
+        run_bench(scenmgr, map, noop, results[2]);
+    }
+
+    std::cout
+        << std::setw(20) << std::left << "listener"
+        << std::setw(14) << std::right << "expanded"
+        << std::setw(16) << "nanos"
+        << std::setw(16) << "nanos/expansion" << std::endl;
+    for(bench_result& r : results)
+    {
+        std::cout
+            << std::setw(20) << std::left << r.name_
+            << std::setw(14) << std::right << r.expanded_
+            << std::setw(16) << (uint64_t)r.nanos_
+            << std::setw(16) << std::fixed << std::setprecision(2)
+            << (r.expanded_ ? r.nanos_ / r.expanded_ : 0)
+            << std::endl;
+    }
+
+    if(results[0].cost_ != results[1].cost_ ||
+       results[0].cost_ != results[2].cost_)
+    {
+        std::cerr << "err; listeners disagree on solution costs\n";
+        return 1;
+    }
+    return 0;
+}
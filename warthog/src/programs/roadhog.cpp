@@ -10,8 +10,11 @@
 #include "af_filter.h"
 #include "apex_filter.h"
 #include "bbaf_filter.h"
+#include "batch_query.h"
 #include "bb_filter.h"
+#include "bch_many_to_many.h"
 #include "bch_search.h"
+#include "bucket_queue.h"
 #include "bidirectional_search.h"
 #include "cfg.h"
 #include "bch_expansion_policy.h"
@@ -23,6 +26,8 @@
 #include "constants.h"
 #include "contraction.h"
 #include "corner_point_graph.h"
+#include "cpd_search.h"
+#include "customizable_ch.h"
 #include "dimacs_parser.h"
 #include "euclidean_heuristic.h"
 #include "fch_af_expansion_policy.h"
@@ -33,10 +38,16 @@
 #include "fch_expansion_policy.h"
 #include "fch_x_expansion_policy.h"
 #include "firstmove_labelling.h"
+#include "firstmove_table.h"
 #include "fixed_graph_contraction.h"
 #include "flexible_astar.h"
 #include "graph_expansion_policy.h"
+#include "helpers.h"
+#include "kway_pqueue.h"
 #include "lazy_graph_contraction.h"
+#include "multilevel_bucket_queue.h"
+#include "phast.h"
+#include "radix_heap.h"
 #include "xy_graph.h"
 #include "solution.h"
 #include "timer.h"
@@ -55,10 +66,12 @@
 
 #include "getopt.h"
 
+#include <algorithm>
 #include <fstream>
 #include <functional>
 #include <iomanip>
 #include <memory>
+#include <queue>
 #include <sstream>
 #include <unordered_map>
 
@@ -74,6 +87,31 @@ int suppress_header = 0;
 
 uint32_t nruns = 1;
 
+// number of worker threads; zero means one per hardware thread
+uint32_t nthreads = 1;
+
+// type of the f- and g-values stored in search nodes (astar and dijkstra)
+std::string cost_type = "double";
+
+// type of open list used by the search
+std::string queue_type = "dary";
+
+// pack graph edges into one array before searching? (default: no)
+int csr_graph = 0;
+
+// run the two directions of bidirectional searches on two threads? 
+// (default: no)
+int parallel_bi = 0;
+
+// number of sources per phast sweep
+uint32_t phast_sources = 1;
+
+// disable AVX2 in phast sweeps? (default: no)
+int phast_nosimd = 0;
+
+// number of first moves extracted by cpd queries (0 = the whole path)
+uint32_t cpd_moves = 0;
+
 void
 help()
 {
@@ -83,14 +121,44 @@ help()
     << "\t--problem [ ss or p2p problem file (required) ]\n"
 	<< "\t--verbose (print debug info; omitting this param means no)\n"
 	<< "\t--nruns [int (repeats per instance; default=" << nruns << ")]\n"
+	<< "\t--threads [int (worker threads for queries and labelling; 0 = all cores; default=" << nthreads << ")]\n"
+	<< "\t--cost [double | float | uint32 (node cost type for astar and dijkstra; default=" << cost_type << ")]\n"
+	<< "\t--queue [binary | dary | dial | radix | mlb (open list; default=" << queue_type << ")]\n"
+	<< "\t\t(dial and radix order nodes by floor(f); they are exact for integer edge costs only)\n"
+	<< "\t--csr (store all graph edges in one array before searching; default: no)\n"
+	<< "\t--parallel (bi-astar, bi-dijkstra and bch search forward and backward on two threads; default: no)\n"
+	<< "\t--sources [1-16 (sources per phast sweep; default=" << phast_sources << ")]\n"
+	<< "\t--nosimd (phast sweeps without AVX2; default: no)\n"
+	<< "\t--moves [int (cpd stops after this many first moves; default=0, the whole path)]\n"
     << "\nRecognised values for --alg:\n"
     << "\tastar, dijkstra, bi-astar, bi-dijkstra\n"
-    << "\tbch, bch-astar, bch-af, bch-bb, bch-bbaf, chase, ch-cpg\n"
-    << "\tfch, fchx, fch-af, fch-bb, fch-bbaf, fch-dfs\n"
+    << "\tbch, bch-astar, bch-af, bch-bb, bch-bbaf, bch-m2m, chase, ch-cpg\n"
+    << "\tphast, cpd\n"
+    << "\tfch, fchx, fch-af, fch-bb, fch-bbaf, fch-dfs, fch-fm\n"
     << "\tfch-cpg, fch-af-cpg, fch-bb-cpg, fch-bbaf-cpg\n"
     << "\tfch-jpg, fch-bb-jpg, fch-af-jpg\n"
     << "\nRecognised values for --input:\n "
-    << "\ttoo many to list. missing input files will be listed at runtime\n";
+    << "\ttoo many to list. missing input files will be listed at runtime\n"
+    << "\tastar, dijkstra, bch, bch-astar and fch also accept a graph image\n"
+    << "\tmade by convert in place of the gr, co and order files\n"
+    << "\tCH-based algorithms accept a customizable CH topology (made by\n"
+    << "\tch --order nd) in place of the order file; the hierarchy is then\n"
+    << "\tcustomized with the weights of the gr file before searching\n"
+    << "\nbch-m2m computes a distance table. its problem file has the line\n"
+    << "\t\"p aux sp m2m\" followed by one \"s id\" line per source and one\n"
+    << "\t\"t id\" line per target. results are printed one table entry\n"
+    << "\tper row; the same file gives all entries as p2p queries to\n"
+    << "\tthe other algorithms\n"
+    << "\nphast computes one-to-all distances for each source of a ss or\n"
+    << "\tp2p problem file; --sources of them share one sweep. pcost is\n"
+    << "\tthe distance to the target (p2p only) and nanos the time of a\n"
+    << "\tsweep divided by the number of sources sharing it\n"
+    << "\ncpd answers p2p queries by following first moves from a\n"
+    << "\tcompressed path database, without search. its input is\n"
+    << "\t[gr file] [co file] [optional firstmove table]; without a\n"
+    << "\ttable, one is computed on first use and cached next to the gr file.\n"
+    << "\texpanded counts first-move lookups; with --moves k only the first\n"
+    << "\tk moves of each path are extracted and pcost is their cost\n";
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -144,80 +212,350 @@ help()
 //        };
 
 void
-run_experiments( warthog::search* algo, std::string alg_name, 
-        warthog::dimacs_parser& parser, std::ostream& out)
+run_experiments(warthog::util::batch_worker_fn& fn_worker, 
+        std::string alg_name, warthog::dimacs_parser& parser, 
+        std::ostream& out, warthog::util::batch_query& batch)
 {
     std::cerr << "running experiments\n";
     std::cerr << "(averaging over " << nruns << " runs per instance)\n";
 
+    // repeat each instance nruns times; keep the average of each counter 
+    // and the fastest time
+    warthog::util::batch_query_fn fn_query = 
+        [&parser] (warthog::search* algo, uint32_t query_id, 
+                   warthog::solution& sol) -> void
+        {
+            warthog::dimacs_parser::experiment exp = 
+                *(parser.experiments_begin() + query_id);
+            warthog::problem_instance pi(
+                    exp.source, (exp.p2p ? exp.target : warthog::INF), verbose);
+            uint32_t expanded=0, inserted=0, updated=0, touched=0;
+            double nano_time = DBL_MAX;
+            for(uint32_t i = 0; i < nruns; i++)
+            {
+                sol.reset();
+                algo->get_distance(pi, sol);
+
+                expanded += sol.nodes_expanded_;
+                inserted += sol.nodes_inserted_;
+                touched += sol.nodes_touched_;
+                updated += sol.nodes_updated_;
+                nano_time = nano_time < sol.time_elapsed_nano_ 
+                                ?  nano_time : sol.time_elapsed_nano_;
+            }
+            sol.nodes_expanded_ = expanded / nruns;
+            sol.nodes_inserted_ = inserted / nruns;
+            sol.nodes_updated_ = updated / nruns;
+            sol.nodes_touched_ = touched / nruns;
+            sol.time_elapsed_nano_ = nano_time;
+        };
+
+    batch.run(parser.num_experiments(), fn_worker, fn_query);
+
     if(!suppress_header)
     {
         std::cout 
             << "id\talg\texpanded\tinserted\tupdated\ttouched"
             << "\tnanos\tpcost\tplen\tmap\n";
     }
-    uint32_t exp_id = 0;
-    for(auto it = parser.experiments_begin(); 
-            it != parser.experiments_end(); 
-            it++)
+    for(uint32_t exp_id = 0; exp_id < batch.get_num_queries(); exp_id++)
     {
-        warthog::dimacs_parser::experiment exp = (*it);
-        warthog::solution sol;
-        warthog::problem_instance pi(
-                exp.source, (exp.p2p ? exp.target : warthog::INF), verbose);
-        uint32_t expanded=0, inserted=0, updated=0, touched=0;
-        double nano_time = DBL_MAX;
-        for(uint32_t i = 0; i < nruns; i++)
-        {
-            sol.reset();
-            algo->get_distance(pi, sol);
-
-            expanded += sol.nodes_expanded_;
-            inserted += sol.nodes_inserted_;
-            touched += sol.nodes_touched_;
-            updated += sol.nodes_updated_;
-            nano_time = nano_time < sol.time_elapsed_nano_ 
-                            ?  nano_time : sol.time_elapsed_nano_;
-        }
-
+        warthog::solution& sol = batch.get_result(exp_id);
         out
-            << exp_id++ <<"\t" 
+            << exp_id <<"\t" 
             << alg_name << "\t" 
-            << expanded / nruns << "\t" 
-            << inserted / nruns << "\t"
-            << updated / nruns << "\t"
-            << touched / nruns << "\t"
-            << nano_time << "\t" /// (double)nruns << "\t"
+            << sol.nodes_expanded_ << "\t" 
+            << sol.nodes_inserted_ << "\t"
+            << sol.nodes_updated_ << "\t"
+            << sol.nodes_touched_ << "\t"
+            << sol.time_elapsed_nano_ << "\t" 
             << sol.sum_of_edge_costs_ << "\t" 
             << (sol.path_.size()-1) << "\t" 
             << parser.get_problemfile() 
             << std::endl;
     }
+    batch.print_stats(std::cerr);
 }
 
 void
-run_astar(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
-        std::string alg_name, std::string gr, std::string co)
+run_experiments(warthog::util::batch_worker_fn& fn_worker, 
+        std::string alg_name, warthog::dimacs_parser& parser, 
+        std::ostream& out)
 {
-    warthog::graph::xy_graph g;
-    if(!g.load_from_dimacs(gr.c_str(), co.c_str()))
+    warthog::util::batch_query batch(nthreads);
+    run_experiments(fn_worker, alg_name, parser, out, batch);
+}
+
+// for algorithms whose search objects cannot be replicated per thread 
+// (e.g. because they modify the input graph during search)
+void
+run_experiments( warthog::search* algo, std::string alg_name, 
+        warthog::dimacs_parser& parser, std::ostream& out)
+{
+    if(nthreads != 1)
+    {
+        std::cerr << "warn; " << alg_name << " does not support --threads;"
+                  << " running single-threaded\n";
+    }
+    warthog::util::batch_worker_fn fn_worker = 
+        [algo] (warthog::util::batch_serve_fn& fn_serve) -> void
+        { fn_serve(algo); };
+    warthog::util::batch_query batch(1);
+    run_experiments(fn_worker, alg_name, parser, out, batch);
+}
+
+// load the input graph. @param gr is either a DIMACS gr file, read
+// together with @param co, or a graph image written by convert (see
+// domains/xy_graph_image.h). images are memory-mapped and used as-is;
+// @param layout says how their edges are arranged.
+bool
+load_graph(warthog::graph::xy_graph& g, std::string gr, std::string co,
+        bool store_incoming, uint32_t& layout, 
+        std::vector<uint32_t>* rank = 0)
+{
+    if(warthog::graph::is_xyg_image(gr.c_str()))
+    {
+        return g.load_from_image(gr.c_str(), rank, &layout);
+    }
+
+    layout = warthog::graph::XYG_LAYOUT_PLAIN;
+    if(!g.load_from_dimacs(gr.c_str(), co.c_str(), false, store_incoming))
     {
         std::cerr << "err; could not load gr or co input files " 
                   << "(one or both)\n";
-        return;
+        return false;
     }
+    return true;
+}
 
-    warthog::simple_graph_expansion_policy expander(&g);
-    warthog::euclidean_heuristic h(&g);
-    warthog::pqueue_min open;
+// load the input graph and contraction order for CH-based algorithms.
+// with a graph image the order is part of the image. otherwise it is
+// the --input value after the gr and co files.
+bool
+load_ch_graph(warthog::util::cfg& cfg, warthog::graph::xy_graph& g, 
+        std::vector<uint32_t>& order, std::string gr, std::string co, 
+        uint32_t& layout)
+{
+    if(warthog::graph::is_xyg_image(gr.c_str()))
+    {
+        return g.load_from_image(gr.c_str(), &order, &layout);
+    }
 
-    warthog::flexible_astar<
-        warthog::euclidean_heuristic, 
-        warthog::simple_graph_expansion_policy, 
-        warthog::pqueue_min> 
-            alg(&h, &expander, &open);
+    std::string orderfile = cfg.get_param_value("input");
+    if(orderfile == "")
+    {
+        std::cerr << "err; missing contraction order input file\n";
+        return false;
+    }
 
-    run_experiments(&alg, alg_name, parser, std::cout);
+    // customizable CH: the gr file holds the weights and the 
+    // hierarchy is customized on the spot
+    if(warthog::ch::is_cch_file(orderfile.c_str()))
+    {
+        warthog::ch::customizable_ch cch;
+        warthog::graph::xy_graph metric;
+        if(!cch.load(orderfile.c_str()) || 
+           !load_graph(metric, gr, co, false, layout)) 
+        { return false; }
+        if(layout != warthog::graph::XYG_LAYOUT_PLAIN)
+        {
+            std::cerr << "err; a customizable CH needs a DIMACS gr file\n";
+            return false;
+        }
+
+        warthog::timer mytimer;
+        mytimer.start();
+        if(!cch.customize(&metric, nthreads)) { return false; }
+        cch.make_hierarchy(&metric, &g, &order);
+        mytimer.stop();
+        std::cerr << "customized " << cch.get_num_arcs() << " arcs; "
+            << "time (s): " << mytimer.elapsed_time_micro() / 1e6 << "\n";
+        return true;
+    }
+
+    if(!warthog::ch::load_node_order(orderfile.c_str(), order, true))
+    {
+        std::cerr << "err; could not load contraction order file\n";
+        return false;
+    }
+    return load_graph(g, gr, co, true, layout);
+}
+
+// called once the input graph is loaded and preprocessed. with --csr
+// the edges of all nodes are packed into one array (xy_graph::freeze)
+void
+prepare_graph(warthog::graph::xy_graph& g)
+{
+    if(!csr_graph) { return; }
+    g.freeze();
+    std::cerr << "edges packed; memory fragmentation: (1=none): " 
+        << g.edge_mem_frag() << std::endl;
+}
+
+// the largest distance from @param root over the arcs @param head, with
+// the arcs of node i at [@param begin[i], @param begin[i+1]).
+// @return DBL_MAX if some node is not reached from @param root
+double
+max_distance_from(uint32_t root, std::vector<uint32_t>& begin,
+        std::vector<uint32_t>& head, std::vector<uint32_t>& wt)
+{
+    typedef std::pair<double, uint32_t> entry;
+    uint32_t num_nodes = begin.size() - 1;
+    std::vector<double> dist(num_nodes, DBL_MAX);
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+    dist[root] = 0;
+    open.push(entry(0, root));
+    double max_d = 0;
+    uint32_t num_reached = 0;
+    while(open.size())
+    {
+        entry e = open.top();
+        open.pop();
+        if(e.first > dist[e.second]) { continue; }
+        max_d = e.first;
+        num_reached++;
+        for(uint32_t i = begin[e.second]; i < begin[e.second+1]; i++)
+        {
+            double d = e.first + wt[i];
+            if(d < dist[head[i]])
+            {
+                dist[head[i]] = d;
+                open.push(entry(d, head[i]));
+            }
+        }
+    }
+    return num_reached == num_nodes ? max_d : DBL_MAX;
+}
+
+// an upper bound on the cost of any shortest path in @param g. when g is
+// strongly connected, a path s~r~t exists for every node r, so
+// max d(r,.) + max d(.,r) bounds d(s,t); one forward and one backward
+// Dijkstra from r = 0 give both terms. otherwise fall back to the sum of
+// the heaviest out-edge of every node, which bounds every simple path.
+// 32bit cost types are only selected when the bound is exactly
+// representable (see search_node.h)
+bool
+costs_fit(warthog::graph::xy_graph& g, double max_cost)
+{
+    uint32_t num_nodes = g.get_num_nodes();
+    if(num_nodes == 0) { return true; }
+
+    // forward and backward arcs in CSR form
+    std::vector<uint32_t> fbegin(num_nodes+1, 0), bbegin(num_nodes+1, 0);
+    double sum_max_wt = 0;
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        warthog::graph::node* n = g.get_node(i);
+        uint32_t max_wt = 0;
+        for(warthog::graph::edge_iter it = n->outgoing_begin();
+                it != n->outgoing_end(); it++)
+        {
+            fbegin[i+1]++;
+            bbegin[it->node_id_+1]++;
+            max_wt = std::max(max_wt, it->wt_);
+        }
+        sum_max_wt += max_wt;
+    }
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        fbegin[i+1] += fbegin[i];
+        bbegin[i+1] += bbegin[i];
+    }
+    std::vector<uint32_t> fhead(fbegin[num_nodes]), fwt(fbegin[num_nodes]);
+    std::vector<uint32_t> bhead(bbegin[num_nodes]), bwt(bbegin[num_nodes]);
+    std::vector<uint32_t> bnext(bbegin.begin(), bbegin.end() - 1);
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        warthog::graph::node* n = g.get_node(i);
+        uint32_t fnext = fbegin[i];
+        for(warthog::graph::edge_iter it = n->outgoing_begin();
+                it != n->outgoing_end(); it++)
+        {
+            fhead[fnext] = it->node_id_;
+            fwt[fnext++] = it->wt_;
+            uint32_t j = bnext[it->node_id_]++;
+            bhead[j] = i;
+            bwt[j] = it->wt_;
+        }
+    }
+
+    double bound = sum_max_wt;
+    double fmax = max_distance_from(0, fbegin, fhead, fwt);
+    double bmax = fmax == DBL_MAX ? DBL_MAX :
+        max_distance_from(0, bbegin, bhead, bwt);
+    if(bmax != DBL_MAX) { bound = std::min(bound, fmax + bmax); }
+
+    if(bound > max_cost)
+    {
+        std::cerr << "err; path costs up to " << bound 
+                  << " exceed the largest exact value for --cost " 
+                  << cost_type << " (" << max_cost << "); use --cost double\n";
+        return false;
+    }
+    return true;
+}
+
+// Q is the open list; its node type is the one selected by --cost
+template<class Q>
+void
+run_astar(warthog::graph::xy_graph& g, warthog::dimacs_parser& parser, 
+        std::string alg_name)
+{
+    typedef warthog::graph_expansion_policy<
+        warthog::dummy_filter, typename Q::node> t_expander;
+    typedef Q t_open;
+
+    warthog::util::batch_worker_fn fn_worker = 
+        [&] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            t_expander expander(&g);
+            warthog::euclidean_heuristic h(&g);
+            t_open open;
+
+            warthog::flexible_astar<
+                warthog::euclidean_heuristic, 
+                t_expander, 
+                t_open> 
+                    alg(&h, &expander, &open);
+
+            fn_serve(&alg);
+        };
+
+    run_experiments(fn_worker, alg_name, parser, std::cout);
+}
+
+template<class Q>
+void
+run_astar(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
+        std::string alg_name, std::string gr, std::string co)
+{
+    warthog::graph::xy_graph g;
+    uint32_t layout;
+    if(!load_graph(g, gr, co, false, layout)) { return; }
+    if(layout == warthog::graph::XYG_LAYOUT_BCH)
+    {
+        std::cerr << "err; graph image has BCH layout; --alg " << alg_name
+                  << " needs all outgoing edges\n";
+        return;
+    }
+    prepare_graph(g);
+
+    if(cost_type == "double")
+    { run_astar<Q>(g, parser, alg_name); }
+    else if(cost_type == "float")
+    {
+        if(!costs_fit(g, warthog::max_exact_cost<float>())) { return; }
+        run_astar<typename Q::template
+            rebind<warthog::search_node_f32>::other>(g, parser, alg_name);
+    }
+    else if(cost_type == "uint32")
+    {
+        if(!costs_fit(g, warthog::max_exact_cost<uint32_t>())) { return; }
+        run_astar<typename Q::template
+            rebind<warthog::search_node_u32>::other>(g, parser, alg_name);
+    }
+    else
+    { std::cerr << "err; unknown cost type " << cost_type << "\n"; }
 }
 
 void
@@ -232,8 +570,6 @@ run_bi_astar(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
         return;
     }
 
-    warthog::simple_graph_expansion_policy fexp(&g);
-
     warthog::graph::xy_graph backward_g;
     if(!backward_g.load_from_dimacs(gr.c_str(), co.c_str(), true, true))
     {
@@ -241,15 +577,26 @@ run_bi_astar(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
                   << "(one or both)\n";
         return;
     }
-    warthog::simple_graph_expansion_policy bexp(&g);
+    prepare_graph(g);
+    prepare_graph(backward_g);
 
-    warthog::euclidean_heuristic h(&g);
-    warthog::bidirectional_search<
-        warthog::euclidean_heuristic,
-        warthog::simple_graph_expansion_policy> 
-            alg(&fexp, &bexp, &h);
+    warthog::util::batch_worker_fn fn_worker = 
+        [&] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::simple_graph_expansion_policy fexp(&g);
+            warthog::simple_graph_expansion_policy bexp(&backward_g);
 
-    run_experiments(&alg, alg_name, parser, std::cout);
+            warthog::euclidean_heuristic h(&g);
+            warthog::bidirectional_search<
+                warthog::euclidean_heuristic,
+                warthog::simple_graph_expansion_policy> 
+                    alg(&fexp, &bexp, &h);
+            alg.set_parallel(parallel_bi);
+
+            fn_serve(&alg);
+        };
+
+    run_experiments(fn_worker, alg_name, parser, std::cout);
 }
 
 void
@@ -257,90 +604,391 @@ run_bi_dijkstra(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
         std::string alg_name, std::string gr, std::string co)
 {
     warthog::graph::xy_graph g;
-    if(!g.load_from_dimacs(gr.c_str(), co.c_str()))
+    warthog::graph::xy_graph backward_g;
+    if(!g.load_from_dimacs(gr.c_str(), co.c_str()) ||
+       !backward_g.load_from_dimacs(gr.c_str(), co.c_str(), true))
     {
         std::cerr << "err; could not load gr or co input files " 
                   << "(one or both)\n";
         return;
     }
-    warthog::simple_graph_expansion_policy fexp(&g);
-    warthog::simple_graph_expansion_policy bexp(&g);
+    prepare_graph(g);
+    prepare_graph(backward_g);
+    warthog::util::batch_worker_fn fn_worker = 
+        [&] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::simple_graph_expansion_policy fexp(&g);
+            warthog::simple_graph_expansion_policy bexp(&backward_g);
 
-    warthog::zero_heuristic h;
-    warthog::bidirectional_search<
-        warthog::zero_heuristic, warthog::simple_graph_expansion_policy>
-        alg(&fexp, &bexp, &h);
+            warthog::zero_heuristic h;
+            warthog::bidirectional_search<
+                warthog::zero_heuristic, warthog::simple_graph_expansion_policy>
+                alg(&fexp, &bexp, &h);
+            alg.set_parallel(parallel_bi);
 
-    run_experiments(&alg, alg_name, parser, std::cout);
+            fn_serve(&alg);
+        };
+
+    run_experiments(fn_worker, alg_name, parser, std::cout);
 }
 
+// Q is the open list; its node type is the one selected by --cost.
+// NB: with a zero heuristic f == g, so breaking ties on g (as the
+// default comparator does) gives the same order as comparing f only
+template<class Q>
+void
+run_dijkstra(warthog::graph::xy_graph& g, warthog::dimacs_parser& parser, 
+        std::string alg_name)
+{
+    typedef warthog::graph_expansion_policy<
+        warthog::dummy_filter, typename Q::node> t_expander;
+    typedef Q t_open;
+
+    warthog::util::batch_worker_fn fn_worker = 
+        [&] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            t_expander expander(&g);
+            warthog::zero_heuristic h;
+            t_open open;
+
+            warthog::flexible_astar<
+                warthog::zero_heuristic, 
+                t_expander,
+                t_open> 
+                    alg(&h, &expander, &open);
+
+            fn_serve(&alg);
+        };
+
+    run_experiments(fn_worker, alg_name, parser, std::cout);
+}
+
+template<class Q>
 void
 run_dijkstra(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
 {
     warthog::graph::xy_graph g;
-
-    if(!g.load_from_dimacs(gr.c_str(), co.c_str()))
+    uint32_t layout;
+    if(!load_graph(g, gr, co, false, layout)) { return; }
+    if(layout == warthog::graph::XYG_LAYOUT_BCH)
     {
-        std::cerr << "err; could not load gr or co input files " 
-                  << "(one or both)\n";
+        std::cerr << "err; graph image has BCH layout; --alg " << alg_name
+                  << " needs all outgoing edges\n";
         return;
     }
+    prepare_graph(g);
 
-    warthog::simple_graph_expansion_policy expander(&g);
-    warthog::zero_heuristic h;
-    warthog::pqueue<warthog::cmp_less_search_node_f_only, warthog::min_q> open;
+    if(cost_type == "double")
+    { run_dijkstra<Q>(g, parser, alg_name); }
+    else if(cost_type == "float")
+    {
+        if(!costs_fit(g, warthog::max_exact_cost<float>())) { return; }
+        run_dijkstra<typename Q::template
+            rebind<warthog::search_node_f32>::other>(g, parser, alg_name);
+    }
+    else if(cost_type == "uint32")
+    {
+        if(!costs_fit(g, warthog::max_exact_cost<uint32_t>())) { return; }
+        run_dijkstra<typename Q::template
+            rebind<warthog::search_node_u32>::other>(g, parser, alg_name);
+    }
+    else
+    { std::cerr << "err; unknown cost type " << cost_type << "\n"; }
+}
 
-    warthog::flexible_astar<
-        warthog::zero_heuristic, 
-        warthog::simple_graph_expansion_policy,
-        warthog::pqueue<warthog::cmp_less_search_node_f_only, warthog::min_q>> 
-            alg(&h, &expander, &open);
+template<class Q>
+void
+run_bch(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
+        std::string alg_name, std::string gr, std::string co)
+{
+    // load up the graph and node order
+    std::vector<uint32_t> order;
+    uint32_t layout;
+    std::shared_ptr<warthog::graph::xy_graph> g(
+            new warthog::graph::xy_graph());
+    if(!load_ch_graph(cfg, *g, order, gr, co, layout)) { return; }
+    if(layout != warthog::graph::XYG_LAYOUT_BCH)
+    {
+        warthog::ch::optimise_graph_for_bch_v2(g.get(), &order);
+    }
+    prepare_graph(*g);
 
-    run_experiments(&alg, alg_name, parser, std::cout);
+    std::cerr << "preparing to search\n";
+    warthog::util::batch_worker_fn fn_worker = 
+        [&] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::bch_expansion_policy fexp(g.get(), &order);
+            warthog::bch_expansion_policy bexp (g.get(), &order, true);
+            warthog::zero_heuristic h;
+            warthog::bch_search<
+                warthog::zero_heuristic, 
+                warthog::bch_expansion_policy,
+                Q> 
+                    alg(&fexp, &bexp, &h);
+            alg.set_parallel(parallel_bi);
+
+            fn_serve(&alg);
+        };
+
+    run_experiments(fn_worker, alg_name, parser, std::cout);
 }
 
 void
-run_bch(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
+run_bch_m2m(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
 {
-    std::string orderfile = cfg.get_param_value("input");
-    if(orderfile == "")
+    std::vector<uint32_t>& sources = parser.get_m2m_sources();
+    std::vector<uint32_t>& targets = parser.get_m2m_targets();
+    if(sources.size() == 0 || targets.size() == 0)
     {
-        std::cerr << "err; missing contraction order input file\n";
+        std::cerr << "err; " << alg_name << " needs a distance table "
+            << "problem file (p aux sp m2m) with sources and targets\n";
         return;
     }
 
-    // load up the node order
+    // load up the graph and node order
     std::vector<uint32_t> order;
-    if(!warthog::ch::load_node_order(orderfile.c_str(), order, true))
+    uint32_t layout;
+    std::shared_ptr<warthog::graph::xy_graph> g(
+            new warthog::graph::xy_graph());
+    if(!load_ch_graph(cfg, *g, order, gr, co, layout)) { return; }
+    if(layout != warthog::graph::XYG_LAYOUT_BCH)
     {
-        std::cerr << "err; could not load contraction order file\n";
+        warthog::ch::optimise_graph_for_bch_v2(g.get(), &order);
+    }
+    prepare_graph(*g);
+
+    std::cerr << "preparing to search\n";
+    warthog::ch::bch_many_to_many m2m(g.get(), &order);
+    std::vector<double> table;
+
+    std::cerr << "running experiments\n";
+    std::cerr << "(fastest of " << nruns << " runs per table)\n";
+    double bucket_nano = DBL_MAX, scan_nano = DBL_MAX;
+    for(uint32_t i = 0; i < nruns; i++)
+    {
+        if(!m2m.distance_table(sources, targets, table, nthreads)) 
+        { return; }
+        bucket_nano = std::min(bucket_nano, m2m.get_bucket_nano());
+        scan_nano = std::min(scan_nano, m2m.get_scan_nano());
+    }
+
+    if(!suppress_header)
+    {
+        std::cout << "id\talg\tsource\ttarget\tpcost\tmap\n";
+    }
+    for(uint32_t i = 0; i < sources.size(); i++)
+    {
+        for(uint32_t j = 0; j < targets.size(); j++)
+        {
+            uint32_t exp_id = i * targets.size() + j;
+            std::cout
+                << exp_id << "\t"
+                << alg_name << "\t"
+                << sources[i] << "\t"
+                << targets[j] << "\t"
+                << table[exp_id] << "\t"
+                << parser.get_problemfile()
+                << std::endl;
+        }
+    }
+
+    double total_nano = bucket_nano + scan_nano;
+    std::cerr 
+        << "table " << sources.size() << "x" << targets.size()
+        << "; threads " << nthreads
+        << "; bucket entries " << m2m.get_num_bucket_entries()
+        << "; settled " << m2m.get_nodes_settled()
+        << "; stalled " << m2m.get_nodes_stalled() << "\n"
+        << "time (s): buckets " << bucket_nano / 1e9
+        << "; scans " << scan_nano / 1e9
+        << "; total " << total_nano / 1e9
+        << "; nanos per entry " << total_nano / table.size() << "\n"
+        << "mem (MB): " << m2m.mem() / (1024.0*1024.0) << "\n";
+}
+
+void
+run_phast(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
+        std::string alg_name, std::string gr, std::string co)
+{
+    if(phast_sources < 1 || phast_sources > warthog::ch::phast::MAX_SOURCES)
+    {
+        std::cerr << "err; --sources must be between 1 and " 
+            << warthog::ch::phast::MAX_SOURCES << "\n";
         return;
     }
+    if(nthreads != 1)
+    {
+        std::cerr << "warn; " << alg_name << " does not support --threads;"
+                  << " running single-threaded\n";
+    }
 
-    // load up the graph
+    // load up the graph and node order
+    std::vector<uint32_t> order;
+    uint32_t layout;
     std::shared_ptr<warthog::graph::xy_graph> g(
             new warthog::graph::xy_graph());
-    if(!g->load_from_dimacs( gr.c_str(), co.c_str(), false, true))
+    if(!load_ch_graph(cfg, *g, order, gr, co, layout)) { return; }
+    if(layout != warthog::graph::XYG_LAYOUT_BCH)
+    {
+        warthog::ch::optimise_graph_for_bch_v2(g.get(), &order);
+    }
+
+    std::cerr << "preparing to search\n";
+    warthog::ch::phast alg(g.get(), &order);
+    alg.set_simd(!phast_nosimd);
+    std::vector<warthog::dimacs_parser::experiment> exps(
+            parser.experiments_begin(), parser.experiments_end());
+    std::vector<uint32_t> sources(exps.size());
+    std::vector<uint32_t> targets(exps.size(), warthog::INF);
+    for(uint32_t i = 0; i < exps.size(); i++)
+    {
+        sources[i] = g->to_graph_id(exps[i].source);
+        if(sources[i] == warthog::INF)
+        {
+            std::cerr << "err; source " << exps[i].source 
+                << " is not in the graph\n";
+            return;
+        }
+        if(exps[i].p2p) { targets[i] = g->to_graph_id(exps[i].target); }
+    }
+    g.reset(); // phast has its own copy of the hierarchy
+
+    std::cerr << "running experiments\n";
+    std::cerr << "(fastest of " << nruns << " runs per sweep; " 
+        << phast_sources << " sources per sweep; simd " 
+        << (alg.cpu_has_avx2() && !phast_nosimd ? "on" : "off") << ")\n";
+    if(!suppress_header)
+    {
+        std::cout 
+            << "id\talg\texpanded\tinserted\tupdated\ttouched"
+            << "\tnanos\tpcost\tplen\tmap\n";
+    }
+
+    double total_nano = 0;
+    for(uint32_t first = 0; first < exps.size(); first += phast_sources)
+    {
+        uint32_t num = std::min<uint32_t>(phast_sources, exps.size() - first);
+        double nano_time = DBL_MAX;
+        for(uint32_t i = 0; i < nruns; i++)
+        {
+            warthog::timer mytimer;
+            mytimer.start();
+            alg.many_to_all(&sources[first], num);
+            mytimer.stop();
+            nano_time = std::min(nano_time, mytimer.elapsed_time_nano());
+        }
+        total_nano += nano_time;
+
+        for(uint32_t i = 0; i < num; i++)
+        {
+            uint32_t target_id = targets[first + i];
+            double cost = target_id == warthog::INF ? warthog::INF : 
+                alg.get_distance(i, target_id);
+            std::cout
+                << first + i << "\t" 
+                << alg_name << "\t" 
+                << alg.get_nodes_settled() / num << "\t" 
+                << 0 << "\t"
+                << 0 << "\t"
+                << alg.get_num_nodes() << "\t"
+                << nano_time / num << "\t" 
+                << cost << "\t" 
+                << 0 << "\t" 
+                << parser.get_problemfile() 
+                << std::endl;
+        }
+    }
+    std::cerr << "sources " << exps.size() 
+        << "; down arcs " << alg.get_num_down_arcs()
+        << "; time (s) " << total_nano / 1e9 
+        << "; nanos per source " << total_nano / exps.size() << "\n"
+        << "mem (MB): " << alg.mem() / (1024.0*1024.0) << "\n";
+}
+
+void
+run_cpd(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
+        std::string alg_name, std::string gr, std::string co)
+{
+    warthog::graph::xy_graph g;
+    if(!g.load_from_dimacs(gr.c_str(), co.c_str(), false, true))
     {
         std::cerr 
-            << "err; could not load gr or co input files "
-            << "(one or both)\n";
+            << "err; could not load gr or co input files (one or both)\n";
         return;
     }
-    warthog::ch::optimise_graph_for_bch_v2(g.get(), &order);
+    prepare_graph(g);
 
-    std::cerr << "preparing to search\n";
-    warthog::bch_expansion_policy fexp(g.get(), &order);
-    warthog::bch_expansion_policy bexp (g.get(), &order, true);
-    warthog::zero_heuristic h;
-    warthog::bch_search<
-        warthog::zero_heuristic, 
-        warthog::bch_expansion_policy> 
-            alg(&fexp, &bexp, &h);
+    // load up the first-move table (e.g. one made by labelmaker --type fm);
+    // if none is given, compute one or use the one computed last time
+    std::string table_file = cfg.get_param_value("input");
+    bool cached = table_file == "";
+    if(cached) { table_file = gr + "." + alg_name + ".fmt"; }
+    warthog::label::firstmove_table* lab =
+        warthog::label::firstmove_table::load(table_file.c_str());
+    if(lab == 0 && cached)
+    {
+        std::vector<uint32_t> column_order;
+        warthog::label::compute_fm_dfs_preorder(g, column_order);
 
-    run_experiments(&alg, alg_name, parser, std::cout);
+        warthog::util::workload_manager workload(g.get_num_nodes());
+        workload.set_all_flags(true);
+        std::function<warthog::graph_expansion_policy<>*(void)> 
+            fn_new_expander = [&g]() -> warthog::graph_expansion_policy<>*
+            {
+                return new warthog::graph_expansion_policy<>(&g);
+            };
+        warthog::label::firstmove_labelling* rows = 
+            warthog::label::firstmove_labelling::compute
+            <warthog::graph_expansion_policy<>>
+                (&g, &column_order, fn_new_expander, &workload);
+        bool saved = warthog::label::firstmove_table::save(
+                table_file.c_str(), *rows, column_order);
+        delete rows;
+        if(!saved) { return; }
+
+        lab = warthog::label::firstmove_table::load(table_file.c_str());
+    }
+    if(lab == 0) { return; }
+    if(lab->get_num_nodes() != g.get_num_nodes())
+    {
+        std::cerr << "err; firstmove table has " << lab->get_num_nodes()
+            << " nodes but graph has " << g.get_num_nodes() << "\n";
+        delete lab;
+        return;
+    }
+
+    std::cerr << "firstmove table: " << lab->get_num_runs() << " runs ("
+        << (double)lab->get_num_runs() / g.get_num_nodes() 
+        << " per row); size on disk (MB): " 
+        << lab->get_file_size() / (1024.0*1024.0) << "\n";
+
+    // the graph and the table are read-only; each worker needs only a 
+    // query object of its own
+    warthog::util::batch_worker_fn fn_worker = 
+        [&g, lab] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::cpd_search alg(&g, lab);
+            if(cpd_moves) { alg.set_max_moves(cpd_moves); }
+            fn_serve(&alg);
+        };
+    warthog::util::batch_query batch(nthreads);
+    run_experiments(fn_worker, alg_name, parser, std::cout, batch);
+
+    // each lookup counts as one expansion
+    double total_nano = 0;
+    uint64_t total_moves = 0;
+    for(uint32_t i = 0; i < batch.get_num_queries(); i++)
+    {
+        warthog::solution& sol = batch.get_result(i);
+        total_nano += sol.time_elapsed_nano_;
+        total_moves += sol.nodes_expanded_;
+    }
+    std::cerr << "first moves " << total_moves 
+        << "; nanos per first move " 
+        << (total_moves ? total_nano / total_moves : 0) << "\n";
+    delete lab;
 }
 
 void
@@ -373,6 +1021,7 @@ run_bch_backwards_only(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
         return;
     }
     warthog::ch::optimise_graph_for_bch_v2(g.get(), &order);
+    prepare_graph(*g);
 
     std::cerr << "preparing to search\n";
     warthog::bch_expansion_policy bexp (g.get(), &order, true);
@@ -432,46 +1081,38 @@ run_bch_backwards_only(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
     }
 }
 
+template<class Q>
 void
 run_bch_astar(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
 {
-    std::string orderfile = cfg.get_param_value("input");
-    if(orderfile == "")
-    {
-        std::cerr << "err; missing contraction order input file\n";
-        return;
-    }
-
-    // load up the node order
+    // load up the graph and node order
     std::vector<uint32_t> order;
-    if(!warthog::ch::load_node_order(orderfile.c_str(), order, true))
-    {
-        std::cerr << "err; could not load node order input file\n";
-        return;
-    }
-
-    // load up the graph 
+    uint32_t layout;
     warthog::graph::xy_graph g;
-    if(!g.load_from_dimacs(gr.c_str(), co.c_str(), false, true))
-    {
-        std::cerr 
-            << "err; could not load gr or co input files (one or both)\n";
-        return;
-    }
+    if(!load_ch_graph(cfg, g, order, gr, co, layout)) { return; }
+    prepare_graph(g);
 
     std::cerr << "preparing to search\n";
-    warthog::euclidean_heuristic h(&g);
-    warthog::bch_expansion_policy fexp(&g, &order);
-    warthog::bch_expansion_policy bexp (&g, &order, true);
-    warthog::bch_search<
-        warthog::euclidean_heuristic,
-        warthog::bch_expansion_policy>
-            alg(&fexp, &bexp, &h);
-
-    run_experiments(&alg, alg_name, parser, std::cout);
+    warthog::util::batch_worker_fn fn_worker = 
+        [&] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::euclidean_heuristic h(&g);
+            warthog::bch_expansion_policy fexp(&g, &order);
+            warthog::bch_expansion_policy bexp (&g, &order, true);
+            warthog::bch_search<
+                warthog::euclidean_heuristic,
+                warthog::bch_expansion_policy,
+                Q>
+                    alg(&fexp, &bexp, &h);
+
+            fn_serve(&alg);
+        };
+
+    run_experiments(fn_worker, alg_name, parser, std::cout);
 }
 
+template<class Q>
 void
 run_ch_cpg(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
@@ -518,7 +1159,8 @@ run_ch_cpg(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
 	warthog::ch::ch_cpg_expansion_policy bexp(&cpg, &order, true);
     warthog::bch_search<
         warthog::zero_heuristic,
-        warthog::ch::ch_cpg_expansion_policy>
+        warthog::ch::ch_cpg_expansion_policy,
+        Q>
         alg(&fexp, &bexp, &h);
 
     run_experiments(&alg, alg_name, parser, std::cout);
@@ -591,23 +1233,31 @@ run_chase(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
         return;
     }
     warthog::ch::optimise_graph_for_bch_v2(g.get(), &order);
+    prepare_graph(*g);
 
     std::shared_ptr<warthog::label::af_labelling> fwd_afl(fwd_lab);
     std::shared_ptr<warthog::label::af_labelling> bwd_afl(bwd_lab);
     
-    warthog::af_filter fwd_filter(fwd_afl.get());
-    warthog::af_filter bwd_filter(bwd_afl.get());
-
     std::cerr << "preparing to search\n";
-    warthog::zero_heuristic h;
-    warthog::chase_expansion_policy fexp(g.get(), &fwd_filter);
-    warthog::chase_expansion_policy bexp (g.get(), &bwd_filter, true);
-    warthog::chase_search<warthog::zero_heuristic> 
-        alg(&fexp, &bexp, &h, &order, core_pct_value);
+    warthog::util::batch_worker_fn fn_worker = 
+        [&] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::af_filter fwd_filter(fwd_afl.get());
+            warthog::af_filter bwd_filter(bwd_afl.get());
 
-    run_experiments(&alg, alg_name, parser, std::cout);
+            warthog::zero_heuristic h;
+            warthog::chase_expansion_policy fexp(g.get(), &fwd_filter);
+            warthog::chase_expansion_policy bexp (g.get(), &bwd_filter, true);
+            warthog::chase_search<warthog::zero_heuristic> 
+                alg(&fexp, &bexp, &h, &order, core_pct_value);
+
+            fn_serve(&alg);
+        };
+
+    run_experiments(fn_worker, alg_name, parser, std::cout);
 }
 
+template<class Q>
 void
 run_bch_bb(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
@@ -653,25 +1303,34 @@ run_bch_bb(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
         return;
     }
     warthog::ch::optimise_graph_for_bch_v2(g.get(), &order);
+    prepare_graph(*g);
 
     std::shared_ptr<warthog::label::bb_labelling> fwd_lab(fwd_lab_ptr);
     std::shared_ptr<warthog::label::bb_labelling> bwd_lab(bwd_lab_ptr);
 
-    warthog::bb_filter fwd_filter(fwd_lab.get());
-    warthog::bb_filter bwd_filter(bwd_lab.get());
-
     std::cerr << "preparing to search\n";
-    warthog::bch_bb_expansion_policy fexp(g.get(), &fwd_filter);
-    warthog::bch_bb_expansion_policy bexp (g.get(), &bwd_filter, true);
-    warthog::zero_heuristic h;
-    warthog::bch_search<
-        warthog::zero_heuristic,
-        warthog::bch_bb_expansion_policy> 
-            alg(&fexp, &bexp, &h);
-
-    run_experiments(&alg, alg_name, parser, std::cout);
+    warthog::util::batch_worker_fn fn_worker = 
+        [&] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::bb_filter fwd_filter(fwd_lab.get());
+            warthog::bb_filter bwd_filter(bwd_lab.get());
+
+            warthog::bch_bb_expansion_policy fexp(g.get(), &fwd_filter);
+            warthog::bch_bb_expansion_policy bexp (g.get(), &bwd_filter, true);
+            warthog::zero_heuristic h;
+            warthog::bch_search<
+                warthog::zero_heuristic,
+                warthog::bch_bb_expansion_policy,
+                Q> 
+                    alg(&fexp, &bexp, &h);
+
+            fn_serve(&alg);
+        };
+
+    run_experiments(fn_worker, alg_name, parser, std::cout);
 }
 
+template<class Q>
 void
 run_bch_af(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
@@ -728,25 +1387,34 @@ run_bch_af(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
         return;
     }
     warthog::ch::optimise_graph_for_bch_v2(g.get(), &order);
+    prepare_graph(*g);
 
     std::shared_ptr<warthog::label::af_labelling> fwd_afl(fwd_lab);
     std::shared_ptr<warthog::label::af_labelling> bwd_afl(bwd_lab);
     
-    warthog::af_filter fwd_filter(fwd_afl.get());
-    warthog::af_filter bwd_filter(bwd_afl.get());
-
     std::cerr << "preparing to search\n";
-    warthog::bch_af_expansion_policy fexp(g.get(), &fwd_filter);
-    warthog::bch_af_expansion_policy bexp (g.get(), &bwd_filter, true);
-    warthog::zero_heuristic h;
-    warthog::bch_search<
-        warthog::zero_heuristic,
-        warthog::bch_af_expansion_policy>
-            alg(&fexp, &bexp, &h);
-
-    run_experiments(&alg, alg_name, parser, std::cout);
+    warthog::util::batch_worker_fn fn_worker = 
+        [&] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::af_filter fwd_filter(fwd_afl.get());
+            warthog::af_filter bwd_filter(bwd_afl.get());
+
+            warthog::bch_af_expansion_policy fexp(g.get(), &fwd_filter);
+            warthog::bch_af_expansion_policy bexp (g.get(), &bwd_filter, true);
+            warthog::zero_heuristic h;
+            warthog::bch_search<
+                warthog::zero_heuristic,
+                warthog::bch_af_expansion_policy,
+                Q>
+                    alg(&fexp, &bexp, &h);
+
+            fn_serve(&alg);
+        };
+
+    run_experiments(fn_worker, alg_name, parser, std::cout);
 }
 
+template<class Q>
 void
 run_bch_bbaf(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
@@ -804,84 +1472,86 @@ run_bch_bbaf(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
         return;
     }
     warthog::ch::optimise_graph_for_bch_v2(g.get(), &order);
+    prepare_graph(*g);
 
     std::shared_ptr<warthog::label::bbaf_labelling> fwd_lab(fwd_lab_ptr);
     std::shared_ptr<warthog::label::bbaf_labelling> bwd_lab(bwd_lab_ptr);
     
-    warthog::bbaf_filter fwd_filter(fwd_lab.get());
-    warthog::bbaf_filter bwd_filter(bwd_lab.get());
-
     std::cerr << "preparing to search\n";
-    warthog::zero_heuristic h;
-    warthog::bch_bbaf_expansion_policy fexp(g.get(), &fwd_filter);
-    warthog::bch_bbaf_expansion_policy bexp (g.get(), &bwd_filter, true);
-    warthog::bch_search<
-        warthog::zero_heuristic,
-        warthog::bch_bbaf_expansion_policy> 
-            alg(&fexp, &bexp, &h);
-
-    run_experiments(&alg, alg_name, parser, std::cout);
+    warthog::util::batch_worker_fn fn_worker = 
+        [&] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::bbaf_filter fwd_filter(fwd_lab.get());
+            warthog::bbaf_filter bwd_filter(bwd_lab.get());
+
+            warthog::zero_heuristic h;
+            warthog::bch_bbaf_expansion_policy fexp(g.get(), &fwd_filter);
+            warthog::bch_bbaf_expansion_policy bexp (g.get(), &bwd_filter, true);
+            warthog::bch_search<
+                warthog::zero_heuristic,
+                warthog::bch_bbaf_expansion_policy,
+                Q> 
+                    alg(&fexp, &bexp, &h);
+
+            fn_serve(&alg);
+        };
+
+    run_experiments(fn_worker, alg_name, parser, std::cout);
 }
 
+template<class Q>
 void
 run_fch(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
 {
-    std::string orderfile = cfg.get_param_value("input");
-    if(orderfile == "")
-    {
-        std::cerr << "err; insufficient input parameters for --alg "
-                  << alg_name << ". required, in order:\n"
-                  << " --input [gr file] [co file] "
-                  << " [contraction order file] \n";
-        return;
-    }
-
-    // load up the graph 
-    warthog::graph::xy_graph g;
-    if(!g.load_from_dimacs(gr.c_str(), co.c_str(), false, true))
-    {
-        std::cerr 
-            << "err; could not load gr or co input files (one or both)\n";
-        return;
-    }
-
-    // load up the node order
+    // load up the graph and node order
     std::vector<uint32_t> order;
-    if(!warthog::ch::load_node_order(orderfile.c_str(), order, true))
+    uint32_t layout;
+    warthog::graph::xy_graph g;
+    if(!load_ch_graph(cfg, g, order, gr, co, layout)) { return; }
+    if(layout == warthog::graph::XYG_LAYOUT_BCH)
     {
-        std::cerr << "err; could not load node order input file\n";
+        std::cerr << "err; graph image has BCH layout; --alg " << alg_name
+                  << " needs all outgoing edges\n";
         return;
     }
+    prepare_graph(g);
 
     std::cerr << "preparing to search\n";
-    warthog::fch_expansion_policy fexp(&g, &order); 
-    warthog::euclidean_heuristic h(&g);
-    warthog::pqueue_min open;
-
-    warthog::flexible_astar< 
-        warthog::euclidean_heuristic, 
-        warthog::fch_expansion_policy,
-        warthog::pqueue_min> 
-            alg(&h, &fexp, &open);
-    
-    // extra metric; how many nodes do we expand above the apex?
-    std::function<uint32_t(warthog::search_node*)> fn_get_apex = 
-    [&order, &fexp] (warthog::search_node* n) -> uint32_t
-    {
-        while(true)
+    warthog::util::batch_worker_fn fn_worker = 
+        [&] (warthog::util::batch_serve_fn& fn_serve) -> void
         {
-            warthog::search_node* p = fexp.generate(n->get_parent());
-            if(!p || order.at(p->get_id()) < order.at(n->get_id()))
-            { break; }
-            n = p;
-        }
-        return order.at(n->get_id());
-    };
+            warthog::fch_expansion_policy fexp(&g, &order); 
+            warthog::euclidean_heuristic h(&g);
+            Q open;
+
+            warthog::flexible_astar< 
+                warthog::euclidean_heuristic, 
+                warthog::fch_expansion_policy,
+                Q> 
+                    alg(&h, &fexp, &open);
+
+            // extra metric; how many nodes do we expand above the apex?
+            std::function<uint32_t(warthog::search_node*)> fn_get_apex = 
+            [&order, &fexp] (warthog::search_node* n) -> uint32_t
+            {
+                while(true)
+                {
+                    warthog::search_node* p = fexp.generate(n->get_parent());
+                    if(!p || order.at(p->get_id()) < order.at(n->get_id()))
+                    { break; }
+                    n = p;
+                }
+                return order.at(n->get_id());
+            };
 
-    run_experiments(&alg, alg_name, parser, std::cout);
+            fn_serve(&alg);
+        };
+
+    run_experiments(fn_worker, alg_name, parser, std::cout);
 }
 
+template<class Q>
 void
 run_fch_dfs(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
@@ -929,6 +1599,7 @@ run_fch_dfs(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
 
     // sort the graph edges
     warthog::ch::fch_sort_successors(&g, &order);
+    prepare_graph(g);
 
     // define the workload
     double cutoff = 1;
@@ -968,35 +1639,42 @@ run_fch_dfs(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
         std::cerr << "done.\n";
     }
 
-    warthog::fch_dfs_expansion_policy fexp(&g, &order, lab, false);
-    warthog::euclidean_heuristic h(&g);
-    warthog::pqueue_min open;
-
-    warthog::flexible_astar<
-        warthog::euclidean_heuristic, 
-        warthog::fch_dfs_expansion_policy,
-        warthog::pqueue_min> 
-            alg(&h, &fexp, &open);
-    
-    // extra metric; how many nodes do we expand above the apex?
-    std::function<uint32_t(warthog::search_node*)> fn_get_apex = 
-    [&order, &fexp] (warthog::search_node* n) -> uint32_t
-    {
-        while(true)
+    warthog::util::batch_worker_fn fn_worker = 
+        [&] (warthog::util::batch_serve_fn& fn_serve) -> void
         {
-            warthog::search_node* p = fexp.generate(n->get_parent());
-            if(!p || order.at(p->get_id()) < order.at(n->get_id()))
-            { break; }
-            n = p;
-        }
-        return order.at(n->get_id());
-    };
+            warthog::fch_dfs_expansion_policy fexp(&g, &order, lab, false);
+            warthog::euclidean_heuristic h(&g);
+            Q open;
+
+            warthog::flexible_astar<
+                warthog::euclidean_heuristic, 
+                warthog::fch_dfs_expansion_policy,
+                Q> 
+                    alg(&h, &fexp, &open);
+
+            // extra metric; how many nodes do we expand above the apex?
+            std::function<uint32_t(warthog::search_node*)> fn_get_apex = 
+            [&order, &fexp] (warthog::search_node* n) -> uint32_t
+            {
+                while(true)
+                {
+                    warthog::search_node* p = fexp.generate(n->get_parent());
+                    if(!p || order.at(p->get_id()) < order.at(n->get_id()))
+                    { break; }
+                    n = p;
+                }
+                return order.at(n->get_id());
+            };
 
-    run_experiments(&alg, alg_name, parser, std::cout);
+            fn_serve(&alg);
+        };
+
+    run_experiments(fn_worker, alg_name, parser, std::cout);
 
     delete lab;
 }
 
+template<class Q>
 void
 run_fch_fm(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
@@ -1034,6 +1712,7 @@ run_fch_fm(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
 
     // sort the graph edges
     warthog::ch::fch_sort_successors(&g, &order);
+    prepare_graph(g);
 
     // define the workload
     double cutoff = 1;
@@ -1057,55 +1736,71 @@ run_fch_fm(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
         { workload.set_flag(i, true); }
     }
 
-    // load up the labelling
-    std::string arclab_file =  gr + "." + alg_name + "." + "label";
-
-    warthog::label::firstmove_labelling* lab =
-        warthog::label::firstmove_labelling::load(
-            arclab_file.c_str(), &g, &order);
+    // load up the first-move table
+    std::string table_file =  gr + "." + alg_name + ".fmt";
+    warthog::label::firstmove_table* lab =
+        warthog::label::firstmove_table::load(table_file.c_str());
 
     if(lab == 0)
     {
-        //std::cerr << "computing fch-firstmove labelling... \n";
+        // the table records the column order used for compression
+        std::vector<uint32_t> column_order;
+        warthog::label::compute_fm_fch_dfs_preorder(g, order, column_order);
+
         std::function<warthog::fch_expansion_policy*(void)> fn_new_expander = 
             [&g, &order]() -> warthog::fch_expansion_policy*
             {
                 return new warthog::fch_expansion_policy(&g, &order);
             };
-        lab = warthog::label::firstmove_labelling::compute
+        warthog::label::firstmove_labelling* rows = 
+            warthog::label::firstmove_labelling::compute
             <warthog::fch_expansion_policy>
-                (&g, &order, fn_new_expander, &workload);
+                (&g, &column_order, fn_new_expander, &workload);
         std::cerr << "precompute finished. saving result to " 
-            << arclab_file << "...";
-        warthog::label::firstmove_labelling::save(arclab_file.c_str(), *lab);
+            << table_file << "...";
+        bool saved = warthog::label::firstmove_table::save(
+                table_file.c_str(), *rows, column_order);
+        delete rows;
+        if(!saved) { return; }
         std::cerr << "done.\n";
-    }
 
-    warthog::fch_fm_expansion_policy fexp(&g, &order, lab, false);
-    warthog::euclidean_heuristic h(&g);
-    warthog::pqueue_min open;
+        lab = warthog::label::firstmove_table::load(table_file.c_str());
+        if(lab == 0) { return; }
+    }
+    std::cerr << "firstmove table: " << lab->get_num_runs() << " runs; "
+        << lab->get_file_size() << " bytes\n";
 
-    warthog::flexible_astar< 
-        warthog::euclidean_heuristic, 
-        warthog::fch_fm_expansion_policy,
-        warthog::pqueue_min>
-            alg(&h, &fexp, &open);
-    
-    // extra metric; how many nodes do we expand above the apex?
-    std::function<uint32_t(warthog::search_node*)> fn_get_apex = 
-    [&order, &fexp] (warthog::search_node* n) -> uint32_t
-    {
-        while(true)
+    warthog::util::batch_worker_fn fn_worker = 
+        [&] (warthog::util::batch_serve_fn& fn_serve) -> void
         {
-            warthog::search_node* p = fexp.generate(n->get_parent());
-            if(!p || order.at(p->get_id()) < order.at(n->get_id()))
-            { break; }
-            n = p;
-        }
-        return order.at(n->get_id());
-    };
+            warthog::fch_fm_expansion_policy fexp(&g, &order, lab, false);
+            warthog::euclidean_heuristic h(&g);
+            Q open;
+
+            warthog::flexible_astar< 
+                warthog::euclidean_heuristic, 
+                warthog::fch_fm_expansion_policy,
+                Q>
+                    alg(&h, &fexp, &open);
+
+            // extra metric; how many nodes do we expand above the apex?
+            std::function<uint32_t(warthog::search_node*)> fn_get_apex = 
+            [&order, &fexp] (warthog::search_node* n) -> uint32_t
+            {
+                while(true)
+                {
+                    warthog::search_node* p = fexp.generate(n->get_parent());
+                    if(!p || order.at(p->get_id()) < order.at(n->get_id()))
+                    { break; }
+                    n = p;
+                }
+                return order.at(n->get_id());
+            };
 
-    run_experiments(&alg, alg_name, parser, std::cout);
+            fn_serve(&alg);
+        };
+
+    run_experiments(fn_worker, alg_name, parser, std::cout);
 
     delete lab;
 }
@@ -1224,6 +1919,7 @@ run_fch_apex_experiment(warthog::util::cfg& cfg,
 
 }
 
+template<class Q>
 void
 run_fch_af(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
@@ -1268,6 +1964,7 @@ run_fch_af(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
         std::cerr << "err; could not load gr or co input files (one or both)\n";
         return;
     }
+    prepare_graph(*g);
 
     // load up the arc-flags
     std::shared_ptr<warthog::label::af_labelling> afl
@@ -1279,20 +1976,27 @@ run_fch_af(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
         return;
     }
 
-    warthog::af_filter filter(afl.get());
-    warthog::euclidean_heuristic h(g.get());
-    warthog::fch_af_expansion_policy fexp(g.get(), &order, &filter);
-    warthog::pqueue_min open;
+    warthog::util::batch_worker_fn fn_worker = 
+        [&] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::af_filter filter(afl.get());
+            warthog::euclidean_heuristic h(g.get());
+            warthog::fch_af_expansion_policy fexp(g.get(), &order, &filter);
+            Q open;
 
-    warthog::flexible_astar< 
-        warthog::euclidean_heuristic, 
-        warthog::fch_af_expansion_policy,
-        warthog::pqueue_min>
-            alg(&h, &fexp, &open);
+            warthog::flexible_astar< 
+                warthog::euclidean_heuristic, 
+                warthog::fch_af_expansion_policy,
+                Q>
+                    alg(&h, &fexp, &open);
 
-    run_experiments(&alg, alg_name, parser, std::cout);
+            fn_serve(&alg);
+        };
+
+    run_experiments(fn_worker, alg_name, parser, std::cout);
 }
 
+template<class Q>
 void
 run_fch_bb(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
@@ -1326,6 +2030,7 @@ run_fch_bb(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
         std::cerr << "err; could not load gr or co input files (one or both)\n";
         return;
     }
+    prepare_graph(*g);
     // load up the arc labels
     std::shared_ptr<warthog::label::bb_labelling> bbl
         (warthog::label::bb_labelling::load(arclabels_file.c_str(), g.get()));
@@ -1334,22 +2039,29 @@ run_fch_bb(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
         std::cerr << "err; could not load arcflags file\n";
         return;
     }
-    warthog::bb_filter filter(bbl.get());
+    warthog::util::batch_worker_fn fn_worker = 
+        [&] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::bb_filter filter(bbl.get());
 
-    warthog::euclidean_heuristic h(g.get());
-    warthog::fch_bb_expansion_policy fexp(g.get(), &order, &filter);
-    warthog::pqueue_min open;
+            warthog::euclidean_heuristic h(g.get());
+            warthog::fch_bb_expansion_policy fexp(g.get(), &order, &filter);
+            Q open;
 
-    warthog::flexible_astar< 
-        warthog::euclidean_heuristic, 
-        warthog::fch_bb_expansion_policy,
-        warthog::pqueue_min>
-            alg(&h, &fexp, &open);
+            warthog::flexible_astar< 
+                warthog::euclidean_heuristic, 
+                warthog::fch_bb_expansion_policy,
+                Q>
+                    alg(&h, &fexp, &open);
 
-    run_experiments(&alg, alg_name, parser, std::cout);
+            fn_serve(&alg);
+        };
+
+    run_experiments(fn_worker, alg_name, parser, std::cout);
 
 }
 
+template<class Q>
 void
 run_fch_bbaf(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
@@ -1394,6 +2106,7 @@ run_fch_bbaf(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
         std::cerr << "err; could not load gr or co input files (one or both)\n";
         return;
     }
+    prepare_graph(*g);
 
     // load up the arc-flags
     std::shared_ptr<warthog::label::bbaf_labelling> lab(
@@ -1407,19 +2120,26 @@ run_fch_bbaf(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
     }
 
     std::cerr << "preparing to search\n";
-    warthog::euclidean_heuristic h(g.get());
-    warthog::fch_bbaf_expansion_policy fexp(g.get(), &order, lab.get());
-    warthog::pqueue_min open;
+    warthog::util::batch_worker_fn fn_worker = 
+        [&] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::euclidean_heuristic h(g.get());
+            warthog::fch_bbaf_expansion_policy fexp(g.get(), &order, lab.get());
+            Q open;
 
-    warthog::flexible_astar< 
-        warthog::euclidean_heuristic, 
-        warthog::fch_bbaf_expansion_policy,
-        warthog::pqueue_min>
-            alg(&h, &fexp, &open);
+            warthog::flexible_astar< 
+                warthog::euclidean_heuristic, 
+                warthog::fch_bbaf_expansion_policy,
+                Q>
+                    alg(&h, &fexp, &open);
 
-    run_experiments(&alg, alg_name, parser, std::cout);
+            fn_serve(&alg);
+        };
+
+    run_experiments(fn_worker, alg_name, parser, std::cout);
 }
 
+template<class Q>
 void
 run_fch_bbaf_cpg(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
@@ -1489,17 +2209,18 @@ run_fch_bbaf_cpg(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
     // search algo
     warthog::euclidean_heuristic h(pg.get());
     warthog::fch_bbaf_cpg_expansion_policy fexp(&cpg, &order, lab.get());
-    warthog::pqueue_min open;
+    Q open;
 
     warthog::flexible_astar< 
         warthog::euclidean_heuristic, 
         warthog::fch_bbaf_cpg_expansion_policy, 
-        warthog::pqueue_min>
+        Q>
             alg(&h, &fexp, &open);
 
     run_experiments(&alg, alg_name, parser, std::cout);
 }
 
+template<class Q>
 void
 run_fch_cpg(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
@@ -1542,17 +2263,18 @@ run_fch_cpg(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
     warthog::euclidean_heuristic h(pg.get());
 
     // open list
-    warthog::pqueue_min open;
+    Q open;
 
     warthog::flexible_astar< 
         warthog::euclidean_heuristic, 
         warthog::fch_cpg_expansion_policy, 
-        warthog::pqueue_min> 
+        Q> 
             alg(&h, &fexp, &open);
 
     run_experiments(&alg, alg_name, parser, std::cout);
 }
 
+template<class Q>
 void
 run_fch_jpg(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
@@ -1595,17 +2317,18 @@ run_fch_jpg(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
     warthog::euclidean_heuristic h(pg.get());
 
     // open list
-    warthog::pqueue_min open;
+    Q open;
 
     warthog::flexible_astar< 
         warthog::euclidean_heuristic, 
         warthog::fch_jpg_expansion_policy, 
-        warthog::pqueue_min> 
+        Q> 
             alg(&h, &fexp, &open);
 
     run_experiments(&alg, alg_name, parser, std::cout);
 }
 
+template<class Q>
 void
 run_fch_af_cpg(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
@@ -1676,16 +2399,17 @@ run_fch_af_cpg(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
     // search algo
     warthog::euclidean_heuristic h(pg.get());
     warthog::fch_af_cpg_expansion_policy fexp(&cpg, &order, afl.get());
-    warthog::pqueue_min open; 
+    Q open; 
 
     warthog::flexible_astar< 
         warthog::euclidean_heuristic, 
         warthog::fch_af_cpg_expansion_policy,
-        warthog::pqueue_min> alg(&h, &fexp, &open);
+        Q> alg(&h, &fexp, &open);
 
     run_experiments(&alg, alg_name, parser, std::cout);
 }
 
+template<class Q>
 void
 run_fch_af_jpg(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
@@ -1755,17 +2479,18 @@ run_fch_af_jpg(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
     // search algo
     warthog::euclidean_heuristic h(pg.get());
     warthog::fch_af_jpg_expansion_policy fexp(&cpg, &order, afl.get());
-    warthog::pqueue_min open;
+    Q open;
 
     warthog::flexible_astar< 
         warthog::euclidean_heuristic, 
         warthog::fch_af_jpg_expansion_policy,
-        warthog::pqueue_min> 
+        Q> 
             alg(&h, &fexp, &open);
 
     run_experiments(&alg, alg_name, parser, std::cout);
 }
 
+template<class Q>
 void
 run_fch_bb_cpg(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
@@ -1817,17 +2542,18 @@ run_fch_bb_cpg(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
     // create a search algo
     warthog::euclidean_heuristic h(pg.get());
     warthog::fch_bb_cpg_expansion_policy fexp(&cpg, &order, bbl.get());
-    warthog::pqueue_min open;
+    Q open;
 
     warthog::flexible_astar< 
         warthog::euclidean_heuristic, 
         warthog::fch_bb_cpg_expansion_policy,
-        warthog::pqueue_min>
+        Q>
             alg(&h, &fexp, &open);
 
     run_experiments(&alg, alg_name, parser, std::cout);
 }
 
+template<class Q>
 void
 run_fch_bb_jpg(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
         std::string alg_name, std::string gr, std::string co)
@@ -1879,64 +2605,30 @@ run_fch_bb_jpg(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
     // create a search algo
     warthog::euclidean_heuristic h(pg.get());
     warthog::fch_bb_jpg_expansion_policy fexp(&jpg, &order, bbl.get());
-    warthog::pqueue_min open;
+    Q open;
 
     warthog::flexible_astar< 
         warthog::euclidean_heuristic, 
         warthog::fch_bb_jpg_expansion_policy,
-        warthog::pqueue_min> 
+        Q> 
            alg(&h, &fexp, &open);
 
     run_experiments(&alg, alg_name, parser, std::cout);
 }
 
+// run algorithm @param alg_name using an open list of type Q
+template<class Q>
 void
-run_dimacs(warthog::util::cfg& cfg)
+run_alg(warthog::util::cfg& cfg, warthog::dimacs_parser& parser, 
+        std::string alg_name, std::string gr, std::string co)
 {
-    std::string gr = cfg.get_param_value("input");
-    std::string co = cfg.get_param_value("input");
-    std::string problemfile = cfg.get_param_value("problem");
-    std::string alg_name = cfg.get_param_value("alg");
-    std::string par_nruns = cfg.get_param_value("nruns");
-
-    if(par_nruns != "")
-    {
-       char* end;
-       nruns = strtol(par_nruns.c_str(), &end, 10);
-    }
-
-
-    if((problemfile == ""))
-    {
-        std::cerr << "parameter is missing: --problem\n";
-        return;
-    }
-    if((gr == "") || co == "")
-    {
-        std::cerr << "parameter is missing: --input [gr file] [co file]\n";
-        return;
-    }
-    if((alg_name == ""))
-    {
-        std::cerr << "parameter is missing: --alg\n";
-        return;
-    }
-
-    warthog::dimacs_parser parser;
-    parser.load_instance(problemfile.c_str());
-    if(parser.num_experiments() == 0)
-    {
-        std::cerr << "err; specified problem file contains no instances\n";
-        return;
-    }
-
     if(alg_name == "dijkstra")
     {
-        run_dijkstra(cfg, parser, alg_name, gr, co);
+        run_dijkstra<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "astar")
     {
-        run_astar(cfg, parser, alg_name, gr, co);
+        run_astar<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "bi-dijkstra")
     {
@@ -1948,7 +2640,19 @@ run_dimacs(warthog::util::cfg& cfg)
     }
     else if(alg_name == "bch")
     {
-        run_bch(cfg, parser, alg_name, gr, co);
+        run_bch<Q>(cfg, parser, alg_name, gr, co);
+    }
+    else if(alg_name == "bch-m2m")
+    {
+        run_bch_m2m(cfg, parser, alg_name, gr, co);
+    }
+    else if(alg_name == "phast")
+    {
+        run_phast(cfg, parser, alg_name, gr, co);
+    }
+    else if(alg_name == "cpd")
+    {
+        run_cpd(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "bchb")
     {
@@ -1960,27 +2664,27 @@ run_dimacs(warthog::util::cfg& cfg)
     }
     else if(alg_name == "bch-astar")
     {
-        run_bch_astar(cfg, parser, alg_name, gr, co);
+        run_bch_astar<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "bch-bb")
     {
-        run_bch_bb(cfg, parser, alg_name, gr, co);
+        run_bch_bb<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "bch-af")
     {
-        run_bch_af(cfg, parser, alg_name, gr, co);
+        run_bch_af<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "bch-bbaf")
     {
-        run_bch_bbaf(cfg, parser, alg_name, gr, co);
+        run_bch_bbaf<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "ch-cpg")
     {
-        run_ch_cpg(cfg, parser, alg_name, gr, co);
+        run_ch_cpg<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "fch")
     {
-        run_fch(cfg, parser, alg_name, gr, co);
+        run_fch<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "fchx")
     {
@@ -1988,51 +2692,51 @@ run_dimacs(warthog::util::cfg& cfg)
     }
     else if(alg_name == "fch-af")
     {
-        run_fch_af(cfg, parser, alg_name, gr, co);
+        run_fch_af<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "fch-bb")
     {
-        run_fch_bb(cfg, parser, alg_name, gr, co);
+        run_fch_bb<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "fch-bbaf")
     {
-        run_fch_bbaf(cfg, parser, alg_name, gr, co);
+        run_fch_bbaf<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "fch-dfs")
     {
-        run_fch_dfs(cfg, parser, alg_name, gr, co);
+        run_fch_dfs<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "fch-fm")
     {
-        run_fch_fm(cfg, parser, alg_name, gr, co);
+        run_fch_fm<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "fch-cpg")
     {
-        run_fch_cpg(cfg, parser, alg_name, gr, co);
+        run_fch_cpg<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "fch-af-cpg")
     {
-        run_fch_af_cpg(cfg, parser, alg_name, gr, co);
+        run_fch_af_cpg<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "fch-bb-cpg")
     {
-        run_fch_bb_cpg(cfg, parser, alg_name, gr, co);
+        run_fch_bb_cpg<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "fch-bbaf-cpg")
     {
-        run_fch_bbaf_cpg(cfg, parser, alg_name, gr, co);
+        run_fch_bbaf_cpg<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "fch-jpg")
     {
-        run_fch_jpg(cfg, parser, alg_name, gr, co);
+        run_fch_jpg<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "fch-bb-jpg")
     {
-        run_fch_bb_jpg(cfg, parser, alg_name, gr, co);
+        run_fch_bb_jpg<Q>(cfg, parser, alg_name, gr, co);
     }
     else if(alg_name == "fch-af-jpg")
     {
-        run_fch_af_jpg(cfg, parser, alg_name, gr, co);
+        run_fch_af_jpg<Q>(cfg, parser, alg_name, gr, co);
     }
     else
     {
@@ -2040,6 +2744,111 @@ run_dimacs(warthog::util::cfg& cfg)
     }
 }
 
+void
+run_dimacs(warthog::util::cfg& cfg)
+{
+    std::string gr = cfg.get_param_value("input");
+    std::string co = cfg.get_param_value("input");
+    std::string problemfile = cfg.get_param_value("problem");
+    std::string alg_name = cfg.get_param_value("alg");
+    std::string par_nruns = cfg.get_param_value("nruns");
+
+    if(par_nruns != "")
+    {
+       char* end;
+       nruns = strtol(par_nruns.c_str(), &end, 10);
+    }
+
+    std::string par_cost = cfg.get_param_value("cost");
+    if(par_cost != "")
+    {
+        cost_type = par_cost;
+    }
+
+    std::string par_queue = cfg.get_param_value("queue");
+    if(par_queue != "")
+    {
+        queue_type = par_queue;
+    }
+
+    std::string par_sources = cfg.get_param_value("sources");
+    if(par_sources != "")
+    {
+       char* end;
+       phast_sources = strtol(par_sources.c_str(), &end, 10);
+    }
+
+    std::string par_moves = cfg.get_param_value("moves");
+    if(par_moves != "")
+    {
+       char* end;
+       cpd_moves = strtol(par_moves.c_str(), &end, 10);
+    }
+
+    std::string par_threads = cfg.get_param_value("threads");
+    if(par_threads != "")
+    {
+       char* end;
+       nthreads = strtol(par_threads.c_str(), &end, 10);
+
+       // also used when computing labels (e.g. for fch-dfs)
+       warthog::helpers::set_parallel_threads(nthreads);
+    }
+
+
+    if((problemfile == ""))
+    {
+        std::cerr << "parameter is missing: --problem\n";
+        return;
+    }
+    if((gr == "") || 
+       (co == "" && !warthog::graph::is_xyg_image(gr.c_str())))
+    {
+        std::cerr << "parameter is missing: --input [gr file] [co file]"
+                  << " or --input [graph image]\n";
+        return;
+    }
+    if((alg_name == ""))
+    {
+        std::cerr << "parameter is missing: --alg\n";
+        return;
+    }
+
+    warthog::dimacs_parser parser;
+    parser.load_instance(problemfile.c_str());
+    if(parser.num_experiments() == 0)
+    {
+        std::cerr << "err; specified problem file contains no instances\n";
+        return;
+    }
+
+    if(queue_type == "binary")
+    {
+        run_alg<warthog::pqueue_min>(cfg, parser, alg_name, gr, co);
+    }
+    else if(queue_type == "dary")
+    {
+        run_alg<warthog::kway_pqueue_min>(cfg, parser, alg_name, gr, co);
+    }
+    else if(queue_type == "dial")
+    {
+        run_alg<warthog::bucket_queue<>>(cfg, parser, alg_name, gr, co);
+    }
+    else if(queue_type == "radix")
+    {
+        run_alg<warthog::radix_heap<>>(cfg, parser, alg_name, gr, co);
+    }
+    else if(queue_type == "mlb")
+    {
+        run_alg<warthog::multilevel_bucket_queue<>>(
+                cfg, parser, alg_name, gr, co);
+    }
+    else
+    {
+        std::cerr << "err; invalid queue type: " << queue_type << "\n";
+    }
+}
+
 
 int 
 main(int argc, char** argv)
@@ -2049,6 +2858,14 @@ main(int argc, char** argv)
 	{
 		{"alg",  required_argument, 0, 1},
 		{"nruns",  required_argument, 0, 1},
+		{"threads",  required_argument, 0, 1},
+		{"cost",  required_argument, 0, 1},
+		{"queue",  required_argument, 0, 1},
+		{"csr",  no_argument, &csr_graph, 1},
+		{"sources",  required_argument, 0, 1},
+		{"nosimd",  no_argument, &phast_nosimd, 1},
+		{"moves",  required_argument, 0, 1},
+		{"parallel",  no_argument, &parallel_bi, 1},
 		{"help", no_argument, &print_help, 1},
 		{"checkopt",  no_argument, &checkopt, 1},
 		{"verbose",  no_argument, &verbose, 1},
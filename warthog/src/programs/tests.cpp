@@ -1,27 +1,196 @@
+#include "bch_expansion_policy.h"
+#include "bch_search.h"
+#include "bch_many_to_many.h"
 #include "blockmap.h"
+#include "bidirectional_search.h"
+#include "bucket_queue.h"
+#include "cbs_ll_heuristic.h"
+#include "contraction.h"
 #include "cuckoo_table.h"
 #include "cpool.h"
+#include "customizable_ch.h"
+#include "firstmove_labelling.h"
+#include "firstmove_table.h"
 #include "flexible_astar.h"
+#include "graph_expansion_policy.h"
 #include "gridmap.h"
 #include "gridmap_expansion_policy.h"
 #include "hash_table.h"
 #include "jps_expansion_policy.h"
+#include "lazy_graph_contraction.h"
+#include "multilevel_bucket_queue.h"
 #include "pqueue.h"
+#include "reservation_table.h"
+#include "radix_heap.h"
 #include "octile_heuristic.h"
+#include "online_jump_point_locator2.h"
+#include "paged_node_pool.h"
+#include "phast.h"
 #include "search_node.h"
 #include "scenario_manager.h"
 #include "solution.h"
+#include "sparse_reservation_table.h"
+#include "workload_manager.h"
+#include "xy_graph.h"
+#include "zero_heuristic.h"
 
 #include "getopt.h"
 
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iomanip>
 #include <sstream>
+#include <vector>
 #include <unordered_map>
 #include <memory>
+#include <queue>
+
+// bin/tests is built with -DNDEBUG, so the tests below report failures
+// with check rather than assert
+#define check(expr) \
+	((expr) ? (void)0 : check_failed(#expr, __FILE__, __LINE__))
+
+void
+check_failed(const char* expr, const char* file, int line)
+{
+	std::cerr << "err; check failed: " << expr << " ("
+		<< file << ":" << line << ")\n";
+	exit(1);
+}
 
 void blockmap_access_test();
+// the distance from the cell with unpadded id @param target to every 
+// cell of @param map, moving in four directions at unit cost, by plain 
+// Dijkstra search. indexed by padded id; warthog::INF if not reachable
+void
+grid_distances(warthog::gridmap& map, uint32_t target,
+		std::vector<double>& dist)
+{
+	typedef std::pair<double, uint32_t> entry;
+	std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+	int32_t step[4] = { -1, 1, -(int32_t)map.width(), (int32_t)map.width() };
+	dist.assign(map.width() * map.height(), warthog::INF);
+	uint32_t source = map.to_padded_id(target);
+	dist[source] = 0;
+	open.push(entry(0, source));
+	while(open.size())
+	{
+		entry top = open.top();
+		open.pop();
+		if(top.first > dist[top.second]) { continue; }
+		for(uint32_t i = 0; i < 4; i++)
+		{
+			uint32_t nei = top.second + step[i];
+			if(!map.get_label(nei) || top.first + 1 >= dist[nei]) 
+			{ continue; }
+			dist[nei] = top.first + 1;
+			open.push(entry(dist[nei], nei));
+		}
+	}
+}
+
+// make @param target current and check each of its h-values against
+// the Dijkstra distance. @return the largest finite distance
+double
+check_h_values(warthog::cbs_ll_heuristic& heuristic, 
+		warthog::gridmap& map, uint32_t target)
+{
+	check(heuristic.set_current_target(target));
+	std::vector<double> dist;
+	grid_distances(map, target, dist);
+	double max_d = 0;
+	for(uint32_t y = 0; y < map.header_height(); y++)
+	{
+		for(uint32_t x = 0; x < map.header_width(); x++)
+		{
+			uint32_t id = map.to_padded_id(x, y);
+			check(heuristic.h(id, 0) == dist[id]);
+			if(dist[id] != warthog::INF) { max_d = std::max(max_d, dist[id]); }
+		}
+	}
+	return max_d;
+}
+
+// the tables of cbs_ll_heuristic are the Dijkstra distances, both when
+// they fit 16 bits per cell and when they need 32. with a memory limit
+// of two tables, the least recently used table is evicted and computed
+// again when its target is next made current
+void cbs_ll_heuristic_test()
+{
+	std::cout << "cbs_ll_heuristic_test...\n";
+	std::vector<uint32_t> targets;
+
+	// random obstacles, some of which enclose unreachable cells
+	warthog::gridmap map(40, 64);
+	srand(5);
+	for(uint32_t y = 0; y < 40; y++)
+	{
+		for(uint32_t x = 0; x < 64; x++)
+		{
+			map.set_label(map.to_padded_id(x, y), rand() % 4);
+		}
+	}
+	uint32_t ids[3] = { 0, 40 * 64 - 1, 20 * 64 + 31 };
+	for(uint32_t i = 0; i < 3; i++)
+	{
+		map.set_label(map.to_padded_id(ids[i]), true);
+	}
+
+	warthog::cbs_ll_heuristic heuristic;
+	heuristic.compute_h_values(targets, &map);
+	check(!heuristic.set_current_target(40 * 64));
+	heuristic.set_memory_limit(
+			2 * sizeof(uint16_t) * map.width() * map.height());
+	for(uint32_t i = 0; i < 3; i++) 
+	{ 
+		check(check_h_values(heuristic, map, ids[i]) < UINT16_MAX); 
+	}
+	check(heuristic.get_num_misses() == 3 && heuristic.get_num_hits() == 0);
+	check_h_values(heuristic, map, ids[1]);
+	check(heuristic.get_num_misses() == 3 && heuristic.get_num_hits() == 1);
+	check_h_values(heuristic, map, ids[0]);
+	check(heuristic.get_num_misses() == 4 && heuristic.get_num_hits() == 1);
+	check_h_values(heuristic, map, ids[1]);
+	check(heuristic.get_num_misses() == 4 && heuristic.get_num_hits() == 2);
+
+	// a limit below one table still keeps the current one
+	heuristic.set_memory_limit(1);
+	check_h_values(heuristic, map, ids[1]);
+	check_h_values(heuristic, map, ids[2]);
+	check(heuristic.get_num_misses() == 5 && heuristic.get_num_hits() == 3);
+
+	// a serpentine corridor; its far end is more than UINT16_MAX steps
+	// from the start, so the table needs 32 bits per cell
+	warthog::gridmap maze(300, 512);
+	for(uint32_t y = 0; y < 300; y++)
+	{
+		for(uint32_t x = 0; x < 512; x++)
+		{
+			uint32_t gap = (y / 2) % 2 ? 0 : 511;
+			maze.set_label(maze.to_padded_id(x, y), y % 2 == 0 || x == gap);
+		}
+	}
+	warthog::cbs_ll_heuristic long_heuristic;
+	long_heuristic.compute_h_values(targets, &maze);
+	check(check_h_values(long_heuristic, maze, 0) > UINT16_MAX);
+	check(check_h_values(long_heuristic, maze, 150 * 512 + 7) < UINT16_MAX);
+	std::cout << "/cbs_ll_heuristic_test...\n";
+}
+
 void gridmap_access_test();
 void pqueue_insert_test();
+void monotone_queue_test();
+void paged_node_pool_test();
+void firstmove_table_test();
+void parallel_contraction_test();
+void witness_search_test();
+void customizable_ch_test();
+void many_to_many_test();
+void phast_test();
+void parallel_bidirectional_test();
+void reservation_table_test();
+void cbs_ll_heuristic_test();
 void cuckoo_table_test();
 void unordered_map_test();
 void hash_table_test();
@@ -33,6 +202,17 @@ void online_jps_test();
 int main(int argc, char** argv)
 {
 	//flexible_astar_test();
+	monotone_queue_test();
+	paged_node_pool_test();
+	firstmove_table_test();
+	parallel_contraction_test();
+	witness_search_test();
+	customizable_ch_test();
+	many_to_many_test();
+	phast_test();
+	parallel_bidirectional_test();
+	reservation_table_test();
+	cbs_ll_heuristic_test();
 	online_jps_test();
 }
 
@@ -87,14 +267,93 @@ void test_alloc()
 //	}
 }
 
+// jumping from @param node_id towards @param goal_id, in every 
+// direction and with both ::jump and ::rjump, yields the same jump 
+// points and costs whether straight jumps read 32, 64 or 256 tiles 
+// at a time
+void
+check_jump_scan_widths(warthog::jps::online_jump_point_locator2& jpl,
+		uint32_t node_id, uint32_t goal_id)
+{
+	const warthog::jps::scan_width widths[3] = {
+		warthog::jps::SCAN_32BIT,
+		warthog::jps::SCAN_64BIT,
+		warthog::jps::SCAN_256BIT };
+	std::vector<uint32_t> jpoints[3];
+	std::vector<double> costs[3];
+	for(uint32_t d = warthog::jps::NORTH; 
+			d <= warthog::jps::SOUTHWEST; d <<= 1)
+	{
+		for(uint32_t rev = 0; rev < 2; rev++)
+		{
+			for(uint32_t w = 0; w < 3; w++)
+			{
+				jpl.set_scan_width(widths[w]);
+				jpoints[w].clear();
+				costs[w].clear();
+				if(rev)
+				{
+					jpl.rjump((warthog::jps::direction)d, node_id, goal_id,
+							jpoints[w], costs[w]);
+				}
+				else
+				{
+					jpl.jump((warthog::jps::direction)d, node_id, goal_id,
+							jpoints[w], costs[w]);
+				}
+				check(jpoints[w] == jpoints[0] && costs[w] == costs[0]);
+			}
+		}
+	}
+}
+
 void online_jps_test()
 {
+	// a map whose obstacles lie on a few rows and columns, so that many
+	// straight jumps are longer than one 256-tile window
+	warthog::gridmap open_map(300, 300);
+	srand(11);
+	for(uint32_t y = 0; y < 300; y++)
+	{
+		for(uint32_t x = 0; x < 300; x++)
+		{
+			bool on_line = x % 37 == 0 || y % 41 == 0;
+			open_map.set_label(open_map.to_padded_id(x, y), 
+					!on_line || rand() % 16);
+		}
+	}
+	uint32_t goals[3] = { 
+		open_map.to_padded_id(150, 150), 
+		open_map.to_padded_id(299, 7),
+		open_map.to_padded_id(3, 260) };
+	for(uint32_t i = 0; i < 3; i++) { open_map.set_label(goals[i], true); }
+	warthog::jps::online_jump_point_locator2 open_jpl(&open_map);
+	for(uint32_t y = 0; y < 300; y++)
+	{
+		for(uint32_t x = y % 5; x < 300; x += 5)
+		{
+			uint32_t node_id = open_map.to_padded_id(x, y);
+			if(!open_map.get_label(node_id)) { continue; }
+			check_jump_scan_widths(open_jpl, node_id, goals[(x + y) % 3]);
+		}
+	}
+
 	bool check_opt = false;
 	//bool check_opt = true;
 	warthog::scenario_manager scenmgr;
 	scenmgr.load_scenario("orz700d.map.scen");
 	warthog::gridmap map(scenmgr.get_experiment(0)->map().c_str());
 
+	// the scan widths also agree on the instances of the scenario
+	warthog::jps::online_jump_point_locator2 jpl(&map);
+	for(uint32_t i = 0; i < scenmgr.num_experiments(); i++)
+	{
+		warthog::experiment* exp = scenmgr.get_experiment(i);
+		check_jump_scan_widths(jpl, 
+				map.to_padded_id(exp->startx(), exp->starty()),
+				map.to_padded_id(exp->goalx(), exp->goaly()));
+	}
+
 //	warthog::gridmap map("CSC2F.map", true);
 //	map.printdb(std::cerr);
 //	map.print(std::cerr);
@@ -350,6 +609,750 @@ void pqueue_insert_test()
 	std::cout << "/pqueue_insert_test...\n";
 }
 
+// insert, decrease-key and pop order for one of the monotone queues.
+// keys have many ties; after the first pops, some queued nodes have
+// their keys decreased into the bucket currently being popped. with
+// @param exact the queue must also break f-ties in favour of larger g,
+// like warthog::pqueue
+template<class Q>
+void
+monotone_queue_test(Q& open, bool exact)
+{
+	const uint32_t num_nodes = 10000;
+	std::vector<warthog::search_node*> nodes(num_nodes);
+	// keys are monotone: the first node pushed has the smallest key,
+	// like the start node of a search
+	nodes[0] = new warthog::search_node(0);
+	nodes[0]->set_g(0);
+	nodes[0]->set_f(100);
+	open.push(nodes[0]);
+	for(uint32_t i = 1; i < num_nodes; i++)
+	{
+		nodes[i] = new warthog::search_node(i);
+		nodes[i]->set_g(i % 7);
+		nodes[i]->set_f(150 + (i * 7919) % 500);
+		open.push(nodes[i]);
+	}
+	// duplicate pushes are ignored
+	for(uint32_t i = 0; i < num_nodes; i += 3) { open.push(nodes[i]); }
+	check(open.size() == num_nodes);
+
+	// decrease some keys before anything is popped
+	for(uint32_t i = 5; i < num_nodes; i += 5)
+	{
+		nodes[i]->set_f(nodes[i]->get_f() - 50);
+		open.decrease_key(nodes[i]);
+	}
+	check(open.size() == num_nodes);
+
+	std::vector<bool> popped(num_nodes, false);
+	double last_f = 0;
+	double last_g = 0;
+	uint32_t num_popped = 0;
+	while(open.size() > 0)
+	{
+		warthog::search_node* n = open.pop();
+		check(n && !open.contains(n) && !popped[n->get_id()]);
+		check(n->get_f() >= last_f);
+		check(!exact || n->get_f() > last_f || n->get_g() <= last_g);
+		popped[n->get_id()] = true;
+		last_f = n->get_f();
+		last_g = n->get_g();
+		num_popped++;
+		check(open.size() == num_nodes - num_popped);
+
+		// decrease a few queued keys into the current bucket
+		if(num_popped % 1000 == 0)
+		{
+			bool decreased = false;
+			for(uint32_t i = num_popped; i < num_nodes; i += 97)
+			{
+				if(!open.contains(nodes[i]) ||
+				   nodes[i]->get_f() <= last_f) { continue; }
+				nodes[i]->set_f(last_f);
+				nodes[i]->set_g(0);
+				open.decrease_key(nodes[i]);
+				decreased = true;
+			}
+			// the next node has the current key
+			check(!decreased || open.peek()->get_f() == last_f);
+		}
+	}
+	check(num_popped == num_nodes);
+	check(open.pop() == 0);
+
+	// the queue is reusable after ::clear
+	for(uint32_t i = 0; i < 10; i++)
+	{
+		nodes[i]->set_f(10 - i);
+		open.push(nodes[i]);
+	}
+	open.clear();
+	check(open.size() == 0 && !open.contains(nodes[0]));
+	nodes[0]->set_f(3);
+	open.push(nodes[0]);
+	check(open.pop() == nodes[0]);
+
+	for(uint32_t i = 0; i < num_nodes; i++) { delete nodes[i]; }
+}
+
+void monotone_queue_test()
+{
+	std::cout << "monotone_queue_test...\n";
+	// a small initial size makes the bucket queue grow its window
+	warthog::bucket_queue<> bq(16);
+	monotone_queue_test(bq, false);
+	warthog::radix_heap<> rh;
+	monotone_queue_test(rh, false);
+	warthog::multilevel_bucket_queue<> mlbq(1024, 8);
+	monotone_queue_test(mlbq, true);
+	std::cout << "/monotone_queue_test...\n";
+}
+
+void paged_node_pool_test()
+{
+	std::cout << "paged_node_pool_test...\n";
+	const uint32_t page_size = warthog::mem::paged_node_pool_ns::PAGE_SIZE;
+	const uint32_t num_nodes = 10000;
+	warthog::mem::paged_node_pool pool(num_nodes);
+	check(pool.get_num_touched_pages() == 0);
+	check(pool.get_ptr(5) == 0);
+
+	// nodes on the same page share one allocation
+	warthog::search_node* n5 = pool.generate(5);
+	check(n5 && n5->get_id() == 5);
+	check(pool.get_num_touched_pages() == 1);
+	warthog::search_node* n7 = pool.generate(7);
+	check(n7 == n5 + 2 && n7->get_id() == 7);
+	check(pool.get_num_touched_pages() == 1);
+	check(pool.get_ptr(page_size - 1) == n5 + page_size - 6);
+	check(pool.get_ptr(page_size) == 0);
+
+	// a node is the same object until the next reset
+	n5->init(1, warthog::NODE_NONE, 3, 4);
+	check(pool.generate(5) == n5 && pool.get_ptr(5)->get_g() == 3);
+
+	// the last id is in a different directory block
+	warthog::search_node* last = pool.generate(num_nodes - 1);
+	check(last && last->get_id() == num_nodes - 1);
+	check(pool.get_num_touched_pages() == 2);
+
+	// ids outside the pool yield null and allocate nothing
+	check(pool.generate(warthog::NODE_NONE) == 0);
+	check(pool.get_ptr(warthog::NODE_NONE) == 0);
+	check(pool.generate(num_nodes * 4) == 0);
+	check(pool.get_num_touched_pages() == 2);
+
+	// the next search reuses freed pages; its nodes are fresh
+	pool.reset();
+	size_t mem = pool.mem();
+	check(pool.get_num_touched_pages() == 0);
+	check(pool.get_ptr(5) == 0 && pool.get_ptr(num_nodes - 1) == 0);
+	warthog::search_node* m = pool.generate(2 * page_size + 1);
+	check(m && m->get_id() == 2 * page_size + 1);
+	check(m->get_search_id() == 0 && m->get_g() == warthog::INF);
+	warthog::search_node* m2 = pool.generate(5);
+	check(m2 && m2->get_id() == 5 && m2->get_search_id() == 0);
+	check(pool.get_num_touched_pages() == 2);
+	check(pool.mem() == mem);
+
+	// reclaim only releases pages that are not in use
+	pool.reset();
+	pool.generate(5);
+	pool.reclaim();
+	check(pool.mem() < mem);
+	check(pool.get_ptr(5)->get_id() == 5);
+	pool.reset();
+	pool.reclaim();
+	check(pool.get_num_touched_pages() == 0 && pool.get_ptr(5) == 0);
+	std::cout << "/paged_node_pool_test...\n";
+}
+
+// a grid of @param height x @param width with a wall down the middle,
+// open at the top
+void
+make_test_graph(warthog::graph::xy_graph& g, uint32_t height, uint32_t width)
+{
+	warthog::gridmap map(height, width);
+	for(uint32_t y = 0; y < height; y++)
+	{
+		for(uint32_t x = 0; x < width; x++)
+		{
+			map.set_label(map.to_padded_id(x, y),
+					x != width/2 || y == 0);
+		}
+	}
+	g.load_from_grid(&map);
+}
+
+// add to the weight of every edge of @param g (outgoing and incoming)
+// an amount that depends on the direction of the edge
+void
+make_directed(warthog::graph::xy_graph& g)
+{
+	for(uint32_t i = 0; i < g.get_num_nodes(); i++)
+	{
+		warthog::graph::node* n = g.get_node(i);
+		for(warthog::graph::edge_iter it = n->outgoing_begin();
+				it != n->outgoing_end(); it++)
+		{
+			it->wt_ += ((i * 3 + it->node_id_ * 5) % 7) * 100;
+		}
+		for(warthog::graph::edge_iter it = n->incoming_begin();
+				it != n->incoming_end(); it++)
+		{
+			it->wt_ += ((it->node_id_ * 3 + i * 5) % 7) * 100;
+		}
+	}
+}
+
+// save a firstmove_table, load it back and compare every label with
+// the firstmove_labelling it was made from. corrupt copies of the file
+// must not load
+void firstmove_table_test()
+{
+	std::cout << "firstmove_table_test...\n";
+	const char* file = "firstmove_table_test.fmt";
+	warthog::graph::xy_graph g;
+	make_test_graph(g, 12, 16);
+
+	std::vector<uint32_t> column_order;
+	warthog::label::compute_fm_dfs_preorder(g, column_order);
+	warthog::util::workload_manager workload(g.get_num_nodes());
+	workload.set_all_flags(true);
+	std::function<warthog::graph_expansion_policy<>*(void)>
+		fn_new_expander = [&g]() -> warthog::graph_expansion_policy<>*
+		{
+			return new warthog::graph_expansion_policy<>(&g);
+		};
+	warthog::label::firstmove_labelling* rows =
+		warthog::label::firstmove_labelling::compute
+		<warthog::graph_expansion_policy<>>
+			(&g, &column_order, fn_new_expander, &workload);
+	bool saved = warthog::label::firstmove_table::save(
+			file, *rows, column_order);
+	check(saved);
+
+	warthog::label::firstmove_table* lab =
+		warthog::label::firstmove_table::load(file);
+	check(lab && lab->get_num_nodes() == g.get_num_nodes());
+	std::vector<uint32_t> col(g.get_num_nodes());
+	for(uint32_t i = 0; i < column_order.size(); i++)
+	{
+		col[column_order[i]] = i;
+	}
+	uint64_t num_runs = 0;
+	for(uint32_t s = 0; s < g.get_num_nodes(); s++)
+	{
+		num_runs += lab->get_row_length(s);
+		for(uint32_t t = 0; t < g.get_num_nodes(); t++)
+		{
+			check(lab->get_label(s, t) == rows->get_label(s, col[t]));
+		}
+	}
+	check(num_runs == lab->get_num_runs());
+	delete lab;
+
+	// ::load rejects files that are truncated or whose header, row
+	// offsets or columns do not match the arrays
+	std::ifstream in(file, std::ios::binary);
+	std::string image((std::istreambuf_iterator<char>(in)),
+			std::istreambuf_iterator<char>());
+	in.close();
+	auto loads = [file] (const std::string& bytes) -> bool
+	{
+		std::ofstream out(file, std::ios::binary | std::ios::trunc);
+		out.write(bytes.data(), bytes.size());
+		out.close();
+		warthog::label::firstmove_table* tab =
+			warthog::label::firstmove_table::load(file);
+		delete tab;
+		return tab != 0;
+	};
+	warthog::label::fmt_header hdr;
+	memcpy(&hdr, image.data(), sizeof(hdr));
+	check(loads(image));
+	check(!loads(image.substr(0, image.size() - 1)));
+
+	std::string bad = image;
+	warthog::label::fmt_header bad_hdr = hdr;
+	bad_hdr.num_rows_ = hdr.num_nodes_ + 1;
+	memcpy(&bad[0], &bad_hdr, sizeof(hdr));
+	check(!loads(bad));
+
+	bad = image;
+	bad_hdr = hdr;
+	bad_hdr.heads_offset_ = hdr.file_size_;
+	memcpy(&bad[0], &bad_hdr, sizeof(hdr));
+	check(!loads(bad));
+
+	bad = image;
+	uint64_t last_row = hdr.num_runs_ - 1;
+	memcpy(&bad[hdr.row_index_offset_ + sizeof(uint64_t) * hdr.num_rows_],
+			&last_row, sizeof(last_row));
+	check(!loads(bad));
+
+	bad = image;
+	uint32_t bad_col = hdr.num_nodes_;
+	memcpy(&bad[hdr.col_offset_ + sizeof(uint32_t) * 3],
+			&bad_col, sizeof(bad_col));
+	check(!loads(bad));
+
+	std::remove(file);
+	check(warthog::label::firstmove_table::load(file) == 0);
+
+	delete rows;
+	std::cout << "/firstmove_table_test...\n";
+}
+
+// the distance from @param source to every node of @param g, by plain
+// Dijkstra search; warthog::INF if a node is not reachable
+void
+dijkstra_distances(warthog::graph::xy_graph& g, uint32_t source,
+		std::vector<double>& dist)
+{
+	typedef std::pair<double, uint32_t> entry;
+	std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+	dist.assign(g.get_num_nodes(), warthog::INF);
+	dist[source] = 0;
+	open.push(entry(0, source));
+	while(open.size())
+	{
+		entry top = open.top();
+		open.pop();
+		if(top.first > dist[top.second]) { continue; }
+		warthog::graph::node* n = g.get_node(top.second);
+		for(warthog::graph::edge_iter it = n->outgoing_begin();
+				it != n->outgoing_end(); it++)
+		{
+			double d = top.first + it->wt_;
+			if(d < dist[it->node_id_])
+			{
+				dist[it->node_id_] = d;
+				open.push(entry(d, it->node_id_));
+			}
+		}
+	}
+}
+
+// bch_search over the contraction hierarchy @param ch of @param g, whose
+// nodes have ranks @param rank, finds the Dijkstra distance in @param g 
+// between every pair of nodes. @param ch must have the same node ids
+// as @param g; it is pruned for bch (see ch::optimise_graph_for_bch_v2)
+void
+check_ch_distances(warthog::graph::xy_graph& g,
+		warthog::graph::xy_graph& ch, std::vector<uint32_t>& rank,
+		bool parallel = false)
+{
+	check(ch.get_num_nodes() == g.get_num_nodes());
+	warthog::ch::optimise_graph_for_bch_v2(&ch, &rank);
+	warthog::bch_expansion_policy fexp(&ch, &rank);
+	warthog::bch_expansion_policy bexp(&ch, &rank, true);
+	warthog::zero_heuristic h;
+	warthog::bch_search<warthog::zero_heuristic, 
+		warthog::bch_expansion_policy> alg(&fexp, &bexp, &h);
+	alg.set_parallel(parallel);
+
+	std::vector<double> dist;
+	for(uint32_t s = 0; s < g.get_num_nodes(); s++)
+	{
+		dijkstra_distances(g, s, dist);
+		for(uint32_t t = 0; t < g.get_num_nodes(); t++)
+		{
+			warthog::problem_instance pi(
+					g.to_external_id(s), g.to_external_id(t));
+			warthog::solution sol;
+			alg.get_distance(pi, sol);
+			check(sol.sum_of_edge_costs_ == dist[t]);
+		}
+	}
+}
+
+// contract_parallel may add more shortcuts than the sequential 
+// contraction, but its hierarchy must yield the same distances
+void parallel_contraction_test()
+{
+	std::cout << "parallel_contraction_test...\n";
+	warthog::graph::xy_graph g;
+	make_test_graph(g, 12, 16);
+	for(uint32_t num_threads = 1; num_threads <= 4; num_threads *= 4)
+	{
+		warthog::graph::xy_graph ch;
+		make_test_graph(ch, 12, 16);
+		warthog::ch::lazy_graph_contraction contractor(&ch);
+		contractor.contract_parallel(num_threads);
+
+		std::vector<uint32_t> rank;
+		contractor.get_order(rank);
+		check(rank.size() == g.get_num_nodes());
+		warthog::ch::value_index_swap_dimacs(rank);
+		check_ch_distances(g, ch, rank);
+	}
+	std::cout << "/parallel_contraction_test...\n";
+}
+
+// one-to-many witness searches yield a correct hierarchy, also when 
+// they stop early and thus add more shortcuts than needed. pairwise 
+// searches are the baseline
+void witness_search_test()
+{
+	std::cout << "witness_search_test...\n";
+	warthog::graph::xy_graph g;
+	make_test_graph(g, 12, 16);
+	struct { warthog::ch::witness_search_type type; uint32_t settled, hops; }
+	setups[] = {
+		{ warthog::ch::WS_PAIRWISE, 500, 0 },
+		{ warthog::ch::WS_ONE_TO_MANY, 500, 0 },
+		{ warthog::ch::WS_ONE_TO_MANY, 4, 2 },
+	};
+	uint64_t shortcuts[3];
+	for(uint32_t i = 0; i < 3; i++)
+	{
+		warthog::graph::xy_graph ch;
+		make_test_graph(ch, 12, 16);
+		warthog::ch::lazy_graph_contraction contractor(&ch);
+		contractor.set_witness_search(setups[i].type);
+		contractor.set_witness_limits(setups[i].settled, setups[i].hops);
+		contractor.contract();
+		shortcuts[i] = contractor.get_num_shortcuts();
+
+		std::vector<uint32_t> rank;
+		contractor.get_order(rank);
+		check(rank.size() == g.get_num_nodes());
+		warthog::ch::value_index_swap_dimacs(rank);
+		check_ch_distances(g, ch, rank);
+	}
+	check(shortcuts[1] <= shortcuts[2]);
+	std::cout << "/witness_search_test...\n";
+}
+
+// one CCH topology is customized for the grid weights and then for a
+// directed metric, on one and on four threads, and once more after a
+// save and load. every customized hierarchy must yield the Dijkstra
+// distances of its metric
+void customizable_ch_test()
+{
+	std::cout << "customizable_ch_test...\n";
+	const char* file = "customizable_ch_test.cch";
+	warthog::graph::xy_graph g;
+	make_test_graph(g, 12, 16);
+	std::vector<uint32_t> order;
+	warthog::ch::make_nested_dissection_order(&g, order);
+	warthog::ch::customizable_ch cch;
+	check(cch.contract(&g, order));
+
+	for(uint32_t metric = 0; metric < 2; metric++)
+	{
+		if(metric == 1) { make_directed(g); }
+		for(uint32_t num_threads = 1; num_threads <= 4; num_threads *= 4)
+		{
+			check(cch.customize(&g, num_threads));
+			warthog::graph::xy_graph ch;
+			std::vector<uint32_t> rank;
+			cch.make_hierarchy(&g, &ch, &rank);
+			check_ch_distances(g, ch, rank);
+		}
+	}
+
+	check(cch.save(file));
+	warthog::ch::customizable_ch loaded;
+	check(loaded.load(file));
+	check(loaded.get_num_arcs() == cch.get_num_arcs());
+	check(loaded.customize(&g));
+	warthog::graph::xy_graph ch;
+	std::vector<uint32_t> rank;
+	loaded.make_hierarchy(&g, &ch, &rank);
+	check_ch_distances(g, ch, rank);
+	std::remove(file);
+	std::cout << "/customizable_ch_test...\n";
+}
+
+// a contraction hierarchy of the test grid with directed weights (see
+// make_directed), pruned for bch. @param rank receives the node ranks
+void
+make_test_hierarchy(warthog::graph::xy_graph& ch, 
+		std::vector<uint32_t>& rank)
+{
+	make_test_graph(ch, 12, 16);
+	make_directed(ch);
+	warthog::ch::lazy_graph_contraction contractor(&ch);
+	contractor.contract();
+	contractor.get_order(rank);
+	warthog::ch::value_index_swap_dimacs(rank);
+	warthog::ch::optimise_graph_for_bch_v2(&ch, &rank);
+}
+
+// distance tables between overlapping sets of sources and targets, 
+// with repeated nodes, are the Dijkstra distances. edge weights depend 
+// on direction, so mixing up sources and targets is an error
+void many_to_many_test()
+{
+	std::cout << "many_to_many_test...\n";
+	warthog::graph::xy_graph g;
+	make_test_graph(g, 12, 16);
+	make_directed(g);
+	warthog::graph::xy_graph ch;
+	std::vector<uint32_t> rank;
+	make_test_hierarchy(ch, rank);
+
+	std::vector<uint32_t> sources, targets;
+	for(uint32_t i = 0; i < g.get_num_nodes(); i += 5)
+	{
+		sources.push_back(g.to_external_id(i));
+	}
+	for(uint32_t i = 1; i < g.get_num_nodes(); i += 3)
+	{
+		targets.push_back(g.to_external_id(i));
+	}
+	targets.push_back(sources.at(2));
+	targets.push_back(targets.at(0));
+
+	warthog::ch::bch_many_to_many m2m(&ch, &rank);
+	std::vector<double> table, dist;
+	for(uint32_t num_threads = 1; num_threads <= 4; num_threads *= 4)
+	{
+		table.clear();
+		check(m2m.distance_table(sources, targets, table, num_threads));
+		check(table.size() == sources.size() * targets.size());
+		for(uint32_t i = 0; i < sources.size(); i++)
+		{
+			dijkstra_distances(g, g.to_graph_id(sources[i]), dist);
+			for(uint32_t j = 0; j < targets.size(); j++)
+			{
+				check(table[i * targets.size() + j] == 
+						dist[g.to_graph_id(targets[j])]);
+			}
+		}
+	}
+
+	// ids that are not in the graph
+	targets.push_back(warthog::INF - 1);
+	check(!m2m.distance_table(sources, targets, table, 1));
+	std::cout << "/many_to_many_test...\n";
+}
+
+// one-to-all sweeps from every node, and sweeps that share several 
+// sources (including repeats) among their lanes, give the Dijkstra 
+// distances; with and without AVX2
+void phast_test()
+{
+	std::cout << "phast_test...\n";
+	warthog::graph::xy_graph g;
+	make_test_graph(g, 12, 16);
+	make_directed(g);
+	warthog::graph::xy_graph ch;
+	std::vector<uint32_t> rank;
+	make_test_hierarchy(ch, rank);
+	warthog::ch::phast alg(&ch, &rank);
+	check(alg.get_num_nodes() == g.get_num_nodes());
+
+	std::vector<std::vector<double>> dist(g.get_num_nodes());
+	for(uint32_t s = 0; s < g.get_num_nodes(); s++)
+	{
+		dijkstra_distances(g, s, dist[s]);
+	}
+
+	for(uint32_t simd = 0; simd < 2; simd++)
+	{
+		alg.set_simd(simd);
+		for(uint32_t s = 0; s < g.get_num_nodes(); s++)
+		{
+			alg.one_to_all(s);
+			for(uint32_t t = 0; t < g.get_num_nodes(); t++)
+			{
+				check(alg.get_distance(0, t) == dist[s][t]);
+			}
+		}
+
+		uint32_t num_sources[] = { 3, 5, warthog::ch::phast::MAX_SOURCES };
+		for(uint32_t k = 0; k < 3; k++)
+		{
+			uint32_t n = num_sources[k];
+			std::vector<uint32_t> sources;
+			for(uint32_t i = 0; i < n; i++)
+			{
+				sources.push_back((i * 37) % g.get_num_nodes());
+			}
+			sources.back() = sources.front();
+			alg.many_to_all(&sources[0], n);
+			check(alg.get_num_lanes() >= n);
+			for(uint32_t i = 0; i < n; i++)
+			{
+				for(uint32_t t = 0; t < g.get_num_nodes(); t++)
+				{
+					check(alg.get_distance(i, t) == dist[sources[i]][t]);
+				}
+			}
+		}
+	}
+	std::cout << "/phast_test...\n";
+}
+
+// @param rev receives @param g with every edge reversed
+void
+reverse_graph(warthog::graph::xy_graph& g, warthog::graph::xy_graph& rev)
+{
+	rev.capacity(g.get_num_nodes());
+	for(uint32_t i = 0; i < g.get_num_nodes(); i++)
+	{
+		int32_t x, y;
+		g.get_xy(i, x, y);
+		rev.add_node(x, y, g.to_external_id(i));
+	}
+	for(uint32_t i = 0; i < g.get_num_nodes(); i++)
+	{
+		warthog::graph::node* n = g.get_node(i);
+		for(warthog::graph::edge_iter it = n->outgoing_begin();
+				it != n->outgoing_end(); it++)
+		{
+			rev.get_node(it->node_id_)->add_outgoing(
+					warthog::graph::edge(i, it->wt_));
+			rev.get_node(i)->add_incoming(
+					warthog::graph::edge(it->node_id_, it->wt_));
+		}
+	}
+}
+
+// bidirectional Dijkstra and bch find the Dijkstra distance between
+// every pair of nodes of the directed test grid, with the backward 
+// search on the same thread and on a helper thread
+void parallel_bidirectional_test()
+{
+	std::cout << "parallel_bidirectional_test...\n";
+	warthog::graph::xy_graph g;
+	make_test_graph(g, 12, 16);
+	make_directed(g);
+	warthog::graph::xy_graph backward_g;
+	reverse_graph(g, backward_g);
+
+	warthog::simple_graph_expansion_policy fexp(&g);
+	warthog::simple_graph_expansion_policy bexp(&backward_g);
+	warthog::zero_heuristic h;
+	warthog::bidirectional_search<
+		warthog::zero_heuristic, warthog::simple_graph_expansion_policy>
+			alg(&fexp, &bexp, &h);
+
+	std::vector<double> dist;
+	for(uint32_t parallel = 0; parallel < 2; parallel++)
+	{
+		alg.set_parallel(parallel);
+		for(uint32_t s = 0; s < g.get_num_nodes(); s++)
+		{
+			dijkstra_distances(g, s, dist);
+			for(uint32_t t = 0; t < g.get_num_nodes(); t++)
+			{
+				warthog::problem_instance pi(
+						g.to_external_id(s), g.to_external_id(t));
+				warthog::solution sol;
+				alg.get_distance(pi, sol);
+				check(sol.sum_of_edge_costs_ == dist[t]);
+			}
+		}
+
+		warthog::graph::xy_graph ch;
+		make_test_graph(ch, 12, 16);
+		make_directed(ch);
+		warthog::ch::lazy_graph_contraction contractor(&ch);
+		contractor.contract();
+		std::vector<uint32_t> rank;
+		contractor.get_order(rank);
+		warthog::ch::value_index_swap_dimacs(rank);
+		check_ch_distances(g, ch, rank, parallel);
+	}
+	std::cout << "/parallel_bidirectional_test...\n";
+}
+
+// @return true if the dense and sparse tables agree on every cell and
+// timestep up to @param horizon (and a little beyond)
+bool
+same_reservations(warthog::reservation_table& dense,
+		warthog::sparse_reservation_table& sparse,
+		uint32_t map_sz, uint32_t horizon)
+{
+	for(uint32_t xy = 0; xy < map_sz; xy++)
+	{
+		for(uint32_t t = 0; t < horizon + 4; t++)
+		{
+			if(dense.is_reserved(xy, t) != sparse.is_reserved(xy, t))
+			{ return false; }
+
+			uint32_t db = 7, de = 7, sb = 7, se = 7;
+			bool dfree = dense.get_safe_interval(xy, t, db, de);
+			bool sfree = sparse.get_safe_interval(xy, t, sb, se);
+			if(dfree != sfree || db != sb || de != se) { return false; }
+		}
+	}
+	return true;
+}
+
+// the sparse reservation table gives the same answers as the dense one
+// for a random sequence of reservations, interval reservations and
+// unreservations, and again after ::clear_reservations
+void reservation_table_test()
+{
+	std::cout << "reservation_table_test...\n";
+	const uint32_t map_sz = 300;
+	const uint32_t horizon = 40;
+	warthog::reservation_table dense(map_sz);
+	warthog::sparse_reservation_table sparse(map_sz);
+	uint32_t map_bitwidth = 32 - __builtin_clz(map_sz);
+	srand(7);
+
+	for(uint32_t round = 0; round < 2; round++)
+	{
+		// dense can only unreserve timesteps it has a bitmap for
+		uint32_t dense_horizon = 0;
+		for(uint32_t i = 0; i < 3000; i++)
+		{
+			uint32_t xy = rand() % map_sz;
+			uint32_t t = rand() % horizon;
+			uint32_t len = 1 + rand() % 5;
+			switch(rand() % 5)
+			{
+				case 0:
+					dense.reserve(xy, t);
+					sparse.reserve(xy, t);
+					dense_horizon = std::max(dense_horizon, t + 1);
+					break;
+				case 1:
+				{
+					uint32_t id = (t << map_bitwidth) | xy;
+					dense.reserve(id);
+					sparse.reserve(id);
+					check(dense.is_reserved(id) && sparse.is_reserved(id));
+					dense_horizon = std::max(dense_horizon, t + 1);
+					break;
+				}
+				case 2:
+					for(uint32_t j = t; j < t + len; j++)
+					{ dense.reserve(xy, j); }
+					sparse.reserve(xy, t, t + len);
+					dense_horizon = std::max(dense_horizon, t + len);
+					break;
+				case 3:
+					if(t + len > dense_horizon) { break; }
+					for(uint32_t j = t; j < t + len; j++)
+					{ dense.unreserve(xy, j); }
+					sparse.unreserve(xy, t, t + len);
+					break;
+				default:
+					if(t >= dense_horizon) { break; }
+					dense.unreserve(xy, t);
+					sparse.unreserve(xy, t);
+					break;
+			}
+		}
+		check(sparse.get_num_reserved_cells() > 0);
+		check(same_reservations(dense, sparse, map_sz, horizon));
+
+		dense.clear_reservations();
+		sparse.clear_reservations();
+		check(sparse.get_num_reserved_cells() == 0);
+		check(same_reservations(dense, sparse, map_sz, horizon));
+	}
+	std::cout << "/reservation_table_test...\n";
+}
+
 void gridmap_access_test()
 {
 	std::cout << "gridmap_access_test..."<<std::endl;
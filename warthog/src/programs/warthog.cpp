@@ -7,29 +7,40 @@
 // @created: 2016-11-23
 //
 
+#include "batch_query.h"
 #include "cbs.h"
 #include "cbs_ll_heuristic.h"
 #include "cfg.h"
 #include "constants.h"
 #include "corner_point_graph.h"
+#include "cpd_search.h"
 #include "cpg_expansion_policy.h"
+#include "firstmove_labelling.h"
+#include "firstmove_table.h"
 #include "flexible_astar.h"
+#include "graph_expansion_policy.h"
 #include "gridmap.h"
 #include "gridmap_expansion_policy.h"
+#include "helpers.h"
 #include "cbs_ll_expansion_policy.h"
 #include "jpg_expansion_policy.h"
 #include "jps_expansion_policy.h"
 #include "jps_expansion_policy_wgm.h"
 #include "jps2_expansion_policy.h"
+#include "jps2_listener.h"
 #include "jpsplus_expansion_policy.h"
+#include "kway_pqueue.h"
 #include "jps2plus_expansion_policy.h"
 #include "manhattan_heuristic.h"
+#include "multilevel_bucket_queue.h"
 #include "octile_heuristic.h"
 #include "scenario_manager.h"
 #include "timer.h"
 #include "labelled_gridmap.h"
 #include "txevl_gridmap_expansion_policy.h"
 #include "vl_gridmap_expansion_policy.h"
+#include "workload_manager.h"
+#include "xy_graph.h"
 #include "zero_heuristic.h"
 
 #include "getopt.h"
@@ -47,6 +58,16 @@ int checkopt = 0;
 int verbose = 0;
 // display program help on startup
 int print_help = 0;
+// number of worker threads used to answer queries (0 = one per core)
+uint32_t nthreads = 1;
+// type of open list used by the search
+std::string queue_type = "dary";
+// per-worker memory (MB) above which search nodes are reclaimed (0 = never)
+uint32_t reclaim_mb = 0;
+// number of first moves extracted by cpd queries (0 = the whole path)
+uint32_t cpd_moves = 0;
+// type of reservation table used by cbs_ll and tx_astar
+std::string restab_type = "dense";
 
 void
 help()
@@ -57,10 +78,21 @@ help()
 	<< "\t--gen [map filename] \n"
 	<< "\t--checkopt (optional)\n"
 	<< "\t--verbose (optional)\n"
+	<< "\t--threads [int (worker threads; 0 = all cores; default=1)]\n"
+	<< "\t--queue [binary|dary|mlb] (open list; default=dary)\n"
+	<< "\t--reclaim [int (free the search nodes of a worker once it "
+    << "uses more MB than this; default=0, never)]\n"
+	<< "\t--moves [int (cpd stops after this many first moves; "
+    << "default=0, the whole path)]\n"
+	<< "\t--restab [dense|sparse] (reservation table of cbs_ll and "
+    << "tx_astar; default=dense)\n"
     << "\nRecognised values for --alg:\n"
     << "\tcbs_ll, dijkstra, astar, astar_wgm, fc_astar, tx_astar, sssp\n"
     << "\tjps, jps2, jps+, jps2+, jps, jps_wgm\n"
-    << "\tcpg, jpg\n";
+    << "\tcpg, jpg, cpd\n"
+    << "\ncpd follows first moves from a compressed path database, without\n"
+    << "\tsearch. the database is computed on first use and cached next to\n"
+    << "\tthe map file; --threads also applies to computing it\n";
 }
 
 bool
@@ -93,25 +125,36 @@ check_optimality(warthog::solution& sol, warthog::experiment* exp)
     return true;
 }
 
+// answer every experiment in @param scenmgr. each worker thread runs
+// @param fn_worker to build its own search objects; results are written
+// in the same order as the experiments appear in the scenario file.
 void
-run_experiments(warthog::search* algo, std::string alg_name,
-        warthog::scenario_manager& scenmgr, bool verbose, bool checkopt,
-        std::ostream& out)
+run_experiments(warthog::util::batch_worker_fn& fn_worker,
+        std::string alg_name, warthog::scenario_manager& scenmgr,
+        bool verbose, bool checkopt, std::ostream& out)
 {
+    warthog::util::batch_query_fn fn_query =
+        [&scenmgr, verbose]
+        (warthog::search* algo, uint32_t i, warthog::solution& sol) -> void
+        {
+            warthog::experiment* exp = scenmgr.get_experiment(i);
+
+            int startid = exp->starty() * exp->mapwidth() + exp->startx();
+            int goalid = exp->goaly() * exp->mapwidth() + exp->goalx();
+            warthog::problem_instance pi(startid, goalid, verbose);
+            algo->get_path(pi, sol);
+        };
+
+    warthog::util::batch_query batch(nthreads);
+    batch.set_reclaim_limit((size_t)reclaim_mb * 1024 * 1024);
+    batch.run(scenmgr.num_experiments(), fn_worker, fn_query);
+
 	std::cout 
         << "id\talg\texpanded\tinserted\tupdated\ttouched"
         << "\tnanos\tpcost\tplen\tmap\n";
 	for(unsigned int i=0; i < scenmgr.num_experiments(); i++)
 	{
-		warthog::experiment* exp = scenmgr.get_experiment(i);
-
-		int startid = exp->starty() * exp->mapwidth() + exp->startx();
-		int goalid = exp->goaly() * exp->mapwidth() + exp->goalx();
-        warthog::problem_instance pi(startid, goalid, verbose);
-        warthog::solution sol;
-
-        algo->get_path(pi, sol);
-
+        warthog::solution& sol = batch.get_result(i);
 		out
             << i<<"\t" 
             << alg_name << "\t" 
@@ -125,135 +168,187 @@ run_experiments(warthog::search* algo, std::string alg_name,
             << scenmgr.last_file_loaded() 
             << std::endl;
 
-        if(checkopt) { check_optimality(sol, exp); }
+        if(checkopt) { check_optimality(sol, scenmgr.get_experiment(i)); }
 	}
+
+    batch.print_stats(std::cerr);
+	std::cerr << "done. total memory: "
+        << batch.get_worker_mem() + scenmgr.mem() << "\n";
 }
 
 
+template<class Q>
 void
 run_jpsplus(warthog::scenario_manager& scenmgr, std::string alg_name)
 {
     warthog::gridmap map(scenmgr.get_experiment(0)->map().c_str());
-	warthog::jpsplus_expansion_policy expander(&map);
-	warthog::octile_heuristic heuristic(map.width(), map.height());
-    warthog::pqueue_min open;
 
-	warthog::flexible_astar<
-		warthog::octile_heuristic,
-	   	warthog::jpsplus_expansion_policy,
-        warthog::pqueue_min> 
-            astar(&heuristic, &expander, &open);
+    // build (or load) the jump point database before forking any workers.
+    // the database is saved to disk when first computed; this way the
+    // workers load it from there instead of all writing the same file
+    { warthog::jpsplus_expansion_policy preproc(&map); }
 
-    run_experiments(&astar, alg_name, scenmgr, 
-            verbose, checkopt, std::cout);
+    warthog::util::batch_worker_fn fn_worker = 
+        [&map] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::jpsplus_expansion_policy expander(&map);
+            warthog::octile_heuristic heuristic(map.width(), map.height());
+            Q open;
 
-	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
+            warthog::flexible_astar<
+                warthog::octile_heuristic,
+                warthog::jpsplus_expansion_policy,
+                Q> 
+                    astar(&heuristic, &expander, &open);
+
+            fn_serve(&astar);
+        };
+
+    run_experiments(fn_worker, alg_name, scenmgr, 
+            verbose, checkopt, std::cout);
 }
 
+template<class Q>
 void
 run_jps2plus(warthog::scenario_manager& scenmgr, std::string alg_name)
 {
     warthog::gridmap map(scenmgr.get_experiment(0)->map().c_str());
-	warthog::jps2plus_expansion_policy expander(&map);
-	warthog::octile_heuristic heuristic(map.width(), map.height());
-    warthog::pqueue_min open;
 
-	warthog::flexible_astar<
-		warthog::octile_heuristic,
-	   	warthog::jps2plus_expansion_policy,
-        warthog::pqueue_min> astar(&heuristic, &expander, &open);
+    // build (or load) the jump point database before forking any workers.
+    // the database is saved to disk when first computed; this way the
+    // workers load it from there instead of all writing the same file
+    { warthog::jps2plus_expansion_policy preproc(&map); }
 
-    std::function<void(warthog::search_node*)> relax_fn = 
-            [&](warthog::search_node* n)
-            {
-                expander.update_parent_direction(n);
-            };
-    astar.apply_on_relax(relax_fn);
+    warthog::util::batch_worker_fn fn_worker = 
+        [&map] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::jps2plus_expansion_policy expander(&map);
+            warthog::octile_heuristic heuristic(map.width(), map.height());
+            Q open;
 
-	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
+            warthog::jps2_listener<warthog::jps2plus_expansion_policy> 
+                listener(&expander);
+
+            warthog::flexible_astar<
+                warthog::octile_heuristic,
+                warthog::jps2plus_expansion_policy,
+                Q,
+                warthog::jps2_listener<warthog::jps2plus_expansion_policy>> 
+                    astar(&heuristic, &expander, &open, listener);
+
+            fn_serve(&astar);
+        };
+
+    run_experiments(fn_worker, alg_name, scenmgr, 
+            verbose, checkopt, std::cout);
 }
 
+template<class Q>
 void
 run_jps2(warthog::scenario_manager& scenmgr, std::string alg_name)
 {
     warthog::gridmap map(scenmgr.get_experiment(0)->map().c_str());
-	warthog::jps2_expansion_policy expander(&map);
-	warthog::octile_heuristic heuristic(map.width(), map.height());
-    warthog::pqueue_min open;
 
-	warthog::flexible_astar<
-		warthog::octile_heuristic,
-	   	warthog::jps2_expansion_policy,
-        warthog::pqueue_min> 
-            astar(&heuristic, &expander, &open);
+    warthog::util::batch_worker_fn fn_worker = 
+        [&map] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::jps2_expansion_policy expander(&map);
+            warthog::octile_heuristic heuristic(map.width(), map.height());
+            Q open;
 
-    std::function<void(warthog::search_node*)> relax_fn = 
-            [&](warthog::search_node* n)
-            {
-                expander.update_parent_direction(n);
-            };
-    astar.apply_on_relax(relax_fn);
+            warthog::jps2_listener<warthog::jps2_expansion_policy> 
+                listener(&expander);
+
+            warthog::flexible_astar<
+                warthog::octile_heuristic,
+                warthog::jps2_expansion_policy,
+                Q,
+                warthog::jps2_listener<warthog::jps2_expansion_policy>> 
+                    astar(&heuristic, &expander, &open, listener);
+
+            fn_serve(&astar);
+        };
 
-    run_experiments(&astar, alg_name, scenmgr, 
+    run_experiments(fn_worker, alg_name, scenmgr, 
             verbose, checkopt, std::cout);
-	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
+template<class Q>
 void
 run_jps(warthog::scenario_manager& scenmgr, std::string alg_name)
 {
     warthog::gridmap map(scenmgr.get_experiment(0)->map().c_str());
-	warthog::jps_expansion_policy expander(&map);
-	warthog::octile_heuristic heuristic(map.width(), map.height());
-    warthog::pqueue_min open;
 
-	warthog::flexible_astar<
-		warthog::octile_heuristic,
-	   	warthog::jps_expansion_policy,
-        warthog::pqueue_min> 
-            astar(&heuristic, &expander, &open);
+    warthog::util::batch_worker_fn fn_worker = 
+        [&map] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::jps_expansion_policy expander(&map);
+            warthog::octile_heuristic heuristic(map.width(), map.height());
+            Q open;
 
-    run_experiments(&astar, alg_name, scenmgr, 
+            warthog::flexible_astar<
+                warthog::octile_heuristic,
+                warthog::jps_expansion_policy,
+                Q> 
+                    astar(&heuristic, &expander, &open);
+
+            fn_serve(&astar);
+        };
+
+    run_experiments(fn_worker, alg_name, scenmgr, 
             verbose, checkopt, std::cout);
-	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
+template<class Q>
 void
 run_astar(warthog::scenario_manager& scenmgr, std::string alg_name)
 {
     warthog::gridmap map(scenmgr.get_experiment(0)->map().c_str());
-	warthog::gridmap_expansion_policy expander(&map);
-	warthog::octile_heuristic heuristic(map.width(), map.height());
-    warthog::pqueue_min open;
 
-	warthog::flexible_astar<
-		warthog::octile_heuristic,
-	   	warthog::gridmap_expansion_policy, 
-        warthog::pqueue_min> 
-            astar(&heuristic, &expander, &open);
+    warthog::util::batch_worker_fn fn_worker = 
+        [&map] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::gridmap_expansion_policy expander(&map);
+            warthog::octile_heuristic heuristic(map.width(), map.height());
+            Q open;
+
+            warthog::flexible_astar<
+                warthog::octile_heuristic,
+                warthog::gridmap_expansion_policy,
+                Q> 
+                    astar(&heuristic, &expander, &open);
 
-    run_experiments(&astar, alg_name, scenmgr, 
+            fn_serve(&astar);
+        };
+
+    run_experiments(fn_worker, alg_name, scenmgr, 
             verbose, checkopt, std::cout);
-	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
+template<class Q>
 void
 run_fc_astar(warthog::scenario_manager& scenmgr, std::string alg_name)
 {
     warthog::gridmap map(scenmgr.get_experiment(0)->map().c_str());
-	warthog::gridmap_expansion_policy expander(&map, true);
-	warthog::manhattan_heuristic heuristic(map.width(), map.height());
-    warthog::pqueue_min open;
 
-	warthog::flexible_astar<
-		warthog::manhattan_heuristic,
-	   	warthog::gridmap_expansion_policy, 
-        warthog::pqueue_min> 
-            astar(&heuristic, &expander, &open);
+    warthog::util::batch_worker_fn fn_worker = 
+        [&map] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::gridmap_expansion_policy expander(&map, true);
+            warthog::manhattan_heuristic heuristic(map.width(), map.height());
+            Q open;
+
+            warthog::flexible_astar<
+                warthog::manhattan_heuristic,
+                warthog::gridmap_expansion_policy,
+                Q> 
+                    astar(&heuristic, &expander, &open);
 
-    run_experiments(&astar, alg_name, scenmgr, 
+            fn_serve(&astar);
+        };
+
+    run_experiments(fn_worker, alg_name, scenmgr, 
             verbose, checkopt, std::cout);
-	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
 void
@@ -263,8 +358,23 @@ run_cbs_ll(warthog::scenario_manager& scenmgr, std::string alg_name)
 	warthog::cbs_ll_heuristic heuristic;
 	warthog::cbs_ll_expansion_policy expander(&gm, &heuristic);
 
-    warthog::reservation_table restab(gm.width()*gm.height());
-    warthog::cbs::cmp_cbs_ll_lessthan lessthan(&restab);
+    // tie-breaking reservations come from a dense or a sparse table;
+    // only the one selected is built
+    std::shared_ptr<warthog::reservation_table> restab;
+    std::shared_ptr<warthog::sparse_reservation_table> sparse_restab;
+    if(restab_type == "sparse")
+    {
+        sparse_restab.reset(
+                new warthog::sparse_reservation_table(gm.width()*gm.height()));
+    }
+    else
+    {
+        restab.reset(new warthog::reservation_table(gm.width()*gm.height()));
+    }
+    warthog::cbs::cmp_cbs_ll_lessthan lessthan = 
+        sparse_restab 
+        ? warthog::cbs::cmp_cbs_ll_lessthan(sparse_restab.get())
+        : warthog::cbs::cmp_cbs_ll_lessthan(restab.get());
     warthog::cbs::pqueue_cbs_ll open(&lessthan);
 
 	warthog::flexible_astar<
@@ -317,6 +427,22 @@ run_tx_astar(warthog::scenario_manager& scenmgr, std::string alg_name)
 	warthog::txevl_gridmap_expansion_policy expander(&gm, &heuristic);
     warthog::pqueue_min open;
 
+    // successors reserved by other agents are blocked; only the 
+    // selected table is built
+    std::shared_ptr<warthog::reservation_table> restab;
+    std::shared_ptr<warthog::sparse_reservation_table> sparse_restab;
+    if(restab_type == "sparse") 
+    { 
+        sparse_restab.reset(
+                new warthog::sparse_reservation_table(gm.width()*gm.height()));
+        expander.set_reservation_table(sparse_restab.get()); 
+    }
+    else 
+    { 
+        restab.reset(new warthog::reservation_table(gm.width()*gm.height()));
+        expander.set_reservation_table(restab.get()); 
+    }
+
 
 	warthog::flexible_astar<
 		warthog::cbs_ll_heuristic,
@@ -445,236 +571,314 @@ run_tx_astar(warthog::scenario_manager& scenmgr, std::string alg_name)
 //	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 //}
 
+template<class Q>
 void
 run_dijkstra(warthog::scenario_manager& scenmgr, std::string alg_name)
 {
     warthog::gridmap map(scenmgr.get_experiment(0)->map().c_str());
-	warthog::gridmap_expansion_policy expander(&map);
-	warthog::zero_heuristic heuristic;
-    warthog::pqueue_min open;
 
-	warthog::flexible_astar<
-		warthog::zero_heuristic,
-	   	warthog::gridmap_expansion_policy,
-        warthog::pqueue_min> 
-            astar(&heuristic, &expander, &open);
+    warthog::util::batch_worker_fn fn_worker = 
+        [&map] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::gridmap_expansion_policy expander(&map);
+            warthog::zero_heuristic heuristic;
+            Q open;
+
+            warthog::flexible_astar<
+                warthog::zero_heuristic,
+                warthog::gridmap_expansion_policy,
+                Q> 
+                    astar(&heuristic, &expander, &open);
 
-    run_experiments(&astar, alg_name, scenmgr, 
+            fn_serve(&astar);
+        };
+
+    run_experiments(fn_worker, alg_name, scenmgr, 
             verbose, checkopt, std::cout);
-	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
+template<class Q>
 void
 run_wgm_astar(warthog::scenario_manager& scenmgr, std::string alg_name)
 {
     warthog::vl_gridmap map(scenmgr.get_experiment(0)->map().c_str());
-	warthog::vl_gridmap_expansion_policy expander(&map);
-	warthog::octile_heuristic heuristic(map.width(), map.height());
-    warthog::pqueue_min open;
-    
-    // cheapest terrain (movingai benchmarks) has ascii value '.'; we scale
-    // all heuristic values accordingly (otherwise the heuristic doesn't 
-    // impact f-values much and search starts to behave like dijkstra)
-    heuristic.set_hscale('.');
 
-	warthog::flexible_astar<
-		warthog::octile_heuristic,
-	   	warthog::vl_gridmap_expansion_policy,
-        warthog::pqueue_min> 
-            astar(&heuristic, &expander, &open);
-
-    run_experiments(&astar, alg_name, scenmgr, 
+    warthog::util::batch_worker_fn fn_worker = 
+        [&map] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::vl_gridmap_expansion_policy expander(&map);
+            warthog::octile_heuristic heuristic(map.width(), map.height());
+            Q open;
+
+            // cheapest terrain (movingai benchmarks) has ascii value '.'; we
+            // scale all heuristic values accordingly (otherwise the 
+            // heuristic doesn't impact f-values much and search starts to
+            // behave like dijkstra)
+            heuristic.set_hscale('.');
+
+            warthog::flexible_astar<
+                warthog::octile_heuristic,
+                warthog::vl_gridmap_expansion_policy,
+                Q> 
+                    astar(&heuristic, &expander, &open);
+
+            fn_serve(&astar);
+        };
+
+    run_experiments(fn_worker, alg_name, scenmgr, 
             verbose, checkopt, std::cout);
-	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
+template<class Q>
 void
 run_wgm_sssp(warthog::scenario_manager& scenmgr, std::string alg_name)
 {
     warthog::vl_gridmap map(scenmgr.get_experiment(0)->map().c_str());
-	warthog::vl_gridmap_expansion_policy expander(&map);
-	warthog::zero_heuristic heuristic;
-    warthog::pqueue_min open;
 
-	warthog::flexible_astar<
-		warthog::zero_heuristic,
-	   	warthog::vl_gridmap_expansion_policy,
-        warthog::pqueue_min> 
-            astar(&heuristic, &expander, &open);
+    warthog::util::batch_worker_fn fn_worker = 
+        [&map] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::vl_gridmap_expansion_policy expander(&map);
+            warthog::zero_heuristic heuristic;
+            Q open;
 
-    run_experiments(&astar, alg_name, scenmgr, 
+            warthog::flexible_astar<
+                warthog::zero_heuristic,
+                warthog::vl_gridmap_expansion_policy,
+                Q> 
+                    astar(&heuristic, &expander, &open);
+
+            fn_serve(&astar);
+        };
+
+    run_experiments(fn_worker, alg_name, scenmgr, 
             verbose, checkopt, std::cout);
-	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
+template<class Q>
 void
 run_sssp(warthog::scenario_manager& scenmgr, std::string alg_name)
 {
     warthog::gridmap map(scenmgr.get_experiment(0)->map().c_str());
-	warthog::gridmap_expansion_policy expander(&map);
-	warthog::zero_heuristic heuristic;
-    warthog::pqueue_min open;
 
-	warthog::flexible_astar<
-		warthog::zero_heuristic,
-	   	warthog::gridmap_expansion_policy, 
-        warthog::pqueue_min> 
-            astar(&heuristic, &expander, &open);
+    warthog::util::batch_worker_fn fn_worker = 
+        [&map] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::gridmap_expansion_policy expander(&map);
+            warthog::zero_heuristic heuristic;
+            Q open;
 
-    run_experiments(&astar, alg_name, scenmgr, 
+            warthog::flexible_astar<
+                warthog::zero_heuristic,
+                warthog::gridmap_expansion_policy,
+                Q> 
+                    astar(&heuristic, &expander, &open);
+
+            fn_serve(&astar);
+        };
+
+    run_experiments(fn_worker, alg_name, scenmgr, 
             verbose, checkopt, std::cout);
-	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
+template<class Q>
 void
 run_jps_wgm(warthog::scenario_manager& scenmgr, std::string alg_name)
 {
     warthog::vl_gridmap map(scenmgr.get_experiment(0)->map().c_str());
-	warthog::jps_expansion_policy_wgm expander(&map);
-	warthog::octile_heuristic heuristic(map.width(), map.height());
-    warthog::pqueue_min open;
-    // cheapest terrain (movingai benchmarks) has ascii value '.'; we scale
-    // all heuristic values accordingly (otherwise the heuristic doesn't 
-    // impact f-values much and search starts to behave like dijkstra)
-    heuristic.set_hscale('.');  
 
-	warthog::flexible_astar<
-		warthog::octile_heuristic,
-	   	warthog::jps_expansion_policy_wgm,
-        warthog::pqueue_min> astar(&heuristic, &expander, &open);
-
-    run_experiments(&astar, alg_name, scenmgr, 
+    warthog::util::batch_worker_fn fn_worker = 
+        [&map] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::jps_expansion_policy_wgm expander(&map);
+            warthog::octile_heuristic heuristic(map.width(), map.height());
+            Q open;
+
+            // cheapest terrain (movingai benchmarks) has ascii value '.'; we
+            // scale all heuristic values accordingly (otherwise the 
+            // heuristic doesn't impact f-values much and search starts to
+            // behave like dijkstra)
+            heuristic.set_hscale('.');
+
+            warthog::flexible_astar<
+                warthog::octile_heuristic,
+                warthog::jps_expansion_policy_wgm,
+                Q> 
+                    astar(&heuristic, &expander, &open);
+
+            fn_serve(&astar);
+        };
+
+    run_experiments(fn_worker, alg_name, scenmgr, 
             verbose, checkopt, std::cout);
-	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
+template<class Q>
 void
 run_jpg(warthog::scenario_manager& scenmgr, std::string alg_name)
 {
     std::shared_ptr<warthog::gridmap> map(
             new warthog::gridmap(scenmgr.get_experiment(0)->map().c_str()));
-    std::shared_ptr<warthog::graph::corner_point_graph> cpg(
-            new warthog::graph::corner_point_graph(map));
-	warthog::octile_heuristic heuristic(map->width(), map->height());
-	warthog::jps::jpg_expansion_policy expander(cpg.get());
-    warthog::pqueue_min open;
-
-	warthog::flexible_astar<
-		warthog::octile_heuristic,
-	   	warthog::jps::jpg_expansion_policy,
-        warthog::pqueue_min> 
-            astar(&heuristic, &expander, &open);
 
-    run_experiments(&astar, alg_name, scenmgr, 
+    // start and target are inserted into the corner point graph for 
+    // every query, so each worker needs a graph of its own
+    warthog::util::batch_worker_fn fn_worker = 
+        [&map] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            std::shared_ptr<warthog::graph::corner_point_graph> cpg(
+                    new warthog::graph::corner_point_graph(map));
+            warthog::octile_heuristic heuristic(map->width(), map->height());
+            warthog::jps::jpg_expansion_policy expander(cpg.get());
+            Q open;
+
+            warthog::flexible_astar<
+                warthog::octile_heuristic,
+                warthog::jps::jpg_expansion_policy,
+                Q> 
+                    astar(&heuristic, &expander, &open);
+
+            fn_serve(&astar);
+        };
+
+    run_experiments(fn_worker, alg_name, scenmgr, 
             verbose, checkopt, std::cout);
-	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
+template<class Q>
 void
 run_cpg(warthog::scenario_manager& scenmgr, std::string alg_name)
 {
     std::shared_ptr<warthog::gridmap> map(
             new warthog::gridmap(scenmgr.get_experiment(0)->map().c_str()));
-    std::shared_ptr<warthog::graph::corner_point_graph> cpg(
-            new warthog::graph::corner_point_graph(map));
-	warthog::cpg_expansion_policy expander(cpg.get());
-	warthog::octile_heuristic heuristic(map->width(), map->height());
-    warthog::pqueue_min open;
 
-	warthog::flexible_astar<
-		warthog::octile_heuristic,
-	   	warthog::cpg_expansion_policy,
-        warthog::pqueue_min>
-            astar(&heuristic, &expander, &open);
-
-    run_experiments(&astar, alg_name, scenmgr, 
+    // start and target are inserted into the corner point graph for 
+    // every query, so each worker needs a graph of its own
+    warthog::util::batch_worker_fn fn_worker = 
+        [&map] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            std::shared_ptr<warthog::graph::corner_point_graph> cpg(
+                    new warthog::graph::corner_point_graph(map));
+            warthog::octile_heuristic heuristic(map->width(), map->height());
+            warthog::cpg_expansion_policy expander(cpg.get());
+            Q open;
+
+            warthog::flexible_astar<
+                warthog::octile_heuristic,
+                warthog::cpg_expansion_policy,
+                Q> 
+                    astar(&heuristic, &expander, &open);
+
+            fn_serve(&astar);
+        };
+
+    run_experiments(fn_worker, alg_name, scenmgr, 
             verbose, checkopt, std::cout);
-	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
-int 
-main(int argc, char** argv)
+// answer each query by following first moves from a compressed path 
+// database. the grid is converted to a graph; the first-move table for 
+// its map is computed on first use and cached next to the map file
+void
+run_cpd(warthog::scenario_manager& scenmgr, std::string alg_name)
 {
-	// parse arguments
-	warthog::util::param valid_args[] = 
-	{
-		{"scen",  required_argument, 0, 0},
-		{"alg",  required_argument, 0, 1},
-		{"gen", required_argument, 0, 3},
-		{"help", no_argument, &print_help, 1},
-		{"checkopt",  no_argument, &checkopt, 1},
-		{"verbose",  no_argument, &verbose, 1},
-		{"format",  required_argument, 0, 1},
-	};
-
-	warthog::util::cfg cfg;
-	cfg.parse_args(argc, argv, "-f", valid_args);
+    std::string map_file = scenmgr.get_experiment(0)->map();
+    warthog::gridmap gm(map_file.c_str());
+    warthog::graph::xy_graph g;
+    g.load_from_grid(&gm, false);
+
+    std::string table_file = map_file + "." + alg_name + ".fmt";
+    warthog::label::firstmove_table* lab =
+        warthog::label::firstmove_table::load(table_file.c_str());
+    if(lab == 0)
+    {
+        std::vector<uint32_t> column_order;
+        warthog::label::compute_fm_dfs_preorder(g, column_order);
 
-    if(argc == 1 || print_help)
+        warthog::util::workload_manager workload(g.get_num_nodes());
+        workload.set_all_flags(true);
+        std::function<warthog::graph_expansion_policy<>*(void)> 
+            fn_new_expander = [&g]() -> warthog::graph_expansion_policy<>*
+            {
+                return new warthog::graph_expansion_policy<>(&g);
+            };
+        warthog::label::firstmove_labelling* rows = 
+            warthog::label::firstmove_labelling::compute
+            <warthog::graph_expansion_policy<>>
+                (&g, &column_order, fn_new_expander, &workload);
+        bool saved = warthog::label::firstmove_table::save(
+                table_file.c_str(), *rows, column_order);
+        delete rows;
+        if(!saved) { return; }
+
+        lab = warthog::label::firstmove_table::load(table_file.c_str());
+        if(lab == 0) { return; }
+    }
+    if(lab->get_num_nodes() != g.get_num_nodes())
     {
-		help();
-        exit(0);
+        std::cerr << "err; firstmove table has " << lab->get_num_nodes()
+            << " nodes but the grid has " << g.get_num_nodes() 
+            << " traversable cells; delete " << table_file << "\n";
+        delete lab;
+        return;
     }
 
-    std::string sfile = cfg.get_param_value("scen");
-    std::string alg = cfg.get_param_value("alg");
-    std::string gen = cfg.get_param_value("gen");
-
-	if(gen != "")
-	{
-		warthog::scenario_manager sm;
-		warthog::gridmap gm(gen.c_str());
-		sm.generate_experiments(&gm, 1000) ;
-		sm.write_scenario(std::cout);
-        exit(0);
-	}
-
-	if(alg == "" || sfile == "")
-	{
-        std::cerr << "Err. Must specify a scenario file and search algorithm. Try --help for options.\n";
-		exit(0);
-	}
-
-	warthog::scenario_manager scenmgr;
-	scenmgr.load_scenario(sfile.c_str());
+    // graph edge weights are grid costs scaled up to integers
+    warthog::util::batch_worker_fn fn_worker = 
+        [&g, lab] (warthog::util::batch_serve_fn& fn_serve) -> void
+        {
+            warthog::cpd_search alg(&g, lab, 
+                    warthog::graph::GRID_TO_GRAPH_SCALE_FACTOR);
+            if(cpd_moves) { alg.set_max_moves(cpd_moves); }
+            fn_serve(&alg);
+        };
+
+    run_experiments(fn_worker, alg_name, scenmgr, 
+            verbose, checkopt, std::cout);
+    delete lab;
+}
 
+// run algorithm @param alg using an open list of type Q
+template<class Q>
+void
+run_alg(warthog::scenario_manager& scenmgr, std::string alg)
+{
     if(alg == "jps+")
     {
-        run_jpsplus(scenmgr, alg);
+        run_jpsplus<Q>(scenmgr, alg);
     }
 
     else if(alg == "jps2")
     {
-        run_jps2(scenmgr, alg);
+        run_jps2<Q>(scenmgr, alg);
     }
 
     else if(alg == "jps2+")
     {
-        run_jps2plus(scenmgr, alg);
+        run_jps2plus<Q>(scenmgr, alg);
     }
 
     else if(alg == "jps")
     {
-        run_jps(scenmgr, alg);
+        run_jps<Q>(scenmgr, alg);
     }
 
     else if(alg == "jps_wgm")
     {
-        run_jps_wgm(scenmgr, alg);
+        run_jps_wgm<Q>(scenmgr, alg);
     }
 
     else if(alg == "dijkstra")
     {
-        run_dijkstra(scenmgr, alg); 
+        run_dijkstra<Q>(scenmgr, alg); 
     }
 
     else if(alg == "astar")
     {
-        run_astar(scenmgr, alg); 
+        run_astar<Q>(scenmgr, alg); 
     }
     else if(alg == "fc_astar")
     {
-        run_fc_astar(scenmgr, alg); 
+        run_fc_astar<Q>(scenmgr, alg); 
     }
 
     else if(alg == "cbs_ll")
@@ -688,25 +892,29 @@ main(int argc, char** argv)
 
     else if(alg == "astar_wgm")
     {
-        run_wgm_astar(scenmgr, alg); 
+        run_wgm_astar<Q>(scenmgr, alg); 
     }
 
     else if(alg == "sssp")
     {
-        run_sssp(scenmgr, alg);
+        run_sssp<Q>(scenmgr, alg);
     }
 
     else if(alg == "sssp")
     {
-        run_wgm_sssp(scenmgr, alg); 
+        run_wgm_sssp<Q>(scenmgr, alg); 
     }
     else if(alg == "jpg")
     {
-        run_jpg(scenmgr, alg);
+        run_jpg<Q>(scenmgr, alg);
     }
     else if(alg == "cpg")
     {
-        run_cpg(scenmgr, alg);
+        run_cpg<Q>(scenmgr, alg);
+    }
+    else if(alg == "cpd")
+    {
+        run_cpd(scenmgr, alg);
     }
     else
     {
@@ -714,4 +922,110 @@ main(int argc, char** argv)
     }
 }
 
+int 
+main(int argc, char** argv)
+{
+	// parse arguments
+	warthog::util::param valid_args[] = 
+	{
+		{"scen",  required_argument, 0, 0},
+		{"alg",  required_argument, 0, 1},
+		{"gen", required_argument, 0, 3},
+		{"help", no_argument, &print_help, 1},
+		{"checkopt",  no_argument, &checkopt, 1},
+		{"verbose",  no_argument, &verbose, 1},
+		{"format",  required_argument, 0, 1},
+		{"threads",  required_argument, 0, 1},
+		{"queue",  required_argument, 0, 1},
+		{"reclaim",  required_argument, 0, 1},
+		{"moves",  required_argument, 0, 1},
+		{"restab",  required_argument, 0, 1},
+	};
+
+	warthog::util::cfg cfg;
+	cfg.parse_args(argc, argv, "-f", valid_args);
+
+    if(argc == 1 || print_help)
+    {
+		help();
+        exit(0);
+    }
+
+    std::string sfile = cfg.get_param_value("scen");
+    std::string alg = cfg.get_param_value("alg");
+    std::string gen = cfg.get_param_value("gen");
+    std::string par_threads = cfg.get_param_value("threads");
+    std::string par_queue = cfg.get_param_value("queue");
+    std::string par_reclaim = cfg.get_param_value("reclaim");
+    std::string par_moves = cfg.get_param_value("moves");
+    std::string par_restab = cfg.get_param_value("restab");
+
+    if(par_threads != "")
+    {
+        char* end;
+        nthreads = strtol(par_threads.c_str(), &end, 10);
+
+        // also used when computing first-move labels (for cpd)
+        warthog::helpers::set_parallel_threads(nthreads);
+    }
+    if(par_queue != "") { queue_type = par_queue; }
+    if(par_restab != "") 
+    { 
+        restab_type = par_restab; 
+        if(restab_type != "dense" && restab_type != "sparse")
+        {
+            std::cerr << "err; invalid reservation table type: " 
+                << restab_type << "\n";
+            exit(1);
+        }
+    }
+    if(par_reclaim != "")
+    {
+        char* end;
+        reclaim_mb = strtol(par_reclaim.c_str(), &end, 10);
+    }
+    if(par_moves != "")
+    {
+        char* end;
+        cpd_moves = strtol(par_moves.c_str(), &end, 10);
+    }
+
+	if(gen != "")
+	{
+		warthog::scenario_manager sm;
+		warthog::gridmap gm(gen.c_str());
+		sm.generate_experiments(&gm, 1000) ;
+		sm.write_scenario(std::cout);
+        exit(0);
+	}
+
+	if(alg == "" || sfile == "")
+	{
+        std::cerr << "Err. Must specify a scenario file and search algorithm. Try --help for options.\n";
+		exit(0);
+	}
+
+	warthog::scenario_manager scenmgr;
+	scenmgr.load_scenario(sfile.c_str());
+
+    // grid costs are not integers, so only the queues that order nodes
+    // exactly by f are offered here (see roadhog for the others)
+    if(queue_type == "binary")
+    {
+        run_alg<warthog::pqueue_min>(scenmgr, alg);
+    }
+    else if(queue_type == "dary")
+    {
+        run_alg<warthog::kway_pqueue_min>(scenmgr, alg);
+    }
+    else if(queue_type == "mlb")
+    {
+        run_alg<warthog::multilevel_bucket_queue<>>(scenmgr, alg);
+    }
+    else
+    {
+        std::cerr << "err; invalid queue type: " << queue_type << "\n";
+    }
+}
+
 
@@ -0,0 +1,253 @@
+#ifndef WARTHOG_BIDIRECTIONAL_PARALLEL_H
+#define WARTHOG_BIDIRECTIONAL_PARALLEL_H
+
+// search/bidirectional_parallel.h
+//
+// Support for bidirectional searches whose forward and backward
+// directions run at the same time, on two threads (see the parallel
+// mode of warthog::bidirectional_search and warthog::bch_search).
+//
+// Each direction keeps its own open list, expansion policy and node
+// pool; nothing in them is touched by the other thread. What the two
+// directions share is:
+//  - a meeting_labels table per direction, to which a direction
+//    publishes the g-value of every node it labels or relabels;
+//  - a bidirectional_meeting, which holds the best solution found so
+//    far (updated atomically) and the current f-value at the top of
+//    each open list (the termination bound of each direction).
+//
+// Every time a direction writes a label for node n it reads the label
+// of n in the other direction and, if there is one, offers the path
+// through n as a solution. Labels are published and read with
+// sequentially consistent atomics, so when both directions label the
+// same node at the same time at least one of them sees the other.
+//
+
+#include "constants.h"
+#include "problem_instance.h"
+#include "search_node.h"
+#include "solution.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <mutex>
+
+namespace warthog
+{
+
+// the g-values published by one direction during the current search.
+// entries of earlier searches are told apart by a search stamp, so
+// starting a new search takes constant time
+class meeting_labels
+{
+    public:
+        meeting_labels(uint32_t num_nodes)
+            : num_nodes_(num_nodes), stamp_(0)
+        {
+            labels_ = new label[num_nodes_];
+            clear();
+        }
+
+        ~meeting_labels() { delete [] labels_; }
+
+        // forget every label of the previous search
+        inline void
+        reset()
+        {
+            if(++stamp_ == 0) { clear(); stamp_ = 1; }
+        }
+
+        inline void
+        set(uint32_t node_id, double g)
+        {
+            assert(node_id < num_nodes_);
+            labels_[node_id].g_.store(g);
+            labels_[node_id].stamp_.store(stamp_);
+        }
+
+        // @return the last g-value published for @param node_id in the
+        // current search, or warthog::INF if there is none
+        inline double
+        get(uint32_t node_id)
+        {
+            assert(node_id < num_nodes_);
+            if(labels_[node_id].stamp_.load() != stamp_)
+            { return warthog::INF; }
+            return labels_[node_id].g_.load();
+        }
+
+        size_t
+        mem() { return sizeof(*this) + sizeof(label) * num_nodes_; }
+
+    private:
+        struct label
+        {
+            std::atomic<uint32_t> stamp_;
+            std::atomic<double> g_;
+        };
+
+        uint32_t num_nodes_;
+        uint32_t stamp_;
+        label* labels_;
+
+        void
+        clear()
+        {
+            for(uint32_t i = 0; i < num_nodes_; i++)
+            {
+                labels_[i].stamp_.store(0);
+                labels_[i].g_.store(warthog::INF);
+            }
+        }
+
+        // no copy
+        meeting_labels(const meeting_labels& other) { }
+        meeting_labels& operator=(const meeting_labels& other)
+        { return *this; }
+};
+
+// the state shared by the two directions of a search
+class bidirectional_meeting
+{
+    public:
+        bidirectional_meeting() { reset(); }
+
+        inline void
+        reset()
+        {
+            best_cost_.store(warthog::INF);
+            meet_id_ = warthog::NODE_NONE;
+            bound_[0].store(0);
+            bound_[1].store(0);
+            stop_.store(false);
+        }
+
+        // a path of cost @param cost passes through node @param node_id.
+        // keep it if it improves the best solution so far
+        inline void
+        offer(uint32_t node_id, double cost)
+        {
+            if(cost >= best_cost_.load()) { return; }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(cost < best_cost_.load())
+            {
+                best_cost_.store(cost);
+                meet_id_ = node_id;
+            }
+        }
+
+        inline double
+        get_best_cost() { return best_cost_.load(); }
+
+        // the node where the best solution meets; NODE_NONE if there is
+        // no solution. read only once both directions are finished
+        inline uint32_t
+        get_meet_id() { return meet_id_; }
+
+        // the f-value at the top of the open list of direction
+        // @param dir (0 = forward, 1 = backward). it only ever grows,
+        // so a stale value is still a lower bound
+        inline double
+        get_bound(uint32_t dir) { return bound_[dir].load(); }
+
+        inline void
+        set_bound(uint32_t dir, double bound) { bound_[dir].store(bound); }
+
+        // tell both directions to finish (e.g. a cutoff was reached)
+        inline void
+        stop() { stop_.store(true); }
+
+        inline bool
+        stopped() { return stop_.load(); }
+
+    private:
+        std::atomic<double> best_cost_;
+        uint32_t meet_id_;
+        std::atomic<double> bound_[2];
+        std::atomic<bool> stop_;
+        std::mutex mutex_;
+};
+
+// publish the label @param g of node @param n to @param mine, the labels
+// of its own direction, and look for a meeting with the other direction
+inline void
+bidirectional_publish(warthog::search_node* n, double g,
+        warthog::meeting_labels* mine, warthog::meeting_labels* theirs,
+        warthog::bidirectional_meeting* meet)
+{
+    mine->set(n->get_id(), g);
+    double other_g = theirs->get(n->get_id());
+    if(other_g != warthog::INF) { meet->offer(n->get_id(), g + other_g); }
+}
+
+// run one direction of a parallel bidirectional search: expand nodes
+// from @param open, the open list of direction @param dir, until
+//  - the open list is empty, or
+//  - the f-value at its top (plus, if @param sum_bounds, the top of the
+//    other direction) is no better than the best solution, or
+//  - a cutoff is reached or the other direction says to stop.
+// @param open holds only the root of the direction when called.
+// @param h_target is the node whose distance @param heuristic estimates
+template<class H, class E, class Q>
+void
+bidirectional_parallel_direction(uint32_t dir, Q* open, E* expander,
+        H* heuristic, uint32_t h_target, warthog::problem_instance* pi,
+        warthog::meeting_labels* mine, warthog::meeting_labels* theirs,
+        warthog::bidirectional_meeting* meet, bool sum_bounds,
+        double cost_cutoff, uint32_t exp_cutoff, warthog::solution& sol)
+{
+    while(open->size())
+    {
+        warthog::search_node* current = open->peek();
+        double top = current->get_f();
+        meet->set_bound(dir, top);
+        double bound = sum_bounds ? top + meet->get_bound(1 - dir) : top;
+        if(bound >= meet->get_best_cost() || meet->stopped()) { break; }
+        if(top > cost_cutoff || sol.nodes_expanded_ >= exp_cutoff)
+        {
+            meet->stop();
+            break;
+        }
+
+        open->pop();
+        current->set_expanded(true);
+        expander->expand(current, pi);
+        sol.nodes_expanded_++;
+
+        warthog::search_node* n = 0;
+        double cost_to_n = warthog::INF;
+        for(expander->first(n, cost_to_n);
+                n != 0;
+                expander->next(n, cost_to_n))
+        {
+            sol.nodes_touched_++;
+            double gval = current->get_g() + cost_to_n;
+            if(n->get_search_id() != current->get_search_id())
+            {
+                n->init(current->get_search_id(), current->get_id(), gval,
+                        gval + heuristic->h(n->get_id(), h_target));
+                open->push(n);
+                sol.nodes_inserted_++;
+            }
+            else if(!n->get_expanded() && open->contains(n) &&
+                    gval < n->get_g())
+            {
+                n->relax(gval, current->get_id());
+                open->decrease_key(n);
+                sol.nodes_updated_++;
+            }
+            else { continue; }
+            bidirectional_publish(n, gval, mine, theirs, meet);
+        }
+    }
+
+    // either this direction has labelled every node it can reach or
+    // the best solution is optimal already; the other direction can
+    // stop as soon as the sum of bounds says so
+    meet->set_bound(dir, warthog::INF);
+}
+
+}
+
+#endif
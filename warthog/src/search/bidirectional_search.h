@@ -6,12 +6,19 @@
 // A customisable variant of bidirectional best-first search.
 // Users can pass in any heuristic and any (domain-specific) expansion policy.
 //
+// In parallel mode (see ::set_parallel) the backward search runs on a
+// helper thread at the same time as the forward search; the two only
+// share their labels, the best solution so far and the f-values at the
+// top of their open lists (see search/bidirectional_parallel.h).
+//
 // @author: dharabor
 // @created: 2016-02-14
 //
 
+#include "bidirectional_parallel.h"
 #include "constants.h"
 #include "graph_expansion_policy.h"
+#include "helper_thread.h"
 #include "xy_graph.h"
 #include "pqueue.h"
 #include "search.h"
@@ -52,12 +59,21 @@ class bidirectional_search : public warthog::search
 
             exp_cutoff_ = warthog::INF;
             cost_cutoff_ = warthog::INF;
+
+            parallel_ = false;
+            flabels_ = blabels_ = 0;
+            meet_ = 0;
+            helper_ = 0;
         }
 
         ~bidirectional_search()
         {
             delete fopen_;
             delete bopen_;
+            delete helper_;
+            delete flabels_;
+            delete blabels_;
+            delete meet_;
         }
 
         virtual void
@@ -111,6 +127,24 @@ class bidirectional_search : public warthog::search
         inline uint32_t
         get_max_expansions_cutoff() { return exp_cutoff_; }
 
+        // run the forward and backward searches on two threads
+        // at the same time? (default: no)
+        void
+        set_parallel(bool parallel)
+        {
+            parallel_ = parallel;
+            if(!parallel_ || helper_) { return; }
+            helper_ = new warthog::util::helper_thread();
+            flabels_ = new warthog::meeting_labels(
+                    fexpander_->get_nodes_pool_size());
+            blabels_ = new warthog::meeting_labels(
+                    bexpander_->get_nodes_pool_size());
+            meet_ = new warthog::bidirectional_meeting();
+        }
+
+        inline bool
+        get_parallel() { return parallel_; }
+
         warthog::search_node*
         get_search_node(uint32_t id, int direction=0)
         {
@@ -125,7 +159,8 @@ class bidirectional_search : public warthog::search
             return sizeof(*this) +
                 fopen_->mem() +
                 bopen_->mem() +
-                fexpander_->mem();
+                (flabels_ ? flabels_->mem() + blabels_->mem() : 0) +
+                fexpander_->mem() +
                 bexpander_->mem();
         }
 
@@ -138,6 +173,13 @@ class bidirectional_search : public warthog::search
         H* heuristic_;
         bool dijkstra_;
 
+        // parallel mode
+        bool parallel_;
+        warthog::meeting_labels* flabels_;
+        warthog::meeting_labels* blabels_;
+        warthog::bidirectional_meeting* meet_;
+        warthog::util::helper_thread* helper_;
+
         // early termination limits
         double cost_cutoff_;
         uint32_t exp_cutoff_;
@@ -194,6 +236,12 @@ class bidirectional_search : public warthog::search
         void
         search(warthog::solution& sol)
         {
+            if(parallel_)
+            {
+                search_parallel(sol);
+                return;
+            }
+
             warthog::timer mytimer;
             mytimer.start();
 
@@ -326,6 +374,69 @@ class bidirectional_search : public warthog::search
 
             assert(best_cost_ == warthog::INF || (v_ && w_));
         }
+        // as ::search, but the backward search runs on the helper thread.
+        // with a zero heuristic, a direction stops once the sum of the 
+        // g-values at the top of both open lists is no better than the 
+        // best solution. otherwise it stops once the f-value at the top 
+        // of its own open list is no better.
+        void
+        search_parallel(warthog::solution& sol)
+        {
+            warthog::timer mytimer;
+            mytimer.start();
+
+            best_cost_ = warthog::INF;
+            v_ = w_ = 0;
+            fopen_->clear();
+            bopen_->clear();
+            flabels_->reset();
+            blabels_->reset();
+            meet_->reset();
+
+            warthog::search_node *start, *target;
+            start = fexpander_->generate_start_node(&pi_);
+            target = bexpander_->generate_target_node(&pi_);
+            start->init(pi_.instance_id_, warthog::NODE_NONE,
+                    0, heuristic_->h(start->get_id(), target->get_id()));
+            target->init(pi_.instance_id_, warthog::NODE_NONE,
+                    0, heuristic_->h(start->get_id(), target->get_id()));
+            fopen_->push(start);
+            bopen_->push(target);
+            pi_.start_id_ = start->get_id();
+            pi_.target_id_ = target->get_id();
+            warthog::bidirectional_publish(start, 0, flabels_, blabels_, meet_);
+            warthog::bidirectional_publish(target, 0, blabels_, flabels_, meet_);
+
+            warthog::solution bsol;
+            helper_->start([this, &bsol] () -> void
+            {
+                warthog::bidirectional_parallel_direction(1, bopen_,
+                    bexpander_, heuristic_, pi_.start_id_, &pi_, blabels_,
+                    flabels_, meet_, dijkstra_, cost_cutoff_, exp_cutoff_,
+                    bsol);
+            });
+            warthog::bidirectional_parallel_direction(0, fopen_,
+                fexpander_, heuristic_, pi_.target_id_, &pi_, flabels_,
+                blabels_, meet_, dijkstra_, cost_cutoff_, exp_cutoff_, sol);
+            helper_->wait();
+
+            sol.nodes_expanded_ += bsol.nodes_expanded_;
+            sol.nodes_inserted_ += bsol.nodes_inserted_;
+            sol.nodes_updated_ += bsol.nodes_updated_;
+            sol.nodes_touched_ += bsol.nodes_touched_;
+
+            uint32_t meet_id = meet_->get_meet_id();
+            if(meet_id != warthog::NODE_NONE)
+            {
+                best_cost_ = meet_->get_best_cost();
+                v_ = fexpander_->generate(meet_id);
+                w_ = bexpander_->generate(meet_id);
+            }
+
+			mytimer.stop();
+			sol.time_elapsed_nano_ = mytimer.elapsed_time_nano();
+        }
+
 //jj
         void
         expand( warthog::search_node* current,
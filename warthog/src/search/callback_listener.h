@@ -0,0 +1,92 @@
+#ifndef WARTHOG_CALLBACK_LISTENER_H
+#define WARTHOG_CALLBACK_LISTENER_H
+
+// search/callback_listener.h
+//
+// A search listener that forwards events to user-supplied callbacks.
+// Useful for tools (labelling, heuristic precomputation etc) that need
+// to observe a search without writing a dedicated listener type.
+// Each event costs an extra check and an indirect call, so
+// performance-critical code should prefer a dedicated listener.
+//
+
+#include "search_node.h"
+
+#include <cstdint>
+#include <functional>
+
+namespace warthog
+{
+
+class callback_listener
+{
+    public:
+        callback_listener()
+            : on_relax_fn_(0), on_generate_fn_(0), on_expand_fn_(0) { }
+        ~callback_listener() { }
+
+        // apply @param fn every time a node is successfully relaxed
+        inline void
+        apply_on_relax(std::function<void(warthog::search_node*)>& fn)
+        {
+            on_relax_fn_ = &fn;
+        }
+
+        // apply @param fn every time a node is generated (equiv, reached)
+        inline void
+        apply_on_generate(
+                std::function<void(
+                    warthog::search_node* succ,
+                    warthog::search_node* from,
+                    double edge_cost,
+                    uint32_t edge_id)>& fn)
+        {
+            on_generate_fn_ = &fn;
+        }
+
+        // apply @param fn when a node is popped off the open list for
+        // expansion
+        inline void
+        apply_on_expand(std::function<void(warthog::search_node*)>& fn)
+        {
+            on_expand_fn_ = &fn;
+        }
+
+        inline void
+        generate_node(warthog::search_node* succ, warthog::search_node* from,
+                double edge_cost, uint32_t edge_id)
+        {
+            if(on_generate_fn_)
+            { (*on_generate_fn_)(succ, from, edge_cost, edge_id); }
+        }
+
+        inline void
+        expand_node(warthog::search_node* current)
+        {
+            if(on_expand_fn_) { (*on_expand_fn_)(current); }
+        }
+
+        inline void
+        relax_node(warthog::search_node* current)
+        {
+            if(on_relax_fn_) { (*on_relax_fn_)(current); }
+        }
+
+    private:
+        // callback for when a node is relaxed
+        std::function<void(warthog::search_node*)>* on_relax_fn_;
+
+        // callback for when a node is reached / generated
+        std::function<void(
+                warthog::search_node*,
+                warthog::search_node*,
+                double edge_cost,
+                uint32_t edge_id)>* on_generate_fn_;
+
+        // callback for when a node is expanded
+        std::function<void(warthog::search_node*)>* on_expand_fn_;
+};
+
+}
+
+#endif
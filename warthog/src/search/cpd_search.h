@@ -0,0 +1,157 @@
+#ifndef WARTHOG_CPD_SEARCH_H
+#define WARTHOG_CPD_SEARCH_H
+
+// search/cpd_search.h
+//
+// Answers point-to-point queries with a compressed path database (CPD):
+// a warthog::label::firstmove_table that stores, for every pair of nodes,
+// the first edge of an optimal path between them. A query needs no open
+// list and no node pool; it looks up the first move from the start
+// towards the target, follows that edge and repeats until the target is
+// reached. Each lookup is counted as one node expansion.
+//
+// Queries can stop after the first k moves (see ::set_max_moves), so an
+// agent can start moving before the whole path is known; it can later
+// resume from the last node of the prefix. ::next_move extracts a single
+// move at a time.
+//
+// Problem instances use the external ids of the graph (e.g. y*width+x
+// for graphs made by xy_graph::load_from_grid) and so does the returned
+// path. Costs are the edge weights of the graph divided by the cost unit
+// given to the constructor (e.g. GRID_TO_GRAPH_SCALE_FACTOR, to report
+// the costs of a grid map).
+//
+
+#include "constants.h"
+#include "firstmove_table.h"
+#include "problem_instance.h"
+#include "search.h"
+#include "solution.h"
+#include "timer.h"
+#include "xy_graph.h"
+
+#include <cstdint>
+#include <iostream>
+
+namespace warthog
+{
+
+class cpd_search : public warthog::search
+{
+    public:
+        cpd_search(warthog::graph::xy_graph* g,
+                warthog::label::firstmove_table* tab, double cost_unit = 1)
+            : g_(g), tab_(tab), cost_unit_(cost_unit)
+        {
+            assert(g_->get_num_nodes() == tab_->get_num_nodes());
+            max_moves_ = warthog::INF;
+        }
+
+        virtual ~cpd_search() { }
+
+        virtual void
+        get_path(warthog::problem_instance& pi, warthog::solution& sol)
+        {
+            follow(pi, sol, true);
+        }
+
+        // the path cost is only known once the path is extracted, so this
+        // is the same as ::get_path minus the list of nodes
+        virtual void
+        get_distance(warthog::problem_instance& pi, warthog::solution& sol)
+        {
+            follow(pi, sol, false);
+        }
+
+        // stop every query after @param max_moves first moves (default:
+        // warthog::INF, i.e. follow the path to the target). a query that
+        // stops early returns the cost of the prefix it extracted
+        inline void
+        set_max_moves(uint32_t max_moves) { max_moves_ = max_moves; }
+
+        inline uint32_t
+        get_max_moves() { return max_moves_; }
+
+        // the next node on an optimal path from @param node_id to
+        // @param target_id (both internal graph ids) and the cost of
+        // getting there. @return warthog::INF if there is no such node
+        inline uint32_t
+        next_move(uint32_t node_id, uint32_t target_id, double& cost)
+        {
+            uint32_t fm = tab_->get_label(node_id, target_id);
+            if(fm >= FM_NONE) { return warthog::INF; }
+            warthog::graph::edge* e =
+                g_->get_node(node_id)->outgoing_begin() + fm;
+            cost = e->wt_ / cost_unit_;
+            return e->node_id_;
+        }
+
+        virtual size_t
+        mem() { return sizeof(*this); }
+
+    private:
+        warthog::graph::xy_graph* g_;
+        warthog::label::firstmove_table* tab_;
+        double cost_unit_;
+        uint32_t max_moves_;
+
+        void
+        follow(warthog::problem_instance& pi, warthog::solution& sol,
+                bool keep_path)
+        {
+            warthog::timer mytimer;
+            mytimer.start();
+
+            uint32_t start_id = g_->to_graph_id(pi.start_id_);
+            uint32_t target_id = g_->to_graph_id(pi.target_id_);
+            if(start_id == warthog::INF || target_id == warthog::INF)
+            {
+                mytimer.stop();
+                sol.time_elapsed_nano_ = mytimer.elapsed_time_nano();
+                return;
+            }
+
+            // no optimal path has more moves than the graph has nodes;
+            // any more would mean the table does not belong to the graph
+            uint32_t max_moves = max_moves_ < g_->get_num_nodes()
+                ? max_moves_ : g_->get_num_nodes();
+
+            double cost = 0;
+            uint32_t n = start_id;
+            bool stuck = false;
+            if(keep_path) { sol.path_.push_back(pi.start_id_); }
+            while(n != target_id && sol.nodes_expanded_ < max_moves)
+            {
+                double edge_cost = 0;
+                uint32_t next = next_move(n, target_id, edge_cost);
+                sol.nodes_expanded_++;
+                if(next == warthog::INF) { stuck = true; break; }
+
+                sol.nodes_touched_++;
+                cost += edge_cost;
+                n = next;
+                if(keep_path) { sol.path_.push_back(g_->to_external_id(n)); }
+            }
+
+            // a path (or a prefix of max_moves_ moves) was extracted;
+            // otherwise the target is unreachable
+            if(n == target_id || (!stuck && sol.nodes_expanded_ == max_moves_))
+            {
+                sol.sum_of_edge_costs_ = cost;
+            }
+            else { sol.path_.clear(); }
+            mytimer.stop();
+            sol.time_elapsed_nano_ = mytimer.elapsed_time_nano();
+
+            if(pi.verbose_)
+            {
+                std::cerr << "cpd; " << sol.nodes_expanded_ << " moves from "
+                    << pi.start_id_ << " to " << pi.target_id_ << " cost "
+                    << sol.sum_of_edge_costs_ << std::endl;
+            }
+        }
+};
+
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef WARTHOG_DUMMY_LISTENER_H
+#define WARTHOG_DUMMY_LISTENER_H
+
+// search/dummy_listener.h
+//
+// A search listener that ignores every event. This is the default
+// listener for flexible_astar; all calls are inlined away.
+//
+// A listener is any type with the following three member functions:
+//
+//  generate_node(succ, from, edge_cost, edge_id): called every time a
+//  node is reached. @param from is 0 when @param succ is the start node.
+//
+//  expand_node(current): called when a node is popped off the open list
+//
+//  relax_node(current): called when a node is inserted into the open
+//  list or when its g-value is improved
+//
+
+#include "search_node.h"
+
+#include <cstdint>
+
+namespace warthog
+{
+
+class dummy_listener
+{
+    public:
+        dummy_listener() { }
+        ~dummy_listener() { }
+
+        template<class NODE>
+        inline void
+        generate_node(NODE* succ, NODE* from,
+                double edge_cost, uint32_t edge_id) { }
+
+        template<class NODE>
+        inline void
+        expand_node(NODE* current) { }
+
+        template<class NODE>
+        inline void
+        relax_node(NODE* current) { }
+};
+
+}
+
+#endif
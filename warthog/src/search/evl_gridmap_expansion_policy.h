@@ -91,6 +91,10 @@ class evl_gridmap_expansion_policy
             return (n->get_id() == pi->target_id_);
         }
 
+        // nodes stay in the pool until destruction; nothing to reclaim
+        inline void
+        reclaim() { }
+
 		size_t 
         mem();
 
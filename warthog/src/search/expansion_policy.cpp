@@ -3,7 +3,8 @@
 warthog::expansion_policy::expansion_policy(uint32_t nodes_pool_size)
 {
     nodes_pool_size_ = nodes_pool_size;
-    nodepool_ = new warthog::mem::node_pool(nodes_pool_size);
+    nodepool_ = new warthog::mem::paged_node_pool(nodes_pool_size);
+    own_nodepool_ = true;
     //neis_ = new std::vector<neighbour_record>();
     //neis_->reserve(32);
     neis_ = new warthog::arraylist<neighbour_record>(32);
@@ -13,5 +14,14 @@ warthog::expansion_policy::~expansion_policy()
 {
     reset();
     delete neis_;
-    delete nodepool_;
+    if(own_nodepool_) { delete nodepool_; }
+}
+
+void
+warthog::expansion_policy::set_node_pool(warthog::mem::paged_node_pool* pool)
+{
+    assert(pool && pool->get_num_nodes() >= nodes_pool_size_);
+    if(own_nodepool_) { delete nodepool_; }
+    nodepool_ = pool;
+    own_nodepool_ = false;
 }
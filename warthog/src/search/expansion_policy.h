@@ -8,12 +8,19 @@
 // search space is known apriori and a description of each node can be
 // generated in constant time and independent of any other node.
 //
+// Search nodes are kept in a warthog::mem::paged_node_pool. By default
+// each expansion policy creates a pool of its own. Several threads can
+// search the same domain by giving each thread's expansion policy a
+// separate pool via ::set_node_pool. Only pages reached by the search
+// are allocated, and ::reclaim forgets the nodes of the last search in
+// time proportional to the number of pages touched.
+//
 // @author: dharabor
 // @created: 2016-01-26
 //
 
 #include "arraylist.h"
-#include "node_pool.h"
+#include "paged_node_pool.h"
 #include "search_node.h"
 #include "problem_instance.h"
 
@@ -30,12 +37,25 @@ class expansion_policy
 
         uint32_t
         get_nodes_pool_size() { return nodes_pool_size_; } 
+
+        // use @param pool to store search nodes. the pool must cover at
+        // least ::get_nodes_pool_size node ids and outlive this object.
+        // the pool created by the constructor is released.
+        void
+        set_node_pool(warthog::mem::paged_node_pool* pool);
+
+        inline warthog::mem::paged_node_pool*
+        get_node_pool() { return nodepool_; }
        
+        // forget every node generated so far and release their memory. 
+        // pointers to nodes from previous searches are invalid after 
+        // this call.
         inline void
         reclaim()
         {
-            //reset();
-            //nodepool_->eclaim();
+            reset();
+            nodepool_->reset();
+            nodepool_->reclaim();
         }        
 
 		inline void
@@ -186,7 +206,8 @@ class expansion_policy
             double cost_;
         };
 
-        warthog::mem::node_pool* nodepool_;
+        warthog::mem::paged_node_pool* nodepool_;
+        bool own_nodepool_;
         //std::vector<neighbour_record>* neis_;
         arraylist<neighbour_record>* neis_;
         uint32_t current_;
@@ -17,6 +17,7 @@
 //
 
 #include "cpool.h"
+#include "dummy_listener.h"
 #include "pqueue.h"
 #include "problem_instance.h"
 #include "search.h"
@@ -28,6 +29,8 @@
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace warthog
@@ -35,21 +38,27 @@ namespace warthog
 
 // H is a heuristic function
 // E is an expansion policy
+// Q is the open list
+// L is a listener which is notified of search events (see dummy_listener.h)
 template< class H,
           class E,
-          class Q = warthog::pqueue_min >
+          class Q = warthog::pqueue_min,
+          class L = warthog::dummy_listener >
 class flexible_astar : public warthog::search
 {
 	public:
-		flexible_astar(H* heuristic, E* expander, Q* queue) :
-            heuristic_(heuristic), expander_(expander)
+        // the type of search node generated by the expansion policy.
+        // usually warthog::search_node (see search_node.h for others)
+        typedef typename std::remove_pointer<
+            decltype(std::declval<E&>().generate(0))>::type node;
+
+		flexible_astar(H* heuristic, E* expander, Q* queue, 
+                L listener = L()) :
+            heuristic_(heuristic), expander_(expander), listener_(listener)
 		{
 			open_ = queue;
             cost_cutoff_ = warthog::INF;
             exp_cutoff_ = warthog::INF;
-            on_relax_fn_ = 0;
-            on_generate_fn_ = 0;
-            on_expand_fn_ = 0;
             pi_.instance_id_ = UINT32_MAX;
 		}
 
@@ -64,7 +73,7 @@ class flexible_astar : public warthog::search
                 sol.path_.empty() && sol.sum_of_edge_costs_ == warthog::INF);
             pi_ = instance;
 
-			warthog::search_node* target = search(sol);
+			node* target = search(sol);
 			if(target)
 			{
                 sol.sum_of_edge_costs_ = target->get_g();
@@ -78,14 +87,14 @@ class flexible_astar : public warthog::search
                 sol.path_.empty() && sol.sum_of_edge_costs_ == warthog::INF);
             pi_ = instance;
 
-			warthog::search_node* target = search(sol);
+			node* target = search(sol);
 			if(target)
 			{
                 sol.sum_of_edge_costs_ = target->get_g();
 
 				// follow backpointers to extract the path
 				assert(expander_->is_target(target, &pi_));
-                warthog::search_node* current = target;
+                node* current = target;
 				while(true)
                 {
 					sol.path_.push_back(current->get_id());
@@ -103,7 +112,7 @@ class flexible_astar : public warthog::search
                         expander_->get_xy(node_id, x, y);
                         std::cerr
                             << "final path: (" << x << ", " << y << ")...";
-                        warthog::search_node* n =
+                        node* n =
                             expander_->generate(node_id);
                         assert(n->get_search_id() == pi_.instance_id_);
                         n->print(std::cerr);
@@ -117,11 +126,11 @@ class flexible_astar : public warthog::search
         // return a list of the nodes expanded during the last search
         // @param coll: an empty list
         void
-        closed_list(std::vector<warthog::search_node*>& coll)
+        closed_list(std::vector<node*>& coll)
         {
             for(uint32_t i = 0; i < expander_->get_nodes_pool_size(); i++)
             {
-                warthog::search_node* current = expander_->generate(i);
+                node* current = expander_->generate(i);
                 if(current->get_search_id() == pi_.instance_id_)
                 {
                     coll.push_back(current);
@@ -132,51 +141,29 @@ class flexible_astar : public warthog::search
         // return a pointer to the warthog::search_node object associated
         // with node @param id. If this node was not generate during the
         // last search instance, 0 is returned instead
-        warthog::search_node*
+        node*
         get_generated_node(uint32_t id)
         {
-            warthog::search_node* ret = expander_->generate(id);
+            node* ret = expander_->generate(id);
             return ret->get_search_id() == pi_.instance_id_ ? ret : 0;
         }
 
         // apply @param fn to every node on the closed list
         void
-        apply_to_closed(std::function<void(warthog::search_node*)>& fn)
+        apply_to_closed(std::function<void(node*)>& fn)
         {
             for(uint32_t i = 0; i < expander_->get_nodes_pool_size(); i++)
             {
-                warthog::search_node* current = expander_->generate(i);
+                node* current = expander_->generate(i);
                 if(current->get_search_id() == pi_.instance_id_)
                 { fn(current); }
             }
         }
 
-        // apply @param fn every time a node is successfully relaxed
-        void
-        apply_on_relax(std::function<void(warthog::search_node*)>& fn)
-        {
-            on_relax_fn_ = &fn;
-        }
-
-        // apply @param fn every time a node is generated (equiv, reached)
-        void
-        apply_on_generate(
-                std::function<void(
-                    warthog::search_node* succ,
-                    warthog::search_node* from,
-                    double edge_cost,
-                    uint32_t edge_id)>& fn)
-        {
-            on_generate_fn_ = &fn;
-        }
-
-        // apply @param fn when a node is popped off the open list for
-        // expansion
-        void
-        apply_on_expand(std::function<void(warthog::search_node*)>& fn)
-        {
-            on_expand_fn_ = &fn;
-        }
+        // the listener is stored by value; use this function to
+        // configure it after construction
+        inline L*
+        get_listener() { return &listener_; }
 
         // set a cost-cutoff to run a bounded-cost A* search.
         // the search terminates when the target is found or the f-cost
@@ -196,6 +183,15 @@ class flexible_astar : public warthog::search
         inline uint32_t
         get_max_expansions_cutoff() { return exp_cutoff_; }
 
+        // clear the open list and return all memory allocated for nodes
+        // to the node pool
+        virtual void
+        reclaim()
+        {
+            open_->clear();
+            expander_->reclaim();
+        }
+
 		virtual inline size_t
 		mem()
 		{
@@ -213,43 +209,33 @@ class flexible_astar : public warthog::search
 
 
 	private:
-    Debugger<E> debugger;
+        #ifndef NDEBUG
+        Debugger<E> debugger;
+        #endif
 		H* heuristic_;
 		E* expander_;
 		Q* open_;
+        L listener_;
         warthog::problem_instance pi_;
 
         // early termination limits
         double cost_cutoff_;
         uint32_t exp_cutoff_;
 
-        // callback for when a node is relaxed
-        std::function<void(warthog::search_node*)>* on_relax_fn_;
-
-        // callback for when a node is reached / generated
-        std::function<void(
-                warthog::search_node*,
-                warthog::search_node*,
-                double edge_cost,
-                uint32_t edge_id)>* on_generate_fn_;
-
-        // callback for when a node is expanded
-        std::function<void(warthog::search_node*)>* on_expand_fn_;
-
 		// no copy ctor
 		flexible_astar(const flexible_astar& other) { }
 		flexible_astar&
 		operator=(const flexible_astar& other) { return *this; }
 
-		warthog::search_node*
+		node*
 		search(warthog::solution& sol)
 		{
 			warthog::timer mytimer;
 			mytimer.start();
 			open_->clear();
 
-			warthog::search_node* start;
-			warthog::search_node* target = 0;
+			node* start;
+			node* target = 0;
 
             // get the internal target id
             if(pi_.target_id_ != warthog::INF)
@@ -269,8 +255,7 @@ class flexible_astar : public warthog::search
 			open_->push(start);
             sol.nodes_inserted_++;
 
-            if(on_generate_fn_)
-            { (*on_generate_fn_)(start, 0, 0, UINT32_MAX); }
+            listener_.generate_node(start, (node*)0, 0, UINT32_MAX);
 
 
 			#ifndef NDEBUG
@@ -287,11 +272,11 @@ class flexible_astar : public warthog::search
             // begin expanding
 			while(open_->size())
 			{
-				warthog::search_node* current = open_->pop();
+				node* current = open_->pop();
 				current->set_expanded(true); // NB: set before generating
 				assert(current->get_expanded());
 				sol.nodes_expanded_++;
-                if(on_expand_fn_) { (*on_expand_fn_)(current); }
+                listener_.expand_node(current);
 
                 // goal test
                 if(expander_->is_target(current, &pi_))
@@ -322,7 +307,7 @@ class flexible_astar : public warthog::search
 
                 // generate successors
 				expander_->expand(current, &pi_);
-				warthog::search_node* n = 0;
+				node* n = 0;
 				double cost_to_n = warthog::INF;
                 uint32_t edge_id = 0;
 				for(expander_->first(n, cost_to_n);
@@ -330,8 +315,7 @@ class flexible_astar : public warthog::search
 					   	expander_->next(n, cost_to_n))
 				{
                     sol.nodes_touched_++;
-                    if(on_generate_fn_)
-                    { (*on_generate_fn_)(n, current, cost_to_n, edge_id++); }
+                    listener_.generate_node(n, current, cost_to_n, edge_id++);
 
                     // add new nodes to the fringe
                     if(n->get_search_id() != current->get_search_id())
@@ -358,7 +342,7 @@ class flexible_astar : public warthog::search
                         }
                         #endif
 
-                        if(on_relax_fn_) { (*on_relax_fn_)(n); }
+                        listener_.relax_node(n);
                         continue;
                     }
 
@@ -402,7 +386,7 @@ class flexible_astar : public warthog::search
                 debugger.AddEvent(updating,n);
 							}
 							#endif
-                            if(on_relax_fn_) { (*on_relax_fn_)(n); }
+                            listener_.relax_node(n);
 						}
 						else
 						{
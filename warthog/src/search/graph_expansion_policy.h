@@ -23,7 +23,10 @@
 namespace warthog
 {
 
-template <class FILTER = warthog::dummy_filter>
+// FILTER decides which successors to prune
+// NODE is the type of search node; see search_node.h
+template <class FILTER = warthog::dummy_filter,
+          class NODE = warthog::search_node>
 class graph_expansion_policy
 {
     public:
@@ -35,16 +38,16 @@ class graph_expansion_policy
             if(filter == 0)
             {
                 fn_generate_successor = &warthog::graph_expansion_policy
-                                        <FILTER>::fn_generate_no_filter;
+                                        <FILTER, NODE>::fn_generate_no_filter;
             }
             else
             {
                 fn_generate_successor = &warthog::graph_expansion_policy
-                                        <FILTER>::fn_generate_with_filter;
+                                        <FILTER, NODE>::fn_generate_with_filter;
             }
 
             nodes_pool_size_ = g_->get_num_nodes();
-            nodepool_ = new warthog::search_node[nodes_pool_size_];
+            nodepool_ = new NODE[nodes_pool_size_];
             for(uint32_t i = 0; i < nodes_pool_size_; i++)
             {
                 nodepool_[i].set_id(i);
@@ -57,21 +60,21 @@ class graph_expansion_policy
         }
 
 		void
-		expand(warthog::search_node* current, warthog::problem_instance* pi)
+		expand(NODE* current, warthog::problem_instance* pi)
         {
             edge_index_ = 0;
             current_graph_node_ = g_->get_node(current->get_id()) ;
         }
 
 		inline void
-		first(warthog::search_node*& ret, double& cost)
+		first(NODE*& ret, double& cost)
 		{
             edge_index_ = UINT32_MAX;
             next(ret, cost);
 		}
 
 		inline void
-		n(warthog::search_node*& ret, double& cost)
+		n(NODE*& ret, double& cost)
 		{
             if(edge_index_ < current_graph_node_->out_degree())
             {
@@ -89,7 +92,7 @@ class graph_expansion_policy
 		}
 
 		inline void
-		next(warthog::search_node*& ret, double& cost)
+		next(NODE*& ret, double& cost)
 		{
             assert(current_graph_node_);
             ret = 0;
@@ -114,7 +117,7 @@ class graph_expansion_policy
             }
 		}
 
-        warthog::search_node*
+        NODE*
         generate_start_node(warthog::problem_instance* pi)
         {
             uint32_t s_graph_id = g_->to_graph_id(pi->start_id_);
@@ -122,7 +125,7 @@ class graph_expansion_policy
             return &nodepool_[s_graph_id];
         }
 
-        warthog::search_node*
+        NODE*
         generate_target_node(warthog::problem_instance* pi)
         {
             // convert from external id to internal id
@@ -136,14 +139,14 @@ class graph_expansion_policy
             return &nodepool_[t_graph_id];
         }
 
-        warthog::search_node*
+        NODE*
         generate(uint32_t nid)
         {
             return &nodepool_[nid];
         }
 
         bool
-        is_target(warthog::search_node* n, warthog::problem_instance* pi)
+        is_target(NODE* n, warthog::problem_instance* pi)
         {
             return n->get_id() == pi->target_id_;
         }
@@ -164,11 +167,15 @@ class graph_expansion_policy
         uint32_t
         get_nodes_pool_size() { return nodes_pool_size_; }
 
+        // every node is allocated up front; nothing to reclaim
+        inline void
+        reclaim() { }
+
         size_t
 		mem()
         {
             return
-                sizeof(warthog::search_node)*nodes_pool_size_ +
+                sizeof(NODE)*nodes_pool_size_ +
                 sizeof(this);
         }
 
@@ -179,17 +186,17 @@ class graph_expansion_policy
         uint32_t edge_index_;
         warthog::graph::node* current_graph_node_;
 
-        warthog::search_node* nodepool_;
+        NODE* nodepool_;
         uint32_t nodes_pool_size_;
 
         typedef
-            warthog::search_node*
-            (warthog::graph_expansion_policy<FILTER>::*generate_fn)
+            NODE*
+            (warthog::graph_expansion_policy<FILTER, NODE>::*generate_fn)
             (uint32_t current_id, uint32_t edge_idx, warthog::graph::edge& e);
 
         generate_fn fn_generate_successor;
 
-        inline warthog::search_node*
+        inline NODE*
         fn_generate_with_filter(
                 uint32_t current_id,
                 uint32_t edge_idx,
@@ -202,7 +209,7 @@ class graph_expansion_policy
             return 0;
         }
 
-        inline warthog::search_node*
+        inline NODE*
         fn_generate_no_filter(
                 uint32_t current_id,
                 uint32_t edge_idx,
@@ -216,6 +223,15 @@ class graph_expansion_policy
 typedef
 warthog::graph_expansion_policy<> simple_graph_expansion_policy;
 
+// simple expansion policies with compact search nodes
+typedef
+warthog::graph_expansion_policy<warthog::dummy_filter, warthog::search_node_f32>
+simple_graph_expansion_policy_f32;
+
+typedef
+warthog::graph_expansion_policy<warthog::dummy_filter, warthog::search_node_u32>
+simple_graph_expansion_policy_u32;
+
 }
 
 #endif
@@ -1,3 +1,3 @@
 #include "problem_instance.h"
 
-uint32_t warthog::problem_instance::instance_counter_ = 0;
+std::atomic<uint32_t> warthog::problem_instance::instance_counter_(0);
@@ -3,6 +3,8 @@
 
 #include "search_node.h"
 
+#include <atomic>
+
 namespace warthog
 {
 
@@ -66,7 +68,8 @@ class problem_instance
         void* extra_params_;
 
         private:
-            static uint32_t instance_counter_;
+            // shared by all threads; every instance gets a distinct id
+            static std::atomic<uint32_t> instance_counter_;
 
 };
 
@@ -34,6 +34,11 @@ class search
 
         virtual size_t
         mem() = 0;
+
+        // release the memory held for the nodes of previous searches.
+        // by default there is nothing to release
+        virtual void
+        reclaim() { }
 };
 
 }
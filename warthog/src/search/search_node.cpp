@@ -1,4 +1,5 @@
 #include "search_node.h"
 
-unsigned int warthog::search_node::refcount_ = 0;
-
+template class warthog::search_node_base<double>;
+template class warthog::search_node_base<float>;
+template class warthog::search_node_base<uint32_t>;
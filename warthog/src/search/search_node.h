@@ -3,6 +3,24 @@
 
 // search_node.h
 //
+// A node in the search space. Nodes are parameterised on the type used
+// to store f- and g-values: double (the default), float, or uint32_t
+// (for graphs with integer edge weights, such as xy_graph). 32bit cost
+// types reduce the size of each node from 40 bytes to 28 bytes.
+//
+// A float has a 24bit significand so integer costs are only exact up to
+// 2^24 (16777216); beyond that g-values round and searches can return
+// suboptimal paths. Nodes start with f and g at warthog::INF (2^31-1),
+// which marks them as unreached, so uint32_t costs must stay below
+// warthog::INF even though the type could hold up to 2^32-1. double is
+// exact up to 2^53. Callers selecting a 32bit cost type should check the
+// largest possible path cost against max_exact_cost<COST_T>() when
+// loading the input.
+//
+// Fields are ordered by access frequency: those read during every
+// open list operation (f, g, heap priority) come first and fields
+// only read during path extraction (parent, jps direction) come last.
+//
 // @author: dharabor
 // @created: 10/08/2012
 //
@@ -11,19 +29,39 @@
 #include "cpool.h"
 #include "jps.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <iostream>
+#include <limits>
 
 namespace warthog
 {
 
 const uint32_t STATUS_MASK = 1;
-class search_node
+
+// the largest integer cost that COST_T represents without rounding.
+// for integer types this excludes warthog::INF, the unreached value
+template<typename COST_T>
+inline double
+max_exact_cost()
+{
+    return std::numeric_limits<COST_T>::is_integer ?
+        std::min<double>(std::numeric_limits<COST_T>::max(),
+                warthog::INF - 1) :
+        std::ldexp(1.0, std::numeric_limits<COST_T>::digits);
+}
+
+template<typename COST_T>
+class search_node_base
 {
 	public:
-		search_node(uint32_t id=warthog::NODE_NONE)
-			: id_and_status_(id << 1), f_(warthog::INF),
-            g_(warthog::INF), parent_id_(warthog::NODE_NONE),
-			priority_(warthog::INF), searchid_(0)
+        typedef COST_T cost_t;
+
+		search_node_base(uint32_t id=warthog::NODE_NONE)
+			: f_(warthog::INF), g_(warthog::INF),
+			priority_(warthog::INF), searchid_(0), id_and_status_(id << 1),
+            parent_id_(warthog::NODE_NONE)
 		{
 			assert(this->get_id() <= ((1ul<<31)-1));
             set_pdir(warthog::jps::direction::NONE);
@@ -31,13 +69,13 @@ class search_node
 			refcount_++;
 		}
 
-		~search_node()
+		~search_node_base()
 		{
 			refcount_--;
 		}
 
 		inline void
-		init(uint32_t searchid, uint32_t parent_id, double g, double f)
+		init(uint32_t searchid, uint32_t parent_id, COST_T g, COST_T f)
 		{
 			id_and_status_ &= ~1;
             parent_id_= parent_id;
@@ -102,20 +140,20 @@ class search_node
 		inline void
 		set_priority(uint32_t priority) { priority_ = priority; }
 
-		inline double
+		inline COST_T
 		get_g() const { return g_; }
 
 		inline void
-		set_g(double g) { g_ = g; }
+		set_g(COST_T g) { g_ = g; }
 
-		inline double
+		inline COST_T
 		get_f() const { return f_; }
 
 		inline void
-		set_f(double f) { f_ = f; }
+		set_f(COST_T f) { f_ = f; }
 
 		inline void
-		relax(double g, uint32_t parent_id)
+		relax(COST_T g, uint32_t parent_id)
 		{
 			assert(g < g_);
 			f_ = (f_ - g_) + g;
@@ -124,7 +162,7 @@ class search_node
 		}
 
 		inline bool
-		operator<(const warthog::search_node& other) const
+		operator<(const warthog::search_node_base<COST_T>& other) const
 		{
 			if(f_ < other.f_)
 			{
@@ -144,7 +182,7 @@ class search_node
 		}
 
 		inline bool
-		operator>(const warthog::search_node& other) const
+		operator>(const warthog::search_node_base<COST_T>& other) const
 		{
 			if(f_ > other.f_)
 			{
@@ -164,7 +202,7 @@ class search_node
 		}
 
 		inline bool
-		operator==(const warthog::search_node& other) const
+		operator==(const warthog::search_node_base<COST_T>& other) const
 		{
 			if( !(*this < other) && !(*this > other))
 			{
@@ -174,7 +212,7 @@ class search_node
 		}
 
 		inline bool
-		operator<=(const warthog::search_node& other) const
+		operator<=(const warthog::search_node_base<COST_T>& other) const
 		{
 			if(*this < other)
 			{
@@ -188,7 +226,7 @@ class search_node
 		}
 
 		inline bool
-		operator>=(const warthog::search_node& other) const
+		operator>=(const warthog::search_node_base<COST_T>& other) const
 		{
 			if(*this > other)
 			{
@@ -214,7 +252,7 @@ class search_node
 		}
 
 		static uint32_t
-		get_refcount() { return refcount_; }
+		get_refcount() { return refcount_.load(); }
 
 		uint32_t
 		mem()
@@ -223,23 +261,29 @@ class search_node
 		}
 
 	private:
-		uint64_t id_and_status_; // bit 0 is expansion status; 1-63 are id
-		double f_;
-		double g_;
-        uint64_t parent_id_;
+		COST_T f_;
+		COST_T g_;
 		uint32_t priority_; // expansion priority
 		uint32_t searchid_;
+		uint32_t id_and_status_; // bit 0 is expansion status; 1-31 are id
+        uint32_t parent_id_;
         uint8_t jps_parent_direction_; // hack
 
-		static uint32_t refcount_;
+		static std::atomic<uint32_t> refcount_;
 };
 
+template<typename COST_T>
+std::atomic<uint32_t> search_node_base<COST_T>::refcount_(0);
+
+typedef search_node_base<double> search_node;
+typedef search_node_base<float> search_node_f32;
+typedef search_node_base<uint32_t> search_node_u32;
+
 struct cmp_less_search_node
 {
+    template<typename NODE>
     inline bool
-    operator()(
-            const warthog::search_node& first,
-            const warthog::search_node& second)
+    operator()(const NODE& first, const NODE& second)
     {
         return first < second;
     }
@@ -247,10 +291,9 @@ struct cmp_less_search_node
 
 struct cmp_greater_search_node
 {
+    template<typename NODE>
     inline bool
-    operator()(
-            const warthog::search_node& first,
-            const warthog::search_node& second)
+    operator()(const NODE& first, const NODE& second)
     {
         return first > second;
     }
@@ -258,10 +301,9 @@ struct cmp_greater_search_node
 
 struct cmp_less_search_node_f_only
 {
+    template<typename NODE>
     inline bool
-    operator()(
-            const warthog::search_node& first,
-            const warthog::search_node& second)
+    operator()(const NODE& first, const NODE& second)
     {
         return first.get_f() < second.get_f();
     }
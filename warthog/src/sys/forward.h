@@ -20,13 +20,14 @@ class expansion_policy;
 class euclidean_heuristic;
 class gridmap;
 class problem_instance;
-class search_node;
+template<typename COST_T> class search_node_base;
+typedef search_node_base<double> search_node;
 class zero_heuristic;
 
-template<typename H, typename E, typename Q>
+template<typename H, typename E, typename Q, typename L>
 class flexible_astar;
 
-template<typename FILTER>
+template<typename FILTER, typename NODE>
 class graph_expansion_policy;
 
 namespace graph
@@ -50,6 +51,7 @@ class bb_labelling;
 class bbaf_labelling;
 class dfs_labelling;
 class firstmove_labelling;
+class firstmove_table;
 
 }
 
@@ -79,7 +79,8 @@ public:
 		expander_-> unpadCoordinate(paddedId,x,y);
 		return y*width + x;
 	}
-	void AddEvent(EventType type, warthog::search_node* node)
+	template<class NODE>
+	void AddEvent(EventType type, NODE* node)
 	{
 		int32_t x,y;
 		expander_-> get_xy(node->get_id(),x,y);
@@ -0,0 +1,137 @@
+#include "batch_query.h"
+#include "timer.h"
+#include "work_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+warthog::util::batch_query::batch_query(uint32_t num_threads)
+    : num_threads_(num_threads), num_steals_(0), num_reclaims_(0),
+      reclaim_limit_(0), wallclock_nano_(0), worker_mem_(0)
+{
+    if(num_threads_ == 0)
+    {
+        num_threads_ = std::thread::hardware_concurrency();
+        if(num_threads_ == 0) { num_threads_ = 1; }
+    }
+}
+
+warthog::util::batch_query::~batch_query()
+{
+}
+
+void
+warthog::util::batch_query::run(uint32_t num_queries,
+        batch_worker_fn& fn_worker, batch_query_fn& fn_query)
+{
+    results_.clear();
+    results_.resize(num_queries);
+    sorted_latency_.clear();
+
+    uint32_t num_workers = std::min(num_threads_,
+            std::max<uint32_t>(num_queries, 1));
+    warthog::util::work_queue queue(num_queries, num_workers);
+    std::atomic<size_t> worker_mem(0);
+    std::atomic<uint32_t> num_reclaims(0);
+
+    auto thread_fn = [&] (uint32_t worker_id) -> void
+    {
+        batch_serve_fn fn_serve = [&] (warthog::search* alg) -> void
+        {
+            uint32_t query_id;
+            while(queue.next(worker_id, query_id))
+            {
+                fn_query(alg, query_id, results_.at(query_id));
+                if(reclaim_limit_ && alg->mem() > reclaim_limit_)
+                {
+                    alg->reclaim();
+                    num_reclaims++;
+                }
+            }
+            worker_mem += alg->mem();
+        };
+        fn_worker(fn_serve);
+    };
+
+    warthog::timer t;
+    t.start();
+    if(num_workers == 1)
+    {
+        // no need to fork when there is nobody to share the work with
+        thread_fn(0);
+    }
+    else
+    {
+        std::vector<std::thread> threads;
+        for(uint32_t i = 0; i < num_workers; i++)
+        {
+            threads.push_back(std::thread(thread_fn, i));
+        }
+        for(uint32_t i = 0; i < num_workers; i++)
+        {
+            threads.at(i).join();
+        }
+    }
+    t.stop();
+
+    wallclock_nano_ = t.elapsed_time_nano();
+    worker_mem_ = worker_mem.load();
+    num_steals_ = queue.get_num_steals();
+    num_reclaims_ = num_reclaims.load();
+
+    sorted_latency_.reserve(num_queries);
+    for(uint32_t i = 0; i < num_queries; i++)
+    {
+        sorted_latency_.push_back(results_.at(i).time_elapsed_nano_);
+    }
+    std::sort(sorted_latency_.begin(), sorted_latency_.end());
+}
+
+double
+warthog::util::batch_query::get_throughput()
+{
+    if(wallclock_nano_ <= 0) { return 0; }
+    return results_.size() / (wallclock_nano_ / 1e9);
+}
+
+double
+warthog::util::batch_query::get_latency_percentile(double pct)
+{
+    if(sorted_latency_.size() == 0) { return 0; }
+
+    // nearest-rank method
+    uint32_t rank = (uint32_t)std::ceil((pct / 100.0) * sorted_latency_.size());
+    if(rank > 0) { rank--; }
+    if(rank >= sorted_latency_.size()) { rank = sorted_latency_.size() - 1; }
+    return sorted_latency_.at(rank);
+}
+
+void
+warthog::util::batch_query::print_stats(std::ostream& out)
+{
+    out
+        << "batch; threads " << num_threads_
+        << " queries " << results_.size()
+        << " steals " << num_steals_
+        << " reclaims " << num_reclaims_
+        << " wallclock (s) " << wallclock_nano_ / 1e9
+        << "\nbatch; throughput (queries/s) " << get_throughput()
+        << " latency p50 (nanos) " << get_latency_percentile(50)
+        << " p99 (nanos) " << get_latency_percentile(99)
+        << "\n";
+}
+
+size_t
+warthog::util::batch_query::mem()
+{
+    size_t bytes = sizeof(*this) +
+        sizeof(double) * sorted_latency_.capacity() +
+        sizeof(warthog::solution) * results_.capacity();
+    for(uint32_t i = 0; i < results_.size(); i++)
+    {
+        bytes += sizeof(uint32_t) * results_.at(i).path_.capacity();
+    }
+    return bytes;
+}
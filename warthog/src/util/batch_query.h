@@ -0,0 +1,133 @@
+#ifndef WARTHOG_BATCH_QUERY_H
+#define WARTHOG_BATCH_QUERY_H
+
+// util/batch_query.h
+//
+// Answers a batch of independent queries using several worker threads.
+//
+// Each worker builds its own search objects (the search algorithm,
+// expansion policy, heuristic, open list and node pool); only the input
+// domain (gridmap, xy_graph, labelling etc.) is shared, read-only, among
+// all workers. Queries are assigned to workers via a work_queue, so
+// workers that draw easy instances steal from those that draw hard ones.
+// Results are stored by query id and can be retrieved in input order
+// once the batch is done.
+//
+// The batch also records the wallclock time needed to answer all queries,
+// which together with the per-query search times yields a throughput
+// figure (queries per second) and latency percentiles.
+//
+// Search objects usually keep the nodes of one query around for the
+// next (see memory/paged_node_pool.h). With a reclaim limit, a worker
+// calls warthog::search::reclaim between queries whenever its search
+// objects use more memory than the limit.
+//
+
+#include "search.h"
+#include "solution.h"
+
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace warthog
+{
+
+namespace util
+{
+
+// a function which answers queries using a given search algorithm,
+// for as long as the batch has unanswered queries.
+typedef std::function<void(warthog::search*)> batch_serve_fn;
+
+// a function called once by every worker thread. it creates the
+// thread-private search objects and then hands the search algorithm
+// to the serve function.
+typedef std::function<void(batch_serve_fn&)> batch_worker_fn;
+
+// a function that answers the query with id @param query_id and writes
+// the result to @param sol
+typedef std::function<void(
+        warthog::search* alg, uint32_t query_id, warthog::solution& sol)>
+    batch_query_fn;
+
+class batch_query
+{
+    public:
+        // @param num_threads: the number of workers. zero means one
+        // worker for every hardware thread
+        batch_query(uint32_t num_threads);
+        ~batch_query();
+
+        // answer queries [0, @param num_queries)
+        void
+        run(uint32_t num_queries, batch_worker_fn& fn_worker,
+            batch_query_fn& fn_query);
+
+        inline uint32_t
+        get_num_threads() { return num_threads_; }
+
+        // reclaim the node memory of a worker whose search objects use
+        // more than @param bytes after a query. zero means never.
+        inline void
+        set_reclaim_limit(size_t bytes) { reclaim_limit_ = bytes; }
+
+        inline size_t
+        get_reclaim_limit() { return reclaim_limit_; }
+
+        // number of times workers reclaimed memory in the last batch
+        inline uint32_t
+        get_num_reclaims() { return num_reclaims_; }
+
+        inline uint32_t
+        get_num_queries() { return results_.size(); }
+
+        // the result of query @param query_id from the last batch
+        inline warthog::solution&
+        get_result(uint32_t query_id) { return results_.at(query_id); }
+
+        // wallclock time needed to answer the last batch
+        inline double
+        get_wallclock_nano() { return wallclock_nano_; }
+
+        // queries answered per second of wallclock time
+        double
+        get_throughput();
+
+        // the search time (nanos) at the @param pct percentile of all
+        // queries in the last batch
+        double
+        get_latency_percentile(double pct);
+
+        // total memory of the search objects of all workers,
+        // measured at the end of the last batch
+        inline size_t
+        get_worker_mem() { return worker_mem_; }
+
+        void
+        print_stats(std::ostream& out);
+
+        size_t
+        mem();
+
+    private:
+        uint32_t num_threads_;
+        uint32_t num_steals_;
+        uint32_t num_reclaims_;
+        size_t reclaim_limit_;
+        double wallclock_nano_;
+        size_t worker_mem_;
+        std::vector<warthog::solution> results_;
+        std::vector<double> sorted_latency_;
+
+        // no copy
+        batch_query(const batch_query& other) { }
+        batch_query& operator=(const batch_query& other) { return *this; }
+};
+
+}
+
+}
+
+#endif
+
@@ -0,0 +1,237 @@
+#ifndef WARTHOG_BUCKET_QUEUE_H
+#define WARTHOG_BUCKET_QUEUE_H
+
+// util/bucket_queue.h
+//
+// Dial's bucket queue: a monotone min priority queue for integer keys.
+// A node with f-value f goes into bucket floor(f). Buckets form a
+// circular array that grows when a key falls outside the current
+// window. Each of push, decrease_key and pop takes amortised
+// constant time.
+//
+// Nodes are ordered by floor(f) only. The queue gives the same order
+// as warthog::pqueue only if every f-value is an integer, for example
+// on graphs with integer edge costs and an integer-valued heuristic.
+// Otherwise the order within each unit interval is arbitrary.
+// Nodes in the same bucket are popped in LIFO order.
+//
+// Keys must be monotone. A key smaller than the current minimum is
+// treated as the current minimum.
+//
+// See util/lazy_entry.h for how decrease_key works.
+//
+
+#include "lazy_entry.h"
+#include "search_node.h"
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+namespace warthog
+{
+
+template<class NODE = warthog::search_node>
+class bucket_queue
+{
+    typedef warthog::lazy_entry<NODE> entry;
+
+    public:
+        typedef NODE node;
+
+        template<class N>
+        struct rebind
+        { typedef bucket_queue<N> other; };
+
+        bucket_queue(unsigned int size=1024)
+            : cur_(0), max_key_(0), live_(0), num_entries_(0),
+              cleared_(true)
+        {
+            num_buckets_ = 1;
+            while(num_buckets_ < size) { num_buckets_ <<= 1; }
+            mask_ = num_buckets_ - 1;
+            buckets_ = new std::vector<entry>[num_buckets_];
+        }
+
+        ~bucket_queue()
+        {
+            delete [] buckets_;
+        }
+
+        // removes all elements from the queue. only buckets that
+        // could hold an entry are visited.
+        void
+        clear()
+        {
+            if(num_entries_ > 0)
+            {
+                for(uint64_t k = cur_; k <= max_key_; k++)
+                {
+                    std::vector<entry>& bucket = buckets_[k & mask_];
+                    for(uint32_t i = 0; i < bucket.size(); i++)
+                    {
+                        bucket[i].node_->set_priority(
+                                warthog::LAZY_DEQUEUED);
+                    }
+                    bucket.clear();
+                }
+            }
+            live_ = 0;
+            num_entries_ = 0;
+            cleared_ = true;
+        }
+
+        void
+        decrease_key(NODE* val)
+        {
+            assert(contains(val));
+            file(val);
+        }
+
+        void
+        push(NODE* val)
+        {
+            if(contains(val)) { return; }
+            val->set_priority(warthog::LAZY_QUEUED);
+            live_++;
+            file(val);
+        }
+
+        NODE*
+        pop()
+        {
+            NODE* ans = peek();
+            if(ans)
+            {
+                buckets_[cur_ & mask_].pop_back();
+                num_entries_--;
+                live_--;
+                ans->set_priority(warthog::LAZY_DEQUEUED);
+            }
+            return ans;
+        }
+
+        // @return the top element without removing it. stale
+        // entries in front of the top element are discarded.
+        NODE*
+        peek()
+        {
+            if(live_ == 0) { return 0; }
+            while(true)
+            {
+                assert(cur_ <= max_key_);
+                std::vector<entry>& bucket = buckets_[cur_ & mask_];
+                while(bucket.size() > 0 && !bucket.back().live())
+                {
+                    bucket.pop_back();
+                    num_entries_--;
+                }
+                if(bucket.size() > 0) { return bucket.back().node_; }
+                cur_++;
+            }
+        }
+
+        inline bool
+        contains(NODE* n)
+        {
+            return n->get_priority() == warthog::LAZY_QUEUED;
+        }
+
+        inline unsigned int
+        size()
+        {
+            return live_;
+        }
+
+        inline bool
+        is_minqueue()
+        {
+            return true;
+        }
+
+        void
+        print(std::ostream& out)
+        {
+            if(num_entries_ == 0) { return; }
+            for(uint64_t k = cur_; k <= max_key_; k++)
+            {
+                std::vector<entry>& bucket = buckets_[k & mask_];
+                for(uint32_t i = 0; i < bucket.size(); i++)
+                {
+                    if(!bucket[i].live()) { continue; }
+                    bucket[i].node_->print(out);
+                    out << std::endl;
+                }
+            }
+        }
+
+        unsigned int
+        mem()
+        {
+            size_t bytes = sizeof(*this) +
+                sizeof(std::vector<entry>) * num_buckets_;
+            for(uint32_t i = 0; i < num_buckets_; i++)
+            {
+                bytes += buckets_[i].capacity() * sizeof(entry);
+            }
+            return bytes;
+        }
+
+    private:
+        std::vector<entry>* buckets_;
+        uint32_t num_buckets_;
+        uint32_t mask_;
+        uint64_t cur_;      // key of the first bucket that may be non-empty
+        uint64_t max_key_;  // largest key in the queue
+        uint32_t live_;
+        uint32_t num_entries_;
+        bool cleared_;      // nothing filed since the last ::clear
+
+        inline uint64_t
+        key(typename NODE::cost_t f)
+        {
+            return (uint64_t)f;
+        }
+
+        void
+        file(NODE* val)
+        {
+            uint64_t k = key(val->get_f());
+            if(cleared_)
+            {
+                cur_ = max_key_ = k;
+                cleared_ = false;
+            }
+            else if(k < cur_) { k = cur_; }
+
+            if(k - cur_ >= num_buckets_) { grow(k - cur_ + 1); }
+            if(k > max_key_) { max_key_ = k; }
+            buckets_[k & mask_].push_back(entry(val));
+            num_entries_++;
+        }
+
+        // resize the circular array to hold at least @param window
+        // consecutive keys, starting at cur_
+        void
+        grow(uint64_t window)
+        {
+            uint32_t newsize = num_buckets_;
+            while(newsize < window) { newsize <<= 1; }
+
+            std::vector<entry>* tmp = new std::vector<entry>[newsize];
+            uint32_t newmask = newsize - 1;
+            for(uint64_t k = cur_; k <= max_key_; k++)
+            {
+                std::vector<entry>& bucket = buckets_[k & mask_];
+                tmp[k & newmask].swap(bucket);
+            }
+            delete [] buckets_;
+            buckets_ = tmp;
+            num_buckets_ = newsize;
+            mask_ = newmask;
+        }
+};
+
+}
+
+#endif
@@ -285,6 +285,7 @@ warthog::dimacs_parser::load_instance(const char* dimacs_file)
 
 
     bool p2p = true;
+    bool m2m = false;
     char buf[1024];
     while(infile.good())
     {
@@ -299,6 +300,11 @@ warthog::dimacs_parser::load_instance(const char* dimacs_file)
             p2p = true;
             break;
         }
+        else if(strstr(buf, "p aux sp m2m") != 0)
+        {
+            m2m = true;
+            break;
+        }
         else if(strstr(buf, "p aux sp ss") != 0)
         {
             p2p = false;
@@ -316,7 +322,22 @@ warthog::dimacs_parser::load_instance(const char* dimacs_file)
         }
 
         char* tok = strtok(buf, " \t\n");
-        if(strcmp(tok, "q") == 0)
+        if(m2m && tok && (strcmp(tok, "s") == 0 || strcmp(tok, "t") == 0))
+        {
+            std::vector<uint32_t>& ids = 
+                strcmp(tok, "s") == 0 ? m2m_sources_ : m2m_targets_;
+            tok = strtok(0, " \t\n");
+            if(tok == 0)
+            {
+                std::cerr << "skipping invalid node in problem file: " 
+                    << buf << std::endl;
+            }
+            else
+            {
+                ids.push_back(atoi(tok));
+            }
+        }
+        else if(tok && strcmp(tok, "q") == 0)
         {
             warthog::dimacs_parser::experiment exp;
 
@@ -353,6 +374,19 @@ warthog::dimacs_parser::load_instance(const char* dimacs_file)
         }
         infile.getline(buf, 1024);
     }
+
+    // a distance table is also a list of p2p queries, one per entry
+    for(uint32_t i = 0; i < m2m_sources_.size(); i++)
+    {
+        for(uint32_t j = 0; j < m2m_targets_.size(); j++)
+        {
+            warthog::dimacs_parser::experiment exp;
+            exp.source = m2m_sources_[i];
+            exp.target = m2m_targets_[j];
+            exp.p2p = true;
+            experiments_->push_back(exp);
+        }
+    }
     //std::cerr << "loaded "<<experiments_->size() << " queries\n";
     return true;
 }
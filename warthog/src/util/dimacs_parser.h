@@ -139,6 +139,16 @@ class dimacs_parser
         inline std::string 
         get_problemfile() { return problemfile_; }
 
+        // the sources and targets of a distance table problem file
+        // ("p aux sp m2m"), which lists one node per line: "s id" for
+        // sources and "t id" for targets. the experiments of such a file
+        // are the p2p queries of every table entry, in row-major order
+        inline std::vector<uint32_t>&
+        get_m2m_sources() { return m2m_sources_; }
+
+        inline std::vector<uint32_t>&
+        get_m2m_targets() { return m2m_targets_; }
+
     private:
         void init();
         bool load_co_file(std::istream& fdimacs);
@@ -147,6 +157,8 @@ class dimacs_parser
        std::vector<warthog::dimacs_parser::node>* nodes_;
        std::vector<warthog::dimacs_parser::edge>* edges_;
        std::vector<warthog::dimacs_parser::experiment>* experiments_;
+       std::vector<uint32_t> m2m_sources_;
+       std::vector<uint32_t> m2m_targets_;
        std::string problemfile_;
 
 };
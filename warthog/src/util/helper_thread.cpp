@@ -0,0 +1,75 @@
+#include "helper_thread.h"
+
+#include <cassert>
+
+// number of times a waiting thread yields before going to sleep
+static const uint32_t SPIN_LIMIT = 1000;
+
+warthog::util::helper_thread::helper_thread() : state_(IDLE)
+{
+}
+
+warthog::util::helper_thread::~helper_thread()
+{
+    if(!thread_.joinable()) { return; }
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        state_ = EXIT;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+void
+warthog::util::helper_thread::start(const std::function<void()>& fn)
+{
+    assert(state_ == IDLE);
+    task_ = fn;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        state_ = READY;
+    }
+    cv_.notify_all();
+
+    if(!thread_.joinable())
+    {
+        thread_ = std::thread(&warthog::util::helper_thread::run, this);
+    }
+}
+
+void
+warthog::util::helper_thread::wait()
+{
+    wait_for([this] () -> bool { return state_ == IDLE; });
+}
+
+void
+warthog::util::helper_thread::run()
+{
+    while(true)
+    {
+        wait_for([this] () -> bool { return state_ != IDLE; });
+        if(state_ == EXIT) { return; }
+
+        task_();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            state_ = IDLE;
+        }
+        cv_.notify_all();
+    }
+}
+
+void
+warthog::util::helper_thread::wait_for(const std::function<bool()>& fn_done)
+{
+    for(uint32_t i = 0; i < SPIN_LIMIT; i++)
+    {
+        if(fn_done()) { return; }
+        std::this_thread::yield();
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, fn_done);
+}
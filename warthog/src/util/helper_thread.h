@@ -0,0 +1,68 @@
+#ifndef WARTHOG_HELPER_THREAD_H
+#define WARTHOG_HELPER_THREAD_H
+
+// util/helper_thread.h
+//
+// A thread that runs one task at a time on behalf of another thread,
+// e.g. one half of a search whose other half runs on the caller.
+//
+// The thread is created by the first call to ::start and lives until
+// the helper is destroyed, so short tasks don't pay for thread creation.
+// Between tasks it spins for a little while (yielding the cpu) before
+// going to sleep, which keeps the handover latency low when tasks
+// arrive back to back.
+//
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace warthog
+{
+
+namespace util
+{
+
+class helper_thread
+{
+    public:
+        helper_thread();
+        ~helper_thread();
+
+        // run @param fn on the helper thread and return immediately.
+        // the previous task must be finished (see ::wait)
+        void
+        start(const std::function<void()>& fn);
+
+        // block until the task given to ::start has returned
+        void
+        wait();
+
+    private:
+        enum state { IDLE, READY, EXIT };
+
+        std::thread thread_;
+        std::function<void()> task_;
+        std::atomic<uint32_t> state_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+
+        void
+        run();
+
+        // spin until @param fn_done returns true, then sleep on cv_
+        void
+        wait_for(const std::function<bool()>& fn_done);
+
+        // no copy
+        helper_thread(const helper_thread& other) { }
+        helper_thread& operator=(const helper_thread& other) { return *this; }
+};
+
+}
+
+}
+
+#endif
@@ -2,12 +2,18 @@
 #include "scenario_manager.h"
 #include "search.h"
 #include "solution.h"
+#include "timer.h"
 
 #include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <pthread.h>
+#include <thread>
 #include <unistd.h>
+#include <vector>
+#ifdef __linux__
+#include <sched.h>
+#endif
 
 bool
 warthog::helpers::load_integer_labels(
@@ -49,42 +55,130 @@ warthog::helpers::load_integer_labels_dimacs(
     return load_integer_labels(filename, labels);
 }
 
+namespace
+{
+    // see warthog::helpers::set_parallel_threads
+    uint32_t parallel_threads = 0;
+}
+
+void
+warthog::helpers::set_parallel_threads(uint32_t num_threads)
+{
+    parallel_threads = num_threads;
+}
+
+uint32_t
+warthog::helpers::get_parallel_threads()
+{
+    if(parallel_threads > 0) { return parallel_threads; }
+    uint32_t hw_threads = std::thread::hardware_concurrency();
+    return hw_threads > 0 ? hw_threads : 1;
+}
+
 void*
 warthog::helpers::parallel_compute(void*(*fn_worker)(void*), 
-        void* shared_data, uint32_t task_total)
+        void* shared_data, uint32_t task_total, uint32_t num_ids)
 {
     std::cerr << "parallel compute; begin\n";
     std::cerr << "tasks to process: " << task_total << "\n";
     if(task_total == 0) { return 0; }
+    if(num_ids == 0) { num_ids = task_total; }
 
     // OK, let's fork some threads
-    const uint32_t NUM_THREADS = 4;
-    pthread_t threads[NUM_THREADS];
-    thread_params task_data[NUM_THREADS];
+    const uint32_t NUM_THREADS = get_parallel_threads();
+    pthread_t* threads = new pthread_t[NUM_THREADS];
+    thread_params* task_data = new thread_params[NUM_THREADS];
+    warthog::util::work_queue tasks(num_ids, NUM_THREADS);
 
     void*(*fn_task_wrapper)(void*) = [] (void* in) -> void*
     {
         thread_params* par = (thread_params*)in;
-        par->thread_finished_ = false;
+        warthog::timer t;
+        t.start();
         void* retval = par->fn_worker_(in);
-        par->thread_finished_ = true;
+        t.stop();
+        par->elapsed_secs_ = t.elapsed_time_micro() / 1e6;
+        __atomic_store_n(&par->thread_finished_, true, __ATOMIC_RELEASE);
         return retval;
     };
 
+    // each thread stays on one cpu. workers allocate their own
+    // scratch memory (search nodes, open lists, etc.) so the first 
+    // touch places it on the memory node closest to that cpu.
+    // only cpus in the affinity mask of the process are used (the mask
+    // may be restricted by taskset, cgroups, containers, etc.)
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if(sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+    {
+        for(int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if(CPU_ISSET(cpu, &allowed)) { cpus.push_back(cpu); }
+        }
+    }
+#endif
+
+    // threads that fail to start are skipped; their share of the tasks
+    // is stolen by the others. thread ids stay contiguous: the threads
+    // that did start are numbered 0, 1, ...
+    uint32_t num_started = 0;
     for(uint32_t i = 0; i < NUM_THREADS; i++)
     {
         // define workloads
-        task_data[i].thread_id_ = i;
-        task_data[i].max_threads_ = NUM_THREADS;
-        task_data[i].nprocessed_ = 0;
-        task_data[i].shared_ = shared_data;
-        task_data[i].fn_worker_ = fn_worker;
+        thread_params& par = task_data[num_started];
+        par.thread_id_ = num_started;
+        par.max_threads_ = NUM_THREADS;
+        par.thread_finished_ = false;
+        par.nprocessed_ = 0;
+        par.shared_ = shared_data;
+        par.fn_worker_ = fn_worker;
+        par.tasks_ = &tasks;
+        par.elapsed_secs_ = 0;
+
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+#ifdef __linux__
+        if(cpus.size() > 0)
+        {
+            cpu_set_t cpu;
+            CPU_ZERO(&cpu);
+            CPU_SET(cpus[i % cpus.size()], &cpu);
+            pthread_attr_setaffinity_np(&attr, sizeof(cpu), &cpu);
+        }
+#endif
 
         // gogogogo
-        pthread_create(&threads[i], NULL, 
-                fn_task_wrapper, (void*) &task_data[i]);
+        int err = pthread_create(&threads[num_started], &attr, 
+                fn_task_wrapper, (void*) &par);
+        pthread_attr_destroy(&attr);
+        if(err != 0 && cpus.size() > 0)
+        {
+            // try again without pinning the thread
+            err = pthread_create(&threads[num_started], 0, 
+                    fn_task_wrapper, (void*) &par);
+        }
+        if(err != 0)
+        {
+            std::cerr << "warning; cannot create thread " << i 
+                << " (error " << err << ")\n";
+            continue;
+        }
+        num_started++;
     }
-    std::cerr << "forked " << NUM_THREADS << " threads \n";
+
+    // no threads at all; do the work on this one
+    if(num_started == 0)
+    {
+        std::cerr << "warning; running all tasks on the calling thread\n";
+        fn_task_wrapper((void*) &task_data[0]);
+    }
+    std::cerr << "forked " << num_started << " threads \n";
+
+    // the params of the threads that ran, or the params used on this 
+    // thread if none could be started
+    const uint32_t num_workers = num_started > 0 ? num_started : 1;
 
     std::cerr << "progress: [";
     for(uint32_t i = 0; i < 100; i++) { std::cerr <<" "; }
@@ -95,10 +189,12 @@ warthog::helpers::parallel_compute(void*(*fn_worker)(void*),
         // check progress
         uint32_t nprocessed = 0;
         uint32_t nfinished = 0;
-        for(uint32_t i = 0; i < NUM_THREADS; i++)
+        for(uint32_t i = 0; i < num_workers; i++)
         { 
-            nprocessed += task_data[i].nprocessed_; 
-            nfinished += task_data[i].thread_finished_;
+            nprocessed += __atomic_load_n(
+                    &task_data[i].nprocessed_, __ATOMIC_RELAXED); 
+            nfinished += __atomic_load_n(
+                    &task_data[i].thread_finished_, __ATOMIC_ACQUIRE);
         }
 
         uint32_t pct_progress = (nprocessed * 100)/task_total;
@@ -111,10 +207,27 @@ warthog::helpers::parallel_compute(void*(*fn_worker)(void*),
             pct_done = pct_progress;
         }
 
-        if(nfinished == NUM_THREADS) { break; }
-        else { sleep(5); }
+        if(nfinished == num_workers) { break; }
+        else { usleep(100000); }
     }
-    std::cerr << "\nparallel compute; end\n"<< std::endl;
+    std::cerr << "\n";
+
+    // per-thread throughput; shows how evenly the work was spread 
+    for(uint32_t i = 0; i < num_workers; i++)
+    {
+        if(i < num_started) { pthread_join(threads[i], 0); }
+        thread_params& par = task_data[i];
+        std::cerr 
+            << "thread " << i << " tasks " << par.nprocessed_ 
+            << " time (s) " << par.elapsed_secs_ 
+            << " tasks/s " << (par.elapsed_secs_ > 0 ? 
+                    par.nprocessed_ / par.elapsed_secs_ : 0)
+            << "\n";
+    }
+    std::cerr << "work steals: " << tasks.get_num_steals() << "\n";
+    std::cerr << "parallel compute; end\n"<< std::endl;
+
+    delete [] threads;
+    delete [] task_data;
     return 0;
 }
-
@@ -9,6 +9,8 @@
 // @created: 21/08/2012
 //
 
+#include "work_queue.h"
+
 #include <vector>
 #include <cstdlib>
 #include <cstdint>
@@ -49,27 +51,60 @@ struct thread_params
     bool thread_finished_;
     void*(*fn_worker_)(void*);
 
-    // task data
+    // task data. the worker counts its tasks with __atomic_fetch_add
+    // while ::parallel_compute reads nprocessed_ to report progress
     uint32_t nprocessed_;
     uint32_t first_id_;
     uint32_t last_id_;
     void* shared_;
+
+    // hands out task ids to threads (see ::next_task)
+    warthog::util::work_queue* tasks_;
+    double elapsed_secs_;
+
+    // threads update their own params while running; keep the params 
+    // of different threads on different cache lines
+    char padding_[64];
 };
 
+// the number of threads used by ::parallel_compute. zero (the default)
+// means one thread per hardware thread.
+void
+set_parallel_threads(uint32_t num_threads);
+
+uint32_t
+get_parallel_threads();
+
+// get the id of the next task for the thread described by @param par.
+// tasks are handed out dynamically: each thread starts with a 
+// contiguous block of ids and steals from other threads when its own 
+// block runs out, so threads that draw expensive tasks don't hold up 
+// the rest.
+// @return false when no tasks remain
+inline bool
+next_task(thread_params* par, uint32_t& task_id)
+{
+    return par->tasks_->next(par->thread_id_, task_id);
+}
+
 // helper code for simple parallel computations.
 // simple in this case means no synchronisation between threads.
 // @param fn_worker: the actual precompute function:
 //          - it takes as input a pointer whose actual type is
 //          warthog::label::thread_params
+//          - it calls ::next_task to get each task id
 //          - it returns a (possibly null) pointer to a result 
 // @param shared_data: 
 //         a pointer to data which will be shared among all worker 
 //         threads
 // @param task_total: the total number of tasks in the workload
+// @param num_ids: task ids are in the range [0, num_ids). workers may 
+//        skip some of these ids, so long as task_total are processed 
+//        (default: num_ids = task_total)
 // @return: 0 (the function always succeeds)
 void*
 parallel_compute(void*(*fn_worker)(void*), void* shared_data, 
-                 uint32_t task_total);
+                 uint32_t task_total, uint32_t num_ids = 0);
 }
 }
 
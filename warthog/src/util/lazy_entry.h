@@ -0,0 +1,47 @@
+#ifndef WARTHOG_LAZY_ENTRY_H
+#define WARTHOG_LAZY_ENTRY_H
+
+// util/lazy_entry.h
+//
+// Bucket-based open lists (bucket_queue, radix_heap,
+// multilevel_bucket_queue) never move a node between buckets. Each
+// call to ::push or ::decrease_key files a new entry holding the node
+// and its f-value at that time. Entries left behind by ::decrease_key
+// are discarded when they reach the front of the queue.
+//
+// An entry is live if its node is still in the queue and the node's
+// f-value has not changed since the entry was filed. A node's f-value
+// only ever decreases while it is on the open list, so at most one
+// entry per node is live.
+//
+// The queues mark nodes that are on the open list by setting
+// search_node::priority_ to LAZY_QUEUED.
+//
+
+#include <cstdint>
+
+namespace warthog
+{
+
+const uint32_t LAZY_QUEUED = UINT32_MAX - 1;
+const uint32_t LAZY_DEQUEUED = UINT32_MAX;
+
+template<class NODE>
+struct lazy_entry
+{
+    lazy_entry(NODE* node) : node_(node), f_(node->get_f()) { }
+
+    inline bool
+    live() const
+    {
+        return node_->get_priority() == warthog::LAZY_QUEUED &&
+               node_->get_f() == f_;
+    }
+
+    NODE* node_;
+    typename NODE::cost_t f_;
+};
+
+}
+
+#endif
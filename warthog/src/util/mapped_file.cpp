@@ -0,0 +1,62 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <iostream>
+
+warthog::util::mapped_file::mapped_file() : data_(0), size_(0)
+{ }
+
+warthog::util::mapped_file::~mapped_file()
+{
+    close();
+}
+
+bool
+warthog::util::mapped_file::open(const char* filename)
+{
+    close();
+
+    int fd = ::open(filename, O_RDONLY);
+    if(fd == -1)
+    {
+        std::cerr << "err; cannot open file " << filename << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) == -1 || st.st_size == 0)
+    {
+        std::cerr << "err; cannot read size of file " << filename 
+            << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    void* addr = mmap(0, st.st_size, PROT_READ | PROT_WRITE, 
+            MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps its own reference to the file
+    if(addr == MAP_FAILED)
+    {
+        std::cerr << "err; cannot mmap file " << filename << std::endl;
+        return false;
+    }
+
+    data_ = (char*)addr;
+    size_ = st.st_size;
+    return true;
+}
+
+void
+warthog::util::mapped_file::close()
+{
+    if(data_)
+    {
+        munmap(data_, size_);
+        data_ = 0;
+        size_ = 0;
+    }
+}
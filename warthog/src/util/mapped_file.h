@@ -0,0 +1,61 @@
+#ifndef WARTHOG_MAPPED_FILE_H
+#define WARTHOG_MAPPED_FILE_H
+
+// util/mapped_file.h
+//
+// Maps an entire file into memory with mmap. The mapping is private:
+// it can be written to, but writes only create a copy of the affected
+// pages and never reach the file. Pages that are never written stay
+// shared with the page cache, so several processes that map the same
+// file use only one copy of it.
+//
+
+#include <cstddef>
+#include <cstdint>
+
+namespace warthog
+{
+
+namespace util
+{
+
+class mapped_file
+{
+    public:
+        mapped_file();
+        ~mapped_file();
+
+        // map the file @param filename. any existing mapping is released.
+        // @return false if the file could not be opened or mapped
+        bool
+        open(const char* filename);
+
+        // release the mapping
+        void
+        close();
+
+        inline char*
+        data() { return data_; }
+
+        inline size_t
+        size() const { return size_; }
+
+        inline bool
+        is_open() const { return data_ != 0; }
+
+        size_t
+        mem() { return sizeof(*this); }
+
+    private:
+        char* data_;
+        size_t size_;
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,289 @@
+#ifndef WARTHOG_MULTILEVEL_BUCKET_QUEUE_H
+#define WARTHOG_MULTILEVEL_BUCKET_QUEUE_H
+
+// util/multilevel_bucket_queue.h
+//
+// A multi-level bucket queue with a heap on top, in the style of the
+// HOT queues of Cherkassky, Goldberg and Silverstein (1999).
+//
+// Each f-value is mapped to a coarse key floor(f / width). Coarse
+// keys larger than the current minimum go into radix buckets: one
+// level for each bit where the key differs from the current minimum,
+// as in warthog::radix_heap. Nodes whose coarse key equals the current
+// minimum go into a small binary heap. The heap orders them exactly,
+// by f and then by g, in the same way as warthog::pqueue. Only the
+// nodes in the current band of width @param width pay the heap's
+// logarithmic cost. All other nodes are filed in constant time.
+//
+// Unlike bucket_queue and radix_heap, this queue returns nodes in the
+// same f-order as a binary heap for any non-negative costs, such as
+// octile distances on grids. The band width only affects speed. A
+// narrow band keeps the heap small. A wide band reduces the number of
+// times nodes are moved between levels.
+//
+// Coarse keys must be monotone. A node whose coarse key is below the
+// current minimum goes into the heap and is still ordered exactly.
+//
+// See util/lazy_entry.h for how decrease_key works.
+//
+
+#include "lazy_entry.h"
+#include "search_node.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+namespace warthog
+{
+
+template<class NODE = warthog::search_node>
+class multilevel_bucket_queue
+{
+    typedef warthog::lazy_entry<NODE> entry;
+
+    // heap entries also remember the g-value of the node when it was
+    // filed. heap keys must not change while an entry is in the heap.
+    struct heap_entry : public entry
+    {
+        heap_entry(const entry& e) : entry(e), g_(e.node_->get_g()) { }
+        typename NODE::cost_t g_;
+    };
+
+    // std::push_heap builds a max-heap. this ordering puts the entry
+    // with the smallest f (largest g on ties) at the top.
+    struct heap_order
+    {
+        inline bool
+        operator()(const heap_entry& a, const heap_entry& b) const
+        {
+            if(a.f_ == b.f_) { return a.g_ < b.g_; }
+            return a.f_ > b.f_;
+        }
+    };
+
+    public:
+        typedef NODE node;
+
+        template<class N>
+        struct rebind
+        { typedef multilevel_bucket_queue<N> other; };
+
+        multilevel_bucket_queue(unsigned int size=1024, double width=1)
+            : inv_width_(1 / width), last_(0), live_(0), num_entries_(0),
+              cleared_(true)
+        {
+            assert(width > 0);
+            top_.reserve(size);
+        }
+
+        ~multilevel_bucket_queue() { }
+
+        void
+        clear()
+        {
+            for(uint32_t i = 0; i < top_.size(); i++)
+            {
+                top_[i].node_->set_priority(warthog::LAZY_DEQUEUED);
+            }
+            top_.clear();
+            for(uint32_t b = 1; b < NUM_LEVELS; b++)
+            {
+                std::vector<entry>& bucket = buckets_[b];
+                for(uint32_t i = 0; i < bucket.size(); i++)
+                {
+                    bucket[i].node_->set_priority(warthog::LAZY_DEQUEUED);
+                }
+                bucket.clear();
+            }
+            live_ = 0;
+            num_entries_ = 0;
+            cleared_ = true;
+        }
+
+        void
+        decrease_key(NODE* val)
+        {
+            assert(contains(val));
+            file(val);
+        }
+
+        void
+        push(NODE* val)
+        {
+            if(contains(val)) { return; }
+            val->set_priority(warthog::LAZY_QUEUED);
+            live_++;
+            file(val);
+        }
+
+        NODE*
+        pop()
+        {
+            NODE* ans = peek();
+            if(ans)
+            {
+                std::pop_heap(top_.begin(), top_.end(), heap_order());
+                top_.pop_back();
+                num_entries_--;
+                live_--;
+                ans->set_priority(warthog::LAZY_DEQUEUED);
+            }
+            return ans;
+        }
+
+        NODE*
+        peek()
+        {
+            if(live_ == 0) { return 0; }
+            while(true)
+            {
+                while(top_.size() > 0 && !top_.front().live())
+                {
+                    std::pop_heap(top_.begin(), top_.end(), heap_order());
+                    top_.pop_back();
+                    num_entries_--;
+                }
+                if(top_.size() > 0) { return top_.front().node_; }
+                redistribute();
+            }
+        }
+
+        inline bool
+        contains(NODE* n)
+        {
+            return n->get_priority() == warthog::LAZY_QUEUED;
+        }
+
+        inline unsigned int
+        size()
+        {
+            return live_;
+        }
+
+        inline bool
+        is_minqueue()
+        {
+            return true;
+        }
+
+        void
+        print(std::ostream& out)
+        {
+            for(uint32_t i = 0; i < top_.size(); i++)
+            {
+                if(!top_[i].live()) { continue; }
+                top_[i].node_->print(out);
+                out << std::endl;
+            }
+            for(uint32_t b = 1; b < NUM_LEVELS; b++)
+            {
+                std::vector<entry>& bucket = buckets_[b];
+                for(uint32_t i = 0; i < bucket.size(); i++)
+                {
+                    if(!bucket[i].live()) { continue; }
+                    bucket[i].node_->print(out);
+                    out << std::endl;
+                }
+            }
+        }
+
+        unsigned int
+        mem()
+        {
+            size_t bytes = sizeof(*this) +
+                top_.capacity() * sizeof(heap_entry);
+            for(uint32_t b = 1; b < NUM_LEVELS; b++)
+            {
+                bytes += buckets_[b].capacity() * sizeof(entry);
+            }
+            return bytes;
+        }
+
+    private:
+        static const uint32_t NUM_LEVELS = 33;
+
+        // level 0 is top_; buckets_[0] is never used
+        std::vector<heap_entry> top_;
+        std::vector<entry> buckets_[NUM_LEVELS];
+        double inv_width_;
+        uint32_t last_;
+        uint32_t live_;
+        uint32_t num_entries_;
+        bool cleared_;      // nothing filed since the last ::clear
+
+        inline uint32_t
+        key(typename NODE::cost_t f)
+        {
+            return (uint32_t)(f * inv_width_);
+        }
+
+        inline uint32_t
+        level(uint32_t k)
+        {
+            return k == last_ ? 0 : 32 - __builtin_clz(k ^ last_);
+        }
+
+        inline void
+        push_top(const entry& e)
+        {
+            top_.push_back(heap_entry(e));
+            std::push_heap(top_.begin(), top_.end(), heap_order());
+        }
+
+        void
+        file(NODE* val)
+        {
+            entry e(val);
+            uint32_t k = key(e.f_);
+            if(cleared_) { last_ = k; cleared_ = false; }
+            if(k <= last_) { push_top(e); }
+            else { buckets_[level(k)].push_back(e); }
+            num_entries_++;
+        }
+
+        // the heap is empty. find the smallest coarse key in the
+        // lowest non-empty level, then move the entries of that level
+        // into the heap (same coarse key) or lower levels (all others).
+        // stale entries are dropped along the way.
+        void
+        redistribute()
+        {
+            uint32_t b = 1;
+            while(buckets_[b].size() == 0)
+            {
+                b++;
+                assert(b < NUM_LEVELS);
+            }
+
+            std::vector<entry>& bucket = buckets_[b];
+            uint32_t min_key = UINT32_MAX;
+            uint32_t num_live = 0;
+            for(uint32_t i = 0; i < bucket.size(); i++)
+            {
+                if(!bucket[i].live()) { continue; }
+                bucket[num_live++] = bucket[i];
+                uint32_t k = key(bucket[i].f_);
+                if(k < min_key) { min_key = k; }
+            }
+            num_entries_ -= (bucket.size() - num_live);
+            bucket.erase(bucket.begin() + num_live, bucket.end());
+            if(num_live == 0) { return; }
+
+            last_ = min_key;
+            for(uint32_t i = 0; i < num_live; i++)
+            {
+                uint32_t nb = level(key(bucket[i].f_));
+                assert(nb < b);
+                if(nb == 0) { top_.push_back(heap_entry(bucket[i])); }
+                else { buckets_[nb].push_back(bucket[i]); }
+            }
+            std::make_heap(top_.begin(), top_.end(), heap_order());
+            bucket.clear();
+        }
+};
+
+}
+
+#endif
@@ -12,13 +12,15 @@
 
 #include "search_node.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
 namespace warthog
 {
 
-class search_node;
+template<typename COST_T> class search_node_base;
+typedef search_node_base<double> search_node;
 
 struct min_q 
 { static const bool is_min_ = true; };
@@ -27,11 +29,20 @@ struct max_q
 { static const bool is_min_ = false; };
 
 
+// NODE is the type of search node stored in the queue
 template <class Comparator = warthog::cmp_less_search_node,
-          class QType = warthog::min_q>
+          class QType = warthog::min_q,
+          class NODE = warthog::search_node>
 class pqueue 
 {
 	public:
+        typedef NODE node;
+
+        // the same queue, but for search nodes of type N
+        template<class N>
+        struct rebind
+        { typedef pqueue<Comparator, QType, N> other; };
+
         pqueue(Comparator* cmp, unsigned int size=1024)
             : pqueue(size)
         { 
@@ -59,7 +70,7 @@ class pqueue
 
 		// reprioritise the specified element (up or down)
         void 
-        decrease_key(warthog::search_node* val)
+        decrease_key(NODE* val)
         {	
             assert(val->get_priority() < queuesize_);
             minqueue_ ?  
@@ -68,7 +79,7 @@ class pqueue
         }
 
         void 
-        increase_key(warthog::search_node* val)
+        increase_key(NODE* val)
         {
             assert(val->get_priority() < queuesize_);
             minqueue_ ? 
@@ -78,7 +89,7 @@ class pqueue
 
 		// add a new element to the pqueue
         void 
-        push(warthog::search_node* val)
+        push(NODE* val)
         {
             if(contains(val))
             {
@@ -87,7 +98,7 @@ class pqueue
 
             if(queuesize_+1 > maxsize_)
             {
-                resize(maxsize_*2);
+                resize(std::max(1u, maxsize_*2));
             }
             unsigned int priority = queuesize_;
             elts_[priority] = val;
@@ -97,7 +108,7 @@ class pqueue
         }
 
 		// remove the top element from the pqueue
-        warthog::search_node*
+        NODE*
         pop()
         {
             if (queuesize_ == 0)
@@ -105,7 +116,7 @@ class pqueue
                 return 0;
             }
 
-            warthog::search_node *ans = elts_[0];
+            NODE *ans = elts_[0];
             queuesize_--;
 
             if(queuesize_ > 0)
@@ -120,7 +131,7 @@ class pqueue
 		// @return true if the priority of the element is 
 		// otherwise
 		inline bool
-		contains(warthog::search_node* n)
+		contains(NODE* n)
 		{
 			unsigned int priority = n->get_priority();
 			if(priority < queuesize_ && &*n == &*elts_[priority])
@@ -131,7 +142,7 @@ class pqueue
 		}
 
 		// retrieve the top element without removing it
-		inline warthog::search_node*
+		inline NODE*
 		peek()
 		{
 			if(queuesize_ > 0)
@@ -166,7 +177,7 @@ class pqueue
 		unsigned int
 		mem()
 		{
-			return maxsize_*sizeof(warthog::search_node*)
+			return maxsize_*sizeof(NODE*)
 				+ sizeof(*this);
 		}
 
@@ -174,7 +185,7 @@ class pqueue
 		unsigned int maxsize_;
 		bool minqueue_;
 		unsigned int queuesize_;
-		warthog::search_node** elts_;
+		NODE** elts_;
         Comparator* cmp_;
 
 		// reorders the subpqueue containing elts_[index]
@@ -232,7 +243,7 @@ class pqueue
                 exit(1);
             }
 
-            warthog::search_node** tmp = new search_node*[newsize];
+            NODE** tmp = new NODE*[newsize];
             for(unsigned int i=0; i < queuesize_; i++)
             {
                 tmp[i] = elts_[i];
@@ -248,7 +259,7 @@ class pqueue
 		{
 			assert(index1 < queuesize_ && index2 < queuesize_);
 
-			warthog::search_node* tmp = elts_[index1];
+			NODE* tmp = elts_[index1];
 			elts_[index1] = elts_[index2];
 			elts_[index1]->set_priority(index1);
 			elts_[index2] = tmp;
@@ -0,0 +1,235 @@
+#ifndef WARTHOG_RADIX_HEAP_H
+#define WARTHOG_RADIX_HEAP_H
+
+// util/radix_heap.h
+//
+// A monotone radix heap for integer keys (Ahuja, Mehlhorn, Orlin and
+// Tarjan, 1990). The key of a node is floor(f). Let last be the key
+// most recently removed from the heap. A key k is stored in bucket 0
+// when k == last, and otherwise in bucket 1 + the index of the highest
+// bit where k and last differ. When bucket 0 runs out, the smallest
+// key in the next non-empty bucket becomes the new value of last, and
+// that bucket's entries move to lower buckets. Each entry moves at
+// most 32 times, so pop is amortised O(log C), where C is the largest
+// edge cost. Unlike Dial's bucket_queue, memory use does not depend
+// on C.
+//
+// As with bucket_queue, nodes are ordered by floor(f) only, so the
+// order matches warthog::pqueue only when every f-value is an integer.
+// Keys must be monotone; a key smaller than last is treated as last.
+//
+// See util/lazy_entry.h for how decrease_key works.
+//
+
+#include "lazy_entry.h"
+#include "search_node.h"
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+namespace warthog
+{
+
+template<class NODE = warthog::search_node>
+class radix_heap
+{
+    typedef warthog::lazy_entry<NODE> entry;
+
+    public:
+        typedef NODE node;
+
+        template<class N>
+        struct rebind
+        { typedef radix_heap<N> other; };
+
+        radix_heap(unsigned int size=1024)
+            : last_(0), live_(0), num_entries_(0), cleared_(true)
+        {
+            buckets_[0].reserve(size);
+        }
+
+        ~radix_heap() { }
+
+        void
+        clear()
+        {
+            for(uint32_t b = 0; b < NUM_BUCKETS; b++)
+            {
+                std::vector<entry>& bucket = buckets_[b];
+                for(uint32_t i = 0; i < bucket.size(); i++)
+                {
+                    bucket[i].node_->set_priority(warthog::LAZY_DEQUEUED);
+                }
+                bucket.clear();
+            }
+            live_ = 0;
+            num_entries_ = 0;
+            cleared_ = true;
+        }
+
+        void
+        decrease_key(NODE* val)
+        {
+            assert(contains(val));
+            file(val);
+        }
+
+        void
+        push(NODE* val)
+        {
+            if(contains(val)) { return; }
+            val->set_priority(warthog::LAZY_QUEUED);
+            live_++;
+            file(val);
+        }
+
+        NODE*
+        pop()
+        {
+            NODE* ans = peek();
+            if(ans)
+            {
+                buckets_[0].pop_back();
+                num_entries_--;
+                live_--;
+                ans->set_priority(warthog::LAZY_DEQUEUED);
+            }
+            return ans;
+        }
+
+        NODE*
+        peek()
+        {
+            if(live_ == 0) { return 0; }
+            while(true)
+            {
+                std::vector<entry>& front = buckets_[0];
+                while(front.size() > 0 && !front.back().live())
+                {
+                    front.pop_back();
+                    num_entries_--;
+                }
+                if(front.size() > 0) { return front.back().node_; }
+                redistribute();
+            }
+        }
+
+        inline bool
+        contains(NODE* n)
+        {
+            return n->get_priority() == warthog::LAZY_QUEUED;
+        }
+
+        inline unsigned int
+        size()
+        {
+            return live_;
+        }
+
+        inline bool
+        is_minqueue()
+        {
+            return true;
+        }
+
+        void
+        print(std::ostream& out)
+        {
+            for(uint32_t b = 0; b < NUM_BUCKETS; b++)
+            {
+                std::vector<entry>& bucket = buckets_[b];
+                for(uint32_t i = 0; i < bucket.size(); i++)
+                {
+                    if(!bucket[i].live()) { continue; }
+                    bucket[i].node_->print(out);
+                    out << std::endl;
+                }
+            }
+        }
+
+        unsigned int
+        mem()
+        {
+            size_t bytes = sizeof(*this);
+            for(uint32_t b = 0; b < NUM_BUCKETS; b++)
+            {
+                bytes += buckets_[b].capacity() * sizeof(entry);
+            }
+            return bytes;
+        }
+
+    private:
+        static const uint32_t NUM_BUCKETS = 33;
+
+        std::vector<entry> buckets_[NUM_BUCKETS];
+        uint32_t last_;
+        uint32_t live_;
+        uint32_t num_entries_;
+        bool cleared_;      // nothing filed since the last ::clear
+
+        inline uint32_t
+        key(typename NODE::cost_t f)
+        {
+            return (uint32_t)f;
+        }
+
+        inline uint32_t
+        bucket_index(uint32_t k)
+        {
+            return k == last_ ? 0 : 32 - __builtin_clz(k ^ last_);
+        }
+
+        void
+        file(NODE* val)
+        {
+            uint32_t k = key(val->get_f());
+            if(cleared_) { last_ = k; cleared_ = false; }
+            else if(k < last_) { k = last_; }
+            buckets_[bucket_index(k)].push_back(entry(val));
+            num_entries_++;
+        }
+
+        // bucket 0 is empty. move the entries of the first non-empty
+        // bucket into lower buckets, relative to the smallest key
+        // among them. stale entries are dropped along the way.
+        void
+        redistribute()
+        {
+            uint32_t b = 1;
+            while(buckets_[b].size() == 0)
+            {
+                b++;
+                assert(b < NUM_BUCKETS);
+            }
+
+            std::vector<entry>& bucket = buckets_[b];
+            uint32_t min_key = UINT32_MAX;
+            uint32_t num_live = 0;
+            for(uint32_t i = 0; i < bucket.size(); i++)
+            {
+                if(!bucket[i].live()) { continue; }
+                bucket[num_live++] = bucket[i];
+                uint32_t k = key(bucket[i].f_);
+                if(k < min_key) { min_key = k; }
+            }
+            num_entries_ -= (bucket.size() - num_live);
+            bucket.erase(bucket.begin() + num_live, bucket.end());
+            if(num_live == 0) { return; }
+
+            // every entry in bucket b has a key greater than last_,
+            // so no entry stays in bucket b
+            last_ = min_key;
+            for(uint32_t i = 0; i < num_live; i++)
+            {
+                uint32_t nb = bucket_index(key(bucket[i].f_));
+                assert(nb < b);
+                buckets_[nb].push_back(bucket[i]);
+            }
+            bucket.clear();
+        }
+};
+
+}
+
+#endif
@@ -0,0 +1,94 @@
+#include "work_queue.h"
+
+#include <cassert>
+
+warthog::util::work_queue::work_queue(
+        uint32_t num_tasks, uint32_t num_workers)
+    : num_tasks_(num_tasks), num_workers_(num_workers), num_steals_(0)
+{
+    if(num_workers_ == 0) { num_workers_ = 1; }
+    ranges_ = new task_range[num_workers_];
+
+    // split the tasks into contiguous ranges of near-equal size
+    uint32_t per_worker = num_tasks_ / num_workers_;
+    uint32_t remainder = num_tasks_ % num_workers_;
+    uint32_t begin = 0;
+    for(uint32_t i = 0; i < num_workers_; i++)
+    {
+        uint32_t end = begin + per_worker + (i < remainder ? 1 : 0);
+        ranges_[i].bounds_.store(pack(begin, end));
+        begin = end;
+    }
+    assert(begin == num_tasks_);
+}
+
+warthog::util::work_queue::~work_queue()
+{
+    delete [] ranges_;
+}
+
+bool
+warthog::util::work_queue::next(uint32_t worker_id, uint32_t& task_id)
+{
+    assert(worker_id < num_workers_);
+    std::atomic<uint64_t>& mine = ranges_[worker_id].bounds_;
+    while(true)
+    {
+        uint64_t bounds = mine.load();
+        uint32_t begin = range_begin(bounds);
+        uint32_t end = range_end(bounds);
+        if(begin < end)
+        {
+            // take from the front; thieves take from the back
+            if(mine.compare_exchange_weak(bounds, pack(begin+1, end)))
+            {
+                task_id = begin;
+                return true;
+            }
+            continue;
+        }
+        if(!steal(worker_id)) { return false; }
+    }
+}
+
+bool
+warthog::util::work_queue::steal(uint32_t worker_id)
+{
+    while(true)
+    {
+        // look for the victim with the most remaining work
+        uint32_t victim = worker_id;
+        uint64_t victim_bounds = 0;
+        uint32_t max_remaining = 0;
+        for(uint32_t i = 1; i < num_workers_; i++)
+        {
+            uint32_t which = (worker_id + i) % num_workers_;
+            uint64_t bounds = ranges_[which].bounds_.load();
+            uint32_t remaining = range_end(bounds) - range_begin(bounds);
+            if(range_begin(bounds) < range_end(bounds) && 
+               remaining > max_remaining)
+            {
+                victim = which;
+                victim_bounds = bounds;
+                max_remaining = remaining;
+            }
+        }
+        if(victim == worker_id) { return false; }
+
+        // take the back half (rounded up) of the victim's range.
+        // if the CAS fails the victim made progress or somebody else
+        // stole first; either way we look again
+        uint32_t begin = range_begin(victim_bounds);
+        uint32_t end = range_end(victim_bounds);
+        uint32_t mid = end - ((end - begin + 1) >> 1);
+        if(ranges_[victim].bounds_.compare_exchange_strong(
+                    victim_bounds, pack(begin, mid)))
+        {
+            // our own range is empty, so nobody else writes to it until 
+            // the stolen tasks are visible here
+            ranges_[worker_id].bounds_.store(pack(mid, end));
+            num_steals_++;
+            return true;
+        }
+    }
+}
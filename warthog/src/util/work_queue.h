@@ -0,0 +1,87 @@
+#ifndef WARTHOG_WORK_QUEUE_H
+#define WARTHOG_WORK_QUEUE_H
+
+// util/work_queue.h
+//
+// Hands out a fixed set of task ids, [0, num_tasks), to a fixed number
+// of worker threads. Each worker begins with a contiguous range of ids
+// and takes tasks from the front of that range. A worker whose range is
+// exhausted steals the back half of the range of some other worker.
+// Every task id is handed out exactly once.
+//
+// The bounds of each range are packed into a single 64bit word so that
+// both the owner and any thieves can update them with one CAS.
+//
+
+#include <atomic>
+#include <cstdint>
+
+namespace warthog
+{
+
+namespace util
+{
+
+class work_queue
+{
+    public:
+        work_queue(uint32_t num_tasks, uint32_t num_workers);
+        ~work_queue();
+
+        // get the next task for the worker @param worker_id
+        // @return true if a task was assigned to @param task_id and
+        // false if there is no work left
+        bool
+        next(uint32_t worker_id, uint32_t& task_id);
+
+        inline uint32_t
+        get_num_tasks() { return num_tasks_; }
+
+        inline uint32_t
+        get_num_workers() { return num_workers_; }
+
+        // the number of ranges successfully stolen from other workers
+        inline uint32_t
+        get_num_steals() { return num_steals_.load(); }
+
+    private:
+        // one range per worker; padded to a cache line so that workers
+        // taking tasks from their own ranges don't contend with each other
+        struct task_range
+        {
+            std::atomic<uint64_t> bounds_;
+            char padding_[64 - sizeof(std::atomic<uint64_t>)];
+        };
+
+        inline uint64_t
+        pack(uint32_t begin, uint32_t end)
+        { return (((uint64_t)begin) << 32) | end; }
+
+        inline uint32_t
+        range_begin(uint64_t bounds) { return (uint32_t)(bounds >> 32); }
+
+        inline uint32_t
+        range_end(uint64_t bounds) { return (uint32_t)bounds; }
+
+        // move half the remaining tasks of some other worker into the
+        // (empty) range of @param worker_id.
+        // @return false if every other range is empty too
+        bool
+        steal(uint32_t worker_id);
+
+        uint32_t num_tasks_;
+        uint32_t num_workers_;
+        task_range* ranges_;
+        std::atomic<uint32_t> num_steals_;
+
+        // no copy
+        work_queue(const work_queue& other) { }
+        work_queue& operator=(const work_queue& other) { return *this; }
+};
+
+}
+
+}
+
+#endif
+